@@ -0,0 +1,201 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/bezierPatchTable.h"
+#include "../far/patchBasis.h"
+
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+
+    //
+    //  Change of basis of one parametric direction of a regular patch : the
+    //  4 Bezier points of a uniform cubic B-spline segment, after replacing
+    //  the first and/or last B-spline points with the phantom points implied
+    //  by a boundary (P0 = 2*P1 - P2), as done by the boundary weights of the
+    //  B-spline basis
+    //
+    void
+    getBezierConversion(bool startBoundary, bool endBoundary, float m[4][4]) {
+
+        static double const bsplineToBezier[4][4] = {
+            { 1.0/6.0, 4.0/6.0, 1.0/6.0,     0.0 },
+            {     0.0, 4.0/6.0, 2.0/6.0,     0.0 },
+            {     0.0, 2.0/6.0, 4.0/6.0,     0.0 },
+            {     0.0, 1.0/6.0, 4.0/6.0, 1.0/6.0 } };
+
+        double phantoms[4][4] = {
+            { 1.0, 0.0, 0.0, 0.0 },
+            { 0.0, 1.0, 0.0, 0.0 },
+            { 0.0, 0.0, 1.0, 0.0 },
+            { 0.0, 0.0, 0.0, 1.0 } };
+        if (startBoundary) {
+            phantoms[0][0] =  0.0;
+            phantoms[0][1] =  2.0;
+            phantoms[0][2] = -1.0;
+        }
+        if (endBoundary) {
+            phantoms[3][3] =  0.0;
+            phantoms[3][2] =  2.0;
+            phantoms[3][1] = -1.0;
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                double w = 0.0;
+                for (int k = 0; k < 4; ++k) {
+                    w += bsplineToBezier[i][k] * phantoms[k][j];
+                }
+                m[i][j] = (float)w;
+            }
+        }
+    }
+} // end namespace unnamed
+
+BezierPatchTable::BezierPatchTable() :
+    _firstBezierPoint(0), _bezierPointStencils(0) {
+}
+
+BezierPatchTable::~BezierPatchTable() {
+    delete _bezierPointStencils;
+}
+
+BezierPatchTable *
+BezierPatchTable::Create(PatchTable const & patchTable,
+                         Index firstBezierPoint) {
+
+    BezierPatchTable * result = new BezierPatchTable;
+    result->_firstBezierPoint = firstBezierPoint;
+
+    int numPatches = patchTable.GetNumPatchesTotal();
+    result->_bezierPointIndices.resize(numPatches, INDEX_INVALID);
+
+    int numBezierPatches = 0;
+    for (int array = 0; array < patchTable.GetNumPatchArrays(); ++array) {
+        if (patchTable.GetPatchArrayDescriptor(array).GetType() ==
+            PatchDescriptor::REGULAR) {
+            numBezierPatches += patchTable.GetNumPatches(array);
+        }
+    }
+    if (numBezierPatches == 0) {
+        return result;
+    }
+    result->_paramTable.reserve(numBezierPatches);
+
+    //  Each Bezier point combines the (at most 3x3) B-spline points of its
+    //  row and column conversions with non-zero weights
+    StencilTable * stencils = new StencilTable;
+    stencils->_numControlVertices = 0;
+    stencils->_sizes.reserve(16 * numBezierPatches);
+    stencils->_indices.reserve(16 * 9 * numBezierPatches);
+    stencils->_weights.reserve(16 * 9 * numBezierPatches);
+
+    int patchIndex = 0;
+    for (int array = 0; array < patchTable.GetNumPatchArrays(); ++array) {
+
+        int numArrayPatches = patchTable.GetNumPatches(array);
+        if (patchTable.GetPatchArrayDescriptor(array).GetType() !=
+            PatchDescriptor::REGULAR) {
+            patchIndex += numArrayPatches;
+            continue;
+        }
+
+        for (int patch = 0; patch < numArrayPatches; ++patch, ++patchIndex) {
+
+            PatchParam param = patchTable.GetPatchParam(array, patch);
+            ConstIndexArray cvs = patchTable.GetPatchVertices(array, patch);
+
+            int boundary = param.GetBoundary();
+
+            float sConversion[4][4], tConversion[4][4];
+            getBezierConversion((boundary & 8) != 0, (boundary & 2) != 0,
+                                sConversion);
+            getBezierConversion((boundary & 1) != 0, (boundary & 4) != 0,
+                                tConversion);
+
+            for (int row = 0; row < 4; ++row) {
+                for (int col = 0; col < 4; ++col) {
+                    int size = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        for (int j = 0; j < 4; ++j) {
+                            float w = tConversion[row][i] * sConversion[col][j];
+                            if (w != 0.0f) {
+                                stencils->_indices.push_back(cvs[4*i + j]);
+                                stencils->_weights.push_back(w);
+                                ++size;
+                            }
+                        }
+                    }
+                    stencils->_sizes.push_back(size);
+                }
+            }
+
+            result->_bezierPointIndices[patchIndex] = firstBezierPoint +
+                16 * (Index)result->_paramTable.size();
+
+            //  The boundaries are resolved in the Bezier points
+            param.field1 &= ~(0xfu << 8);
+            result->_paramTable.push_back(param);
+        }
+    }
+    stencils->generateOffsets();
+    result->_bezierPointStencils = stencils;
+
+    return result;
+}
+
+void
+BezierPatchTable::EvaluateBasis(PatchTable::PatchHandle const & handle,
+    float s, float t, float wP[16], float wDs[16], float wDt[16]) const {
+
+    Index bezierPoints = _bezierPointIndices[handle.patchIndex];
+    assert(bezierPoints != INDEX_INVALID);
+
+    internal::GetBezierWeights(
+        _paramTable[(bezierPoints - _firstBezierPoint) / 16],
+        s, t, wP, wDs, wDt);
+}
+
+void
+BezierPatchTable::ExportBezierPatches(float const * src, int numElements,
+    int stride, float * dst) const {
+
+    src += _firstBezierPoint * stride;
+    for (int i = 0; i < GetNumBezierPoints(); ++i, src += stride) {
+        for (int k = 0; k < numElements; ++k) {
+            *dst++ = src[k];
+        }
+    }
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
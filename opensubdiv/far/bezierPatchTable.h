@@ -0,0 +1,190 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_BEZIER_PATCH_TABLE_H
+#define OPENSUBDIV3_FAR_BEZIER_PATCH_TABLE_H
+
+#include "../version.h"
+
+#include "../far/patchTable.h"
+#include "../far/stencilTable.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief Bicubic Bezier form of the regular patches of a PatchTable
+///
+/// Each REGULAR patch of the source PatchTable is converted to the 16 control
+/// points of an equivalent bicubic Bezier patch. The boundary points implied
+/// by the boundary mask of the patches -- which also flags the sharp edge of
+/// single-crease patches -- are resolved in the conversion, so that the
+/// Bezier patches are evaluated with plain Bernstein polynomials instead of
+/// B-spline weights adjusted at every sample.
+///
+/// The Bezier points are linear combinations of the vertices of the patch
+/// table (refined vertices followed by the local points of the end caps) and
+/// are computed with the stencils returned by GetBezierPointStencilTable(),
+/// once for every update of the vertices. They are stored after these
+/// vertices, 16 consecutive points per patch, starting at the index given to
+/// Create().
+///
+/// Other patch types (Gregory and extraordinary end caps, bilinear quads) are
+/// not converted : their entries in the Bezier point index table are
+/// INDEX_INVALID and they are evaluated from the source PatchTable.
+///
+class BezierPatchTable {
+
+public:
+
+    /// \brief Creates the Bezier form of the regular patches of a PatchTable
+    ///
+    /// @param patchTable        The source patch table
+    ///
+    /// @param firstBezierPoint  Index of the first Bezier point in the vertex
+    ///                          buffer, typically the number of refined
+    ///                          vertices plus the number of local points of
+    ///                          the patch table
+    ///
+    static BezierPatchTable * Create(PatchTable const & patchTable,
+                                     Index firstBezierPoint);
+
+    /// \brief Destructor
+    ~BezierPatchTable();
+
+    /// \brief Returns the number of Bezier patches
+    int GetNumPatches() const { return (int)_paramTable.size(); }
+
+    /// \brief Returns the number of Bezier points (16 per patch)
+    int GetNumBezierPoints() const { return 16 * GetNumPatches(); }
+
+    /// \brief Returns the index of the first Bezier point in the vertex buffer
+    Index GetFirstBezierPoint() const { return _firstBezierPoint; }
+
+    /// \brief Returns the index of the first of the 16 Bezier points of the
+    ///        patch identified by 'handle', or INDEX_INVALID if the patch is
+    ///        not converted
+    Index GetBezierPoints(PatchTable::PatchHandle const & handle) const {
+        return _bezierPointIndices[handle.patchIndex];
+    }
+
+    /// \brief Returns the index of the first Bezier point of each patch of
+    ///        the source table (indexed by PatchHandle::patchIndex)
+    std::vector<Index> const & GetBezierPointIndexTable() const {
+        return _bezierPointIndices;
+    }
+
+    /// \brief Returns the PatchParams of the Bezier patches, in the order of
+    ///        their points (the boundary masks are cleared)
+    PatchParamTable const & GetPatchParamTable() const { return _paramTable; }
+
+    /// \brief Returns the stencils computing the Bezier points from the
+    ///        vertices of the patch table
+    StencilTable const * GetBezierPointStencilTable() const {
+        return _bezierPointStencils;
+    }
+
+    /// \brief Updates the Bezier points from the vertices of the patch table
+    ///
+    /// @param src  Buffer with the refined vertices and the local points
+    ///
+    /// @param dst  Destination of the first Bezier point
+    ///
+    template <class T> void
+    ComputeBezierPointValues(T const *src, T *dst) const;
+
+    /// \brief Evaluates the Bernstein basis functions for position and first
+    ///        derivatives at a given (s,t) parametric location of a patch
+    ///
+    /// The weights apply to the 16 Bezier points of the patch, which must be
+    /// converted (see GetBezierPoints()).
+    ///
+    /// @param handle  A patch handle indentifying the sub-patch containing the
+    ///                (s,t) location
+    ///
+    /// @param s       Patch coordinate (in coarse face normalized space)
+    ///
+    /// @param t       Patch coordinate (in coarse face normalized space)
+    ///
+    /// @param wP      Weights for the position
+    ///
+    /// @param wDs     Weights for derivative wrt s
+    ///
+    /// @param wDt     Weights for derivative wrt t
+    ///
+    void EvaluateBasis(PatchTable::PatchHandle const & handle,
+        float s, float t, float wP[16], float wDs[16], float wDt[16]) const;
+
+    /// \brief Exports the Bezier patches to a flat buffer
+    ///
+    /// The 16 points of each Bezier patch are written consecutively, in the
+    /// order of GetPatchParamTable(), as 'numElements' floats per point :
+    /// the buffer holds 16 * numElements * GetNumPatches() floats.
+    ///
+    /// @param src          Vertex buffer holding the computed Bezier points
+    ///                     (from its first vertex, not from the first Bezier
+    ///                     point)
+    ///
+    /// @param numElements  Number of floats exported per point
+    ///
+    /// @param stride       Number of floats between consecutive vertices of
+    ///                     the source buffer
+    ///
+    /// @param dst          Destination buffer
+    ///
+    void ExportBezierPatches(float const * src, int numElements, int stride,
+                             float * dst) const;
+
+private:
+
+    BezierPatchTable();
+
+    Index                _firstBezierPoint;
+
+    std::vector<Index>   _bezierPointIndices; // per source patch (or INDEX_INVALID)
+    PatchParamTable      _paramTable;         // per Bezier patch
+
+    StencilTable const * _bezierPointStencils;
+};
+
+template <class T>
+inline void
+BezierPatchTable::ComputeBezierPointValues(T const *src, T *dst) const {
+    if (_bezierPointStencils) {
+        _bezierPointStencils->UpdateValues(src, dst);
+    }
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_BEZIER_PATCH_TABLE_H
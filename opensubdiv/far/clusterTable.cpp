@@ -0,0 +1,219 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/clusterTable.h"
+#include "../far/patchTable.h"
+#include "../far/stencilTable.h"
+
+#include <istream>
+#include <ostream>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+
+    //
+    //  Binary serialization helpers : values are written in the native byte
+    //  order, vectors are prefixed with their number of elements.
+    //
+    unsigned int const clusterMagic   = 0x4353444f, // "OSDC"
+                       clusterVersion = 1;
+
+    template <class T> void
+    writeValue(std::ostream & stream, T value) {
+        stream.write(reinterpret_cast<char const *>(&value), sizeof(T));
+    }
+
+    template <class T> bool
+    readValue(std::istream & stream, T * value) {
+        stream.read(reinterpret_cast<char *>(value), sizeof(T));
+        return stream.good();
+    }
+
+    template <class T> void
+    writeVector(std::ostream & stream, std::vector<T> const & v) {
+        writeValue(stream, (unsigned long long)v.size());
+        if (not v.empty()) {
+            stream.write(reinterpret_cast<char const *>(&v[0]), v.size()*sizeof(T));
+        }
+    }
+
+    template <class T> bool
+    readVector(std::istream & stream, std::vector<T> * v) {
+        unsigned long long size = 0;
+        if (not readValue(stream, &size)) {
+            return false;
+        }
+        v->resize((size_t)size);
+        if (size) {
+            stream.read(reinterpret_cast<char *>(&(*v)[0]), (size_t)size*sizeof(T));
+        }
+        return stream.good();
+    }
+
+    void
+    writeStencils(std::ostream & stream, StencilTable const * table) {
+        writeValue(stream, (unsigned char)(table!=0));
+        if (table) {
+            writeValue(stream, table->GetNumControlVertices());
+            writeVector(stream, table->GetSizes());
+            writeVector(stream, table->GetControlIndices());
+            writeVector(stream, table->GetWeights());
+        }
+    }
+} // end namespace
+
+ClusterTable::ClusterTable() :
+    _stencilTable(0), _varyingStencilTable(0), _patchTable(0),
+    _refinedFaceSize(0) {
+}
+
+ClusterTable::~ClusterTable() {
+    delete _stencilTable;
+    delete _varyingStencilTable;
+    delete _patchTable;
+}
+
+int
+ClusterTable::GetNumVertices() const {
+    return _stencilTable ? _stencilTable->GetNumStencils() : 0;
+}
+
+bool
+ClusterTable::Write(std::ostream & stream) const {
+
+    writeValue(stream, clusterMagic);
+    writeValue(stream, clusterVersion);
+
+    writeVector(stream, _baseFaces);
+
+    writeStencils(stream, _stencilTable);
+    writeStencils(stream, _varyingStencilTable);
+
+    writeValue(stream, _refinedFaceSize);
+    writeVector(stream, _refinedFaceVerts);
+
+    writeValue(stream, (unsigned char)(_patchTable!=0));
+    if (_patchTable) {
+        writeValue(stream, _patchTable->_maxValence);
+        writeValue(stream, _patchTable->_numPtexFaces);
+
+        int narrays = _patchTable->GetNumPatchArrays();
+        writeValue(stream, narrays);
+        for (int i=0; i<narrays; ++i) {
+            writeValue(stream, (int)_patchTable->GetPatchArrayDescriptor(i).GetType());
+            writeValue(stream, _patchTable->GetNumPatches(i));
+        }
+        writeVector(stream, _patchTable->_patchVerts);
+        writeVector(stream, _patchTable->_paramTable);
+        writeVector(stream, _patchTable->_sharpnessIndices);
+        writeVector(stream, _patchTable->_sharpnessValues);
+    }
+    return not stream.fail();
+}
+
+ClusterTable *
+ClusterTable::Read(std::istream & stream) {
+
+    unsigned int magic = 0, version = 0;
+    if ((not readValue(stream, &magic)) or (magic!=clusterMagic) or
+        (not readValue(stream, &version)) or (version!=clusterVersion)) {
+        return 0;
+    }
+
+    ClusterTable * cluster = new ClusterTable;
+
+    bool valid = readVector(stream, &cluster->_baseFaces);
+
+    StencilTable const ** stencils[2] = { &cluster->_stencilTable,
+                                          &cluster->_varyingStencilTable };
+    for (int i=0; valid and i<2; ++i) {
+        unsigned char hasTable = 0;
+        valid = readValue(stream, &hasTable);
+        if (valid and hasTable) {
+            StencilTable * table = new StencilTable;
+            *stencils[i] = table;
+            valid = readValue(stream, &table->_numControlVertices) and
+                    readVector(stream, &table->_sizes) and
+                    readVector(stream, &table->_indices) and
+                    readVector(stream, &table->_weights);
+            if (valid) {
+                table->generateOffsets();
+            }
+        }
+    }
+
+    valid = valid and
+            readValue(stream, &cluster->_refinedFaceSize) and
+            readVector(stream, &cluster->_refinedFaceVerts);
+
+    unsigned char hasPatches = 0;
+    valid = valid and readValue(stream, &hasPatches);
+    if (valid and hasPatches) {
+
+        int maxValence = 0, numPtexFaces = 0, narrays = 0;
+        valid = readValue(stream, &maxValence) and
+                readValue(stream, &numPtexFaces) and
+                readValue(stream, &narrays);
+
+        PatchTable * table = new PatchTable(maxValence);
+        cluster->_patchTable = table;
+        table->_numPtexFaces = numPtexFaces;
+
+        if (valid) {
+            table->reservePatchArrays(narrays);
+        }
+        int voffset=0, poffset=0;
+        for (int i=0; valid and i<narrays; ++i) {
+            int type = 0, npatches = 0;
+            valid = readValue(stream, &type) and readValue(stream, &npatches);
+            if (valid) {
+                table->pushPatchArray(PatchDescriptor(type), npatches,
+                    &voffset, &poffset);
+            }
+        }
+        valid = valid and
+                readVector(stream, &table->_patchVerts) and
+                readVector(stream, &table->_paramTable) and
+                readVector(stream, &table->_sharpnessIndices) and
+                readVector(stream, &table->_sharpnessValues) and
+                (table->_patchVerts.size()==(size_t)voffset) and
+                (table->_paramTable.size()==(size_t)poffset);
+    }
+
+    if (not valid) {
+        delete cluster;
+        return 0;
+    }
+    return cluster;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
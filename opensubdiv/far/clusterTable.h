@@ -0,0 +1,157 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_CLUSTER_TABLE_H
+#define OPENSUBDIV3_FAR_CLUSTER_TABLE_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <iosfwd>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+class StencilTable;
+class PatchTable;
+
+/// \brief Refined vertices and patches of a cluster of base faces
+///
+/// Large meshes can be processed one cluster of base faces at a time (see
+/// ClusterTableFactory) : each ClusterTable holds the data needed to compute
+/// the refined vertices or the limit surface of the faces of its cluster,
+/// independently from the rest of the mesh, and can be streamed to and from
+/// disk with Write() and Read().
+///
+/// The vertices of a cluster are computed from the control vertices of the
+/// whole base mesh with the stencil table of the cluster. Vertices on the
+/// border of a cluster are duplicated in the adjacent clusters : they are
+/// computed with the same stencil weights, applied in the same order, as
+/// the corresponding vertices of the whole refined mesh.
+///
+class ClusterTable {
+
+public:
+
+    /// \brief Destructor
+    ~ClusterTable();
+
+    /// \brief Returns true if the cluster holds adaptive patches
+    bool IsFeatureAdaptive() const { return _patchTable!=0; }
+
+    /// \brief Returns the number of base faces in the cluster
+    int GetNumBaseFaces() const { return (int)_baseFaces.size(); }
+
+    /// \brief Returns the (sorted) indices of the base faces of the cluster
+    ConstIndexArray GetBaseFaces() const {
+        return ConstIndexArray(_baseFaces.empty() ? 0 : &_baseFaces[0],
+                               (int)_baseFaces.size());
+    }
+
+    /// \brief Returns the number of vertices of the cluster
+    int GetNumVertices() const;
+
+    /// \brief Returns the stencils computing the vertices of the cluster from
+    ///        the control vertices of the base mesh
+    StencilTable const * GetStencilTable() const { return _stencilTable; }
+
+    /// \brief Returns the varying stencils of the vertices of the cluster (or
+    ///        NULL if they were not requested)
+    StencilTable const * GetVaryingStencilTable() const {
+        return _varyingStencilTable;
+    }
+
+    /// \brief Returns the patches of the base faces (adaptive clusters only)
+    ///
+    /// The patches index the vertices of the cluster and their ptex face ids
+    /// are those of the base mesh.
+    ///
+    PatchTable const * GetPatchTable() const { return _patchTable; }
+
+    /// \brief Returns the number of refined faces (uniform clusters only)
+    ///
+    /// The refined faces of each base face are contiguous and in the order
+    /// of the base faces : they are ordered as in the last level of the
+    /// uniformly refined mesh.
+    ///
+    int GetNumRefinedFaces() const {
+        return _refinedFaceSize ?
+            (int)(_refinedFaceVerts.size() / _refinedFaceSize) : 0;
+    }
+
+    /// \brief Returns the number of vertices of the refined faces
+    int GetRefinedFaceSize() const { return _refinedFaceSize; }
+
+    /// \brief Returns the vertices of a refined face
+    ConstIndexArray GetRefinedFaceVertices(int face) const {
+        return ConstIndexArray(&_refinedFaceVerts[face*_refinedFaceSize],
+                               _refinedFaceSize);
+    }
+
+    /// \brief Writes the cluster to a binary stream
+    ///
+    /// @param stream  Output stream (opened in binary mode)
+    ///
+    /// @return        False if the stream is in a failed state after writing
+    ///
+    bool Write(std::ostream & stream) const;
+
+    /// \brief Reads a cluster written with Write()
+    ///
+    /// @param stream  Input stream (opened in binary mode)
+    ///
+    /// @return        A new ClusterTable or NULL if the data is invalid
+    ///
+    static ClusterTable * Read(std::istream & stream);
+
+private:
+
+    friend class ClusterTableFactory;
+
+    ClusterTable();
+
+    std::vector<Index>   _baseFaces;        // sorted base faces of the cluster
+
+    StencilTable const * _stencilTable,     // vertex stencils of the cluster
+                       * _varyingStencilTable;
+
+    PatchTable *         _patchTable;       // adaptive patches (or NULL)
+
+    int                  _refinedFaceSize;  // uniform refined faces
+    std::vector<Index>   _refinedFaceVerts;
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_CLUSTER_TABLE_H
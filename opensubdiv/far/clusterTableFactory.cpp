@@ -0,0 +1,394 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/clusterTableFactory.h"
+#include "../far/clusterTable.h"
+#include "../far/error.h"
+#include "../far/patchTable.h"
+#include "../far/ptexIndices.h"
+#include "../far/stencilTable.h"
+#include "../far/stencilTableFactory.h"
+#include "../far/topologyRefiner.h"
+#include "../far/topologyRegion.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+namespace {
+
+    //
+    //  Gathers the vertices flagged in 'used' : returns their indices and maps
+    //  the flags to the new (compact) indices
+    //
+    void
+    compactVertices(std::vector<Index> & used, std::vector<Index> & rows) {
+        rows.clear();
+        for (int i=0; i<(int)used.size(); ++i) {
+            if (used[i]!=INDEX_INVALID) {
+                used[i] = (Index)rows.size();
+                rows.push_back(i);
+            }
+        }
+    }
+} // end namespace
+
+//
+//  Returns the stencils of the given rows of a region stencil table, with
+//  their control vertices re-indexed to the base mesh
+//
+StencilTable *
+ClusterTableFactory::extractStencils(StencilTable const & src,
+    std::vector<Index> const & rows,
+    internal::TopologyRegion const & region, int numBaseVertices) {
+
+    StencilTable * dst = new StencilTable(numBaseVertices);
+
+    dst->_sizes.resize(rows.size());
+
+    size_t nelems = 0;
+    for (size_t i=0; i<rows.size(); ++i) {
+        dst->_sizes[i] = src.GetSizes()[rows[i]];
+        nelems += dst->_sizes[i];
+    }
+
+    dst->_indices.reserve(nelems);
+    dst->_weights.reserve(nelems);
+    for (size_t i=0; i<rows.size(); ++i) {
+        Stencil stencil = src.GetStencil(rows[i]);
+        for (int j=0; j<stencil.GetSize(); ++j) {
+            dst->_indices.push_back(
+                region.GetBaseVertex(stencil.GetVertexIndices()[j]));
+            dst->_weights.push_back(stencil.GetWeights()[j]);
+        }
+    }
+    dst->generateOffsets();
+    return dst;
+}
+
+//
+//  Partitioning of the base faces
+//
+int
+ClusterTableFactory::PartitionFaces(TopologyRefiner const & refiner,
+    int maxClusterFaces, std::vector<int> & clusterOffsets,
+    std::vector<Index> & clusterFaces) {
+
+    TopologyLevel const & base = refiner.GetLevel(0);
+
+    int nfaces = base.GetNumFaces();
+
+    maxClusterFaces = std::max(1, maxClusterFaces);
+
+    clusterOffsets.clear();
+    clusterOffsets.push_back(0);
+    clusterFaces.clear();
+    clusterFaces.reserve(nfaces);
+
+    std::vector<unsigned char> assigned(nfaces, false);
+
+    for (Index seed=0; seed<nfaces; ++seed) {
+
+        if (assigned[seed]) {
+            continue;
+        }
+
+        //  Breadth-first traversal of the faces incident to the vertices of
+        //  the faces gathered (clusterFaces doubles as the queue)
+        int start = (int)clusterFaces.size();
+
+        assigned[seed] = true;
+        clusterFaces.push_back(seed);
+
+        for (int head=start; head<(int)clusterFaces.size(); ++head) {
+
+            if ((int)clusterFaces.size()-start >= maxClusterFaces) {
+                break;
+            }
+
+            ConstIndexArray fverts = base.GetFaceVertices(clusterFaces[head]);
+            for (int i=0; i<fverts.size(); ++i) {
+
+                ConstIndexArray vfaces = base.GetVertexFaces(fverts[i]);
+                for (int j=0; j<vfaces.size(); ++j) {
+
+                    if ((int)clusterFaces.size()-start >= maxClusterFaces) {
+                        break;
+                    }
+                    if (not assigned[vfaces[j]]) {
+                        assigned[vfaces[j]] = true;
+                        clusterFaces.push_back(vfaces[j]);
+                    }
+                }
+            }
+        }
+        std::sort(clusterFaces.begin() + start, clusterFaces.end());
+        clusterOffsets.push_back((int)clusterFaces.size());
+    }
+    return (int)clusterOffsets.size()-1;
+}
+
+//
+//  Refinement of a cluster
+//
+ClusterTable *
+ClusterTableFactory::Create(TopologyRefiner const & refiner,
+    ConstIndexArray faces, Options options, PtexIndices const * ptexIndices) {
+
+    if (faces.size()==0) {
+        Error(FAR_CODING_ERROR,
+            "ClusterTableFactory::Create requires a non-empty cluster");
+        return 0;
+    }
+    if (options.adaptive and
+        (options.patchOptions.GetEndCapType()==
+            PatchTableFactory::Options::ENDCAP_LEGACY_GREGORY or
+         options.patchOptions.generateFVarTables)) {
+        Error(FAR_CODING_ERROR,
+            "ClusterTableFactory::Create does not support face-varying "
+            "patches or legacy Gregory end-caps");
+        return 0;
+    }
+
+    int level = std::max(1, (int)options.refinementLevel);
+
+    //
+    //  Extract the faces of the cluster along with enough rings of faces for
+    //  the vertices of the cluster to have the same neighborhoods as in the
+    //  whole mesh : one ring for the stencils of the refined vertices, two for
+    //  the adaptive isolation of the features surrounding the cluster.
+    //
+    internal::TopologyRegion region(refiner, faces, options.adaptive ? 2 : 1);
+
+    TopologyRefiner * regionRefiner = region.CreateRefiner();
+    if (not regionRefiner) {
+        return 0;
+    }
+
+    ClusterTable * cluster = new ClusterTable;
+
+    std::vector<unsigned char> faceMask(region.GetNumFaces());
+    for (int face=0; face<region.GetNumFaces(); ++face) {
+        faceMask[face] = (region.GetFaceRing(face)==0);
+        if (faceMask[face]) {
+            cluster->_baseFaces.push_back(region.GetBaseFace(face));
+        }
+    }
+
+    int numBaseVertices = refiner.GetLevel(0).GetNumVertices();
+
+    StencilTableFactory::Options stencilOptions;
+    stencilOptions.generateOffsets = true;
+
+    //
+    //  Vertices used by the faces or patches of the cluster, indexed by their
+    //  stencil in the region (INDEX_INVALID if unused)
+    //
+    std::vector<Index> used;
+
+    StencilTable const * stencils[2] = { 0, 0 };
+
+    if (not options.adaptive) {
+
+        regionRefiner->RefineUniform(TopologyRefiner::UniformOptions(level));
+
+        stencilOptions.generateIntermediateLevels = false;
+
+        //  Gather the refined faces of the cluster : the child faces of each
+        //  level are ordered like their parents
+        std::vector<Index> parents, children;
+        for (int face=0; face<region.GetNumFaces(); ++face) {
+            if (faceMask[face]) {
+                parents.push_back(face);
+            }
+        }
+        for (int i=0; i<level; ++i) {
+            TopologyLevel const & parentLevel = regionRefiner->GetLevel(i);
+            children.clear();
+            for (size_t j=0; j<parents.size(); ++j) {
+                ConstIndexArray cfaces = parentLevel.GetFaceChildFaces(parents[j]);
+                children.insert(children.end(), cfaces.begin(), cfaces.end());
+            }
+            parents.swap(children);
+        }
+
+        TopologyLevel const & lastLevel = regionRefiner->GetLevel(level);
+
+        used.resize(lastLevel.GetNumVertices(), INDEX_INVALID);
+
+        cluster->_refinedFaceSize = lastLevel.GetFaceVertices(parents[0]).size();
+        cluster->_refinedFaceVerts.reserve(parents.size() * cluster->_refinedFaceSize);
+        for (size_t i=0; i<parents.size(); ++i) {
+            ConstIndexArray fverts = lastLevel.GetFaceVertices(parents[i]);
+            assert(fverts.size()==cluster->_refinedFaceSize);
+            for (int j=0; j<fverts.size(); ++j) {
+                used[fverts[j]] = 0;
+                cluster->_refinedFaceVerts.push_back(fverts[j]);
+            }
+        }
+
+        std::vector<Index> rows;
+        compactVertices(used, rows);
+
+        for (size_t i=0; i<cluster->_refinedFaceVerts.size(); ++i) {
+            cluster->_refinedFaceVerts[i] = used[cluster->_refinedFaceVerts[i]];
+        }
+
+        for (int i=0; i<(options.generateVaryingStencils ? 2 : 1); ++i) {
+
+            stencilOptions.interpolationMode = (i==0) ?
+                StencilTableFactory::INTERPOLATE_VERTEX :
+                StencilTableFactory::INTERPOLATE_VARYING;
+
+            StencilTable const * regionStencils =
+                StencilTableFactory::Create(*regionRefiner, stencilOptions);
+
+            stencils[i] = extractStencils(*regionStencils, rows, region, numBaseVertices);
+            delete regionStencils;
+        }
+
+    } else {
+
+        TopologyRefiner::AdaptiveOptions adaptiveOptions(level);
+        adaptiveOptions.useSingleCreasePatch =
+            options.patchOptions.useSingleCreasePatch;
+        regionRefiner->RefineAdaptive(adaptiveOptions);
+
+        PatchTableFactory::Options patchOptions = options.patchOptions;
+        patchOptions.maxIsolationLevel = level;
+
+        PatchTable * table =
+            PatchTableFactory::createAdaptive(*regionRefiner, patchOptions, &faceMask);
+
+        //  The patches index the control vertices of the region, followed
+        //  by the refined vertices of all levels and the end-cap local points
+        stencilOptions.generateControlVerts = true;
+        stencilOptions.generateIntermediateLevels = true;
+
+        used.resize(regionRefiner->GetNumVerticesTotal() +
+            (table->GetLocalPointStencilTable() ?
+                table->GetLocalPointStencilTable()->GetNumStencils() : 0),
+            INDEX_INVALID);
+
+        for (size_t i=0; i<table->_patchVerts.size(); ++i) {
+            used[table->_patchVerts[i]] = 0;
+        }
+
+        std::vector<Index> rows;
+        compactVertices(used, rows);
+
+        for (size_t i=0; i<table->_patchVerts.size(); ++i) {
+            table->_patchVerts[i] = used[table->_patchVerts[i]];
+        }
+
+        for (int i=0; i<(options.generateVaryingStencils ? 2 : 1); ++i) {
+
+            stencilOptions.interpolationMode = (i==0) ?
+                StencilTableFactory::INTERPOLATE_VERTEX :
+                StencilTableFactory::INTERPOLATE_VARYING;
+
+            StencilTable const * regionStencils =
+                StencilTableFactory::Create(*regionRefiner, stencilOptions);
+
+            StencilTable const * localPointStencils = (i==0) ?
+                table->GetLocalPointStencilTable() :
+                table->GetLocalPointVaryingStencilTable();
+
+            if (localPointStencils) {
+                StencilTable const * appended =
+                    StencilTableFactory::AppendLocalPointStencilTable(
+                        *regionRefiner, regionStencils, localPointStencils);
+                delete regionStencils;
+                regionStencils = appended;
+            }
+
+            stencils[i] = extractStencils(*regionStencils, rows, region, numBaseVertices);
+            delete regionStencils;
+        }
+
+        //  The local points are computed by the stencils of the cluster
+        delete table->_localPointStencils;
+        delete table->_localPointVaryingStencils;
+        table->_localPointStencils = 0;
+        table->_localPointVaryingStencils = 0;
+
+        //  Map the ptex faces of the region to those of the base mesh
+        PtexIndices * basePtexIndices = 0;
+        if (not ptexIndices) {
+            ptexIndices = basePtexIndices = new PtexIndices(refiner);
+        }
+        PtexIndices regionPtexIndices(*regionRefiner);
+
+        int regFaceSize =
+            Sdc::SchemeTypeTraits::GetRegularFaceSize(refiner.GetSchemeType());
+
+        std::vector<Index> ptexRemap(regionPtexIndices.GetNumFaces(), INDEX_INVALID);
+        for (int face=0; face<region.GetNumFaces(); ++face) {
+
+            if (not faceMask[face]) {
+                continue;
+            }
+            Index baseFace = region.GetBaseFace(face);
+
+            int nverts = refiner.GetLevel(0).GetFaceVertices(baseFace).size(),
+                nptex = (nverts==regFaceSize) ? 1 : nverts;
+
+            Index regionPtex = regionPtexIndices.GetFaceId(face),
+                  basePtex = ptexIndices->GetFaceId(baseFace);
+            for (int i=0; i<nptex; ++i) {
+                ptexRemap[regionPtex + i] = basePtex + i;
+            }
+        }
+
+        for (size_t i=0; i<table->_paramTable.size(); ++i) {
+            PatchParam & param = table->_paramTable[i];
+            bool nonquad = param.NonQuadRoot();
+            param.Set(ptexRemap[param.GetFaceId()], param.GetU(), param.GetV(),
+                (unsigned short)(nonquad ? param.GetDepth()-1 : param.GetDepth()),
+                nonquad, param.GetBoundary(), param.GetTransition());
+        }
+        table->_numPtexFaces = ptexIndices->GetNumFaces();
+
+        delete basePtexIndices;
+
+        cluster->_patchTable = table;
+    }
+
+    cluster->_stencilTable = stencils[0];
+    cluster->_varyingStencilTable = stencils[1];
+
+    delete regionRefiner;
+
+    return cluster;
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,157 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_CLUSTER_TABLE_FACTORY_H
+#define OPENSUBDIV3_FAR_CLUSTER_TABLE_FACTORY_H
+
+#include "../version.h"
+
+#include "../far/patchTableFactory.h"
+#include "../far/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+class ClusterTable;
+class PtexIndices;
+class StencilTable;
+class TopologyRefiner;
+
+namespace internal {
+    class TopologyRegion;
+}
+
+/// \brief A specialized factory for ClusterTable
+///
+/// Refining a very large base mesh in one piece requires the whole refined
+/// hierarchy, stencil table and patch table to be held in memory. Instead,
+/// the base faces can be split into clusters with PartitionFaces(), and each
+/// cluster refined on its own with Create() : the peak memory is then bounded
+/// by the size of a cluster rather than by the size of the mesh.
+///
+/// Each cluster is extracted from the base level along with the rings of
+/// neighboring faces needed to reproduce the refined vertices and patches of
+/// its faces exactly (one ring for uniform refinement, two rings for adaptive
+/// patches, so that features are isolated as they are in the whole mesh).
+///
+/// \code
+///     std::vector<int> offsets;
+///     std::vector<Index> faces;
+///     int nclusters = ClusterTableFactory::PartitionFaces(
+///         refiner, 100000, offsets, faces);
+///
+///     for (int i=0; i<nclusters; ++i) {
+///         ConstIndexArray clusterFaces(&faces[offsets[i]],
+///                                      offsets[i+1]-offsets[i]);
+///         ClusterTable * cluster =
+///             ClusterTableFactory::Create(refiner, clusterFaces, options);
+///         cluster->Write(stream);
+///         delete cluster;
+///     }
+/// \endcode
+///
+/// \note Face-varying data and legacy Gregory end-caps are not supported.
+///
+class ClusterTableFactory {
+
+public:
+
+    struct Options {
+
+        Options(unsigned int level=2) :
+            refinementLevel(level),
+            adaptive(false),
+            generateVaryingStencils(false) { }
+
+        unsigned int refinementLevel         : 4, ///< uniform level or adaptive
+                                                  ///  isolation level (>= 1)
+                     adaptive                : 1, ///< generate adaptive patches
+                                                  ///  instead of refined faces
+                     generateVaryingStencils : 1; ///< generate varying stencils
+
+        PatchTableFactory::Options patchOptions;  ///< options of the adaptive
+                                                  ///  patches (end-caps...)
+    };
+
+    /// \brief Splits the base faces of a TopologyRefiner into clusters
+    ///
+    /// Clusters are grown from the first unassigned base face across the
+    /// vertices of the faces already gathered, so that they remain compact
+    /// and their halos small.
+    ///
+    /// @param refiner          TopologyRefiner (only the base level is used)
+    ///
+    /// @param maxClusterFaces  Maximum number of base faces in a cluster
+    ///
+    /// @param clusterOffsets   Offsets of the clusters in clusterFaces
+    ///                         (number of clusters + 1 entries)
+    ///
+    /// @param clusterFaces     Sorted base faces of each cluster
+    ///
+    /// @return                 The number of clusters
+    ///
+    static int PartitionFaces(TopologyRefiner const & refiner,
+                              int maxClusterFaces,
+                              std::vector<int> & clusterOffsets,
+                              std::vector<Index> & clusterFaces);
+
+    /// \brief Refines a cluster of base faces
+    ///
+    /// @param refiner      TopologyRefiner (only the base level is used)
+    ///
+    /// @param faces        Base faces of the cluster
+    ///
+    /// @param options      Options controlling the refinement
+    ///
+    /// @param ptexIndices  Ptex indices of the base mesh (adaptive clusters
+    ///                     only : avoids recomputing them for every cluster)
+    ///
+    /// @return             A new ClusterTable (or NULL on error)
+    ///
+    static ClusterTable * Create(TopologyRefiner const & refiner,
+                                 ConstIndexArray faces,
+                                 Options options=Options(),
+                                 PtexIndices const * ptexIndices=0);
+
+private:
+
+    static StencilTable * extractStencils(StencilTable const & src,
+                                          std::vector<Index> const & rows,
+                                          internal::TopologyRegion const & region,
+                                          int numBaseVertices);
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_CLUSTER_TABLE_FACTORY_H
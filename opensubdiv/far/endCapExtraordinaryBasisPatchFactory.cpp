@@ -0,0 +1,160 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../far/endCapExtraordinaryBasisPatchFactory.h"
+
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+int
+EndCapExtraordinaryBasisPatchFactory::GetExtraordinaryCorner(
+    Vtr::internal::Level const & level, Index faceIndex) {
+
+    ConstIndexArray fVerts = level.getFaceVertices(faceIndex);
+    if (fVerts.size() != 4) {
+        return -1;
+    }
+
+    int corner = -1;
+    for (int i = 0; i < 4; ++i) {
+
+        Vtr::internal::Level::VTag vTag = level.getVertexTag(fVerts[i]);
+        if (vTag._boundary or vTag._nonManifold or
+            (vTag._rule != Sdc::Crease::RULE_SMOOTH)) {
+            return -1;
+        }
+
+        ConstIndexArray vFaces = level.getVertexFaces(fVerts[i]);
+        if (vTag._xordinary) {
+            if ((corner >= 0) or (vFaces.size() < 3) or
+                (vFaces.size() == 4) or (vFaces.size() > 6)) {
+                return -1;
+            }
+            corner = i;
+        } else if (vFaces.size() != 4) {
+            return -1;
+        }
+
+        // the faces around the vertices (refined from non-quads at level 0)
+        for (int j = 0; j < vFaces.size(); ++j) {
+            if (level.getFaceVertices(vFaces[j]).size() != 4) {
+                return -1;
+            }
+        }
+    }
+    return corner;
+}
+
+//
+//  Gathers the 1-ring of the extraordinary vertex, starting with the face, and
+//  the 7 points completing the 4x4 neighborhood of the face, from the faces
+//  diagonally opposite to the face at its regular corners :
+//
+//      X6 -- X5 -- X4 -- X3
+//      |     |  Fc |     |
+//      f1 -- e1 -- f0 -- X2
+//      |  Fe |     |  Fb |
+//      e2 -- EV -- e0 -- X1
+//            |     |  Fa |
+//          e(N-1)-f(N-1)-X0
+//
+ConstIndexArray
+EndCapExtraordinaryBasisPatchFactory::GetPatchPoints(
+    Vtr::internal::Level const * level, Index faceIndex,
+    PatchTableFactory::PatchFaceTag const * levelPatchTags,
+    int levelVertOffset) {
+
+    int corner = levelPatchTags[faceIndex]._boundaryIndex;
+
+    ConstIndexArray fVerts = level->getFaceVertices(faceIndex);
+
+    Index vIndex = fVerts[corner];
+
+    ConstIndexArray vFaces = level->getVertexFaces(vIndex);
+    ConstLocalIndexArray vInFaces = level->getVertexFaceLocalIndices(vIndex);
+
+    int valence = vFaces.size();
+    assert(valence>=3 and valence<=6 and valence!=4);
+
+    int start = vFaces.FindIndex(faceIndex);
+
+    Index * points = _patchPoints;
+
+    points[0] = vIndex;
+    for (int i = 0; i < valence; ++i) {
+        int face = (start + i) % valence;
+        ConstIndexArray fPoints = level->getFaceVertices(vFaces[face]);
+        int vInThisFace = vInFaces[face];
+        points[1 + 2*i] = fPoints[(vInThisFace + 1) % 4];
+        points[2 + 2*i] = fPoints[(vInThisFace + 2) % 4];
+    }
+
+    Index e0 = points[1],
+          f0 = points[2],
+          e1 = points[3];
+
+    // the face diagonally opposite to this face at a regular corner
+    Index * X = points + 2*valence + 1;
+    Index const corners[3] = { e0, f0, e1 };
+    for (int i = 0; i < 3; ++i) {
+        ConstIndexArray cFaces = level->getVertexFaces(corners[i]);
+        ConstLocalIndexArray cInFaces = level->getVertexFaceLocalIndices(corners[i]);
+
+        int opposite = (cFaces.FindIndexIn4Tuple(faceIndex) + 2) % 4;
+        ConstIndexArray oPoints = level->getFaceVertices(cFaces[opposite]);
+        int cInFace = cInFaces[opposite];
+
+        if (i == 0) {
+            X[0] = oPoints[(cInFace + 2) % 4];
+            X[1] = oPoints[(cInFace + 3) % 4];
+        } else if (i == 1) {
+            X[2] = oPoints[(cInFace + 1) % 4];
+            X[3] = oPoints[(cInFace + 2) % 4];
+            X[4] = oPoints[(cInFace + 3) % 4];
+        } else {
+            X[5] = oPoints[(cInFace + 1) % 4];
+            X[6] = oPoints[(cInFace + 2) % 4];
+        }
+    }
+
+    // pad with the extraordinary vertex
+    for (int i = 2*valence + 8; i < 20; ++i) {
+        points[i] = vIndex;
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        points[i] += levelVertOffset;
+    }
+    return ConstIndexArray(_patchPoints, 20);
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
@@ -0,0 +1,88 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_END_CAP_EXTRAORDINARY_BASIS_PATCH_FACTORY_H
+#define OPENSUBDIV3_FAR_END_CAP_EXTRAORDINARY_BASIS_PATCH_FACTORY_H
+
+#include "../far/patchTableFactory.h"
+#include "../vtr/level.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief An exact endcap factory for isolated extraordinary vertices
+///
+/// The control vertices of the end patches are the refined vertices of the
+/// neighborhood of the face (see PatchDescriptor::EXTRAORDINARY_BASIS) : no
+/// local point is created, and the limit surface is evaluated exactly by
+/// Far::internal::GetExtraordinaryWeights().
+///
+/// note: This is an internal use class in PatchTableFactory.
+///
+class EndCapExtraordinaryBasisPatchFactory {
+
+public:
+
+    /// \brief Returns the corner of \a faceIndex at its extraordinary vertex,
+    ///        or -1 if the face does not qualify for an exact end patch : the
+    ///        extraordinary vertex must be a smooth interior vertex of valence
+    ///        3, 5 or 6, and the other corners smooth regular vertices.
+    ///
+    /// @param level            vtr refinement level
+    ///
+    /// @param faceIndex        vtr faceIndex at the level
+    ///
+    static int GetExtraordinaryCorner(
+        Vtr::internal::Level const & level, Index faceIndex);
+
+    /// \brief Returns end patch point indices for \a faceIndex of \a level.
+    ///        The corner of the extraordinary vertex is expected in the
+    ///        boundary index of the patch tag of the face.
+    ///
+    /// @param level            vtr refinement level
+    ///
+    /// @param faceIndex        vtr faceIndex at the level
+    ///
+    /// @param levelPatchTags   Array of patchTags for all faces in the level
+    ///
+    /// @param levelVertOffset  relative offset of patch vertex indices
+    ///
+    ConstIndexArray GetPatchPoints(
+        Vtr::internal::Level const * level, Index faceIndex,
+        PatchTableFactory::PatchFaceTag const * levelPatchTags,
+        int levelVertOffset);
+
+private:
+    Index _patchPoints[20];
+};
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_FAR_END_CAP_EXTRAORDINARY_BASIS_PATCH_FACTORY_H
@@ -43,7 +43,8 @@ namespace Far {
 EndCapGregoryBasisPatchFactory::EndCapGregoryBasisPatchFactory(
     TopologyRefiner const & refiner, bool shareBoundaryVertices) :
     _refiner(&refiner), _shareBoundaryVertices(shareBoundaryVertices),
-    _numGregoryBasisVertices(0), _numGregoryBasisPatches(0) {
+    _numGregoryBasisVertices(0), _numGregoryBasisPatches(0),
+    _levelVertOffset(-1) {
 
     // Sanity check: the mesh must be adaptively refined
     assert(not refiner.IsUniform());
@@ -67,41 +68,82 @@ EndCapGregoryBasisPatchFactory::Create(TopologyRefiner const & refiner,
     return result;
 }
 
-bool
-EndCapGregoryBasisPatchFactory::addPatchBasis(Index faceIndex,
-                                              bool verticesMask[4][5],
-                                              int levelVertOffset) {
+//
+//  Minimum number of patches for their bases to be computed concurrently
+//
+static int const PARALLEL_PATCH_THRESHOLD = 64;
+
+//
+// Computes the basis of the patches and scatters the points created by each
+// patch into their slots : the bases only depend on the topology of the max
+// level, so they are computed concurrently.
+//
+StencilTable *
+EndCapGregoryBasisPatchFactory::CreateVertexStencilTable() const {
 
     // Gregory patches only exist on the hight
     Vtr::internal::Level const & level = _refiner->getLevel(_refiner->GetMaxLevel());
 
-    // Gather the CVs that influence the Gregory patch and their relative
-    // weights in a basis
-    GregoryBasis::ProtoBasis basis(level, faceIndex, levelVertOffset, -1);
+    int gregoryVertexOffset = _refiner->GetNumVerticesTotal(),
+        numPatches = _numGregoryBasisPatches;
 
-    for (int i = 0; i < 4; ++i) {
-        if (verticesMask[i][0]) {
-            _vertexStencils.push_back(basis.P[i]);
-            _varyingStencils.push_back(basis.V[i]);
-        }
-        if (verticesMask[i][1]) {
-            _vertexStencils.push_back(basis.Ep[i]);
-            _varyingStencils.push_back(basis.V[i]);
-        }
-        if (verticesMask[i][2]) {
-            _vertexStencils.push_back(basis.Em[i]);
-            _varyingStencils.push_back(basis.V[i]);
+    GregoryBasis::PointsVector stencils(_numGregoryBasisVertices);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 16) if (numPatches > PARALLEL_PATCH_THRESHOLD)
+#endif
+    for (int patch = 0; patch < numPatches; ++patch) {
+
+        unsigned int newPointsMask = _newPointsMasks[patch];
+        if (not newPointsMask) {
+            continue;
         }
-        if (verticesMask[i][3]) {
-            _vertexStencils.push_back(basis.Fp[i]);
-            _varyingStencils.push_back(basis.V[i]);
+
+        // Gather the CVs that influence the Gregory patch and their relative
+        // weights in a basis
+        GregoryBasis::ProtoBasis basis(level, _faceIndices[patch], _levelVertOffset, -1);
+
+        GregoryBasis::Point const * points[5] = { basis.P, basis.Ep, basis.Em, basis.Fp, basis.Fm };
+
+        Index const * patchPoints = &_patchPoints[patch * 20];
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 5; ++j) {
+                if (newPointsMask & (1 << (i*5+j))) {
+                    stencils[patchPoints[i*5+j] - gregoryVertexOffset] = points[j][i];
+                }
+            }
         }
-        if (verticesMask[i][4]) {
-            _vertexStencils.push_back(basis.Fm[i]);
-            _varyingStencils.push_back(basis.V[i]);
+    }
+    return GregoryBasis::CreateStencilTable(stencils);
+}
+
+StencilTable *
+EndCapGregoryBasisPatchFactory::CreateVaryingStencilTable() const {
+
+    Vtr::internal::Level const & level = _refiner->getLevel(_refiner->GetMaxLevel());
+
+    int gregoryVertexOffset = _refiner->GetNumVerticesTotal();
+
+    // varying primvars are interpolated from the corners of the patch
+    GregoryBasis::PointsVector stencils(_numGregoryBasisVertices);
+
+    for (int patch = 0; patch < _numGregoryBasisPatches; ++patch) {
+
+        unsigned int newPointsMask = _newPointsMasks[patch];
+
+        ConstIndexArray fverts = level.getFaceVertices(_faceIndices[patch]);
+
+        Index const * patchPoints = &_patchPoints[patch * 20];
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 5; ++j) {
+                if (newPointsMask & (1 << (i*5+j))) {
+                    stencils[patchPoints[i*5+j] - gregoryVertexOffset] =
+                        GregoryBasis::Point(fverts[i] + _levelVertOffset);
+                }
+            }
         }
     }
-    return true;
+    return GregoryBasis::CreateStencilTable(stencils);
 }
 
 //
@@ -169,7 +211,7 @@ EndCapGregoryBasisPatchFactory::GetPatchPoints(
 
                 if (!ptr) {
                     // if the adjface is hole, it won't be found
-                    break;
+                    continue;
                 }
                 assert(ptr
                        and srcBasisIdx>=0
@@ -191,7 +233,22 @@ EndCapGregoryBasisPatchFactory::GetPatchPoints(
         }
     }
 
-    bool newVerticesMask[4][5];
+    // The corner points of the basis are the limit positions of the face
+    // vertices : they are shared by all the patches around a vertex, and not
+    // only along shared edges.
+    ConstIndexArray fverts = level->getFaceVertices(faceIndex);
+    if (_shareBoundaryVertices) {
+        if (_vertexPoints.empty()) {
+            _vertexPoints.resize(level->getNumVertices(), Vtr::INDEX_INVALID);
+        }
+        for (int i = 0; i < 4; ++i) {
+            if (dest[i*5]==Vtr::INDEX_INVALID) {
+                dest[i*5] = _vertexPoints[fverts[i]];
+            }
+        }
+    }
+
+    unsigned int newPointsMask = 0;
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 5; ++j) {
             if (dest[i*5+j]==Vtr::INDEX_INVALID) {
@@ -199,17 +256,20 @@ EndCapGregoryBasisPatchFactory::GetPatchPoints(
                 dest[i*5+j] =
                     _numGregoryBasisVertices + gregoryVertexOffset;
                 ++_numGregoryBasisVertices;
-                newVerticesMask[i][j] = true;
-            } else {
-                // share vertex
-                newVerticesMask[i][j] = false;
+                newPointsMask |= (1 << (i*5+j));
             }
         }
+        if (_shareBoundaryVertices and
+            _vertexPoints[fverts[i]]==Vtr::INDEX_INVALID) {
+            _vertexPoints[fverts[i]] = dest[i*5];
+        }
     }
     _faceIndices.push_back(faceIndex);
 
-    // add basis
-    addPatchBasis(faceIndex, newVerticesMask, levelVertOffset);
+    // the bases are computed when the stencil tables are created
+    assert(_levelVertOffset<0 or _levelVertOffset==levelVertOffset);
+    _levelVertOffset = levelVertOffset;
+    _newPointsMasks.push_back(newPointsMask);
 
     ++_numGregoryBasisPatches;
 
@@ -102,34 +102,32 @@ public:
     /// \brief Create a StencilTable for end patch points, relative to the max
     ///        subdivision level.
     ///
-    StencilTable* CreateVertexStencilTable() const {
-        return GregoryBasis::CreateStencilTable(_vertexStencils);
-    }
+    /// \note The bases of the patches are computed concurrently when OpenMP
+    ///       is available.
+    ///
+    StencilTable* CreateVertexStencilTable() const;
 
     /// \brief Create a StencilTable for end patch varying primvar.
     ///        This table is used as a convenient way to get varying primvars
     ///        populated on end patch points along with positions.
     ///
-    StencilTable* CreateVaryingStencilTable() const {
-        return GregoryBasis::CreateStencilTable(_varyingStencils);
-    }
+    StencilTable* CreateVaryingStencilTable() const;
 
 private:
 
-    /// Creates a basis for the vertices specified in mask on the face and
-    /// accumates it
-    bool addPatchBasis(Index faceIndex, bool newVerticesMask[4][5],
-                       int levelVertOffset);
-
-    GregoryBasis::PointsVector _vertexStencils;
-    GregoryBasis::PointsVector _varyingStencils;
-
     TopologyRefiner const *_refiner;
     bool _shareBoundaryVertices;
     int _numGregoryBasisVertices;
     int _numGregoryBasisPatches;
+    int _levelVertOffset;
     std::vector<Index> _faceIndices;
     std::vector<Index> _patchPoints;
+
+    // Masks of the points created by each patch (one bit per patch point)
+    std::vector<unsigned int> _newPointsMasks;
+
+    // Corner point (limit position) shared by all the patches of a vertex
+    std::vector<Index> _vertexPoints;
 };
 
 } // end namespace Far
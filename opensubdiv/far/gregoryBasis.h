@@ -28,6 +28,7 @@
 #include "../vtr/level.h"
 #include "../far/types.h"
 #include "../far/stencilTable.h"
+#include <algorithm>
 #include <cstring>
 
 namespace OpenSubdiv {
@@ -77,43 +78,53 @@ public:
     // Implements arithmetic operators to manipulate the influence of the
     // 1-ring control vertices supporting the patch basis
     //
+    // The influences are stored in place, up to RESERVED_ENTRY_SIZE entries,
+    // and only spill to the heap for very high valences : points are created
+    // in large numbers as temporaries of the basis arithmetic.
+    //
     class Point {
     public:
         static const int RESERVED_ENTRY_SIZE = 64;
 
         Point() : _size(0) {
-            _indices.reserve(RESERVED_ENTRY_SIZE);
-            _weights.reserve(RESERVED_ENTRY_SIZE);
+            initialize();
         }
 
-        Point(Vtr::Index idx, float weight = 1.0f) {
-            _indices.reserve(RESERVED_ENTRY_SIZE);
-            _weights.reserve(RESERVED_ENTRY_SIZE);
-            _size = 1;
-            _indices.push_back(idx);
-            _weights.push_back(weight);
+        Point(Vtr::Index idx, float weight = 1.0f) : _size(1) {
+            initialize();
+            _indices[0] = idx;
+            _weights[0] = weight;
         }
 
-        Point(Point const & other) {
+        Point(Point const & other) : _size(0) {
+            initialize();
             *this = other;
         }
 
+        ~Point() {
+            deallocate();
+        }
+
         int GetSize() const {
             return _size;
         }
 
         Vtr::Index const * GetIndices() const {
-            return &_indices[0];
+            return _indices;
         }
 
         float const * GetWeights() const {
-            return &_weights[0];
+            return _weights;
         }
 
         Point & operator = (Point const & other) {
-            _size = other._size;
-            _indices = other._indices;
-            _weights = other._weights;
+            if (this != &other) {
+                _size = 0;
+                reserve(other._size);
+                _size = other._size;
+                memcpy(_indices, other._indices, _size*sizeof(Vtr::Index));
+                memcpy(_weights, other._weights, _size*sizeof(float));
+            }
             return *this;
         }
 
@@ -167,8 +178,8 @@ public:
         }
 
         void Copy(int ** size, Vtr::Index ** indices, float ** weights) const {
-            memcpy(*indices, &_indices[0], _size*sizeof(Vtr::Index));
-            memcpy(*weights, &_weights[0], _size*sizeof(float));
+            memcpy(*indices, _indices, _size*sizeof(Vtr::Index));
+            memcpy(*weights, _weights, _size*sizeof(float));
             **size = _size;
             *indices += _size;
             *weights += _size;
@@ -177,21 +188,58 @@ public:
 
     private:
 
+        void initialize() {
+            _capacity = RESERVED_ENTRY_SIZE;
+            _indices = _staticIndices;
+            _weights = _staticWeights;
+        }
+
+        void deallocate() {
+            if (_indices != _staticIndices) {
+                delete [] _indices;
+                delete [] _weights;
+            }
+        }
+
+        // grows the storage to hold at least 'capacity' entries (preserving
+        // the current entries)
+        void reserve(int capacity) {
+            if (capacity <= _capacity) {
+                return;
+            }
+            capacity = std::max(capacity, _capacity*2);
+
+            Vtr::Index * indices = new Vtr::Index[capacity];
+            float * weights = new float[capacity];
+            memcpy(indices, _indices, _size*sizeof(Vtr::Index));
+            memcpy(weights, _weights, _size*sizeof(float));
+
+            deallocate();
+            _indices = indices;
+            _weights = weights;
+            _capacity = capacity;
+        }
+
         int findIndex(Vtr::Index idx) {
             for (int i=0; i<_size; ++i) {
                 if (_indices[i]==idx) {
                     return i;
                 }
             }
-            _indices.push_back(idx);
-            _weights.push_back(0.0f);
+            reserve(_size+1);
+            _indices[_size] = idx;
+            _weights[_size] = 0.0f;
             ++_size;
             return _size-1;
         }
 
-        int _size;
-        std::vector<Vtr::Index> _indices;
-        std::vector<float> _weights;
+        int _size,
+            _capacity;
+        Vtr::Index * _indices;
+        float * _weights;
+
+        Vtr::Index _staticIndices[RESERVED_ENTRY_SIZE];
+        float _staticWeights[RESERVED_ENTRY_SIZE];
     };
 
     //
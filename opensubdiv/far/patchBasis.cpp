@@ -269,7 +269,7 @@ void GetBilinearWeights(PatchParam const & param,
     Spline<BASIS_BILINEAR>::GetPatchWeights(param, s, t, point, deriv1, deriv2);
 }
 
-void GetBezierWeights(PatchParam const param,
+void GetBezierWeights(PatchParam const & param,
     float s, float t, float point[16], float deriv1[16], float deriv2[16]) {
 
     Spline<BASIS_BEZIER>::GetPatchWeights(param, s, t, point, deriv1, deriv2);
@@ -427,6 +427,291 @@ void GetGregoryWeights(PatchParam const & param,
     }
 }
 
+//
+//  Exact evaluation of the end-cap patches of isolated extraordinary vertices
+//  (PatchDescriptor::EXTRAORDINARY_BASIS).
+//
+//  The control points of the patch are the 1-ring of the extraordinary vertex
+//  followed by the 7 points completing the 4x4 neighborhood of the face :
+//
+//      X6 -- X5 -- X4 -- X3
+//      |     |     |     |
+//      f1 -- e1 -- f0 -- X2
+//      |     |     |     |
+//      e2 -- EV -- e0 -- X1         EV = 0, e_i = 1+2i, f_i = 2+2i
+//            |     |     |          X_j = 2N+1+j
+//          e(N-1)-f(N-1)-X0
+//
+//  (in the frame of the extraordinary vertex, i.e. with the u axis towards e0
+//  and the v axis towards e1 -- the corner of the face at the extraordinary
+//  vertex is stored in the boundary bits of the PatchParam).
+//
+//  A point of the face away from the extraordinary vertex lies in one of the
+//  three regular sub-patches of some level n : its B-spline weights apply to
+//  points of the refined neighborhood of level n, and are pulled back to the
+//  control points by applying the transposed subdivision rules n times.  So
+//  the evaluation is exact, without any table or eigen-decomposition.
+//
+namespace {
+
+    enum { MAX_RING_POINTS  = 20,
+           MAX_CHILD_POINTS = MAX_RING_POINTS + 9 };
+
+    // Points closer than 2^-MAX_EXTRAORDINARY_LEVEL to the extraordinary
+    // vertex evaluate to its limit position.
+    int const MAX_EXTRAORDINARY_LEVEL = 30;
+
+    inline int ringEdge(int valence, int i) { return 1 + 2*((i + valence) % valence); }
+    inline int ringFace(int valence, int i) { return 2 + 2*((i + valence) % valence); }
+
+    inline void setFacePoint(float row[], int a, int b, int c, int d) {
+        row[a] += 0.25f; row[b] += 0.25f; row[c] += 0.25f; row[d] += 0.25f;
+    }
+
+    // edge (v0,v1) shared by the quads (v0,v1,a,b) and (v1,v0,c,d)
+    inline void setEdgePoint(float row[], int v0, int v1,
+        int a, int b, int c, int d) {
+        row[v0] += 0.375f;  row[v1] += 0.375f;
+        row[a] += 0.0625f; row[b] += 0.0625f;
+        row[c] += 0.0625f; row[d] += 0.0625f;
+    }
+
+    // smooth vertex of valence 4, with its edge and diagonal neighbors
+    inline void setRegularVertexPoint(float row[], int v,
+        int e0, int e1, int e2, int e3, int d0, int d1, int d2, int d3) {
+        row[v] += 0.5625f;
+        row[e0] += 0.09375f;  row[e1] += 0.09375f;
+        row[e2] += 0.09375f;  row[e3] += 0.09375f;
+        row[d0] += 0.015625f; row[d1] += 0.015625f;
+        row[d2] += 0.015625f; row[d3] += 0.015625f;
+    }
+
+    //
+    //  Catmark subdivision matrix from the control points to the points of the
+    //  next level : the control points of the next level (in the same order)
+    //  followed by the 9 points bounding the refined neighborhood :
+    //
+    //      (4,k) for k = 0..4, then (3,4), (2,4), (1,4), (0,4)
+    //
+    //  in the grid coordinates of the next level (EV at (1,1)).
+    //
+    void
+    computeSubdivisionMatrix(int valence,
+        float S[MAX_CHILD_POINTS][MAX_RING_POINTS]) {
+
+        int N = valence,
+            K = 2*N + 8;
+
+        std::memset(S, 0, MAX_CHILD_POINTS*MAX_RING_POINTS*sizeof(float));
+
+        int e0 = ringEdge(N, 0), e1 = ringEdge(N, 1), e2 = ringEdge(N, 2),
+            f0 = ringFace(N, 0), f1 = ringFace(N, 1),
+            eL = ringEdge(N, N-1), fL = ringFace(N, N-1);
+
+        int X0 = 2*N+1, X1 = X0+1, X2 = X0+2, X3 = X0+3,
+            X4 = X0+4, X5 = X0+5, X6 = X0+6;
+
+        // extraordinary vertex
+        float vWeight = (float)(4*N - 7) / (float)(4*N),
+              eWeight = 3.0f / (float)(2*N*N),
+              fWeight = 1.0f / (float)(4*N*N);
+        S[0][0] = vWeight;
+        for (int i = 0; i < N; ++i) {
+            S[0][ringEdge(N, i)] = eWeight;
+            S[0][ringFace(N, i)] = fWeight;
+        }
+
+        // edges and faces around the extraordinary vertex
+        for (int i = 0; i < N; ++i) {
+            setEdgePoint(S[ringEdge(N, i)], 0, ringEdge(N, i),
+                ringEdge(N, i-1), ringFace(N, i-1),
+                ringFace(N, i), ringEdge(N, i+1));
+            setFacePoint(S[ringFace(N, i)],
+                0, ringEdge(N, i), ringFace(N, i), ringEdge(N, i+1));
+        }
+
+        // completion of the 4x4 neighborhood
+        setEdgePoint(S[X0], e0, fL, 0, eL, X0, X1);
+        setRegularVertexPoint(S[X1], e0, 0, X1, fL, f0, eL, X0, X2, e1);
+        setEdgePoint(S[X2], e0, f0, 0, e1, X1, X2);
+        setRegularVertexPoint(S[X3], f0, e0, X2, X4, e1, 0, X1, X3, X5);
+        setEdgePoint(S[X4], f0, e1, 0, e0, X4, X5);
+        setRegularVertexPoint(S[X5], e1, 0, f0, X5, f1, e0, X4, X6, e2);
+        setEdgePoint(S[X6], e1, f1, 0, e2, X5, X6);
+
+        // boundary of the refined neighborhood
+        setFacePoint(S[K+0], fL, X0, X1, e0);
+        setEdgePoint(S[K+1], e0, X1, fL, X0, X2, f0);
+        setFacePoint(S[K+2], e0, X1, X2, f0);
+        setEdgePoint(S[K+3], f0, X2, e0, X1, X3, X4);
+        setFacePoint(S[K+4], f0, X2, X3, X4);
+        setEdgePoint(S[K+5], f0, X4, X2, X3, e1, X5);
+        setFacePoint(S[K+6], e1, f0, X4, X5);
+        setEdgePoint(S[K+7], e1, X5, f0, X4, f1, X6);
+        setFacePoint(S[K+8], f1, e1, X5, X6);
+    }
+
+    //  Index of the refined point at grid coordinates (x,y) of the next level
+    inline int
+    getChildPoint(int valence, int x, int y) {
+
+        int N = valence,
+            K = 2*N + 8;
+
+        if (x == 4) return K + y;
+        if (y == 4) return K + 8 - x;
+        if (x == 3) return 2*N+1 + y;
+        if (y == 3) return 2*N+1 + 6 - x;
+
+        int const inner[3][3] = { {   -1, 2*N-1, 2*N },
+                                  {    5,     0,   1 },
+                                  {    4,     3,   2 } };
+        assert(inner[y][x] >= 0);
+        return inner[y][x];
+    }
+}
+
+void GetExtraordinaryWeights(PatchParam const & param, int valence,
+    float s, float t, float point[20], float deriv1[20], float deriv2[20]) {
+
+    assert(valence==3 or valence==5 or valence==6);
+
+    int N = valence,
+        K = 2*N + 8;
+
+    param.Normalize(s,t);
+
+    // rotate into the frame of the extraordinary vertex
+    float u = s,
+          v = t;
+    switch (param.GetBoundary() & 3) {
+        case 1: u =        t; v = 1.0f - s; break;
+        case 2: u = 1.0f - s; v = 1.0f - t; break;
+        case 3: u = 1.0f - t; v =        s; break;
+        default: break;
+    }
+
+    //
+    //  Too close to the extraordinary vertex, the position is given by its
+    //  limit mask and the derivatives by those of the nearest point at the
+    //  maximum level :
+    //
+    float const minParam = 1.0f / (float)(1 << MAX_EXTRAORDINARY_LEVEL);
+
+    bool isLimitPoint = (u < minParam) and (v < minParam);
+    if (isLimitPoint) {
+        u = minParam;
+    }
+
+    // find the level of the regular sub-patch containing (u,v)
+    int level = 1;
+    float dScale = 2.0f * (float)(1 << param.GetDepth());
+    while (u < 0.5f and v < 0.5f) {
+        u *= 2.0f;
+        v *= 2.0f;
+        dScale *= 2.0f;
+        ++level;
+    }
+
+    int x0 = 1, y0 = 1;
+    if (v < 0.5f) {
+        y0 = 0;
+        u = 2.0f*u - 1.0f; v = 2.0f*v;
+    } else if (u < 0.5f) {
+        x0 = 0;
+        u = 2.0f*u; v = 2.0f*v - 1.0f;
+    } else {
+        u = 2.0f*u - 1.0f; v = 2.0f*v - 1.0f;
+    }
+
+    float uWeights[4], vWeights[4], duWeights[4], dvWeights[4];
+    Spline<BASIS_BSPLINE>::GetWeights(u, uWeights, duWeights);
+    Spline<BASIS_BSPLINE>::GetWeights(v, vWeights, dvWeights);
+
+    // B-spline weights of the refined points of the sub-patch
+    float wP[MAX_CHILD_POINTS], wDu[MAX_CHILD_POINTS], wDv[MAX_CHILD_POINTS];
+    std::memset(wP,  0, sizeof(wP));
+    std::memset(wDu, 0, sizeof(wDu));
+    std::memset(wDv, 0, sizeof(wDv));
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            int p = getChildPoint(N, x0+j, y0+i);
+            wP[p]  +=  uWeights[j] *  vWeights[i];
+            wDu[p] += duWeights[j] *  vWeights[i];
+            wDv[p] +=  uWeights[j] * dvWeights[i];
+        }
+    }
+
+    // pull the weights back to the control points, one level at a time
+    float S[MAX_CHILD_POINTS][MAX_RING_POINTS];
+    computeSubdivisionMatrix(N, S);
+
+    for (int l = 0; l < level; ++l) {
+
+        int numChildPoints = (l == 0) ? (K + 9) : K;
+
+        float rP[MAX_RING_POINTS], rDu[MAX_RING_POINTS], rDv[MAX_RING_POINTS];
+        for (int j = 0; j < K; ++j) {
+            rP[j] = rDu[j] = rDv[j] = 0.0f;
+            for (int i = 0; i < numChildPoints; ++i) {
+                rP[j]  += S[i][j] * wP[i];
+                rDu[j] += S[i][j] * wDu[i];
+                rDv[j] += S[i][j] * wDv[i];
+            }
+        }
+        std::memcpy(wP,  rP,  K*sizeof(float));
+        std::memcpy(wDu, rDu, K*sizeof(float));
+        std::memcpy(wDv, rDv, K*sizeof(float));
+    }
+
+    if (isLimitPoint) {
+        float fWeight = 1.0f / (float)(N * (N + 5));
+        wP[0] = (float)N / (float)(N + 5);
+        for (int i = 0; i < N; ++i) {
+            wP[ringEdge(N, i)] = 4.0f * fWeight;
+            wP[ringFace(N, i)] = fWeight;
+        }
+        for (int j = 2*N+1; j < K; ++j) {
+            wP[j] = 0.0f;
+        }
+    }
+
+    // unused control points (repeating the extraordinary vertex)
+    for (int j = K; j < MAX_RING_POINTS; ++j) {
+        wP[j] = wDu[j] = wDv[j] = 0.0f;
+    }
+
+    if (point) {
+        std::memcpy(point, wP, MAX_RING_POINTS*sizeof(float));
+    }
+
+    if (deriv1 and deriv2) {
+        // rotate the derivatives back into the frame of the patch
+        for (int j = 0; j < MAX_RING_POINTS; ++j) {
+            float du = wDu[j] * dScale,
+                  dv = wDv[j] * dScale;
+            switch (param.GetBoundary() & 3) {
+                case 0: deriv1[j] =  du; deriv2[j] =  dv; break;
+                case 1: deriv1[j] = -dv; deriv2[j] =  du; break;
+                case 2: deriv1[j] = -du; deriv2[j] = -dv; break;
+                case 3: deriv1[j] =  dv; deriv2[j] = -du; break;
+            }
+        }
+    }
+}
+
+int GetExtraordinaryValence(Index const cvs[20]) {
+
+    // the control points of valences lower than 6 are padded with the
+    // extraordinary vertex
+    int numPadding = 0;
+    while (numPadding < 12 and cvs[19 - numPadding] == cvs[0]) {
+        ++numPadding;
+    }
+    return (12 - numPadding) / 2;
+}
+
 } // end namespace internal
 } // end namespace Far
 
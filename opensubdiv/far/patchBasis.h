@@ -57,6 +57,14 @@ void GetBSplineWeights(PatchParam const & patchParam,
 void GetGregoryWeights(PatchParam const & patchParam,
     float s, float t, float wP[20], float wDs[20], float wDt[20]);
 
+// Exact weights of the 2*valence+8 control points of an EXTRAORDINARY_BASIS
+// end-cap (the remaining weights, up to 20, are 0)
+void GetExtraordinaryWeights(PatchParam const & patchParam, int valence,
+    float s, float t, float wP[20], float wDs[20], float wDt[20]);
+
+// Valence of the extraordinary vertex of an EXTRAORDINARY_BASIS end-cap
+int GetExtraordinaryValence(Index const cvs[20]);
+
 
 } // end namespace internal
 } // end namespace Far
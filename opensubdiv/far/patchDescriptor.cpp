@@ -51,6 +51,7 @@ PatchDescriptor::GetAdaptivePatchDescriptors(Sdc::SchemeType type) {
         PatchDescriptor(GREGORY),
         PatchDescriptor(GREGORY_BOUNDARY),
         PatchDescriptor(GREGORY_BASIS),
+        PatchDescriptor(EXTRAORDINARY_BASIS),
     };
 
     switch (type) {
@@ -72,7 +73,8 @@ void
 PatchDescriptor::print() const {
     static char const * types[13] = {
         "NON_PATCH", "POINTS", "LINES", "QUADS", "TRIANGLES", "LOOP",
-            "REGULAR", "GREGORY", "GREGORY_BOUNDARY", "GREGORY_BASIS" };
+            "REGULAR", "GREGORY", "GREGORY_BOUNDARY", "GREGORY_BASIS",
+            "EXTRAORDINARY_BASIS" };
 
     printf("    type %s\n",
         types[_type]);
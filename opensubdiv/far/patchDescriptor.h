@@ -45,7 +45,13 @@ namespace Far {
 ///   or TRIANGLES
 ///
 /// * Adaptively subdivided meshes contain bicubic patches of types REGULAR,
-///   GREGORY, GREGORY_BOUNDARY, GREGORY_BASIS.
+///   GREGORY, GREGORY_BOUNDARY, GREGORY_BASIS, EXTRAORDINARY_BASIS.
+///
+/// * EXTRAORDINARY_BASIS patches are exact end-caps of the faces around
+///   an isolated interior extraordinary vertex of valence 3, 5 or 6 : their
+///   20 control vertices are the 2*valence+8 points of the neighborhood of
+///   the face, padded with the extraordinary vertex, and the boundary bits
+///   of their PatchParam hold the corner of the extraordinary vertex.
 ///
 /// Bitfield layout :
 ///
@@ -71,7 +77,8 @@ public:
         REGULAR,           ///< feature-adaptive bicubic patches
         GREGORY,
         GREGORY_BOUNDARY,
-        GREGORY_BASIS
+        GREGORY_BASIS,
+        EXTRAORDINARY_BASIS
     };
 
 public:
@@ -95,7 +102,7 @@ public:
 
     /// \brief Returns true if the type is an adaptive patch
     static inline bool IsAdaptive(Type type) {
-        return (type>=LOOP and type<=GREGORY_BASIS);
+        return (type>=LOOP and type<=EXTRAORDINARY_BASIS);
     }
 
     /// \brief Returns true if the type is an adaptive patch
@@ -130,6 +137,9 @@ public:
     /// \brief Number of control vertices of Gregory patch basis (20)
     static short GetGregoryBasisPatchSize() { return 20; }
 
+    /// \brief Number of control vertices of extraordinary patch basis (20)
+    static short GetExtraordinaryBasisPatchSize() { return 20; }
+
 
     /// \brief Returns a vector of all the legal patch descriptors for the
     ///        given adaptive subdivision scheme
@@ -159,6 +169,7 @@ PatchDescriptor::GetNumControlVertices( Type type ) {
         case GREGORY           :
         case GREGORY_BOUNDARY  : return GetGregoryPatchSize();
         case GREGORY_BASIS     : return GetGregoryBasisPatchSize();
+        case EXTRAORDINARY_BASIS : return GetExtraordinaryBasisPatchSize();
         case TRIANGLES         : return 3;
         case LINES             : return 2;
         case POINTS            : return 1;
@@ -176,6 +187,7 @@ PatchDescriptor::GetNumFVarControlVertices( Type type ) {
         case LINES             : return 2;
         case POINTS            : return 1;
         case GREGORY_BASIS     : assert(0); return GetGregoryBasisPatchSize();
+        case EXTRAORDINARY_BASIS : assert(0); return GetExtraordinaryBasisPatchSize();
         case GREGORY           :
         case GREGORY_BOUNDARY  : assert(0); // unsupported types
         default : return -1;
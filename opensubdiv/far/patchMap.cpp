@@ -25,6 +25,7 @@
 #include "../far/patchMap.h"
 
 #include <algorithm>
+#include <climits>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -32,7 +33,8 @@ namespace OPENSUBDIV_VERSION {
 namespace Far {
 
 // Constructor
-PatchMap::PatchMap( PatchTable const & patchTable ) {
+PatchMap::PatchMap( PatchTable const & patchTable ) :
+    _minPatchFace(0), _maxPatchFace(-1) {
     initialize( patchTable );
 }
 
@@ -67,7 +69,8 @@ PatchMap::addChild( QuadTree & quadtree, QuadNode * parent, int quadrant ) {
 void
 PatchMap::initialize( PatchTable const & patchTable ) {
 
-    int nfaces = 0,
+    int minface = INT_MAX,
+        maxface = 0,
         narrays = (int)patchTable.GetNumPatchArrays(),
         npatches = (int)patchTable.GetNumPatchesTotal();
 
@@ -91,12 +94,17 @@ PatchMap::initialize( PatchTable const & patchTable ) {
             h.patchIndex = current;
             h.vertIndex  = j * ringsize;
 
-            nfaces = std::max(nfaces, (int)params[j].GetFaceId());
+            minface = std::min(minface, (int)params[j].GetFaceId());
+            maxface = std::max(maxface, (int)params[j].GetFaceId());
 
             ++current;
         }
     }
-    ++nfaces;
+    int nfaces = maxface - minface + 1;
+
+    _minPatchFace = minface;
+    _maxPatchFace = maxface;
+
     // temporary vector to hold the quadtree while under construction
     std::vector<QuadNode> quadtree;
 
@@ -117,7 +125,7 @@ PatchMap::initialize( PatchTable const & patchTable ) {
 
             unsigned short depth = param.GetDepth();
 
-            QuadNode * node = &quadtree[ params[i].GetFaceId() ];
+            QuadNode * node = &quadtree[ params[i].GetFaceId() - minface ];
 
             if (depth==(param.NonQuadRoot() ? 1 : 0)) {
                 // special case : regular BSpline face w/ no sub-patches
@@ -115,8 +115,13 @@ private:
     //
     template <class T> static int resolveQuadrant(T & median, T & u, T & v);
 
+    int _minPatchFace,               // range of faces with patches (tables
+        _maxPatchFace;               // may hold the patches of a subset of
+                                     // the faces, see ClusterTable)
+
     std::vector<Handle>   _handles;  // all the patches in the PatchTable
-    std::vector<QuadNode> _quadtree; // quadtree nodes
+    std::vector<QuadNode> _quadtree; // quadtree nodes (root nodes of the faces
+                                     // of the range first)
 };
 
 // given a median, transforms the (u,v) to the quadrant they point to, and
@@ -148,12 +153,12 @@ PatchMap::resolveQuadrant(T & median, T & u, T & v) {
 inline PatchMap::Handle const *
 PatchMap::FindPatch( int faceid, float u, float v ) const {
 
-    if (faceid>=(int)_quadtree.size())
+    if (faceid<_minPatchFace or faceid>_maxPatchFace)
         return NULL;
 
     assert( (u>=0.0f) and (u<=1.0f) and (v>=0.0f) and (v<=1.0f) );
 
-    QuadNode const * node = &_quadtree[faceid];
+    QuadNode const * node = &_quadtree[faceid - _minPatchFace];
 
     float half = 0.5f;
 
@@ -46,18 +46,22 @@ namespace Far {
 ///
 ///  Field0     | Bits | Content
 ///  -----------|:----:|------------------------------------------------------
-///  faceId     | 28   | the faceId of the patch
+///  faceId     | 28   | the faceId of the patch (low bits)
 ///  transition | 4    | transition edge mask encoding
 ///
 ///  Field1     | Bits | Content
 ///  -----------|:----:|------------------------------------------------------
 ///  level      | 4    | the subdivision level of the patch
 ///  nonquad    | 1    | whether the patch is the child of a non-quad face
-///  unused     | 3    | transition edge mask encoding
+///  faceIdHigh | 3    | the faceId of the patch (high bits)
 ///  boundary   | 4    | boundary edge mask encoding
 ///  v          | 10   | log2 value of u parameter at first patch corner
 ///  u          | 10   | log2 value of v parameter at first patch corner
 ///
+/// The faceId spans 31 bits, i.e. the full range of Index : the high bits
+/// are 0 for meshes of less than 2^28 ptex faces, so that clients decoding
+/// only the 28 bits of Field0 keep working with those meshes.
+///
 /// Note : the bitfield is not expanded in the struct due to differences in how
 ///        GPU & CPU compilers pack bit-fields and endian-ness.
 ///
@@ -83,7 +87,9 @@ struct PatchParam {
     void Clear() { field0 = field1 = 0; }
 
     /// \brief Retuns the faceid
-    Index GetFaceId() const { return Index(field0 & 0xfffffff); }
+    Index GetFaceId() const {
+        return Index((field0 & 0xfffffff) | (((field1 >> 5) & 0x7) << 28));
+    }
 
     /// \brief Returns the log2 value of the u parameter at the top left corner of
     /// the patch
@@ -134,6 +140,7 @@ PatchParam::Set( Index faceid, short u, short v,
     field1 = ((u & 0x3ff) << 22) |
              ((v & 0x3ff) << 12) |
              ((boundary & 0xf) << 8) |
+             ((((unsigned int)faceid >> 28) & 0x7) << 5) |
              ((nonquad ? 1:0) << 4) |
              (nonquad ? depth+1 : depth);
 }
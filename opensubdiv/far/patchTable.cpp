@@ -53,7 +53,10 @@ PatchTable::PatchTable(PatchTable const & src) :
     _localPointVaryingStencils(NULL),
     _fvarChannels(src._fvarChannels),
     _sharpnessIndices(src._sharpnessIndices),
-    _sharpnessValues(src._sharpnessValues) {
+    _sharpnessValues(src._sharpnessValues),
+    _ptexFaceOffsets(src._ptexFaceOffsets),
+    _ptexFacePatches(src._ptexFacePatches),
+    _patchLinks(src._patchLinks) {
 
     if (src._localPointStencils) {
         _localPointStencils =
@@ -114,6 +117,11 @@ PatchTable::reservePatchArrays(int numPatchArrays) {
     _patchArrays.reserve(numPatchArrays);
 }
 
+void
+PatchTable::clearPatchArrays() {
+    _patchArrays.clear();
+}
+
 //
 // FVarPatchChannel
 //
@@ -171,13 +179,14 @@ PatchTable::allocateFVarPatchChannels(int numChannels) {
     _fvarChannels.resize(numChannels);
 }
 void
-PatchTable::allocateFVarPatchChannelValues(
+PatchTable::allocateFVarPatchChannelValues(PatchDescriptor::Type type,
         int numPatches, int numVerticesTotal, int channel) {
 
     FVarPatchChannel & c = getFVarPatchChannel(channel);
     (void)numPatches; // not used
     // Allocate bi-linear channels (allows uniform topology to be populated
     // in a single traversal)
+    c.patchesType = type;
     c.patchValues.resize(numVerticesTotal);
 }
 void
@@ -266,6 +275,66 @@ PatchTable::findPatchArray(PatchDescriptor desc) {
     }
     return Vtr::INDEX_INVALID;
 }
+void
+PatchTable::insertPatchArray(Index arrayIndex, PatchDescriptor desc) {
+
+    // the new (empty) array starts at the end of the previous one
+    Index vidx = 0, pidx = 0;
+    if (arrayIndex>0) {
+        PatchArray const & prev = getPatchArray(arrayIndex-1);
+        vidx = prev.vertIndex + prev.numPatches * getPatchSize(prev.desc);
+        pidx = prev.patchIndex + prev.numPatches;
+    }
+    _patchArrays.insert(_patchArrays.begin() + arrayIndex,
+        PatchArray(desc, 0, vidx, pidx, 0));
+}
+void
+PatchTable::resizePatchArray(Index arrayIndex, int npatches) {
+
+    //  Patches are added or removed at the end of the array : the following
+    //  arrays are shifted along with the per-patch tables
+    PatchArray & pa = getPatchArray(arrayIndex);
+    assert(pa.desc.GetType()!=PatchDescriptor::GREGORY);
+
+    int ncvs = getPatchSize(pa.desc),
+        delta = npatches - pa.numPatches;
+
+    Index vend = pa.vertIndex + pa.numPatches * ncvs,
+          pend = pa.patchIndex + pa.numPatches;
+
+    if (delta>0) {
+        _patchVerts.insert(_patchVerts.begin() + vend, delta * ncvs, 0);
+        _paramTable.insert(_paramTable.begin() + pend, delta, PatchParam());
+        if (not _sharpnessIndices.empty()) {
+            _sharpnessIndices.insert(_sharpnessIndices.begin() + pend, delta, 0);
+        }
+        if (not _patchLinks.empty()) {
+            _patchLinks.insert(_patchLinks.begin() + pend, delta, Vtr::INDEX_INVALID);
+        }
+    } else if (delta<0) {
+        _patchVerts.erase(_patchVerts.begin() + vend + delta * ncvs,
+                          _patchVerts.begin() + vend);
+        _paramTable.erase(_paramTable.begin() + pend + delta,
+                          _paramTable.begin() + pend);
+        if (not _sharpnessIndices.empty()) {
+            _sharpnessIndices.erase(_sharpnessIndices.begin() + pend + delta,
+                                    _sharpnessIndices.begin() + pend);
+        }
+        if (not _patchLinks.empty()) {
+            _patchLinks.erase(_patchLinks.begin() + pend + delta,
+                              _patchLinks.begin() + pend);
+        }
+    }
+    pa.numPatches = npatches;
+
+    for (int i=arrayIndex+1; i<(int)_patchArrays.size(); ++i) {
+        _patchArrays[i].vertIndex += delta * ncvs;
+        _patchArrays[i].patchIndex += delta;
+    }
+    if (npatches==0) {
+        _patchArrays.erase(_patchArrays.begin() + arrayIndex);
+    }
+}
 IndexArray
 PatchTable::getPatchArrayVertices(int arrayIndex) {
     PatchArray const & pa = getPatchArray(arrayIndex);
@@ -358,7 +427,7 @@ PatchTable::IsFeatureAdaptive() const {
     for (int i=0; i<GetNumPatchArrays(); ++i) {
         PatchDescriptor const & desc = _patchArrays[i].desc;
         if (desc.GetType()>=PatchDescriptor::REGULAR and
-            desc.GetType()<=PatchDescriptor::GREGORY_BASIS) {
+            desc.GetType()<=PatchDescriptor::EXTRAORDINARY_BASIS) {
             return true;
         }
     }
@@ -399,6 +468,18 @@ PatchTable::getPatchFVarValues(int patch, int channel) const {
             PatchDescriptor::GetNumFVarControlVertices(c.patchTypes[patch]));
    }
 }
+PatchDescriptor::Type
+PatchTable::getFVarPatchType(int patch, int channel) const {
+
+    FVarPatchChannel const & c = getFVarPatchChannel(channel);
+
+    if (c.patchTypes.empty()) {
+        return c.patchesType;
+    } else {
+        assert(patch<(int)c.patchTypes.size());
+        return c.patchTypes[patch];
+    }
+}
 ConstIndexArray
 PatchTable::GetPatchFVarValues(PatchHandle const & handle, int channel) const {
     return getPatchFVarValues(handle.patchIndex, channel);
@@ -433,6 +514,10 @@ PatchTable::EvaluateBasis(PatchHandle const & handle, float s, float t,
         internal::GetBSplineWeights(param, s, t, wP, wDs, wDt);
     } else if (patchType == PatchDescriptor::GREGORY_BASIS) {
         internal::GetGregoryWeights(param, s, t, wP, wDs, wDt);
+    } else if (patchType == PatchDescriptor::EXTRAORDINARY_BASIS) {
+        int valence = internal::GetExtraordinaryValence(
+            GetPatchVertices(handle).begin());
+        internal::GetExtraordinaryWeights(param, valence, s, t, wP, wDs, wDt);
     } else if (patchType == PatchDescriptor::QUADS) {
         internal::GetBilinearWeights(param, s, t, wP, wDs, wDt);
     } else {
@@ -440,6 +525,35 @@ PatchTable::EvaluateBasis(PatchHandle const & handle, float s, float t,
     }
 }
 
+//
+//  Evaluate face-varying basis functions for value and first derivatives at
+//  (s,t):
+//
+void
+PatchTable::EvaluateBasisFaceVarying(PatchHandle const & handle,
+    float s, float t, float wP[], float wDs[], float wDt[],
+    int channel) const {
+
+    PatchDescriptor::Type patchType =
+        getFVarPatchType(handle.patchIndex, channel);
+    PatchParam const & param = _paramTable[handle.patchIndex];
+
+    if (patchType == PatchDescriptor::QUADS) {
+        internal::GetBilinearWeights(param, s, t, wP, wDs, wDt);
+    } else {
+        // no basis is implemented for the other face-varying patch types
+        // (e.g. the triangles of triangulated uniform tables) : the values
+        // do not contribute
+        int numValues = PatchDescriptor::GetNumFVarControlVertices(patchType);
+        for (int i = 0; i < numValues; ++i) {
+            wP[i] = 0.0f;
+            if (wDs and wDt) {
+                wDs[i] = wDt[i] = 0.0f;
+            }
+        }
+    }
+}
+
 
 } // end namespace Far
 
@@ -308,11 +308,38 @@ public:
     void EvaluateBasis(PatchHandle const & handle, float s, float t,
         float wP[], float wDs[], float wDt[]) const;
 
+    /// \brief Evaluate basis functions for a face-varying value and its first
+    /// derivatives at a given (s,t) parametric location of a patch.
+    ///
+    /// The weights apply to the values returned by GetPatchFVarValues().
+    /// Only bilinear (QUADS) face-varying patches have a basis : the weights
+    /// of any other face-varying patch type are set to zero.
+    ///
+    /// @param handle  A patch handle indentifying the sub-patch containing the
+    ///                (s,t) location
+    ///
+    /// @param s       Patch coordinate (in coarse face normalized space)
+    ///
+    /// @param t       Patch coordinate (in coarse face normalized space)
+    ///
+    /// @param wP      Weights (evaluated basis functions) for the value
+    ///
+    /// @param wDs     Weights (evaluated basis functions) for derivative wrt s
+    ///
+    /// @param wDt     Weights (evaluated basis functions) for derivative wrt t
+    ///
+    /// @param channel Face-varying channel
+    ///
+    void EvaluateBasisFaceVarying(PatchHandle const & handle, float s, float t,
+        float wP[], float wDs[], float wDt[], int channel = 0) const;
+
     //@}
 
 protected:
 
     friend class PatchTableFactory;
+    friend class ClusterTable;
+    friend class ClusterTableFactory;
 
     // Factory constructor
     PatchTable(int maxvalence);
@@ -337,6 +364,7 @@ private:
     PatchArray const & getPatchArray(Index arrayIndex) const;
 
     void reservePatchArrays(int numPatchArrays);
+    void clearPatchArrays();
     void pushPatchArray(PatchDescriptor desc, int npatches,
         Index * vidx, Index * pidx, Index * qoidx=0);
 
@@ -344,6 +372,9 @@ private:
 
     Index findPatchArray(PatchDescriptor desc);
 
+    void insertPatchArray(Index arrayIndex, PatchDescriptor desc);
+    void resizePatchArray(Index arrayIndex, int npatches);
+
 
     //
     // FVar patch channels
@@ -356,7 +387,7 @@ private:
     FVarPatchChannel const & getFVarPatchChannel(int channel) const;
 
     void allocateFVarPatchChannels(int numChannels);
-    void allocateFVarPatchChannelValues(
+    void allocateFVarPatchChannelValues(PatchDescriptor::Type type,
         int numPatches, int numVerticesTotal, int channel);
 
     void setFVarPatchChannelLinearInterpolation(
@@ -408,6 +439,15 @@ private:
 
     std::vector<Index>   _sharpnessIndices; // Indices of single-crease sharpness (one per patch)
     std::vector<float>   _sharpnessValues;  // Sharpness values.
+
+    //
+    // Patches of each ptex face, indexed by the first incremental update of
+    // the table (see PatchTableFactory::UpdateAdaptive)
+    //
+
+    std::vector<Index>   _ptexFaceOffsets;  // First ptex face of each base face (+ total)
+    std::vector<Index>   _ptexFacePatches;  // First patch of each ptex face
+    std::vector<Index>   _patchLinks;       // Next patch of the same ptex face (one per patch)
 };
 
 template <class T>
@@ -25,10 +25,13 @@
 #include "../far/error.h"
 #include "../far/ptexIndices.h"
 #include "../far/topologyRefiner.h"
+#include "../far/topologyRegion.h"
+#include "../far/stencilTableFactory.h"
 #include "../vtr/level.h"
 #include "../vtr/fvarLevel.h"
 #include "../vtr/refinement.h"
 #include "../far/endCapBSplineBasisPatchFactory.h"
+#include "../far/endCapExtraordinaryBasisPatchFactory.h"
 #include "../far/endCapGregoryBasisPatchFactory.h"
 #include "../far/endCapLegacyGregoryPatchFactory.h"
 
@@ -50,7 +53,8 @@ struct PatchTypes {
     TYPE R,    // regular patch
          G,    // gregory patch
          GB,   // gregory boundary patch
-         GP;   // gregory basis patch
+         GP,   // gregory basis patch
+         EP;   // extraordinary basis patch
 
     PatchTypes() { std::memset(this, 0, sizeof(PatchTypes<TYPE>)); }
 
@@ -61,6 +65,7 @@ struct PatchTypes {
             case Far::PatchDescriptor::GREGORY          : return G;
             case Far::PatchDescriptor::GREGORY_BOUNDARY : return GB;
             case Far::PatchDescriptor::GREGORY_BASIS    : return GP;
+            case Far::PatchDescriptor::EXTRAORDINARY_BASIS : return EP;
             default : assert(0);
         }
         // can't be reached (suppress compiler warning)
@@ -75,15 +80,13 @@ struct PatchTypes {
         if (G) ++result;
         if (GB) ++result;
         if (GP) ++result;
+        if (EP) ++result;
         return result;
     }
 };
 
 typedef PatchTypes<Far::Index *>      PatchCVPointers;
-typedef PatchTypes<Far::PatchParam *> PatchParamPointers;
-typedef PatchTypes<Far::Index *>      SharpnessIndexPointers;
-typedef PatchTypes<Far::Index>        PatchFVarOffsets;
-typedef PatchTypes<Far::Index **>     PatchFVarPointers;
+typedef PatchTypes<Far::Index>        PatchIndices;
 
 
 } // namespace anon
@@ -169,6 +172,12 @@ PatchTableFactory::PatchFaceTag::assignBoundaryPropertiesFromVertexMask(int boun
     }
 }
 
+//
+//  Minimum number of faces in a level for its patches to be identified and
+//  gathered concurrently (smaller levels are not worth the threading overhead)
+//
+static int const PARALLEL_FACE_THRESHOLD = 1024;
+
 //
 //  Trivial anonymous helper functions:
 //
@@ -311,6 +320,9 @@ public:
     // Bit tags accumulating patch attributes during topology traversal
     PatchTagVector patchTags;
 
+    // Optional mask restricting patches to the descendants of some base faces
+    std::vector<unsigned char> const * baseFaceMask;
+
 public:
 
     //
@@ -328,7 +340,7 @@ public:
 // Constructor
 PatchTableFactory::AdaptiveContext::AdaptiveContext(
     TopologyRefiner const & ref, Options opts) :
-    refiner(ref), options(opts), table(0),
+    refiner(ref), options(opts), table(0), baseFaceMask(0),
     fvarChannelCursor(ref, opts) {
 }
 
@@ -390,34 +402,40 @@ PatchTableFactory::allocateFVarChannels(TopologyRefiner const & refiner,
 
         int nverts = 0;
 
-        PatchDescriptor::Type type = options.triangulateQuads ?
-            PatchDescriptor::TRIANGLES : PatchDescriptor::QUADS;
+        // Face-varying patches are bi-linear : they match the faces of uniform
+        // tables (possibly triangulated) and are always quads in adaptive ones,
+        // regardless of the linear interpolation mode of the channel
+        PatchDescriptor::Type type = PatchDescriptor::QUADS;
+        if (refiner.IsUniform() and (options.triangulateQuads or
+            (refiner.GetSchemeType() == Sdc::SCHEME_LOOP))) {
+            type = PatchDescriptor::TRIANGLES;
+        }
 
         nverts =
             npatches * PatchDescriptor::GetNumFVarControlVertices(type);
 
-        table->allocateFVarPatchChannelValues(npatches, nverts, fvc.pos());
+        table->allocateFVarPatchChannelValues(type, npatches, nverts, fvc.pos());
     }
 }
 
 
 // gather face-varying patch points
-int
+void
 PatchTableFactory::gatherFVarData(AdaptiveContext & context, int level,
-    Index faceIndex, Index levelFaceOffset, int rotation,
-        Index const * levelFVarVertOffsets, Index fofss, Index ** fptrs) {
-
-    (void)levelFaceOffset;  // not used
-    (void)fofss;  // not used
+    Index faceIndex, int rotation, Index const * levelFVarVertOffsets,
+        Index patchIndex) {
 
     if (not context.RequiresFVarPatches()) {
-        return 0;
+        return;
     }
 
     TopologyRefiner const & refiner = context.refiner;
 
-    // Iterate over valid FVar channels (if any)
-    FVarChannelCursor & fvc = context.fvarChannelCursor;
+    PatchTable * table = context.table;
+
+    // Iterate over valid FVar channels (if any) -- with a local copy of the
+    // cursor, as patches may be gathered concurrently
+    FVarChannelCursor fvc = context.fvarChannelCursor;
     for (fvc=fvc.begin(); fvc!=fvc.end(); ++fvc) {
 
         Vtr::internal::Level const & vtxLevel = refiner.getLevel(level);
@@ -430,13 +448,11 @@ PatchTableFactory::gatherFVarData(AdaptiveContext & context, int level,
         ConstIndexArray fvarValues = fvarLevel.getFaceValues(faceIndex);
 
         // Store verts values directly in non-sparse context channel arrays
+        Index * dst = &table->getFVarValues(fvc.pos())[patchIndex * 4];
         for (int vert=0; vert<fvarValues.size(); ++vert) {
-            fptrs[fvc.pos()][vert] =
-                levelFVarVertOffsets[fvc.pos()] + fvarValues[(vert+rotation)%4];
+            dst[vert] = levelFVarVertOffsets[fvc.pos()] + fvarValues[(vert+rotation)%4];
         }
-        fptrs[fvc.pos()]+=fvarValues.size();
     }
-    return 1;
 }
 
 //
@@ -504,6 +520,33 @@ PatchTableFactory::computePatchParam(
 }
 
 
+//
+//  Patches linked by ptex face (incremental updates) are identified by the
+//  index of their descriptor in the adaptive descriptors and their slot in
+//  the patch array of that type
+//
+inline Index
+linkPatch(int desc, int slot) {
+    return (slot << 3) | desc;
+}
+inline int
+getLinkedPatchDesc(Index link) {
+    return link & 0x7;
+}
+inline int
+getLinkedPatchSlot(Index link) {
+    return link >> 3;
+}
+inline int
+findDescriptor(ConstPatchDescriptorArray const & descs, PatchDescriptor desc) {
+    for (int i=0; i<descs.size(); ++i) {
+        if (descs[i]==desc) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 //
 //  Indexing sharpnesses
 //
@@ -692,13 +735,15 @@ PatchTableFactory::createUniform(TopologyRefiner const & refiner, Options option
 }
 
 PatchTable *
-PatchTableFactory::createAdaptive(TopologyRefiner const & refiner, Options options) {
+PatchTableFactory::createAdaptive(TopologyRefiner const & refiner, Options options,
+    std::vector<unsigned char> const * baseFaceMask) {
 
     assert(not refiner.IsUniform());
 
     PtexIndices ptexIndices(refiner);
 
     AdaptiveContext context(refiner, options);
+    context.baseFaceMask = baseFaceMask;
 
     //
     //  First identify the patches -- accumulating the inventory patches for all of the
@@ -749,6 +794,466 @@ PatchTableFactory::createAdaptive(TopologyRefiner const & refiner, Options optio
     return context.table;
 }
 
+//
+//  Incremental update of an adaptive table after local topology edits
+//
+StencilTable const *
+PatchTableFactory::UpdateAdaptive(TopologyRefiner const & refiner,
+    ConstIndexArray baseFaces, Index firstVertex, PatchTable * table,
+    Options options, StencilTable const ** varyingStencils) {
+
+    if (varyingStencils) {
+        *varyingStencils = 0;
+    }
+
+    if ((not table) or (not table->IsFeatureAdaptive())) {
+        Error(FAR_CODING_ERROR,
+            "PatchTableFactory::UpdateAdaptive requires an adaptive PatchTable");
+        return 0;
+    }
+    if (table->GetNumFVarChannels()>0 or (not table->_quadOffsetsTable.empty()) or
+        options.GetEndCapType()==Options::ENDCAP_LEGACY_GREGORY) {
+        Error(FAR_CODING_ERROR,
+            "PatchTableFactory::UpdateAdaptive does not support face-varying "
+            "patches or legacy Gregory end-caps");
+        return 0;
+    }
+
+    if (table->_ptexFaceOffsets.empty()) {
+        if (not indexPatchesByPtexFace(refiner, baseFaces, table)) {
+            Error(FAR_RUNTIME_ERROR,
+                "PatchTableFactory::UpdateAdaptive : the edits change the ptex "
+                "faces of unmodified faces (number of vertices of a modified "
+                "face changed, or new faces not appended)");
+            return 0;
+        }
+    }
+
+    //
+    //  The patches remaining in the table keep their ptex face ids, which are
+    //  only valid if the ptex faces of the unmodified base faces are unchanged,
+    //  i.e. if the modified faces kept their number of vertices and new faces
+    //  were appended.  Only the modified faces are checked against the ptex
+    //  faces indexed in the table :
+    //
+    TopologyLevel const & baseLevel = refiner.GetLevel(0);
+
+    int regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(refiner.GetSchemeType());
+
+    std::vector<Index> & ptexFaceOffsets = table->_ptexFaceOffsets;
+
+    int numFaces = baseLevel.GetNumFaces(),
+        numIndexedFaces = (int)ptexFaceOffsets.size() - 1;
+
+    std::vector<Index> modifiedFaces(baseFaces.begin(), baseFaces.end());
+    std::sort(modifiedFaces.begin(), modifiedFaces.end());
+    modifiedFaces.erase(std::unique(modifiedFaces.begin(), modifiedFaces.end()),
+        modifiedFaces.end());
+
+    //  first ptex face of the appended faces (+ total)
+    std::vector<Index> appendedPtexFaceOffsets(1, ptexFaceOffsets.back());
+
+    bool ptexFacesShifted = (numFaces < numIndexedFaces);
+    for (int i=0; i<(int)modifiedFaces.size() and (not ptexFacesShifted); ++i) {
+
+        Index face = modifiedFaces[i];
+        int nverts = baseLevel.GetFaceVertices(face).size(),
+            nptex = (nverts==regFaceSize) ? 1 : nverts;
+
+        if (face < numIndexedFaces) {
+            ptexFacesShifted =
+                (nptex != ptexFaceOffsets[face+1] - ptexFaceOffsets[face]);
+        } else {
+            //  appended faces must all be listed as modified
+            appendedPtexFaceOffsets.push_back(
+                appendedPtexFaceOffsets.back() + nptex);
+        }
+    }
+    ptexFacesShifted |=
+        ((int)appendedPtexFaceOffsets.size()-1 != numFaces - numIndexedFaces);
+
+    if (ptexFacesShifted) {
+        Error(FAR_RUNTIME_ERROR,
+            "PatchTableFactory::UpdateAdaptive : the edits change the ptex "
+            "faces of unmodified faces (number of vertices of a modified "
+            "face changed, or new faces not appended)");
+        return 0;
+    }
+
+    //
+    //  The limit surface of the modified faces and of their one-ring changes,
+    //  but the transitions of the patches of the two-ring also change when the
+    //  isolation of their one-ring neighbors does.  So the modified faces and
+    //  their two-ring are extracted along with two more rings of faces : the
+    //  faces of the two-ring then have complete neighborhoods and isolate the
+    //  same features as the whole mesh would, so the transitions of their
+    //  patches match those of the patches remaining in the table.
+    //
+    internal::TopologyRegion region(refiner, baseFaces, 4);
+
+    TopologyRefiner * regionRefiner = region.CreateRefiner();
+    if (not regionRefiner) {
+        return 0;
+    }
+
+    TopologyRefiner::AdaptiveOptions adaptiveOptions(options.maxIsolationLevel);
+    adaptiveOptions.useSingleCreasePatch = options.useSingleCreasePatch;
+    regionRefiner->RefineAdaptive(adaptiveOptions);
+
+    if (regionRefiner->IsUniform()) {
+        delete regionRefiner;
+        return 0;
+    }
+
+    std::vector<unsigned char> faceMask(region.GetNumFaces());
+    for (int face=0; face<region.GetNumFaces(); ++face) {
+        faceMask[face] = (region.GetFaceRing(face) <= 2);
+    }
+
+    options.generateFVarTables = false;
+
+    PatchTable * regionTable = createAdaptive(*regionRefiner, options, &faceMask);
+
+    //
+    //  Stencils for the block of vertices of the region : control vertices of
+    //  the region first, then refined vertices and local points, all of them
+    //  factorized to the control vertices and re-indexed to the base mesh.
+    //
+    StencilTableFactory::Options stencilOptions;
+    stencilOptions.generateOffsets = true;
+    stencilOptions.generateControlVerts = true;
+    stencilOptions.generateIntermediateLevels = true;
+
+    StencilTable const * stencils[2] = { 0, 0 };
+    for (int i=0; i<(varyingStencils ? 2 : 1); ++i) {
+
+        stencilOptions.interpolationMode = (i==0) ?
+            StencilTableFactory::INTERPOLATE_VERTEX :
+            StencilTableFactory::INTERPOLATE_VARYING;
+
+        StencilTable const * refinedStencils =
+            StencilTableFactory::Create(*regionRefiner, stencilOptions);
+
+        StencilTable const * localPointStencils = (i==0) ?
+            regionTable->GetLocalPointStencilTable() :
+            regionTable->GetLocalPointVaryingStencilTable();
+
+        if (localPointStencils) {
+            StencilTable const * appended =
+                StencilTableFactory::AppendLocalPointStencilTable(
+                    *regionRefiner, refinedStencils, localPointStencils);
+            delete refinedStencils;
+            refinedStencils = appended;
+        }
+
+        StencilTable * result = new StencilTable(*refinedStencils);
+        delete refinedStencils;
+
+        result->_numControlVertices = baseLevel.GetNumVertices();
+        for (size_t j=0; j<result->_indices.size(); ++j) {
+            result->_indices[j] = region.GetBaseVertex(result->_indices[j]);
+        }
+        stencils[i] = result;
+    }
+
+    //
+    //  Map the ptex faces of the region to those of the base mesh and gather
+    //  the ptex faces whose patches are replaced :
+    //
+    std::vector<Index> & ptexFacePatches = table->_ptexFacePatches;
+    std::vector<Index> & patchLinks = table->_patchLinks;
+
+    ptexFaceOffsets.insert(ptexFaceOffsets.end(),
+        appendedPtexFaceOffsets.begin()+1, appendedPtexFaceOffsets.end());
+    ptexFacePatches.resize(ptexFaceOffsets.back(), INDEX_INVALID);
+
+    PtexIndices regionPtexIndices(*regionRefiner);
+
+    std::vector<Index> ptexRemap(regionPtexIndices.GetNumFaces(), INDEX_INVALID),
+                       ptexReplaced;
+
+    for (int face=0; face<region.GetNumFaces(); ++face) {
+
+        Index baseFace = region.GetBaseFace(face),
+              basePtex = ptexFaceOffsets[baseFace],
+              regionPtex = regionPtexIndices.GetFaceId(face);
+
+        int nptex = ptexFaceOffsets[baseFace+1] - basePtex;
+        for (int i=0; i<nptex; ++i) {
+            ptexRemap[regionPtex + i] = basePtex + i;
+            if (faceMask[face]) {
+                ptexReplaced.push_back(basePtex + i);
+            }
+        }
+    }
+
+    //
+    //  Release the patches of the replaced ptex faces : the slots they occupy
+    //  in each patch array are gathered to be reused by the new patches.
+    //
+    ConstPatchDescriptorArray const & descs =
+        PatchDescriptor::GetAdaptivePatchDescriptors(Sdc::SCHEME_CATMARK);
+
+    std::vector< std::vector<int> > freeSlots(descs.size());
+
+    for (int i=0; i<(int)ptexReplaced.size(); ++i) {
+        Index & head = ptexFacePatches[ptexReplaced[i]];
+        for (Index patch=head; patch!=INDEX_INVALID; ) {
+            int desc = getLinkedPatchDesc(patch),
+                slot = getLinkedPatchSlot(patch);
+            freeSlots[desc].push_back(slot);
+            patch = patchLinks[table->getPatchIndex(
+                table->findPatchArray(descs[desc]), slot)];
+        }
+        head = INDEX_INVALID;
+    }
+
+    //
+    //  Splice the patches of the region in place : for each type of patch,
+    //  the new patches are written into the free slots, and the array then
+    //  only grows or shrinks at its end (remaining patches moved into the
+    //  free slots below the new end).
+    //
+    bool hasSharpness = options.useSingleCreasePatch or
+                        (not table->_sharpnessIndices.empty());
+    if (hasSharpness and
+        table->_sharpnessIndices.size() != table->_paramTable.size()) {
+        table->_sharpnessIndices.resize(table->_paramTable.size(),
+            assignSharpnessIndex(0.0f, table->_sharpnessValues));
+    }
+
+    std::vector<Index> newPatches;
+
+    for (int desc=0; desc<descs.size(); ++desc) {
+
+        int ncvs = descs[desc].GetNumControlVertices();
+
+        Index regionArray = regionTable->findPatchArray(descs[desc]);
+        int numNewPatches = (regionArray==Vtr::INDEX_INVALID) ?
+            0 : regionTable->GetNumPatches(regionArray);
+
+        Index arrayIndex = table->findPatchArray(descs[desc]);
+        if (arrayIndex==Vtr::INDEX_INVALID) {
+            if (numNewPatches==0) {
+                continue;
+            }
+            //  arrays are kept in the order of the descriptors
+            arrayIndex = 0;
+            for (int i=0; i<table->GetNumPatchArrays(); ++i) {
+                arrayIndex += (findDescriptor(descs,
+                    table->GetPatchArrayDescriptor(i)) < desc);
+            }
+            table->insertPatchArray(arrayIndex, descs[desc]);
+        }
+
+        std::vector<int> & slots = freeSlots[desc];
+        std::sort(slots.begin(), slots.end());
+
+        int numPatches = table->GetNumPatches(arrayIndex),
+            numSlots = (int)slots.size();
+
+        if (numNewPatches > numSlots) {
+            for (int i=numPatches; i<numPatches+numNewPatches-numSlots; ++i) {
+                slots.push_back(i);
+            }
+            table->resizePatchArray(arrayIndex,
+                numPatches + numNewPatches - numSlots);
+        } else if (numNewPatches < numSlots) {
+            //  fill the free slots below the new end of the array with the
+            //  last patches of the array that are not released
+            int end = numPatches - (numSlots - numNewPatches);
+            int last = numPatches-1,
+                next = numSlots-1;
+            for (int i=numNewPatches; i<numSlots and slots[i]<end; ++i) {
+                while (next>=numNewPatches and slots[next]==last) {
+                    --next, --last;
+                }
+                movePatch(table, desc, arrayIndex, last--, slots[i]);
+            }
+            table->resizePatchArray(arrayIndex, end);
+            slots.resize(numNewPatches);
+        }
+        if (numNewPatches==0) {
+            continue;
+        }
+        arrayIndex = table->findPatchArray(descs[desc]);
+
+        IndexArray cvs = table->getPatchArrayVertices(arrayIndex);
+        PatchParamArray params = table->getPatchParams(arrayIndex);
+
+        ConstIndexArray regionCvs = regionTable->GetPatchArrayVertices(regionArray);
+        ConstPatchParamArray regionParams = regionTable->GetPatchParams(regionArray);
+
+        for (int patch=0; patch<numNewPatches; ++patch) {
+
+            int slot = slots[patch];
+
+            for (int j=0; j<ncvs; ++j) {
+                cvs[slot*ncvs + j] = firstVertex + regionCvs[patch*ncvs + j];
+            }
+
+            PatchParam param = regionParams[patch];
+            bool nonquad = param.NonQuadRoot();
+            param.Set(ptexRemap[param.GetFaceId()], param.GetU(), param.GetV(),
+                (unsigned short)(nonquad ? param.GetDepth()-1 : param.GetDepth()),
+                nonquad, param.GetBoundary(), param.GetTransition());
+            params[slot] = param;
+
+            if (hasSharpness) {
+                float sharpness = regionTable->_sharpnessIndices.empty() ? 0.0f :
+                    regionTable->GetSingleCreasePatchSharpnessValue(regionArray, patch);
+                table->_sharpnessIndices[table->getPatchIndex(arrayIndex, slot)] =
+                    assignSharpnessIndex(sharpness, table->_sharpnessValues);
+            }
+            newPatches.push_back(linkPatch(desc, slot));
+        }
+    }
+
+    //  Index the new patches by ptex face
+    patchLinks.resize(table->_paramTable.size(), INDEX_INVALID);
+    for (int i=0; i<(int)newPatches.size(); ++i) {
+        int desc = getLinkedPatchDesc(newPatches[i]);
+        Index patchIndex = table->getPatchIndex(
+            table->findPatchArray(descs[desc]), getLinkedPatchSlot(newPatches[i]));
+        Index & head = ptexFacePatches[table->_paramTable[patchIndex].GetFaceId()];
+        patchLinks[patchIndex] = head;
+        head = newPatches[i];
+    }
+
+    table->_numPtexFaces = ptexFaceOffsets.back();
+    table->_maxValence = std::max(table->_maxValence, regionRefiner->GetMaxValence());
+
+    delete regionTable;
+    delete regionRefiner;
+
+    if (varyingStencils) {
+        *varyingStencils = stencils[1];
+    }
+    return stencils[0];
+}
+
+//
+//  Indexes the patches of a table by ptex face for its first incremental
+//  update.  The ptex faces of the edited mesh are checked against those of
+//  the patches of the table : quad and non-quad faces are told apart by the
+//  patches and the new faces must cover the ptex faces appended to the table.
+//
+bool
+PatchTableFactory::indexPatchesByPtexFace(TopologyRefiner const & refiner,
+    ConstIndexArray baseFaces, PatchTable * table) {
+
+    PtexIndices ptexIndices(refiner);
+
+    TopologyLevel const & baseLevel = refiner.GetLevel(0);
+
+    int regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(refiner.GetSchemeType());
+
+    int numPtexFaces = table->_numPtexFaces;
+
+    //  0 : no patch, 1 : quad face, 2 : non-quad face
+    std::vector<unsigned char> ptexFaceTypes(numPtexFaces, 0);
+    for (int i=0; i<(int)table->_paramTable.size(); ++i) {
+        PatchParam const & param = table->_paramTable[i];
+        if (param.GetFaceId() < numPtexFaces) {
+            ptexFaceTypes[param.GetFaceId()] = param.NonQuadRoot() ? 2 : 1;
+        }
+    }
+
+    std::vector<unsigned char> modifiedFaces(baseLevel.GetNumFaces(), false);
+    for (int i=0; i<baseFaces.size(); ++i) {
+        modifiedFaces[baseFaces[i]] = true;
+    }
+
+    for (int face=0; face<baseLevel.GetNumFaces(); ++face) {
+
+        int nverts = baseLevel.GetFaceVertices(face).size(),
+            nptex = (nverts==regFaceSize) ? 1 : nverts;
+
+        Index ptex = ptexIndices.GetFaceId(face);
+        if (ptex >= numPtexFaces) {
+            //  appended faces must be listed as modified
+            if (not modifiedFaces[face]) {
+                return false;
+            }
+            continue;
+        }
+        if (ptex + nptex > numPtexFaces) {
+            return false;
+        }
+        unsigned char type = (nverts==regFaceSize) ? 1 : 2;
+        for (int i=0; i<nptex; ++i) {
+            if (ptexFaceTypes[ptex+i] and (ptexFaceTypes[ptex+i]!=type)) {
+                return false;
+            }
+        }
+    }
+
+    //  The ptex faces of the faces that are not appended are those of the
+    //  table
+    std::vector<Index> & ptexFaceOffsets = table->_ptexFaceOffsets;
+    for (int face=0; face<baseLevel.GetNumFaces(); ++face) {
+        if (ptexIndices.GetFaceId(face) >= numPtexFaces) {
+            break;
+        }
+        ptexFaceOffsets.push_back(ptexIndices.GetFaceId(face));
+    }
+    ptexFaceOffsets.push_back(numPtexFaces);
+
+    ConstPatchDescriptorArray const & descs =
+        PatchDescriptor::GetAdaptivePatchDescriptors(Sdc::SCHEME_CATMARK);
+
+    table->_ptexFacePatches.assign(numPtexFaces, INDEX_INVALID);
+    table->_patchLinks.assign(table->_paramTable.size(), INDEX_INVALID);
+    for (int array=0, patch=0; array<table->GetNumPatchArrays(); ++array) {
+        int desc = findDescriptor(descs, table->GetPatchArrayDescriptor(array));
+        for (int slot=0; slot<table->GetNumPatches(array); ++slot, ++patch) {
+            Index & head =
+                table->_ptexFacePatches[table->_paramTable[patch].GetFaceId()];
+            table->_patchLinks[patch] = head;
+            head = linkPatch(desc, slot);
+        }
+    }
+    return true;
+}
+
+//
+//  Moves a patch of an array to another slot of the same array, updating the
+//  link to the patch from the list of its ptex face
+//
+void
+PatchTableFactory::movePatch(PatchTable * table, int desc, Index arrayIndex,
+    int from, int to) {
+
+    int ncvs = table->GetPatchArrayDescriptor(arrayIndex).GetNumControlVertices();
+
+    IndexArray cvs = table->getPatchArrayVertices(arrayIndex);
+    std::copy(&cvs[from*ncvs], &cvs[from*ncvs] + ncvs, &cvs[to*ncvs]);
+
+    Index src = table->getPatchIndex(arrayIndex, from),
+          dst = table->getPatchIndex(arrayIndex, to);
+
+    table->_paramTable[dst] = table->_paramTable[src];
+    if (not table->_sharpnessIndices.empty()) {
+        table->_sharpnessIndices[dst] = table->_sharpnessIndices[src];
+    }
+
+    std::vector<Index> & patchLinks = table->_patchLinks;
+    patchLinks[dst] = patchLinks[src];
+
+    ConstPatchDescriptorArray const & descs =
+        PatchDescriptor::GetAdaptivePatchDescriptors(Sdc::SCHEME_CATMARK);
+
+    Index link = linkPatch(desc, from),
+        * prev = &table->_ptexFacePatches[table->_paramTable[dst].GetFaceId()];
+    while (*prev != link) {
+        assert(*prev != INDEX_INVALID);
+        prev = &patchLinks[table->getPatchIndex(
+            table->findPatchArray(descs[getLinkedPatchDesc(*prev)]),
+            getLinkedPatchSlot(*prev))];
+    }
+    *prev = linkPatch(desc, to);
+}
+
 //
 //  Identify all patches required for faces at all levels -- accumulating the number of patches
 //  for each type, and retaining enough information for the patch for each face to populate it
@@ -773,6 +1278,14 @@ PatchTableFactory::identifyAdaptivePatches(AdaptiveContext & context) {
 
     PatchFaceTag * levelPatchTags = &context.patchTags[0];
 
+    //  When patches are only requested for the descendants of some of the base faces,
+    //  the mask of the base level is propagated to the child faces of each level:
+    std::vector<unsigned char> levelFaceMask, childFaceMask;
+    if (context.baseFaceMask) {
+        levelFaceMask = *context.baseFaceMask;
+        assert((int)levelFaceMask.size() == refiner.GetLevel(0).GetNumFaces());
+    }
+
     for (int levelIndex = 0; levelIndex < refiner.GetNumLevels(); ++levelIndex) {
         Vtr::internal::Level const * level = &refiner.getLevel(levelIndex);
 
@@ -794,7 +1307,18 @@ PatchTableFactory::identifyAdaptivePatches(AdaptiveContext & context) {
             refinedFaceTags = &refinement->getParentFaceSparseTag(0);
         }
 
-        for (int faceIndex = 0; faceIndex < level->getNumFaces(); ++faceIndex) {
+        //
+        //  Faces are tagged independently, so the faces of the level are tagged
+        //  concurrently, the inventory being accumulated as a reduction:
+        //
+        int numFaces = level->getNumFaces(),
+            numR = 0, numG = 0, numGB = 0, numGP = 0, numEP = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for schedule(static) reduction(+:numR,numG,numGB,numGP,numEP) \
+                                 if (numFaces > PARALLEL_FACE_THRESHOLD)
+#endif
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
 
             PatchFaceTag & patchTag = levelPatchTags[faceIndex];
             patchTag.clear();
@@ -804,6 +1328,10 @@ PatchTableFactory::identifyAdaptivePatches(AdaptiveContext & context) {
                 continue;
             }
 
+            if (context.baseFaceMask and not levelFaceMask[faceIndex]) {
+                continue;
+            }
+
             //
             //  This face does not warrant a patch under the following conditions:
             //
@@ -975,26 +1503,39 @@ PatchTableFactory::identifyAdaptivePatches(AdaptiveContext & context) {
             if (patchTag._isRegular) {
 
                 if (patchTag._boundaryCount == 0) {
-                    context.patchInventory.R++;
+                    numR++;
                 } else if (patchTag._boundaryCount == 1) {
-                    context.patchInventory.R++;
+                    numR++;
                 } else {
-                    context.patchInventory.R++;
+                    numR++;
                 }
             } else {
                 // select endcap patchtype
                 switch(context.options.GetEndCapType()) {
                 case Options::ENDCAP_GREGORY_BASIS:
-                    context.patchInventory.GP++;
+                    numGP++;
                     break;
                 case Options::ENDCAP_BSPLINE_BASIS:
-                    context.patchInventory.R++;
+                    numR++;
                     break;
                 case Options::ENDCAP_LEGACY_GREGORY:
                     if (patchTag._boundaryCount == 0) {
-                        context.patchInventory.G++;
+                        numG++;
                     } else {
-                        context.patchInventory.GB++;
+                        numGB++;
+                    }
+                    break;
+                case Options::ENDCAP_EXTRAORDINARY_BASIS: {
+                        // exact patches around isolated extraordinary vertices
+                        int corner = EndCapExtraordinaryBasisPatchFactory::
+                            GetExtraordinaryCorner(*level, faceIndex);
+                        if (corner >= 0) {
+                            patchTag._isExtraordinaryBasis = true;
+                            patchTag._boundaryIndex = corner;
+                            numEP++;
+                        } else {
+                            numGP++;
+                        }
                     }
                     break;
                 case Options::ENDCAP_BILINEAR_BASIS:
@@ -1008,6 +1549,22 @@ PatchTableFactory::identifyAdaptivePatches(AdaptiveContext & context) {
             }
         }
         levelPatchTags += level->getNumFaces();
+
+        context.patchInventory.R += numR;
+        context.patchInventory.G += numG;
+        context.patchInventory.GB += numGB;
+        context.patchInventory.GP += numGP;
+        context.patchInventory.EP += numEP;
+
+        if (context.baseFaceMask and refinement) {
+            int numChildFaces = refiner.getLevel(levelIndex+1).getNumFaces();
+            childFaceMask.resize(numChildFaces);
+            for (int childFace = 0; childFace < numChildFaces; ++childFace) {
+                childFaceMask[childFace] =
+                    levelFaceMask[refinement->getChildFaceParentFace(childFace)];
+            }
+            levelFaceMask.swap(childFaceMask);
+        }
     }
 }
 
@@ -1025,14 +1582,11 @@ PatchTableFactory::populateAdaptivePatches(
     PatchTable * table = context.table;
 
     //
-    //  Setup convenience pointers at the beginning of each patch array for each
-    // table (patches, ptex)
+    //  Setup convenience pointers at the beginning of each patch array, and
+    //  the index of the first patch of each array
     //
-    PatchCVPointers    iptrs;
-    PatchParamPointers pptrs;
-    PatchFVarOffsets   fofss;
-    PatchFVarPointers  fptrs;
-    SharpnessIndexPointers sptrs;
+    PatchCVPointers iptrs;
+    PatchIndices    pbase;
 
     ConstPatchDescriptorArray const & descs =
         PatchDescriptor::GetAdaptivePatchDescriptors(Sdc::SCHEME_CATMARK);
@@ -1048,31 +1602,73 @@ PatchTableFactory::populateAdaptivePatches(
         }
 
         iptrs.getValue(desc) = table->getPatchArrayVertices(arrayIndex).begin();
-        pptrs.getValue(desc) = table->getPatchParams(arrayIndex).begin();
-        if (context.options.useSingleCreasePatch) {
-            sptrs.getValue(desc) = table->getSharpnessIndices(arrayIndex);
-        }
+        pbase.getValue(desc) = table->getPatchIndex(arrayIndex, 0);
+    }
+    assert(not context.RequiresFVarPatches() or
+        context.fvarChannelCursor.size() == table->GetNumFVarChannels());
 
-        if (context.RequiresFVarPatches()) {
+    //
+    //  Assign the index of the patch of each face in a first (serial) pass :
+    //  patches are stored in face order within each array, so that the
+    //  patches of regular faces can then be gathered concurrently into their
+    //  own slots.
+    //
+    int numLevels = refiner.GetNumLevels();
 
-            Index & offsets = fofss.getValue(desc);
-            offsets = table->getPatchIndex(arrayIndex, 0);
+    std::vector<Index> patchIndices(context.patchTags.size(), Vtr::INDEX_INVALID);
+    {
+        PatchIndices pidx = pbase;
 
-            // XXXX manuelk this stuff will go away as we use offsets from FVarPatchChannel
-            FVarChannelCursor & fvc = context.fvarChannelCursor;
-            assert(fvc.size() == table->GetNumFVarChannels());
+        int levelFaceOffset = 0;
+        for (int i = 0; i < numLevels; ++i) {
+            Vtr::internal::Level const * level = &refiner.getLevel(i);
 
-            Index ** fptr = (Index **)alloca(fvc.size()*sizeof(Index *));
-            for (fvc=fvc.begin(); fvc!=fvc.end(); ++fvc) {
+            const PatchFaceTag * levelPatchTags = &context.patchTags[levelFaceOffset];
+            Index * levelPatchIndices = &patchIndices[levelFaceOffset];
 
-                Index pidx = table->getPatchIndex(arrayIndex, 0);
-                int ofs = pidx * 4;
-                fptr[fvc.pos()] = &table->getFVarValues(fvc.pos())[ofs];
+            for (int faceIndex = 0; faceIndex < level->getNumFaces(); ++faceIndex) {
+
+                const PatchFaceTag& patchTag = levelPatchTags[faceIndex];
+                if (level->isFaceHole(faceIndex) or (not patchTag._hasPatch)) {
+                    continue;
+                }
+
+                if (patchTag._isRegular) {
+                    levelPatchIndices[faceIndex] = pidx.R++;
+                    continue;
+                }
+                switch(context.options.GetEndCapType()) {
+                case Options::ENDCAP_GREGORY_BASIS:
+                    levelPatchIndices[faceIndex] = pidx.GP++;
+                    break;
+                case Options::ENDCAP_BSPLINE_BASIS:
+                    levelPatchIndices[faceIndex] = pidx.R++;
+                    break;
+                case Options::ENDCAP_LEGACY_GREGORY:
+                    levelPatchIndices[faceIndex] = (patchTag._boundaryCount == 0) ?
+                        pidx.G++ : pidx.GB++;
+                    break;
+                case Options::ENDCAP_EXTRAORDINARY_BASIS:
+                    levelPatchIndices[faceIndex] = patchTag._isExtraordinaryBasis ?
+                        pidx.EP++ : pidx.GP++;
+                    break;
+                default:
+                    // no endcap
+                    break;
+                }
             }
-            fptrs.getValue(desc) = fptr;
+            levelFaceOffset += level->getNumFaces();
         }
     }
 
+    // only single-crease patches have a sharpness : the sharpness of each
+    // patch is gathered first and indexed in face order afterwards, so that
+    // the table of sharpness values does not depend on the threading
+    std::vector<float> patchSharpness;
+    if (context.options.useSingleCreasePatch) {
+        patchSharpness.resize(table->GetNumPatchesTotal(), 0.0f);
+    }
+
     //
     //  Now iterate through the faces for all levels and populate the patches:
     //
@@ -1090,12 +1686,18 @@ PatchTableFactory::populateAdaptivePatches(
     EndCapBSplineBasisPatchFactory *endCapBSpline = NULL;
     EndCapGregoryBasisPatchFactory *endCapGregoryBasis = NULL;
     EndCapLegacyGregoryPatchFactory *endCapLegacyGregory = NULL;
+    EndCapExtraordinaryBasisPatchFactory *endCapExtraordinaryBasis = NULL;
 
     switch(context.options.GetEndCapType()) {
     case Options::ENDCAP_GREGORY_BASIS:
         endCapGregoryBasis = new EndCapGregoryBasisPatchFactory(
             refiner, context.options.shareEndCapPatchPoints);
         break;
+    case Options::ENDCAP_EXTRAORDINARY_BASIS:
+        endCapExtraordinaryBasis = new EndCapExtraordinaryBasisPatchFactory();
+        endCapGregoryBasis = new EndCapGregoryBasisPatchFactory(
+            refiner, context.options.shareEndCapPatchPoints);
+        break;
     case Options::ENDCAP_BSPLINE_BASIS:
         endCapBSpline = new EndCapBSplineBasisPatchFactory(refiner);
         break;
@@ -1106,148 +1708,165 @@ PatchTableFactory::populateAdaptivePatches(
         break;
     }
 
-    for (int i = 0; i < refiner.GetNumLevels(); ++i) {
+    for (int i = 0; i < numLevels; ++i) {
         Vtr::internal::Level const * level = &refiner.getLevel(i);
 
         const PatchFaceTag * levelPatchTags = &context.patchTags[levelFaceOffset];
+        Index const * levelPatchIndices = &patchIndices[levelFaceOffset];
 
-        for (int faceIndex = 0; faceIndex < level->getNumFaces(); ++faceIndex) {
+        int numFaces = level->getNumFaces();
 
-            if (level->isFaceHole(faceIndex)) {
+        //
+        //  Regular patches only depend on the topology of the level : they
+        //  are gathered concurrently into the slots assigned above.
+        //
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp parallel for schedule(static) if (numFaces > PARALLEL_FACE_THRESHOLD)
+#endif
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
+
+            Index patchIndex = levelPatchIndices[faceIndex];
+            if (patchIndex==Vtr::INDEX_INVALID) {
                 continue;
             }
 
             const PatchFaceTag& patchTag = levelPatchTags[faceIndex];
-            if (not patchTag._hasPatch) {
+            if (not patchTag._isRegular) {
                 continue;
             }
 
-            if (patchTag._isRegular) {
-                Index patchVerts[16];
+            Index patchVerts[16];
 
-                int bIndex = patchTag._boundaryIndex;
-                int boundaryMask = patchTag._boundaryMask;
-                int transitionMask = patchTag._transitionMask;
+            int bIndex = patchTag._boundaryIndex;
+            int boundaryMask = patchTag._boundaryMask;
+            int transitionMask = patchTag._transitionMask;
 
-                int const * permutation = 0;
-                // only single-crease patch has a sharpness.
-                float sharpness = 0;
+            int const * permutation = 0;
+            // only single-crease patch has a sharpness.
+            float sharpness = 0;
 
-                if (patchTag._boundaryCount == 0) {
-                    static int const permuteRegular[16] = { 5, 6, 7, 8, 4, 0, 1, 9, 15, 3, 2, 10, 14, 13, 12, 11 };
-                    permutation = permuteRegular;
+            if (patchTag._boundaryCount == 0) {
+                static int const permuteRegular[16] = { 5, 6, 7, 8, 4, 0, 1, 9, 15, 3, 2, 10, 14, 13, 12, 11 };
+                permutation = permuteRegular;
 
-                    if (patchTag._isSingleCrease) {
-                        boundaryMask = (1<<bIndex);
-                        sharpness = level->getEdgeSharpness((level->getFaceEdges(faceIndex)[bIndex]));
-                        sharpness = std::min(sharpness, (float)(context.options.maxIsolationLevel-i));
-                    }
-
-                    level->gatherQuadRegularInteriorPatchPoints(faceIndex, patchVerts, 0 /* no rotation*/);
-                } else if (patchTag._boundaryCount == 1) {
-                    // Expand boundary patch vertices and rotate to restore correct orientation.
-                    static int const permuteBoundary[4][16] = {
-                        { -1, -1, -1, -1, 11, 3, 0, 4, 10, 2, 1, 5, 9, 8, 7, 6 },
-                        { 9, 10, 11, -1, 8, 2, 3, -1, 7, 1, 0, -1, 6, 5, 4, -1 },
-                        { 6, 7, 8, 9, 5, 1, 2, 10, 4, 0, 3, 11, -1, -1, -1, -1 },
-                        { -1, 4, 5, 6, -1, 0, 1, 7, -1, 3, 2, 8, -1, 11, 10, 9 } };
-                    permutation = permuteBoundary[bIndex];
-                    level->gatherQuadRegularBoundaryPatchPoints(faceIndex, patchVerts, bIndex);
-                } else if (patchTag._boundaryCount == 2) {
-                    // Expand corner patch vertices and rotate to restore correct orientation.
-                    static int const permuteCorner[4][16] = {
-                        { -1, -1, -1, -1, -1, 0, 1, 4, -1, 3, 2, 5, -1, 8, 7, 6 },
-                        { -1, -1, -1, -1, 8, 3, 0, -1, 7, 2, 1, -1, 6, 5, 4, -1 },
-                        { 6, 7, 8, -1, 5, 2, 3, -1, 4, 1, 0, -1, -1, -1, -1, -1 },
-                        { -1, 4, 5, 6, -1, 1, 2, 7, -1, 0, 3, 8, -1, -1, -1, -1 } };
-                    permutation = permuteCorner[bIndex];
-                    level->gatherQuadRegularCornerPatchPoints(faceIndex, patchVerts, bIndex);
-                } else {
-                    assert(patchTag._boundaryCount >=0 && patchTag._boundaryCount <= 2);
+                if (patchTag._isSingleCrease) {
+                    boundaryMask = (1<<bIndex);
+                    sharpness = level->getEdgeSharpness((level->getFaceEdges(faceIndex)[bIndex]));
+                    sharpness = std::min(sharpness, (float)(context.options.maxIsolationLevel-i));
                 }
 
-                offsetAndPermuteIndices(patchVerts, 16, levelVertOffset, permutation, iptrs.R);
+                level->gatherQuadRegularInteriorPatchPoints(faceIndex, patchVerts, 0 /* no rotation*/);
+            } else if (patchTag._boundaryCount == 1) {
+                // Expand boundary patch vertices and rotate to restore correct orientation.
+                static int const permuteBoundary[4][16] = {
+                    { -1, -1, -1, -1, 11, 3, 0, 4, 10, 2, 1, 5, 9, 8, 7, 6 },
+                    { 9, 10, 11, -1, 8, 2, 3, -1, 7, 1, 0, -1, 6, 5, 4, -1 },
+                    { 6, 7, 8, 9, 5, 1, 2, 10, 4, 0, 3, 11, -1, -1, -1, -1 },
+                    { -1, 4, 5, 6, -1, 0, 1, 7, -1, 3, 2, 8, -1, 11, 10, 9 } };
+                permutation = permuteBoundary[bIndex];
+                level->gatherQuadRegularBoundaryPatchPoints(faceIndex, patchVerts, bIndex);
+            } else if (patchTag._boundaryCount == 2) {
+                // Expand corner patch vertices and rotate to restore correct orientation.
+                static int const permuteCorner[4][16] = {
+                    { -1, -1, -1, -1, -1, 0, 1, 4, -1, 3, 2, 5, -1, 8, 7, 6 },
+                    { -1, -1, -1, -1, 8, 3, 0, -1, 7, 2, 1, -1, 6, 5, 4, -1 },
+                    { 6, 7, 8, -1, 5, 2, 3, -1, 4, 1, 0, -1, -1, -1, -1, -1 },
+                    { -1, 4, 5, 6, -1, 1, 2, 7, -1, 0, 3, 8, -1, -1, -1, -1 } };
+                permutation = permuteCorner[bIndex];
+                level->gatherQuadRegularCornerPatchPoints(faceIndex, patchVerts, bIndex);
+            } else {
+                assert(patchTag._boundaryCount >=0 && patchTag._boundaryCount <= 2);
+            }
 
-                iptrs.R += 16;
-                pptrs.R = computePatchParam(refiner, ptexIndices, i, faceIndex, boundaryMask, transitionMask, pptrs.R);
-                // XXX: sharpness will be integrated into patch param soon.
-                if (sptrs.R) *sptrs.R++ = assignSharpnessIndex(sharpness, table->_sharpnessValues);
+            offsetAndPermuteIndices(patchVerts, 16, levelVertOffset, permutation,
+                iptrs.R + (patchIndex - pbase.R) * 16);
 
-                fofss.R += gatherFVarData(context,
-                                          i, faceIndex, levelFaceOffset, /*rotation*/0, levelFVarVertOffsets, fofss.R, fptrs.R);
-            } else {
-                // emit end patch. end patch should be in the max level (until we implement DFAS)
-                assert(i==refiner.GetMaxLevel());
+            computePatchParam(refiner, ptexIndices, i, faceIndex, boundaryMask,
+                transitionMask, &table->_paramTable[patchIndex]);
+            // XXX: sharpness will be integrated into patch param soon.
+            if (not patchSharpness.empty()) {
+                patchSharpness[patchIndex] = sharpness;
+            }
 
-                // switch endcap patchtype by option
-                switch(context.options.GetEndCapType()) {
-                case Options::ENDCAP_GREGORY_BASIS:
-                {
-                    // note: this call will be moved into vtr::level.
-                    ConstIndexArray cvs = endCapGregoryBasis->GetPatchPoints(
-                        level, faceIndex, levelPatchTags, levelVertOffset);
+            gatherFVarData(context,
+                           i, faceIndex, /*rotation*/0, levelFVarVertOffsets, patchIndex);
+        }
 
-                    for (int j = 0; j < cvs.size(); ++j) iptrs.GP[j] = cvs[j];
-                    iptrs.GP += cvs.size();
-                    pptrs.GP = computePatchParam(
-                        refiner, ptexIndices, i, faceIndex, /*boundary*/0, /*transition*/0, pptrs.GP);
-                    if (sptrs.R) *sptrs.R++ = assignSharpnessIndex(0, table->_sharpnessValues);
-                    fofss.GP += gatherFVarData(context,
-                                               i, faceIndex, levelFaceOffset,
-                                               0, levelFVarVertOffsets, fofss.GP, fptrs.GP);
-                    break;
-                }
-                case Options::ENDCAP_BSPLINE_BASIS:
-                {
-                    ConstIndexArray cvs = endCapBSpline->GetPatchPoints(
-                        level, faceIndex, levelPatchTags, levelVertOffset);
+        //
+        //  End-cap factories share patch points between adjacent patches :
+        //  end patches are gathered serially, in face order.
+        //
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
 
-                    for (int j = 0; j < cvs.size(); ++j) iptrs.R[j] = cvs[j];
-                    iptrs.R += cvs.size();
-                    pptrs.R = computePatchParam(
-                        refiner, ptexIndices, i, faceIndex, /*boundary*/0, /*transition*/0, pptrs.R);
-                    if (sptrs.R) *sptrs.R++ = assignSharpnessIndex(0, table->_sharpnessValues);
-                    fofss.R += gatherFVarData(context,
-                                              i, faceIndex, levelFaceOffset,
-                                              0, levelFVarVertOffsets, fofss.R, fptrs.R);
-                    break;
-                }
-                case Options::ENDCAP_LEGACY_GREGORY:
-                {
-                    ConstIndexArray cvs = endCapLegacyGregory->GetPatchPoints(
-                        level, faceIndex, levelPatchTags, levelVertOffset);
+            Index patchIndex = levelPatchIndices[faceIndex];
+            if (patchIndex==Vtr::INDEX_INVALID) {
+                continue;
+            }
 
-                    if (patchTag._boundaryCount == 0) {
-                        for (int j = 0; j < cvs.size(); ++j) iptrs.G[j] = cvs[j];
-                        iptrs.G += cvs.size();
-                        pptrs.G = computePatchParam(
-                            refiner, ptexIndices, i, faceIndex, /*boundary*/0, /*transition*/0, pptrs.G);
-                        if (sptrs.R) *sptrs.R++ = assignSharpnessIndex(0, table->_sharpnessValues);
-                        fofss.G += gatherFVarData(context,
-                                                  i, faceIndex, levelFaceOffset,
-                                                  0, levelFVarVertOffsets, fofss.G, fptrs.G);
-                    } else {
-                        for (int j = 0; j < cvs.size(); ++j) iptrs.GB[j] = cvs[j];
-                        iptrs.GB += cvs.size();
-                        pptrs.GB = computePatchParam(
-                            refiner, ptexIndices, i, faceIndex, /*boundary*/0, /*transition*/0, pptrs.GB);
-                        if (sptrs.R) *sptrs.R++ = assignSharpnessIndex(0, table->_sharpnessValues);
-                        fofss.GB += gatherFVarData(context,
-                                                   i, faceIndex, levelFaceOffset,
-                                                   0, levelFVarVertOffsets, fofss.GB, fptrs.GB);
-                    }
-                    break;
-                }
-                case Options::ENDCAP_BILINEAR_BASIS:
-                    // not implemented yet
-                    assert(false);
-                    break;
-                default:
-                    // no endcap
-                    break;
+            const PatchFaceTag& patchTag = levelPatchTags[faceIndex];
+            if (patchTag._isRegular) {
+                continue;
+            }
+
+            // emit end patch. end patch should be in the max level (until we implement DFAS)
+            assert(i==refiner.GetMaxLevel());
+
+            // switch endcap patchtype by option
+            ConstIndexArray cvs;
+            Index * dstCVs = 0;
+            int boundaryMask = 0;
+            switch(context.options.GetEndCapType()) {
+            case Options::ENDCAP_GREGORY_BASIS:
+                // note: this call will be moved into vtr::level.
+                cvs = endCapGregoryBasis->GetPatchPoints(
+                    level, faceIndex, levelPatchTags, levelVertOffset);
+                dstCVs = iptrs.GP + (patchIndex - pbase.GP) * cvs.size();
+                break;
+            case Options::ENDCAP_BSPLINE_BASIS:
+                cvs = endCapBSpline->GetPatchPoints(
+                    level, faceIndex, levelPatchTags, levelVertOffset);
+                dstCVs = iptrs.R + (patchIndex - pbase.R) * cvs.size();
+                break;
+            case Options::ENDCAP_LEGACY_GREGORY:
+                cvs = endCapLegacyGregory->GetPatchPoints(
+                    level, faceIndex, levelPatchTags, levelVertOffset);
+                dstCVs = (patchTag._boundaryCount == 0) ?
+                    iptrs.G + (patchIndex - pbase.G) * cvs.size() :
+                    iptrs.GB + (patchIndex - pbase.GB) * cvs.size();
+                break;
+            case Options::ENDCAP_EXTRAORDINARY_BASIS:
+                if (patchTag._isExtraordinaryBasis) {
+                    // the boundary bits hold the corner of the extraordinary
+                    // vertex (these patches are interior)
+                    cvs = endCapExtraordinaryBasis->GetPatchPoints(
+                        level, faceIndex, levelPatchTags, levelVertOffset);
+                    dstCVs = iptrs.EP + (patchIndex - pbase.EP) * cvs.size();
+                    boundaryMask = patchTag._boundaryIndex;
+                } else {
+                    cvs = endCapGregoryBasis->GetPatchPoints(
+                        level, faceIndex, levelPatchTags, levelVertOffset);
+                    dstCVs = iptrs.GP + (patchIndex - pbase.GP) * cvs.size();
                 }
+                break;
+            case Options::ENDCAP_BILINEAR_BASIS:
+                // not implemented yet
+                assert(false);
+                break;
+            default:
+                // no endcap
+                break;
+            }
+            if (not dstCVs) {
+                continue;
             }
+
+            for (int j = 0; j < cvs.size(); ++j) dstCVs[j] = cvs[j];
+            computePatchParam(refiner, ptexIndices, i, faceIndex,
+                boundaryMask, /*transition*/0, &table->_paramTable[patchIndex]);
+            gatherFVarData(context,
+                           i, faceIndex, /*rotation*/0, levelFVarVertOffsets, patchIndex);
         }
+
         levelFaceOffset += level->getNumFaces();
         levelVertOffset += level->getNumVertices();
         if (context.RequiresFVarPatches()) {
@@ -1258,8 +1877,22 @@ PatchTableFactory::populateAdaptivePatches(
         }
     }
 
+    // index the sharpness of the patches (in face order)
+    if (not patchSharpness.empty()) {
+        for (int face = 0; face < (int)patchIndices.size(); ++face) {
+            Index patchIndex = patchIndices[face];
+            if (patchIndex!=Vtr::INDEX_INVALID) {
+                table->_sharpnessIndices[patchIndex] =
+                    assignSharpnessIndex(patchSharpness[patchIndex], table->_sharpnessValues);
+            }
+        }
+    }
+
     // finalize end patches
     switch(context.options.GetEndCapType()) {
+    case Options::ENDCAP_EXTRAORDINARY_BASIS:
+        delete endCapExtraordinaryBasis;
+        // fall through - the other end patches are Gregory basis patches
     case Options::ENDCAP_GREGORY_BASIS:
         table->_localPointStencils =
             endCapGregoryBasis->CreateVertexStencilTable();
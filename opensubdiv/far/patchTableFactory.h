@@ -66,6 +66,7 @@ public:
         unsigned int   _boundaryCount   : 3;
         unsigned int   _hasBoundaryEdge : 3;
         unsigned int   _isSingleCrease  : 1;
+        unsigned int   _isExtraordinaryBasis : 1;
 
         void clear();
         void assignBoundaryPropertiesFromEdgeMask(int boundaryEdgeMask);
@@ -83,7 +84,16 @@ public:
             ENDCAP_BILINEAR_BASIS,       ///< use bilinear quads (4 cp) as end-caps
             ENDCAP_BSPLINE_BASIS,        ///< use BSpline basis patches (16 cp) as end-caps
             ENDCAP_GREGORY_BASIS,        ///< use Gregory basis patches (20 cp) as end-caps
-            ENDCAP_LEGACY_GREGORY        ///< use legacy (2.x) Gregory patches (4 cp + valence table) as end-caps
+            ENDCAP_LEGACY_GREGORY,       ///< use legacy (2.x) Gregory patches (4 cp + valence table) as end-caps
+            ENDCAP_EXTRAORDINARY_BASIS   ///< use exact patches (20 cp) around isolated smooth interior
+                                         ///< extraordinary vertices of valence 3, 5 or 6 whose other
+                                         ///< corners are regular : other valences and configurations
+                                         ///< silently fall back to Gregory basis patches (20 cp).
+                                         ///< Only evaluated by PatchTable::EvaluateBasis() and the Osd
+                                         ///< CPU, OpenMP and TBB evaluators : the GPU patch tables,
+                                         ///< CpuPatchBVH, CpuPatchCuller and CpuTessellator reject
+                                         ///< tables with these patches (see
+                                         ///< PatchDescriptor::EXTRAORDINARY_BASIS)
         };
 
         Options(unsigned int maxIsolation=10) :
@@ -131,7 +141,77 @@ public:
     static PatchTable * Create(TopologyRefiner const & refiner,
                                Options options=Options());
 
+    /// \brief Regenerates the patches of a set of modified base faces in an
+    ///        existing adaptive PatchTable
+    ///
+    /// Local topology edits (split, collapse, extrude...) only affect the limit
+    /// surface of the modified faces and of their one-ring, and the transitions
+    /// of the patches of their two-ring. Instead of refining the whole mesh
+    /// again, the modified faces, their two-ring and a halo of neighboring
+    /// faces are extracted from the base level of \a refiner and isolated on
+    /// their own. The patches generated for the modified faces and their
+    /// two-ring then replace the previous patches of these faces in \a table
+    /// (patch arrays, patch params and sharpness).
+    ///
+    /// The new patches index a block of vertices starting at \a firstVertex
+    /// in the primvar buffer of the client. This block includes the refined
+    /// vertices and the end-cap local points of the region : the returned
+    /// stencil table computes all of them from the base vertices of \a refiner.
+    /// The previous vertices and local points of the table are left untouched.
+    ///
+    /// \note Base faces and vertices that are not modified are expected to
+    ///       retain their indices (new ones being appended), so that the
+    ///       patches of the rest of the mesh remain valid.
+    ///
+    /// \note Modified faces must keep their number of vertices : the patches
+    ///       remaining in the table keep their ptex face ids, so edits that
+    ///       would shift the ptex faces of the rest of the mesh (ex. a quad
+    ///       split into triangles) are rejected and NULL is returned.
+    ///
+    /// \note The first update of a table indexes its patches by ptex face,
+    ///       which costs a pass over the base mesh and the whole table. The
+    ///       following updates only check the modified faces and replace the
+    ///       patches of the region in place : the patch arrays only grow or
+    ///       shrink at their end, so their cost depends on the size of the
+    ///       edit rather than on the size of the mesh.
+    ///
+    /// \note The vertices of the replaced patches are not reclaimed : each
+    ///       update appends a new block of vertices to the primvar buffer,
+    ///       so the table and the buffer grow with repeated updates until
+    ///       the table is created again from the edited mesh.
+    ///
+    /// \note Face-varying patches and legacy Gregory end-caps are not
+    ///       supported.
+    ///
+    /// @param refiner         TopologyRefiner containing the edited base mesh
+    ///                        (only the base level is used)
+    ///
+    /// @param baseFaces       Indices of the modified base faces
+    ///
+    /// @param firstVertex     Index of the first vertex of the new block
+    ///
+    /// @param table           Adaptive PatchTable to update
+    ///
+    /// @param options         Options used to create the table (the isolation
+    ///                        level is set by maxIsolationLevel)
+    ///
+    /// @param varyingStencils Optional stencil table for varying interpolation
+    ///                        of the new block (returned)
+    ///
+    /// @return                Vertex stencils for the new block of vertices
+    ///                        (or NULL if the table could not be updated)
+    ///
+    static StencilTable const * UpdateAdaptive(TopologyRefiner const & refiner,
+                                               ConstIndexArray baseFaces,
+                                               Index firstVertex,
+                                               PatchTable * table,
+                                               Options options=Options(),
+                                               StencilTable const ** varyingStencils=0);
+
 private:
+
+    friend class ClusterTableFactory;
+
     //
     // Private helper structures
     //
@@ -144,7 +224,8 @@ private:
                                       Options options);
 
     static PatchTable * createAdaptive(TopologyRefiner const & refiner,
-                                       Options options);
+                                       Options options,
+                                       std::vector<unsigned char> const * baseFaceMask=0);
 
     //
     //  High-level methods for identifying and populating patches associated with faces:
@@ -165,9 +246,15 @@ private:
         int level, int face,
         int boundaryMask, int transitionMask, PatchParam * coord);
 
-    static int gatherFVarData(AdaptiveContext & state,
-        int level, Index faceIndex, Index levelFaceOffset, int rotation,
-                              Index const * levelOffsets, Index fofss, Index ** fptrs);
+    static bool indexPatchesByPtexFace(TopologyRefiner const & refiner,
+        ConstIndexArray baseFaces, PatchTable * table);
+
+    static void movePatch(PatchTable * table, int desc, Index arrayIndex,
+        int from, int to);
+
+    static void gatherFVarData(AdaptiveContext & state,
+        int level, Index faceIndex, int rotation,
+                               Index const * levelFVarVertOffsets, Index patchIndex);
 
 };
 
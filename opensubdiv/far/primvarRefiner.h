@@ -195,6 +195,8 @@ private:
     template <Sdc::SchemeType SCHEME, class T, class U> void interpFVarFromEdges(int, T const &, U &, int) const;
     template <Sdc::SchemeType SCHEME, class T, class U> void interpFVarFromVerts(int, T const &, U &, int) const;
 
+    template <class T, class U> void interpFVarLinear(int, T const &, U &, int) const;
+
     template <Sdc::SchemeType SCHEME, class T, class U, class U1, class U2>
     void limit(T const & src, U & pos, U1 * tan1, U2 * tan2) const;
 
@@ -287,6 +289,13 @@ PrimvarRefiner::InterpolateFaceVarying(int level, T const & src, U & dst, int ch
 
     assert(level>0 and level<=(int)_refiner._refinements.size());
 
+    //  Linearly interpolated channels are independent of the scheme and of any
+    //  sharpness -- bypass the masks and value tags entirely:
+    if (_refiner.getLevel(level-1).getFVarLevel(channel).isLinear()) {
+        interpFVarLinear(level, src, dst, channel);
+        return;
+    }
+
     switch (_refiner._subdivType) {
     case Sdc::SCHEME_CATMARK:
         interpFVarFromFaces<Sdc::SCHEME_CATMARK>(level, src, dst, channel);
@@ -992,6 +1001,89 @@ PrimvarRefiner::interpFVarFromVerts(int level, T const & src, U & dst, int chann
     }
 }
 
+template <class T, class U>
+inline void
+PrimvarRefiner::interpFVarLinear(int level, T const & src, U & dst, int channel) const {
+
+    Vtr::internal::Refinement const & refinement = _refiner.getRefinement(level-1);
+
+    Vtr::internal::Level const & parentLevel = refinement.parent();
+    Vtr::internal::Level const & childLevel  = refinement.child();
+
+    Vtr::internal::FVarRefinement const & refineFVar = refinement.getFVarRefinement(channel);
+    Vtr::internal::FVarLevel const &      parentFVar = parentLevel.getFVarLevel(channel);
+    Vtr::internal::FVarLevel const &      childFVar  = childLevel.getFVarLevel(channel);
+
+    //
+    //  Values from faces -- the face-vertex mask is a simple average for all schemes,
+    //  and there is only ever a single child value:
+    //
+    if (refinement.getNumChildVerticesFromFaces() > 0) {
+        for (int face = 0; face < parentLevel.getNumFaces(); ++face) {
+
+            Vtr::Index cVert = refinement.getFaceChildVertex(face);
+            if (!Vtr::IndexIsValid(cVert))
+                continue;
+
+            Vtr::Index cVertValue = childFVar.getVertexValueOffset(cVert);
+
+            ConstIndexArray fValues = parentFVar.getFaceValues(face);
+
+            float fValueWeight = 1.0f / (float) fValues.size();
+
+            dst[cVertValue].Clear();
+            for (int i = 0; i < fValues.size(); ++i) {
+                dst[cVertValue].AddWithWeight(src[fValues[i]], fValueWeight);
+            }
+        }
+    }
+
+    //
+    //  Values from edges -- every sibling (a single one when the edge is continuous)
+    //  is the midpoint of the pair of values of its source face:
+    //
+    for (int edge = 0; edge < parentLevel.getNumEdges(); ++edge) {
+
+        Vtr::Index cVert = refinement.getEdgeChildVertex(edge);
+        if (!Vtr::IndexIsValid(cVert))
+            continue;
+
+        ConstIndexArray cVertValues = childFVar.getVertexValues(cVert);
+
+        for (int i = 0; i < cVertValues.size(); ++i) {
+            Vtr::Index eVertValues[2];
+            parentFVar.getEdgeFaceValues(edge, refineFVar.getChildValueParentSource(cVert, i), eVertValues);
+
+            Index cVertValue = cVertValues[i];
+
+            dst[cVertValue].Clear();
+            dst[cVertValue].AddWithWeight(src[eVertValues[0]], 0.5f);
+            dst[cVertValue].AddWithWeight(src[eVertValues[1]], 0.5f);
+        }
+    }
+
+    //
+    //  Values from vertices -- all values are corners, so every sibling is a copy of
+    //  its parent value:
+    //
+    for (int vert = 0; vert < parentLevel.getNumVertices(); ++vert) {
+
+        Vtr::Index cVert = refinement.getVertexChildVertex(vert);
+        if (!Vtr::IndexIsValid(cVert))
+            continue;
+
+        ConstIndexArray pVertValues = parentFVar.getVertexValues(vert),
+                        cVertValues = childFVar.getVertexValues(cVert);
+
+        for (int i = 0; i < cVertValues.size(); ++i) {
+            Index cVertValue = cVertValues[i];
+
+            dst[cVertValue].Clear();
+            dst[cVertValue].AddWithWeight(src[pVertValues[refineFVar.getChildValueParentSource(cVert, i)]], 1.0f);
+        }
+    }
+}
+
 template <Sdc::SchemeType SCHEME, class T, class U, class U1, class U2>
 inline void
 PrimvarRefiner::limit(T const & src, U & dstPos, U1 * dstTan1Ptr, U2 * dstTan2Ptr) const {
@@ -26,6 +26,7 @@
 #include "../far/error.h"
 #include "../vtr/level.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace OpenSubdiv {
@@ -74,6 +75,20 @@ PtexIndices::GetFaceId(Index f) const {
     return _ptexIndices[f];
 }
 
+Index
+PtexIndices::GetCoarseFaceId(int ptexFace, int * quadrant) const {
+    if (ptexFace<0 or ptexFace>=GetNumFaces()) {
+        return -1;
+    }
+    // the ptex faces of a coarse face are consecutive
+    Index f = (Index)(std::upper_bound(_ptexIndices.begin(),
+        _ptexIndices.end(), ptexFace) - _ptexIndices.begin()) - 1;
+    if (quadrant) {
+        *quadrant = ptexFace - _ptexIndices[f];
+    }
+    return f;
+}
+
 namespace {
     // Returns the face adjacent to 'face' along edge 'edge'
     inline Index
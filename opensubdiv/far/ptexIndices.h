@@ -66,6 +66,15 @@ public:
     ///
     int GetFaceId(Index f) const;
 
+    /// \brief Returns the coarse face of a ptex face 'ptexFace' or -1
+    ///
+    /// @param ptexFace  ptex face index
+    ///
+    /// @param quadrant  local ptex sub-face index of 'ptexFace' if the coarse
+    ///                  face is not a quad, 0 otherwise (optional, returned)
+    ///
+    Index GetCoarseFaceId(int ptexFace, int * quadrant=0) const;
+
     /// \brief Returns ptex face adjacency information for a given coarse face
     ///
     /// @param refiner   refiner used to build this PtexIndices object.
@@ -100,7 +100,7 @@ public:
             _weights[i] = 1.0;
         }
 
-        _size = static_cast<int>(_sources.size());
+        _size = _sources.size();
         _lastOffset = _size - 1;
     }
 
@@ -125,9 +125,9 @@ public:
         //
         // Find the src stencil and number of contributing CVs.
         int len = _sizes[src];
-        int start = _indices[src];
+        size_t start = _indices[src];
 
-        for (int i = start; i < start+len; i++) {
+        for (size_t i = start; i < start+len; i++) {
             // Invariant: by processing each level in order and each vertex in
             // dependent order, any src stencil vertex reference is guaranteed
             // to consist only of coarse verts: therefore resolving src verts
@@ -184,7 +184,7 @@ public:
         return ScalarAccumulator(this);
     };
 
-    std::vector<int> const&
+    std::vector<size_t> const&
     GetOffsets() const { return _indices; }
 
     std::vector<int> const& 
@@ -215,7 +215,7 @@ private:
                W weightFactor, 
                // Similarly, passing offset & tableSize as params yields higher
                // performance than accessing the class members directly.
-               int lastOffset, int tableSize, WACCUM weights) 
+               size_t lastOffset, size_t tableSize, WACCUM weights) 
     {
         // The lastOffset is the vertex we're currently processing, by
         // leveraging this we need not lookup the dest stencil size or offset.
@@ -226,7 +226,7 @@ private:
 
             // tableSize is exactly _sources.size(), but using tableSize is
             // significantly faster.
-            for (int i = lastOffset; i < tableSize; i++) {
+            for (size_t i = lastOffset; i < tableSize; i++) {
 
                 // If we find an existing vertex that matches src, we need to
                 // combine the weights to avoid duplicate entries for src.
@@ -260,11 +260,11 @@ private:
                 _sizes.resize(dst+1);
             }
             // Initialize the new stencil's meta-data (offset, size).
-            _indices[dst] = static_cast<int>(_sources.size());
+            _indices[dst] = _sources.size();
             _sizes[dst] = 0;
             // Keep track of where the current stencil begins, which lets us
             // avoid having to look it up later.
-            _lastOffset = static_cast<int>(_sources.size());
+            _lastOffset = _sources.size();
         }
         // Cache the number of elements as an optimization, it's faster than
         // calling size() on any of the vectors.
@@ -292,13 +292,14 @@ private:
     std::vector<float> _duWeights;
     std::vector<float> _dvWeights;
 
-    // Index data used to recover stencil-to-vertex mapping.
-    std::vector<int> _indices;
+    // Index data used to recover stencil-to-vertex mapping (the offsets are
+    // 64-bit : the weights of all the levels can exceed the range of int).
+    std::vector<size_t> _indices;
     std::vector<int> _sizes;
 
     // Acceleration members to avoid pointer chasing and reverse loops.
-    int _size;
-    int _lastOffset;
+    size_t _size;
+    size_t _lastOffset;
     int _coarseVertCount;
     bool _compactWeights;
 };
@@ -333,7 +334,7 @@ StencilBuilder::GetNumVertsInStencil(size_t stencilIndex) const
     return (int)_weightTable->GetSizes()[stencilIndex];
 }
 
-std::vector<int> const&
+std::vector<size_t> const&
 StencilBuilder::GetStencilOffsets() const { 
     return _weightTable->GetOffsets();
 }
@@ -52,7 +52,7 @@ public:
     int GetNumVertsInStencil(size_t stencilIndex) const;
 
     // Mapping from stencil[i] to it's starting offset in the sources[] and weights[] arrays;
-    std::vector<int> const& GetStencilOffsets() const;
+    std::vector<size_t> const& GetStencilOffsets() const;
 
     // The number of contributing sources and weights in stencil[i]
     std::vector<int> const& GetStencilSizes() const;
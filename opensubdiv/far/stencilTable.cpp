@@ -36,8 +36,7 @@ namespace {
     copyStencilData(int numControlVerts,
                     bool includeCoarseVerts,
                     size_t firstOffset,
-                    std::vector<int> const*    offsets,
-                    std::vector<int> *        _offsets,
+                    std::vector<size_t> const* offsets,
                     std::vector<int> const*    sizes,
                     std::vector<int> *        _sizes,
                     std::vector<int> const*    sources,
@@ -50,7 +49,6 @@ namespace {
                     std::vector<float> *      _dvWeights=NULL) {
         size_t start = includeCoarseVerts ? 0 : firstOffset;
 
-        _offsets->resize(offsets->size());
         _sizes->resize(sizes->size());
         _sources->resize(sources->size());
         _weights->resize(weights->size());
@@ -61,7 +59,7 @@ namespace {
 
         // The stencils are probably not in order, so we must copy/sort them.
         // Note here that loop index 'i' represents stencil_i for vertex_i.
-        int curOffset = 0;
+        size_t curOffset = 0;
 
         size_t stencilCount = 0,
                weightCount = 0;
@@ -74,9 +72,8 @@ namespace {
 
             // Copy the stencil.
             int sz = (*sizes)[i];
-            int off = (*offsets)[i];
+            size_t off = (*offsets)[i];
 
-            (*_offsets)[stencilCount] = curOffset;
             (*_sizes)[stencilCount] = sz;
 
             std::memcpy(&(*_sources)[curOffset],
@@ -98,7 +95,6 @@ namespace {
             weightCount += sz;
         }
 
-        _offsets->resize(stencilCount);
         _sizes->resize(stencilCount);
         _sources->resize(weightCount);
 
@@ -110,7 +106,7 @@ namespace {
 };
 
 StencilTable::StencilTable(int numControlVerts,
-                           std::vector<int> const& offsets,
+                           std::vector<size_t> const& offsets,
                            std::vector<int> const& sizes,
                            std::vector<int> const& sources,
                            std::vector<float> const& weights,
@@ -120,10 +116,11 @@ StencilTable::StencilTable(int numControlVerts,
     copyStencilData(numControlVerts,
                     includeCoarseVerts,
                     firstOffset,
-                    &offsets, &_offsets,
+                    &offsets,
                     &sizes, &_sizes,
                     &sources, &_indices,
                     &weights, &_weights);
+    generateOffsets();
 }
 
 void
@@ -131,12 +128,13 @@ StencilTable::Clear() {
     _numControlVertices=0;
     _sizes.clear();
     _offsets.clear();
+    _largeOffsets.clear();
     _indices.clear();
     _weights.clear();
 }
 
 LimitStencilTable::LimitStencilTable(int numControlVerts,
-                                     std::vector<int> const& offsets,
+                                     std::vector<size_t> const& offsets,
                                      std::vector<int> const& sizes,
                                      std::vector<int> const& sources,
                                      std::vector<float> const& weights,
@@ -148,12 +146,13 @@ LimitStencilTable::LimitStencilTable(int numControlVerts,
     copyStencilData(numControlVerts,
                     includeCoarseVerts,
                     firstOffset,
-                    &offsets, &_offsets,
+                    &offsets,
                     &sizes, &_sizes,
                     &sources, &_indices,
                     &weights, &_weights,
                     &duWeights, &_duWeights,
                     &dvWeights, &_dvWeights);
+    generateOffsets();
 }
 
 void
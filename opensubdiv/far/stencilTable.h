@@ -31,6 +31,7 @@
 
 #include <cassert>
 #include <cstring>
+#include <limits>
 #include <vector>
 #include <iostream>
 
@@ -124,7 +125,7 @@ protected:
 ///
 class StencilTable {
     StencilTable(int numControlVerts,
-                    std::vector<int> const& offsets,
+                    std::vector<size_t> const& offsets,
                     std::vector<int> const& sizes,
                     std::vector<int> const& sources,
                     std::vector<float> const& weights,
@@ -152,10 +153,28 @@ public:
     }
 
     /// \brief Returns the offset to a given stencil (factory may leave empty)
+    ///
+    /// \note Empty for tables with large offsets (see HasLargeOffsets)
+    ///
     std::vector<Index> const & GetOffsets() const {
         return _offsets;
     }
 
+    /// \brief Returns true if the stencils are located with 64-bit offsets
+    ///
+    /// Tables with more weights than the range of Index (2^31) store their
+    /// offsets in GetLargeOffsets() instead of GetOffsets(). Smaller tables
+    /// keep their 32-bit offsets and do not pay for the wider ones.
+    ///
+    bool HasLargeOffsets() const {
+        return not _largeOffsets.empty();
+    }
+
+    /// \brief Returns the 64-bit offset to a given stencil (large tables only)
+    std::vector<size_t> const & GetLargeOffsets() const {
+        return _largeOffsets;
+    }
+
     /// \brief Returns the indices of the control vertices
     std::vector<Index> const & GetControlIndices() const {
         return _indices;
@@ -200,8 +219,13 @@ protected:
     // Populate the offsets table from the stencil sizes in _sizes (factory helper)
     void generateOffsets();
 
+    // Returns the offset to stencil i, from either offsets table
+    size_t getOffset(Index i) const {
+        return _largeOffsets.empty() ? (size_t)_offsets[i] : _largeOffsets[i];
+    }
+
     // Resize the table arrays (factory helper)
-    void resize(int nstencils, int nelems);
+    void resize(int nstencils, size_t nelems);
 
 protected:
     StencilTable() : _numControlVertices(0) {}
@@ -210,6 +234,10 @@ protected:
     { }
 
     friend class StencilTableFactory;
+    friend class PatchTableFactory;
+    friend class BezierPatchTable;
+    friend class ClusterTable;
+    friend class ClusterTableFactory;
     // XXX: temporarily, GregoryBasis class will go away.
     friend class GregoryBasis;
 
@@ -219,6 +247,9 @@ protected:
     std::vector<Index>         _offsets,  // offset to the start of each stencil
                                _indices;  // indices of contributing coarse vertices
     std::vector<float>         _weights;  // stencil weight coefficients
+
+    std::vector<size_t> _largeOffsets; // offsets of tables of more than 2^31
+                                       // weights (replaces _offsets)
 };
 
 
@@ -284,7 +315,7 @@ private:
 ///
 class LimitStencilTable : public StencilTable {
     LimitStencilTable(int numControlVerts,
-                    std::vector<int> const& offsets,
+                    std::vector<size_t> const& offsets,
                     std::vector<int> const& sizes,
                     std::vector<int> const& sources,
                     std::vector<float> const& weights,
@@ -337,7 +368,7 @@ private:
     friend class LimitStencilTableFactory;
 
     // Resize the table arrays (factory helper)
-    void resize(int nstencils, int nelems);
+    void resize(int nstencils, size_t nelems);
 
 private:
     std::vector<float>  _duWeights,  // u derivative limit stencil weights
@@ -355,10 +386,11 @@ StencilTable::update(T const *controlValues, T *values,
     float const * weights = &valueWeights.at(0);
 
     if (start>0) {
-        assert(start<(Index)_offsets.size());
+        assert(start<GetNumStencils());
+        size_t offset = getOffset(start);
         sizes += start;
-        indices += _offsets[start];
-        weights += _offsets[start];
+        indices += offset;
+        weights += offset;
         values += start;
     }
 
@@ -381,17 +413,35 @@ StencilTable::update(T const *controlValues, T *values,
 
 inline void
 StencilTable::generateOffsets() {
-    Index offset=0;
     int noffsets = (int)_sizes.size();
-    _offsets.resize(noffsets);
-    for (int i=0; i<(int)_sizes.size(); ++i ) {
-        _offsets[i]=offset;
-        offset+=_sizes[i];
+
+    // 64-bit offsets are only used if the weights overflow 32-bit ones
+    size_t numWeights = 0;
+    for (int i=0; i<noffsets; ++i) {
+        numWeights += _sizes[i];
+    }
+
+    if (numWeights > (size_t)std::numeric_limits<Index>::max()) {
+        std::vector<Index>().swap(_offsets);
+        _largeOffsets.resize(noffsets);
+        size_t offset=0;
+        for (int i=0; i<noffsets; ++i) {
+            _largeOffsets[i]=offset;
+            offset+=_sizes[i];
+        }
+    } else {
+        std::vector<size_t>().swap(_largeOffsets);
+        _offsets.resize(noffsets);
+        Index offset=0;
+        for (int i=0; i<noffsets; ++i) {
+            _offsets[i]=offset;
+            offset+=_sizes[i];
+        }
     }
 }
 
 inline void
-StencilTable::resize(int nstencils, int nelems) {
+StencilTable::resize(int nstencils, size_t nelems) {
     _sizes.resize(nstencils);
     _indices.resize(nelems);
     _weights.resize(nelems);
@@ -400,9 +450,10 @@ StencilTable::resize(int nstencils, int nelems) {
 // Returns a Stencil at index i in the table
 inline Stencil
 StencilTable::GetStencil(Index i) const {
-    assert((not _offsets.empty()) and i<(int)_offsets.size());
+    assert((not (_offsets.empty() and _largeOffsets.empty())) and
+        i<GetNumStencils());
 
-    Index ofs = _offsets[i];
+    size_t ofs = getOffset(i);
 
     return Stencil( const_cast<int*>(&_sizes[i]),
                     const_cast<Index *>(&_indices[ofs]),
@@ -415,7 +466,7 @@ StencilTable::operator[] (Index index) const {
 }
 
 inline void
-LimitStencilTable::resize(int nstencils, int nelems) {
+LimitStencilTable::resize(int nstencils, size_t nelems) {
     StencilTable::resize(nstencils, nelems);
     _duWeights.resize(nelems);
     _dvWeights.resize(nelems);
@@ -63,46 +63,67 @@ StencilTableFactory::Create(TopologyRefiner const & refiner,
     Options options) {
 
     int maxlevel = std::min(int(options.maxLevel), refiner.GetMaxLevel());
+
+    bool interpolateVarying = options.interpolationMode==INTERPOLATE_VARYING,
+         interpolateFaceVarying =
+             options.interpolationMode==INTERPOLATE_FACE_VARYING;
+
+    int fvarChannel = options.fvarChannel;
+    if (interpolateFaceVarying and
+        fvarChannel>=refiner.GetNumFVarChannels()) {
+        return 0;
+    }
+
+    // The control vertices of face-varying stencils are the values of the
+    // face-varying channel on the base level
+    int numControlVertices = interpolateFaceVarying ?
+        refiner.GetLevel(0).GetNumFVarValues(fvarChannel) :
+        refiner.GetLevel(0).GetNumVertices();
+
     if (maxlevel==0 and (not options.generateControlVerts)) {
         StencilTable * result = new StencilTable;
-        result->_numControlVertices = refiner.GetLevel(0).GetNumVertices();
+        result->_numControlVertices = numControlVertices;
         return result;
     }
 
-    bool interpolateVarying = options.interpolationMode==INTERPOLATE_VARYING;
-    internal::StencilBuilder builder(refiner.GetLevel(0).GetNumVertices(),
+    internal::StencilBuilder builder(numControlVertices,
                                 /*genControlVerts*/ true,
                                 /*compactWeights*/  true);
 
     //
     // Interpolate stencils for each refinement level using
-    // PrimvarRefiner::InterpolateLevel<>() for vertex or varying
+    // PrimvarRefiner::InterpolateLevel<>() for vertex, varying or
+    // face-varying
     //
     PrimvarRefiner primvarRefiner(refiner);
 
     internal::StencilBuilder::Index srcIndex(&builder, 0);
-    internal::StencilBuilder::Index dstIndex(&builder,
-                                        refiner.GetLevel(0).GetNumVertices());
+    internal::StencilBuilder::Index dstIndex(&builder, numControlVertices);
     for (int level=1; level<=maxlevel; ++level) {
-        if (not interpolateVarying) {
+        if (interpolateFaceVarying) {
+            primvarRefiner.InterpolateFaceVarying(
+                level, srcIndex, dstIndex, fvarChannel);
+        } else if (not interpolateVarying) {
             primvarRefiner.Interpolate(level, srcIndex, dstIndex);
         } else {
             primvarRefiner.InterpolateVarying(level, srcIndex, dstIndex);
         }
 
         srcIndex = dstIndex;
-        dstIndex = dstIndex[refiner.GetLevel(level).GetNumVertices()];
+        dstIndex = dstIndex[interpolateFaceVarying ?
+            refiner.GetLevel(level).GetNumFVarValues(fvarChannel) :
+            refiner.GetLevel(level).GetNumVertices()];
     }
 
 
-    size_t firstOffset = refiner.GetLevel(0).GetNumVertices();
+    size_t firstOffset = numControlVertices;
     if (not options.generateIntermediateLevels)
         firstOffset = srcIndex.GetOffset();
  
     // Copy stencils from the pool allocator into the tables
     // always initialize numControlVertices (useful for torus case)
     StencilTable * result = 
-                        new StencilTable(refiner.GetLevel(0).GetNumVertices(),
+                        new StencilTable(numControlVertices,
                                           builder.GetStencilOffsets(),
                                           builder.GetStencilSizes(),
                                           builder.GetStencilSources(),
@@ -128,8 +149,8 @@ StencilTableFactory::Create(int numTables, StencilTable const ** tables) {
     }
 
     int ncvs = -1,
-        nstencils = 0,
-        nelems = 0;
+        nstencils = 0;
+    size_t nelems = 0;
 
     for (int i=0; i<numTables; ++i) {
 
@@ -142,7 +163,7 @@ StencilTableFactory::Create(int numTables, StencilTable const ** tables) {
         }
         ncvs = st->GetNumControlVertices();
         nstencils += st->GetNumStencils();
-        nelems += (int)st->GetControlIndices().size();
+        nelems += st->GetControlIndices().size();
     }
 
     if (ncvs == -1) {
@@ -159,8 +180,8 @@ StencilTableFactory::Create(int numTables, StencilTable const ** tables) {
         StencilTable const * st = tables[i];
         if (!st) continue;
 
-        int st_nstencils = st->GetNumStencils(),
-            st_nelems = (int)st->_indices.size();
+        int st_nstencils = st->GetNumStencils();
+        size_t st_nelems = st->_indices.size();
         memcpy(sizes, &st->_sizes[0], st_nstencils*sizeof(int));
         memcpy(indices, &st->_indices[0], st_nelems*sizeof(Index));
         memcpy(weights, &st->_weights[0], st_nelems*sizeof(float));
@@ -196,7 +217,7 @@ StencilTableFactory::AppendLocalPointStencilTable(
 
     int controlVertsIndexOffset = 0;
     int nBaseStencils = baseStencilTable->GetNumStencils();
-    int nBaseStencilsElements = (int)baseStencilTable->_indices.size();
+    size_t nBaseStencilsElements = baseStencilTable->_indices.size();
     {
         int nverts = refiner.GetNumVerticesTotal();
         if (nBaseStencils == nverts) {
@@ -243,7 +264,7 @@ StencilTableFactory::AppendLocalPointStencilTable(
 
     // copy all local points stencils to proto stencils, and factoriz if needed.
     int nLocalPointStencils = localPointStencilTable->GetNumStencils();
-    int nLocalPointStencilsElements = 0;
+    size_t nLocalPointStencilsElements = 0;
 
     internal::StencilBuilder builder(refiner.GetLevel(0).GetNumVertices(),
                                 /*genControlVerts*/ false,
@@ -301,7 +322,7 @@ StencilTableFactory::AppendLocalPointStencilTable(
     // endcap stencils second
     for (int i = 0 ; i < nLocalPointStencils; ++i) {
         int size = builder.GetNumVertsInStencil(i);
-        int idx = builder.GetStencilOffsets()[i];
+        size_t idx = builder.GetStencilOffsets()[i];
         for (int j = 0; j < size; ++j) {
             *indices++ = builder.GetStencilSources()[idx+j];
             *weights++ = builder.GetStencilWeights()[idx+j];
@@ -319,7 +340,7 @@ StencilTableFactory::AppendLocalPointStencilTable(
 LimitStencilTable const *
 LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
     LocationArrayVec const & locationArrays, StencilTable const * cvStencilsIn,
-        PatchTable const * patchTableIn) {
+        PatchTable const * patchTableIn, Options options) {
 
     // Compute the total number of stencils to generate
     int numStencils=0, numLimitStencils=0;
@@ -335,6 +356,24 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
 
     int maxlevel = refiner.GetMaxLevel();
 
+    bool interpolateFaceVarying = options.interpolationMode==
+        StencilTableFactory::INTERPOLATE_FACE_VARYING;
+
+    int fvarChannel = options.fvarChannel;
+
+    if (interpolateFaceVarying) {
+        if (fvarChannel>=refiner.GetNumFVarChannels()) {
+            return 0;
+        }
+    } else if (options.interpolationMode!=
+        StencilTableFactory::INTERPOLATE_VERTEX) {
+        return 0;
+    }
+
+    int numControlVertices = interpolateFaceVarying ?
+        refiner.GetLevel(0).GetNumFVarValues(fvarChannel) :
+        refiner.GetLevel(0).GetNumVertices();
+
     StencilTable const * cvstencils = cvStencilsIn;
     if (not cvstencils) {
         // Generate stencils for the control vertices - this is necessary to
@@ -347,6 +386,15 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
         options.generateControlVerts = true;
         options.generateOffsets = true;
 
+        if (interpolateFaceVarying) {
+            // The face-varying values of uniform patches are indexed from
+            // the first value of the last level
+            options.interpolationMode =
+                StencilTableFactory::INTERPOLATE_FACE_VARYING;
+            options.fvarChannel = fvarChannel;
+            options.generateControlVerts = uniform ? false : true;
+        }
+
         // PERFORMANCE: We could potentially save some mem-copies by not
         // instanciating the stencil tables and work directly off the source
         // data.
@@ -356,9 +404,17 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
         //
         // Note that the input cvStencils could be larger than the number of
         // refiner's vertices, due to the existence of the end cap stencils.
-        if (cvstencils->GetNumStencils() < (uniform ?
-            refiner.GetLevel(maxlevel).GetNumVertices() :
-                refiner.GetNumVerticesTotal())) {
+        int numRequired = 0;
+        if (interpolateFaceVarying) {
+            numRequired = uniform ?
+                refiner.GetLevel(maxlevel).GetNumFVarValues(fvarChannel) :
+                    refiner.GetNumFVarValuesTotal(fvarChannel);
+        } else {
+            numRequired = uniform ?
+                refiner.GetLevel(maxlevel).GetNumVertices() :
+                    refiner.GetNumVerticesTotal();
+        }
+        if (cvstencils->GetNumStencils() < numRequired) {
                 return 0;
         }
     }
@@ -375,10 +431,11 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
         PatchTableFactory::Options options;
         options.SetEndCapType(
             Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+        options.generateFVarTables = interpolateFaceVarying;
 
         patchtable = PatchTableFactory::Create(refiner, options);
 
-        if (not cvStencilsIn) {
+        if ((not cvStencilsIn) and (not interpolateFaceVarying)) {
             // if cvstencils is just created above, append endcap stencils
             if (StencilTable const *localPointStencilTable =
                 patchtable->GetLocalPointStencilTable()) {
@@ -391,7 +448,9 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
         }
     } else {
         // Sanity checks
-        if (patchtable->IsFeatureAdaptive()==uniform) {
+        if (patchtable->IsFeatureAdaptive()==uniform or
+            (interpolateFaceVarying and
+                fvarChannel>=patchtable->GetNumFVarChannels())) {
             if (not cvStencilsIn) {
                 assert(cvstencils and cvstencils!=cvStencilsIn);
                 delete cvstencils;
@@ -402,6 +461,21 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
 
     assert(patchtable and cvstencils);
 
+    // Face-varying limit stencils are only supported for bilinear (QUADS)
+    // patches : reject tables with any other face-varying patch type
+    if (interpolateFaceVarying and patchtable->GetNumPatchArrays()>0 and
+        patchtable->GetNumPatches(0)>0 and
+        patchtable->GetPatchFVarValues(0, 0, fvarChannel).size() !=
+            PatchDescriptor::GetNumFVarControlVertices(PatchDescriptor::QUADS)) {
+        if (not cvStencilsIn) {
+            delete cvstencils;
+        }
+        if (not patchTableIn) {
+            delete patchtable;
+        }
+        return 0;
+    }
+
     // Create a patch-map to locate sub-patches faster
     PatchMap patchmap( *patchtable );
 
@@ -409,7 +483,7 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
     // Generate limit stencils for locations
     //
 
-    internal::StencilBuilder builder(refiner.GetLevel(0).GetNumVertices(),
+    internal::StencilBuilder builder(numControlVertices,
                                 /*genControlVerts*/ false,
                                 /*compactWeights*/  true);
     internal::StencilBuilder::Index origin(&builder, 0);
@@ -428,9 +502,17 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
             PatchMap::Handle const * handle = 
                                         patchmap.FindPatch(array.ptexIdx, s, t);
             if (handle) {
-                ConstIndexArray cvs = patchtable->GetPatchVertices(*handle);
+                ConstIndexArray cvs;
+                if (interpolateFaceVarying) {
+                    cvs = patchtable->GetPatchFVarValues(*handle, fvarChannel);
+
+                    patchtable->EvaluateBasisFaceVarying(*handle, s, t,
+                        wP, wDs, wDt, fvarChannel);
+                } else {
+                    cvs = patchtable->GetPatchVertices(*handle);
 
-                patchtable->EvaluateBasis(*handle, s, t, wP, wDs, wDt);
+                    patchtable->EvaluateBasis(*handle, s, t, wP, wDs, wDt);
+                }
 
                 StencilTable const & src = *cvstencils;
                 dst = origin[numLimitStencils];
@@ -457,7 +539,7 @@ LimitStencilTableFactory::Create(TopologyRefiner const & refiner,
     // Copy the proto-stencils into the limit stencil table
     //
     LimitStencilTable * result = new LimitStencilTable(
-                                          refiner.GetLevel(0).GetNumVertices(),
+                                          numControlVertices,
                                           builder.GetStencilOffsets(),
                                           builder.GetStencilSizes(),
                                           builder.GetStencilSources(),
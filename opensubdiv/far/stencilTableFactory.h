@@ -51,7 +51,8 @@ public:
 
     enum Mode {
         INTERPOLATE_VERTEX=0,
-        INTERPOLATE_VARYING
+        INTERPOLATE_VARYING,
+        INTERPOLATE_FACE_VARYING
     };
 
     struct Options {
@@ -61,7 +62,8 @@ public:
                     generateControlVerts(false),
                     generateIntermediateLevels(true),
                     factorizeIntermediateLevels(true),
-                    maxLevel(10) { }
+                    maxLevel(10),
+                    fvarChannel(0) { }
 
         unsigned int interpolationMode           : 2, ///< interpolation mode
                      generateOffsets             : 1, ///< populate optional "_offsets" field
@@ -71,6 +73,9 @@ public:
                                                       ///  vertices or from the stencils of the
                                                       ///  previous level
                      maxLevel                    : 4; ///< generate stencils up to 'maxLevel'
+        unsigned int fvarChannel;                     ///< face-varying channel to use
+                                                      ///  when generating face-varying
+                                                      ///  stencils
     };
 
     /// \brief Instantiates StencilTable from TopologyRefiner that have been
@@ -80,6 +85,10 @@ public:
     ///       been refined in the TopologyRefiner. Use RefineUniform() or
     ///       RefineAdaptive() before constructing the stencils.
     ///
+    /// \note With INTERPOLATE_FACE_VARYING, the stencils interpolate the
+    ///       values of the face-varying channel 'fvarChannel' : the control
+    ///       vertices of the table are the coarse face-varying values.
+    ///
     /// @param refiner  The TopologyRefiner containing the topology
     ///
     /// @param options  Options controlling the creation of the table
@@ -140,10 +149,27 @@ private:
 /// normalized (s,t) patch coordinates. The factory exposes the LocationArray
 /// struct as a container for these location descriptors.
 ///
+/// Limit stencils can also be generated for a face-varying channel : the
+/// stencils then interpolate the coarse face-varying values of the channel
+/// over the (bilinear) face-varying patches of the PatchTable.
+///
 class LimitStencilTableFactory {
 
 public:
 
+    struct Options {
+
+        Options() : interpolationMode(StencilTableFactory::INTERPOLATE_VERTEX),
+                    fvarChannel(0) { }
+
+        unsigned int interpolationMode : 2; ///< StencilTableFactory::Mode,
+                                            ///  either INTERPOLATE_VERTEX or
+                                            ///  INTERPOLATE_FACE_VARYING
+        unsigned int fvarChannel;           ///< face-varying channel to use
+                                            ///  when generating face-varying
+                                            ///  stencils
+    };
+
     /// \brief Descriptor for limit surface locations
     struct LocationArray {
 
@@ -168,16 +194,25 @@ public:
     ///
     /// @param cvStencils       A set of StencilTable generated from the
     ///                         TopologyRefiner (optional: prevents redundant
-    ///                         instanciation of the table if available)
+    ///                         instanciation of the table if available).
+    ///                         For face-varying stencils, the table must
+    ///                         interpolate the values of the channel indexed
+    ///                         by the face-varying patches of 'patchTable'
     ///
     /// @param patchTable       A set of PatchTable generated from the
     ///                         TopologyRefiner (optional: prevents redundant
-    ///                         instanciation of the table if available)
+    ///                         instanciation of the table if available). For
+    ///                         face-varying stencils, the table must have been
+    ///                         generated with bilinear (QUADS) face-varying
+    ///                         patches, otherwise no table is returned
+    ///
+    /// @param options          Options controlling the creation of the table
     ///
     static LimitStencilTable const * Create(TopologyRefiner const & refiner,
         LocationArrayVec const & locationArrays,
             StencilTable const * cvStencils=0,
-                PatchTable const * patchTable=0);
+                PatchTable const * patchTable=0,
+                    Options options=Options());
 };
 
 
@@ -53,7 +53,8 @@ TopologyRefiner::TopologyRefiner(Sdc::SchemeType schemeType, Sdc::Options scheme
     _totalEdges(0),
     _totalFaces(0),
     _totalFaceVertices(0),
-    _maxValence(0) {
+    _maxValence(0),
+    _arena(new Vtr::internal::Arena) {
 
     //  Need to revisit allocation scheme here -- want to use smart-ptrs for these
     //  but will probably have to settle for explicit new/delete...
@@ -72,6 +73,7 @@ TopologyRefiner::~TopologyRefiner() {
     for (int i=0; i<(int)_refinements.size(); ++i) {
         delete _refinements[i];
     }
+    delete _arena;
 }
 
 void
@@ -89,6 +91,9 @@ TopologyRefiner::Unrefine() {
     }
     _refinements.clear();
 
+    //  Release the storage of all refined levels and refinements at once:
+    _arena->clear();
+
     assembleFarLevels();
 }
 
@@ -223,7 +228,7 @@ TopologyRefiner::RefineUniform(UniformOptions options) {
             options.fullTopologyInLastLevel ? false : (i == options.refinementLevel);
 
         Vtr::internal::Level& parentLevel = getLevel(i-1);
-        Vtr::internal::Level& childLevel  = *(new Vtr::internal::Level);
+        Vtr::internal::Level& childLevel  = *(new Vtr::internal::Level(_arena));
 
         Vtr::internal::Refinement* refinement = 0;
         if (splitType == Sdc::SPLIT_TO_QUADS) {
@@ -282,7 +287,7 @@ TopologyRefiner::RefineAdaptive(AdaptiveOptions options) {
     for (int i = 1; i <= (int)options.isolationLevel; ++i) {
 
         Vtr::internal::Level& parentLevel     = getLevel(i-1);
-        Vtr::internal::Level& childLevel      = *(new Vtr::internal::Level);
+        Vtr::internal::Level& childLevel      = *(new Vtr::internal::Level(_arena));
 
         Vtr::internal::Refinement* refinement = 0;
         if (splitType == Sdc::SPLIT_TO_QUADS) {
@@ -37,7 +37,7 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
-namespace Vtr { namespace internal { class SparseSelector; } }
+namespace Vtr { namespace internal { class SparseSelector; class Arena; } }
 
 namespace Far {
 
@@ -186,6 +186,7 @@ protected:
     friend class EndCapLegacyGregoryPatchFactory;
     friend class PtexIndices;
     friend class PrimvarRefiner;
+    friend class UniformMeshExporter;
 
     Vtr::internal::Level & getLevel(int l) { return *_levels[l]; }
     Vtr::internal::Level const & getLevel(int l) const { return *_levels[l]; }
@@ -232,6 +233,9 @@ private:
     std::vector<Vtr::internal::Level *>      _levels;
     std::vector<Vtr::internal::Refinement *> _refinements;
 
+    //  Storage of the refined levels and refinements (released on Unrefine):
+    Vtr::internal::Arena * _arena;
+
     std::vector<TopologyLevel> _farLevels;;
 };
 
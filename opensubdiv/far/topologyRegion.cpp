@@ -0,0 +1,206 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/topologyRegion.h"
+#include "../far/topologyDescriptor.h"
+#include "../far/topologyRefiner.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+namespace internal {
+
+namespace {
+    typedef std::pair<Index, int> FaceRing;
+
+    inline bool
+    containsFace(std::vector<FaceRing> const & faces, Index face) {
+        std::vector<FaceRing>::const_iterator it =
+            std::lower_bound(faces.begin(), faces.end(), FaceRing(face, 0));
+        return it!=faces.end() and it->first==face;
+    }
+} // end namespace anon
+
+TopologyRegion::TopologyRegion(TopologyRefiner const & refiner,
+    ConstIndexArray faces, int numRings) : _refiner(refiner) {
+
+    TopologyLevel const & level = refiner.GetLevel(0);
+
+    //
+    //  Grow the region one ring at a time : the faces of each new ring are the
+    //  faces incident to the vertices of the previous ring that have not been
+    //  gathered yet.  The region is kept sorted so that the cost remains
+    //  proportional to the size of the region rather than that of the mesh.
+    //
+    std::vector<FaceRing> region;
+    region.reserve(faces.size());
+    for (int i=0; i<faces.size(); ++i) {
+        assert(faces[i]>=0 and faces[i]<level.GetNumFaces());
+        region.push_back(FaceRing(faces[i], 0));
+    }
+    std::sort(region.begin(), region.end());
+    region.erase(std::unique(region.begin(), region.end()), region.end());
+
+    std::vector<Index> frontier(region.size()), next;
+    for (int i=0; i<(int)region.size(); ++i) {
+        frontier[i] = region[i].first;
+    }
+
+    for (int ring=1; ring<=numRings; ++ring) {
+
+        next.clear();
+        for (int i=0; i<(int)frontier.size(); ++i) {
+            ConstIndexArray fverts = level.GetFaceVertices(frontier[i]);
+            for (int j=0; j<fverts.size(); ++j) {
+                ConstIndexArray vfaces = level.GetVertexFaces(fverts[j]);
+                for (int k=0; k<vfaces.size(); ++k) {
+                    if (not containsFace(region, vfaces[k])) {
+                        next.push_back(vfaces[k]);
+                    }
+                }
+            }
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+
+        if (next.empty()) {
+            break;
+        }
+
+        std::vector<FaceRing> merged;
+        merged.reserve(region.size() + next.size());
+        for (int i=0, j=0; i<(int)region.size() or j<(int)next.size(); ) {
+            if (j==(int)next.size() or
+                (i<(int)region.size() and region[i].first<next[j])) {
+                merged.push_back(region[i++]);
+            } else {
+                merged.push_back(FaceRing(next[j++], ring));
+            }
+        }
+        region.swap(merged);
+        frontier.swap(next);
+    }
+
+    _faces.resize(region.size());
+    _faceRings.resize(region.size());
+    for (int i=0; i<(int)region.size(); ++i) {
+        _faces[i] = region[i].first;
+        _faceRings[i] = (unsigned char)region[i].second;
+    }
+
+    for (int i=0; i<(int)_faces.size(); ++i) {
+        ConstIndexArray fverts = level.GetFaceVertices(_faces[i]);
+        _vertices.insert(_vertices.end(), fverts.begin(), fverts.end());
+    }
+    std::sort(_vertices.begin(), _vertices.end());
+    _vertices.erase(std::unique(_vertices.begin(), _vertices.end()), _vertices.end());
+}
+
+Index
+TopologyRegion::FindVertex(Index baseVert) const {
+
+    std::vector<Index>::const_iterator it =
+        std::lower_bound(_vertices.begin(), _vertices.end(), baseVert);
+    return (it!=_vertices.end() and *it==baseVert) ?
+        (Index)(it - _vertices.begin()) : INDEX_INVALID;
+}
+
+TopologyRefiner *
+TopologyRegion::CreateRefiner() const {
+
+    TopologyLevel const & level = _refiner.GetLevel(0);
+
+    std::vector<int>   vertsPerFace(_faces.size());
+    std::vector<Index> faceVerts,
+                       holes,
+                       creaseEdges,
+                       creaseVerts,
+                       cornerVerts;
+    std::vector<float> creaseWeights,
+                       cornerWeights;
+
+    for (int face=0; face<(int)_faces.size(); ++face) {
+
+        ConstIndexArray fverts = level.GetFaceVertices(_faces[face]),
+                        fedges = level.GetFaceEdges(_faces[face]);
+
+        vertsPerFace[face] = fverts.size();
+        for (int i=0; i<fverts.size(); ++i) {
+            faceVerts.push_back(FindVertex(fverts[i]));
+            if (level.GetEdgeSharpness(fedges[i]) > 0.0f) {
+                creaseEdges.push_back(fedges[i]);
+            }
+        }
+        if (level.IsFaceHole(_faces[face])) {
+            holes.push_back(face);
+        }
+    }
+
+    std::sort(creaseEdges.begin(), creaseEdges.end());
+    creaseEdges.erase(std::unique(creaseEdges.begin(), creaseEdges.end()), creaseEdges.end());
+    for (int i=0; i<(int)creaseEdges.size(); ++i) {
+        ConstIndexArray everts = level.GetEdgeVertices(creaseEdges[i]);
+        creaseVerts.push_back(FindVertex(everts[0]));
+        creaseVerts.push_back(FindVertex(everts[1]));
+        creaseWeights.push_back(level.GetEdgeSharpness(creaseEdges[i]));
+    }
+
+    for (int vert=0; vert<(int)_vertices.size(); ++vert) {
+        float sharpness = level.GetVertexSharpness(_vertices[vert]);
+        if (sharpness > 0.0f) {
+            cornerVerts.push_back(vert);
+            cornerWeights.push_back(sharpness);
+        }
+    }
+
+    TopologyDescriptor desc;
+    desc.numVertices = (int)_vertices.size();
+    desc.numFaces = (int)_faces.size();
+    desc.numVertsPerFace = vertsPerFace.empty() ? 0 : &vertsPerFace[0];
+    desc.vertIndicesPerFace = faceVerts.empty() ? 0 : &faceVerts[0];
+    desc.numCreases = (int)creaseWeights.size();
+    desc.creaseVertexIndexPairs = creaseVerts.empty() ? 0 : &creaseVerts[0];
+    desc.creaseWeights = creaseWeights.empty() ? 0 : &creaseWeights[0];
+    desc.numCorners = (int)cornerWeights.size();
+    desc.cornerVertexIndices = cornerVerts.empty() ? 0 : &cornerVerts[0];
+    desc.cornerWeights = cornerWeights.empty() ? 0 : &cornerWeights[0];
+    desc.numHoles = (int)holes.size();
+    desc.holeIndices = holes.empty() ? 0 : &holes[0];
+
+    typedef TopologyRefinerFactory<TopologyDescriptor> Factory;
+
+    return Factory::Create(desc, Factory::Options(
+        _refiner.GetSchemeType(), _refiner.GetSchemeOptions()));
+}
+
+} // end namespace internal
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
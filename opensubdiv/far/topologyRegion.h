@@ -0,0 +1,106 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#ifndef OPENSUBDIV3_FAR_TOPOLOGY_REGION_H
+#define OPENSUBDIV3_FAR_TOPOLOGY_REGION_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+class TopologyRefiner;
+
+namespace internal {
+
+//
+//  TopologyRegion
+//
+//  Gathers a subset of the faces of the base level of a TopologyRefiner along
+//  with a number of rings of neighboring faces, so that the region can be
+//  refined independently from the rest of the mesh.
+//
+//  Faces and vertices retain the relative order they have in the base level:
+//  vertex neighborhoods of the region refiner are then oriented and ordered
+//  like those of the base mesh, and the refined vertices of the faces that
+//  have a complete neighborhood are computed exactly as they would be with
+//  the whole mesh.
+//
+//  Note: face-varying channels are not transferred to the region.
+//
+class TopologyRegion {
+
+public:
+
+    // Gathers 'faces' from the base level of 'refiner', along with 'numRings'
+    // rings of neighboring faces (all the faces incident to the vertices of
+    // the previous ring)
+    TopologyRegion(TopologyRefiner const & refiner,
+        ConstIndexArray faces, int numRings);
+
+    // Returns the number of faces in the region
+    int GetNumFaces() const { return (int)_faces.size(); }
+
+    // Returns the number of vertices in the region
+    int GetNumVertices() const { return (int)_vertices.size(); }
+
+    // Returns the index of a region face in the base level
+    Index GetBaseFace(Index face) const { return _faces[face]; }
+
+    // Returns the index of a region vertex in the base level
+    Index GetBaseVertex(Index vert) const { return _vertices[vert]; }
+
+    // Returns the ring a region face belongs to (0 for the seed faces)
+    int GetFaceRing(Index face) const { return _faceRings[face]; }
+
+    // Returns the index of a base level vertex in the region (or INDEX_INVALID)
+    Index FindVertex(Index baseVert) const;
+
+    // Returns a new (unrefined) TopologyRefiner for the faces of the region
+    TopologyRefiner * CreateRefiner() const;
+
+private:
+
+    TopologyRefiner const & _refiner;
+
+    std::vector<Index>         _faces,      // sorted base level face indices
+                               _vertices;   // sorted base level vertex indices
+    std::vector<unsigned char> _faceRings;
+};
+
+} // end namespace internal
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif // OPENSUBDIV3_FAR_TOPOLOGY_REGION_H
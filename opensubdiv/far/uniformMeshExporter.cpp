@@ -0,0 +1,137 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include "../far/uniformMeshExporter.h"
+#include "../vtr/level.h"
+#include "../vtr/fvarLevel.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+UniformMeshExporter::UniformMeshExporter(TopologyRefiner const & refiner,
+    Options options) :
+        _refiner(refiner), _primvarRefiner(refiner), _options(options) {
+
+    assert(refiner.IsUniform() and refiner.GetMaxLevel() > 0);
+
+    // ensure that triangulateQuads is only set for quadrilateral schemes
+    _options.triangulateQuads &= (refiner.GetSchemeType()==Sdc::SCHEME_BILINEAR or
+                                  refiner.GetSchemeType()==Sdc::SCHEME_CATMARK);
+
+    Vtr::internal::Level const & level = refiner.getLevel(refiner.GetMaxLevel());
+
+    _numFaces = level.getNumFaces();
+    if (refiner.HasHoles()) {
+        for (int face = 0; face < level.getNumFaces(); ++face) {
+            _numFaces -= level.isFaceHole(face);
+        }
+    }
+
+    _faceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(refiner.GetSchemeType());
+    if (_options.triangulateQuads) {
+        // each quad is exported as 2 triangles
+        _numFaces *= 2;
+        _faceSize = 3;
+    }
+}
+
+int
+UniformMeshExporter::GetNumVertices() const {
+    return _refiner.GetLevel(_refiner.GetMaxLevel()).GetNumVertices();
+}
+
+int
+UniformMeshExporter::GetNumFVarValues(int channel) const {
+    return _refiner.GetLevel(_refiner.GetMaxLevel()).GetNumFVarValues(channel);
+}
+
+int
+UniformMeshExporter::getNumValues(InterpolationMode mode, int level, int channel) const {
+
+    TopologyLevel const & refLevel = _refiner.GetLevel(level);
+    return (mode == INTERPOLATE_FACE_VARYING) ?
+        refLevel.GetNumFVarValues(channel) : refLevel.GetNumVertices();
+}
+
+void
+UniformMeshExporter::exportFaceIndices(Index * dst, int channel) const {
+
+    Vtr::internal::Level const & level = _refiner.getLevel(_refiner.GetMaxLevel());
+
+    //  Refined faces all have the regular face size, so the indices of the
+    //  faces of the last level are stored contiguously (with or without
+    //  face-varying channel) in the same order as the exported faces:
+    Index const * indices = 0;
+    int numIndices = 0;
+    if (channel < 0) {
+        indices = &level.getFaceVertices()[0];
+        numIndices = level.getNumFaceVerticesTotal();
+    } else {
+        Vtr::internal::FVarLevel const & fvarLevel = level.getFVarLevel(channel);
+        indices = &fvarLevel.getFaceValues(0)[0];
+        numIndices = fvarLevel.getNumFaceValuesTotal();
+    }
+
+    if ((not _refiner.HasHoles()) and (not _options.triangulateQuads)) {
+        std::memcpy(dst, indices, numIndices * sizeof(Index));
+        return;
+    }
+
+    int regFaceSize = Sdc::SchemeTypeTraits::GetRegularFaceSize(
+        _refiner.GetSchemeType());
+
+    int numFaces = level.getNumFaces();
+    for (int face = 0; face < numFaces; ++face, indices += regFaceSize) {
+
+        if (_refiner.HasHoles() and level.isFaceHole(face)) {
+            continue;
+        }
+
+        if (_options.triangulateQuads) {
+            // Triangulate the quadrilateral: {v0,v1,v2,v3} -> {v0,v1,v2},{v3,v0,v2}.
+            dst[0] = indices[0];
+            dst[1] = indices[1];
+            dst[2] = indices[2];
+            dst[3] = indices[3];
+            dst[4] = indices[0];
+            dst[5] = indices[2];
+            dst += 6;
+        } else {
+            for (int i = 0; i < regFaceSize; ++i) {
+                dst[i] = indices[i];
+            }
+            dst += regFaceSize;
+        }
+    }
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
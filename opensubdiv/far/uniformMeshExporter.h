@@ -0,0 +1,304 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_FAR_UNIFORM_MESH_EXPORTER_H
+#define OPENSUBDIV3_FAR_UNIFORM_MESH_EXPORTER_H
+
+#include "../version.h"
+
+#include "../far/types.h"
+#include "../far/primvarRefiner.h"
+#include "../far/topologyRefiner.h"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+
+/// \brief Exports the last level of a uniformly refined mesh
+///
+/// The face-vertex indices, face-varying indices and interpolated primvar
+/// data of the last refinement level are written directly into buffers
+/// provided by the client (ex. GPU buffers or memory-mapped files), without
+/// copying the topology of the faces or storing the primvar data of the
+/// intermediate levels in client buffers.
+///
+/// Primvar data of the intermediate levels is interpolated into a scratch
+/// buffer owned by the exporter : two alternating regions sized to the
+/// largest intermediate levels, that are reused by all subsequent calls
+/// (other primvars or later frames) so that no allocations occur once the
+/// scratch buffer has reached its size.
+///
+/// An exporter is not thread-safe : concurrent exports of the same refiner
+/// should each use their own exporter.
+///
+class UniformMeshExporter {
+
+public:
+
+    struct Options {
+
+        Options() : triangulateQuads(false) { }
+
+        unsigned int triangulateQuads : 1; ///< Triangulate the quads of the
+                                           ///< bilinear and Catmark schemes
+    };
+
+    /// \brief Constructor
+    ///
+    /// @param refiner  TopologyRefiner refined uniformly at least once
+    ///
+    /// @param options  Options controlling the exported faces
+    ///
+    UniformMeshExporter(TopologyRefiner const & refiner,
+                        Options options = Options());
+
+    /// \brief Returns the TopologyRefiner exported
+    TopologyRefiner const & GetTopologyRefiner() const { return _refiner; }
+
+    //@{
+    ///  @name Faces
+
+    /// \brief Returns the number of exported faces (holes are skipped)
+    int GetNumFaces() const { return _numFaces; }
+
+    /// \brief Returns the number of vertices of the exported faces (3 or 4)
+    int GetFaceSize() const { return _faceSize; }
+
+    /// \brief Returns the size of the face-vertex and face-varying index
+    ///        buffers : GetNumFaces() * GetFaceSize()
+    int GetNumFaceIndices() const { return _numFaces * _faceSize; }
+
+    /// \brief Writes the face-vertex indices of the last level
+    ///
+    /// Indices refer to the vertices of the last level, as written by
+    /// Interpolate() and InterpolateVarying().  Triangulated quads
+    /// {v0,v1,v2,v3} are written as the triangles {v0,v1,v2},{v3,v0,v2}.
+    ///
+    /// @param dst  Destination buffer of at least GetNumFaceIndices() indices
+    ///
+    void ExportFaceVertices(Index * dst) const;
+
+    /// \brief Writes the face-varying indices of the last level
+    ///
+    /// Indices refer to the face-varying values of the last level, as written
+    /// by InterpolateFaceVarying(), and follow the face-vertex indices.
+    ///
+    /// @param dst      Destination buffer of at least GetNumFaceIndices()
+    ///                 indices
+    ///
+    /// @param channel  Face-varying channel
+    ///
+    void ExportFaceFVarValues(Index * dst, int channel = 0) const;
+
+    //@}
+
+    //@{
+    ///  @name Primvar data
+    ///
+    /// Source and destination buffers follow the requirements of the
+    /// PrimvarRefiner (see \ref templating) : the source buffer holds the
+    /// data of the base level and the destination buffer receives the data
+    /// of the last level only.  The data of the intermediate levels is held
+    /// in the scratch buffer as default-constructed instances of the
+    /// destination class U.
+
+    /// \brief Returns the number of vertices of the last level
+    int GetNumVertices() const;
+
+    /// \brief Returns the number of face-varying values of the last level
+    int GetNumFVarValues(int channel = 0) const;
+
+    /// \brief Interpolates vertex primvar data to the last level
+    ///
+    /// @param src  Source primvar buffer (control vertex data)
+    ///
+    /// @param dst  Destination buffer of at least GetNumVertices() elements
+    ///
+    template <class T, class U> void Interpolate(T const & src, U * dst);
+
+    /// \brief Interpolates varying primvar data to the last level
+    ///
+    /// @param src  Source primvar buffer (control vertex data)
+    ///
+    /// @param dst  Destination buffer of at least GetNumVertices() elements
+    ///
+    template <class T, class U> void InterpolateVarying(T const & src, U * dst);
+
+    /// \brief Interpolates face-varying primvar data to the last level
+    ///
+    /// @param src      Source primvar buffer (face-varying values of the
+    ///                 base level)
+    ///
+    /// @param dst      Destination buffer of at least GetNumFVarValues()
+    ///                 elements
+    ///
+    /// @param channel  Face-varying channel
+    ///
+    template <class T, class U> void InterpolateFaceVarying(T const & src, U * dst,
+        int channel = 0);
+
+    /// \brief Returns the size in bytes of the scratch buffer
+    size_t GetScratchMemoryUsage() const { return _scratch.size(); }
+
+    //@}
+
+private:
+
+    enum InterpolationMode {
+        INTERPOLATE_VERTEX,
+        INTERPOLATE_VARYING,
+        INTERPOLATE_FACE_VARYING
+    };
+
+    template <class T, class U>
+    void interpolate(InterpolationMode mode, T const & src, U * dst, int channel);
+
+    template <class T, class U>
+    void interpolateLevel(InterpolationMode mode, int level,
+        T const & src, U & dst, int channel) const;
+
+    int getNumValues(InterpolationMode mode, int level, int channel) const;
+
+    void exportFaceIndices(Index * dst, int channel) const;
+
+private:
+
+    TopologyRefiner const & _refiner;
+    PrimvarRefiner          _primvarRefiner;
+
+    Options _options;
+
+    int _numFaces,
+        _faceSize;
+
+    //  Raw memory holding the data of the intermediate levels, reused by all
+    //  interpolations:
+    std::vector<char> _scratch;
+};
+
+inline void
+UniformMeshExporter::ExportFaceVertices(Index * dst) const {
+    exportFaceIndices(dst, -1);
+}
+
+inline void
+UniformMeshExporter::ExportFaceFVarValues(Index * dst, int channel) const {
+    exportFaceIndices(dst, channel);
+}
+
+template <class T, class U>
+inline void
+UniformMeshExporter::Interpolate(T const & src, U * dst) {
+    interpolate(INTERPOLATE_VERTEX, src, dst, 0);
+}
+
+template <class T, class U>
+inline void
+UniformMeshExporter::InterpolateVarying(T const & src, U * dst) {
+    interpolate(INTERPOLATE_VARYING, src, dst, 0);
+}
+
+template <class T, class U>
+inline void
+UniformMeshExporter::InterpolateFaceVarying(T const & src, U * dst, int channel) {
+    interpolate(INTERPOLATE_FACE_VARYING, src, dst, channel);
+}
+
+template <class T, class U>
+inline void
+UniformMeshExporter::interpolateLevel(InterpolationMode mode, int level,
+    T const & src, U & dst, int channel) const {
+
+    switch (mode) {
+        case INTERPOLATE_VERTEX:
+            _primvarRefiner.Interpolate(level, src, dst);
+            break;
+        case INTERPOLATE_VARYING:
+            _primvarRefiner.InterpolateVarying(level, src, dst);
+            break;
+        case INTERPOLATE_FACE_VARYING:
+            _primvarRefiner.InterpolateFaceVarying(level, src, dst, channel);
+            break;
+    }
+}
+
+template <class T, class U>
+inline void
+UniformMeshExporter::interpolate(InterpolationMode mode,
+    T const & src, U * dst, int channel) {
+
+    int maxLevel = _refiner.GetMaxLevel();
+
+    if (maxLevel == 1) {
+        interpolateLevel(mode, 1, src, dst, channel);
+        return;
+    }
+
+    //  Odd intermediate levels are interpolated into the first region of the
+    //  scratch buffer and even ones into the second, each level reading the
+    //  region written by the previous one:
+    int regionSize[2] = { 0, 0 };
+    for (int level = 1; level < maxLevel; ++level) {
+        int & size = regionSize[(level - 1) & 1];
+        size = std::max(size, getNumValues(mode, level, channel));
+    }
+
+    size_t numValues = (size_t)regionSize[0] + regionSize[1];
+    if (_scratch.size() < numValues * sizeof(U)) {
+        _scratch.resize(numValues * sizeof(U));
+    }
+
+    U * values = _scratch.empty() ? 0 : reinterpret_cast<U *>(&_scratch[0]);
+    for (size_t i = 0; i < numValues; ++i) {
+        new (values + i) U;
+    }
+
+    U * region[2] = { values, values + regionSize[0] };
+
+    interpolateLevel(mode, 1, src, region[0], channel);
+    for (int level = 2; level < maxLevel; ++level) {
+        U const * parent = region[level & 1];
+        interpolateLevel(mode, level, parent, region[(level - 1) & 1], channel);
+    }
+    U const * parent = region[maxLevel & 1];
+    interpolateLevel(mode, maxLevel, parent, dst, channel);
+
+    for (size_t i = 0; i < numValues; ++i) {
+        values[i].~U();
+    }
+}
+
+} // end namespace Far
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_FAR_UNIFORM_MESH_EXPORTER_H */
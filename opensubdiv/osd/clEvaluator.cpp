@@ -62,9 +62,28 @@ createCLBuffer(std::vector<T> const & src, cl_context clContext) {
 
 // ----------------------------------------------------------------------------
 
+// The kernels locate the stencils with 32-bit offsets
+bool
+CLStencilTable::isSupported(Far::StencilTable const *stencilTable) {
+    if (stencilTable->HasLargeOffsets()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "CLStencilTable : stencil tables with large offsets are "
+            "not supported\n");
+        return false;
+    }
+    return true;
+}
+
+bool
+CLStencilTable::isSupported(Far::LimitStencilTable const *limitStencilTable) {
+    return isSupported(
+        static_cast<Far::StencilTable const *>(limitStencilTable));
+}
+
 CLStencilTable::CLStencilTable(Far::StencilTable const *stencilTable,
                                cl_context clContext) {
-    _numStencils = stencilTable->GetNumStencils();
+    _numStencils = isSupported(stencilTable) ?
+        stencilTable->GetNumStencils() : 0;
 
     if (_numStencils > 0) {
         _sizes   = createCLBuffer(stencilTable->GetSizes(), clContext);
@@ -81,7 +100,8 @@ CLStencilTable::CLStencilTable(Far::StencilTable const *stencilTable,
 
 CLStencilTable::CLStencilTable(Far::LimitStencilTable const *limitStencilTable,
                                cl_context clContext) {
-    _numStencils = limitStencilTable->GetNumStencils();
+    _numStencils = isSupported(limitStencilTable) ?
+        limitStencilTable->GetNumStencils() : 0;
 
     if (_numStencils > 0) {
         _sizes   = createCLBuffer(limitStencilTable->GetSizes(), clContext);
@@ -36,6 +36,7 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Far {
     class StencilTable;
+    class LimitStencilTable;
 }
 
 namespace Osd {
@@ -52,14 +53,16 @@ public:
     template <typename DEVICE_CONTEXT>
     static CLStencilTable *Create(Far::StencilTable const *stencilTable,
                                   DEVICE_CONTEXT context) {
-        return new CLStencilTable(stencilTable, context->GetContext());
+        return isSupported(stencilTable) ?
+            new CLStencilTable(stencilTable, context->GetContext()) : NULL;
     }
 
     template <typename DEVICE_CONTEXT>
     static CLStencilTable *Create(
         Far::LimitStencilTable const *limitStencilTable,
         DEVICE_CONTEXT context) {
-        return new CLStencilTable(limitStencilTable, context->GetContext());
+        return isSupported(limitStencilTable) ?
+            new CLStencilTable(limitStencilTable, context->GetContext()) : NULL;
     }
 
     CLStencilTable(Far::StencilTable const *stencilTable,
@@ -78,6 +81,11 @@ public:
     int GetNumStencils()        const { return _numStencils; }
 
 private:
+    // reports and rejects tables with large offsets (see
+    // Far::StencilTable::HasLargeOffsets)
+    static bool isSupported(Far::StencilTable const *stencilTable);
+    static bool isSupported(Far::LimitStencilTable const *limitStencilTable);
+
     cl_mem _sizes;
     cl_mem _offsets;
     cl_mem _indices;
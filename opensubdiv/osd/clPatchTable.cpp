@@ -55,6 +55,17 @@ CLPatchTable::Create(Far::PatchTable const *farPatchTable,
 
 bool
 CLPatchTable::allocate(Far::PatchTable const *farPatchTable, cl_context clContext) {
+    // the kernels and shaders do not evaluate exact end caps
+    for (int i = 0; i < farPatchTable->GetNumPatchArrays(); ++i) {
+        if (farPatchTable->GetPatchArrayDescriptor(i).GetType() ==
+            Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "CLPatchTable : extraordinary basis end caps are "
+                "not supported\n");
+            return false;
+        }
+    }
+
     CpuPatchTable patchTable(farPatchTable);
 
     size_t numPatchArrays = patchTable.GetNumPatchArrays();
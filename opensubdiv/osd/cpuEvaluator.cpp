@@ -82,6 +82,86 @@ CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
     return true;
 }
 
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           const int * sizes,
+                           const size_t * offsets,
+                           const int * indices,
+                           const float * weights,
+                           int start, int end) {
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(const float *src, BufferDescriptor const &srcDesc,
+                           float *dst,       BufferDescriptor const &dstDesc,
+                           float *du,        BufferDescriptor const &duDesc,
+                           float *dv,        BufferDescriptor const &dvDesc,
+                           const int * sizes,
+                           const size_t * offsets,
+                           const int * indices,
+                           const float * weights,
+                           const float * duWeights,
+                           const float * dvWeights,
+                           int start, int end) {
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end);
+
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalStencils(
+    const float *src,        BufferDescriptor const &srcDesc,
+    float *dst,              BufferDescriptor const &dstDesc,
+    const float *varyingSrc, BufferDescriptor const &varyingSrcDesc,
+    float *varyingDst,       BufferDescriptor const &varyingDstDesc,
+    const int * sizes,
+    const int * offsets,
+    const int * indices,
+    const float * weights,
+    const int * varyingSizes,
+    const int * varyingOffsets,
+    const int * varyingIndices,
+    const float * varyingWeights,
+    int start, int end) {
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (varyingSrcDesc.length != varyingDstDesc.length) return false;
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    varyingSrc, varyingSrcDesc,
+                    varyingDst, varyingDstDesc,
+                    sizes, offsets, indices, weights,
+                    varyingSizes, varyingOffsets,
+                    varyingIndices, varyingWeights,
+                    start, end);
+
+    return true;
+}
+
 template <typename T>
 struct BufferAdapter {
     BufferAdapter(T *p, int length, int stride) :
@@ -97,7 +177,7 @@ struct BufferAdapter {
         }
     }
     const T *operator[] (int index) const {
-        return _p + _stride * index;
+        return _p + (ptrdiff_t)_stride * index;
     }
     BufferAdapter<T> & operator ++() {
         if (_p) {
@@ -148,6 +228,9 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
         Far::PatchParam const & param =
             patchParamBuffer[coord.handle.patchIndex];
 
+        const int *cvs =
+            patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
         int numControlVertices = 0;
         if (patchType == Far::PatchDescriptor::REGULAR) {
             Far::internal::GetBSplineWeights(param,
@@ -157,6 +240,11 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
             Far::internal::GetGregoryWeights(param,
                                              coord.s, coord.t, wP, wDs, wDt);
             numControlVertices = 20;
+        } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::internal::GetExtraordinaryWeights(param,
+                Far::internal::GetExtraordinaryValence(cvs),
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 20;
         } else if (patchType == Far::PatchDescriptor::QUADS) {
             Far::internal::GetBilinearWeights(param,
                                               coord.s, coord.t, wP, wDs, wDt);
@@ -165,8 +253,6 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
             assert(0);
             return false;
         }
-        const int *cvs =
-            &patchIndexBuffer[array.indexBase + coord.handle.vertIndex];
 
         dstT.Clear();
         for (int j = 0; j < numControlVertices; ++j) {
@@ -221,6 +307,9 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
         Far::PatchParam const & param =
             patchParamBuffer[coord.handle.patchIndex];
 
+        const int *cvs =
+            patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
         int numControlVertices = 0;
         if (patchType == Far::PatchDescriptor::REGULAR) {
             Far::internal::GetBSplineWeights(param,
@@ -230,6 +319,11 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
             Far::internal::GetGregoryWeights(param,
                                              coord.s, coord.t, wP, wDs, wDt);
             numControlVertices = 20;
+        } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::internal::GetExtraordinaryWeights(param,
+                Far::internal::GetExtraordinaryValence(cvs),
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 20;
         } else if (patchType == Far::PatchDescriptor::QUADS) {
             Far::internal::GetBilinearWeights(param,
                                               coord.s, coord.t, wP, wDs, wDt);
@@ -237,8 +331,6 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
         } else {
             assert(0);
         }
-        const int *cvs =
-            &patchIndexBuffer[array.indexBase + coord.handle.vertIndex];
 
         dstT.Clear();
         duT.Clear();
@@ -255,6 +347,213 @@ CpuEvaluator::EvalPatches(const float *src, BufferDescriptor const &srcDesc,
     return true;
 }
 
+/* static */
+bool
+CpuEvaluator::EvalPatchesVarying(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer) {
+
+    if ((not src) or (not dst)) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    // the legacy Gregory patches have no varying corners
+    if (not CpuCheckVaryingPatchCoords(numPatchCoords, patchCoords,
+                                       patchArrays)) {
+        return false;
+    }
+
+    BufferAdapter<const float> srcT(src + srcDesc.offset,
+                                    srcDesc.length, srcDesc.stride);
+    BufferAdapter<float>       dstT(dst + dstDesc.offset,
+                                    dstDesc.length, dstDesc.stride);
+
+    float wP[4];
+    int cvs[4];
+
+    for (int i = 0; i < numPatchCoords; ++i) {
+        int numCorners = CpuGetVaryingPatchWeights(patchCoords[i],
+            patchArrays, patchIndexBuffer, patchParamBuffer, wP, cvs);
+
+        dstT.Clear();
+        for (int j = 0; j < numCorners; ++j) {
+            dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
+        }
+        ++dstT;
+    }
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesFaceVarying(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *fvarPatchArrays,
+    const int *fvarPatchIndexBuffer,
+    const PatchParam *patchParamBuffer) {
+
+    if ((not src) or (not dst)) return false;
+
+    return EvalPatches(NULL, BufferDescriptor(), NULL, BufferDescriptor(),
+                       src, srcDesc, dst, dstDesc,
+                       numPatchCoords, patchCoords,
+                       NULL, NULL, patchParamBuffer,
+                       fvarPatchArrays, fvarPatchIndexBuffer);
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatches(
+    const float *src,     BufferDescriptor const &srcDesc,
+    float *dst,           BufferDescriptor const &dstDesc,
+    const float *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+    float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const PatchArray *fvarPatchArrays,
+    const int *fvarPatchIndexBuffer) {
+
+    if (src) {
+        if ((not dst) or srcDesc.length != dstDesc.length) return false;
+        src += srcDesc.offset;
+        dst += dstDesc.offset;
+    }
+    if (fvarSrc) {
+        if ((not fvarDst) or fvarSrcDesc.length != fvarDstDesc.length or
+            (not fvarPatchArrays) or (not fvarPatchIndexBuffer)) {
+            return false;
+        }
+        fvarSrc += fvarSrcDesc.offset;
+        fvarDst += fvarDstDesc.offset;
+    }
+
+    BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
+    BufferAdapter<float>       dstT(dst, dstDesc.length, dstDesc.stride);
+    BufferAdapter<const float> fvarSrcT(fvarSrc, fvarSrcDesc.length,
+                                                 fvarSrcDesc.stride);
+    BufferAdapter<float>       fvarDstT(fvarDst, fvarDstDesc.length,
+                                                 fvarDstDesc.stride);
+
+    float wP[20], wDs[20], wDt[20];
+
+    for (int i = 0; i < numPatchCoords; ++i) {
+        PatchCoord const &coord = patchCoords[i];
+
+        if (src) {
+            PatchArray const &array = patchArrays[coord.handle.arrayIndex];
+
+            int patchType = array.GetPatchType();
+            Far::PatchParam const & param =
+                patchParamBuffer[coord.handle.patchIndex];
+
+            const int *cvs =
+                patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
+            int numControlVertices = 0;
+            if (patchType == Far::PatchDescriptor::REGULAR) {
+                Far::internal::GetBSplineWeights(param,
+                                                 coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 16;
+            } else if (patchType == Far::PatchDescriptor::GREGORY_BASIS) {
+                Far::internal::GetGregoryWeights(param,
+                                                 coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 20;
+            } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+                Far::internal::GetExtraordinaryWeights(param,
+                    Far::internal::GetExtraordinaryValence(cvs),
+                    coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 20;
+            } else if (patchType == Far::PatchDescriptor::QUADS) {
+                Far::internal::GetBilinearWeights(param,
+                                                  coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 4;
+            } else {
+                assert(0);
+                return false;
+            }
+
+            dstT.Clear();
+            for (int j = 0; j < numControlVertices; ++j) {
+                dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
+            }
+            ++dstT;
+        }
+
+        if (fvarSrc) {
+            const int *values = NULL;
+            int numValues = CpuGetFVarPatchWeights(coord,
+                fvarPatchArrays, fvarPatchIndexBuffer, patchParamBuffer,
+                wP, &values);
+            if (numValues == 0) {
+                return false;
+            }
+
+            fvarDstT.Clear();
+            for (int j = 0; j < numValues; ++j) {
+                fvarDstT.AddWithWeight(fvarSrcT[values[j]], wP[j]);
+            }
+            ++fvarDstT;
+        }
+    }
+    return true;
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesBezier(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const int *bezierPointIndices) {
+
+    return EvalPatchesBezier(src, srcDesc, dst, dstDesc,
+                             NULL, BufferDescriptor(), NULL, BufferDescriptor(),
+                             numPatchCoords, patchCoords,
+                             patchArrays, patchIndexBuffer, patchParamBuffer,
+                             bezierPointIndices);
+}
+
+/* static */
+bool
+CpuEvaluator::EvalPatchesBezier(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const int *bezierPointIndices) {
+
+    if ((not src) or (not dst)) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (du and srcDesc.length != duDesc.length) return false;
+    if (dv and srcDesc.length != dvDesc.length) return false;
+
+    CpuEvalPatchesBezier(src, srcDesc, dst, dstDesc, du, duDesc, dv, dvDesc,
+                         patchCoords, patchArrays, patchIndexBuffer,
+                         patchParamBuffer, bezierPointIndices,
+                         0, numPatchCoords);
+
+    return true;
+}
+
 
 }  // end namespace Osd
 
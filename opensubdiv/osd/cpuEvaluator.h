@@ -39,6 +39,10 @@ namespace Osd {
 
 class CpuEvaluator {
 public:
+    /// Vertex and varying stencils can be evaluated together
+    /// (see Osd::MeshFuseVaryingStencils)
+    typedef bool FusedStencils;
+
     /// ----------------------------------------------------------------------
     ///
     ///   Stencil evaluations with StencilTable
@@ -83,6 +87,18 @@ public:
         if (stencilTable->GetNumStencils() == 0)
             return false;
 
+        size_t const * largeOffsets = GetLargeStencilOffsets(stencilTable);
+        if (largeOffsets) {
+            return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                &stencilTable->GetSizes()[0],
+                                largeOffsets,
+                                &stencilTable->GetControlIndices()[0],
+                                &stencilTable->GetWeights()[0],
+                                /*start = */ 0,
+                                /*end   = */ stencilTable->GetNumStencils());
+        }
+
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
                             &stencilTable->GetSizes()[0],
@@ -129,6 +145,18 @@ public:
         const float * weights,
         int start, int end);
 
+    /// \brief Same as above, with the 64-bit offsets of stencil tables of
+    ///        more than 2^31 weights (see Far::StencilTable::HasLargeOffsets)
+    ///
+    static bool EvalStencils(
+        const float *src,  BufferDescriptor const &srcDesc,
+        float *dst,        BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const size_t * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end);
+
     /// \brief Generic static eval stencils function with derivatives.
     ///        This function has a same signature as other device kernels
     ///        have so that it can be called in the same way from OsdMesh
@@ -179,6 +207,22 @@ public:
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
+        size_t const * largeOffsets = GetLargeStencilOffsets(stencilTable);
+        if (largeOffsets) {
+            return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                duBuffer->BindCpuBuffer(),  duDesc,
+                                dvBuffer->BindCpuBuffer(),  dvDesc,
+                                &stencilTable->GetSizes()[0],
+                                largeOffsets,
+                                &stencilTable->GetControlIndices()[0],
+                                &stencilTable->GetWeights()[0],
+                                &stencilTable->GetDuWeights()[0],
+                                &stencilTable->GetDvWeights()[0],
+                                /*start = */ 0,
+                                /*end   = */ stencilTable->GetNumStencils());
+        }
+
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
                             duBuffer->BindCpuBuffer(),  duDesc,
@@ -246,6 +290,122 @@ public:
         const float * dvWeights,
         int start, int end);
 
+    /// \brief Same as above, with the 64-bit offsets of stencil tables of
+    ///        more than 2^31 weights (see Far::StencilTable::HasLargeOffsets)
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const size_t * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end);
+
+    /// \brief Generic static fused eval stencils function. Evaluates the
+    ///        vertex and varying stencil tables of a mesh in a single
+    ///        traversal of the stencils (the varying table is expected to
+    ///        have the same number of stencils as the vertex table).
+    ///
+    /// With interleaved varying data, the source and destination buffers
+    /// of both tables are the same and each row is written once.
+    ///
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param varyingSrcBuffer Input varying primvar buffer.
+    ///
+    /// @param varyingSrcDesc   vertex buffer descriptor for the varying input
+    ///
+    /// @param varyingDstBuffer Output varying primvar buffer
+    ///
+    /// @param varyingDstDesc   vertex buffer descriptor for the varying output
+    ///
+    /// @param stencilTable     vertex stencil table
+    ///
+    /// @param varyingStencilTable  varying stencil table
+    ///
+    /// @param instance         not used in the cpu kernel
+    ///
+    /// @param deviceContext    not used in the cpu kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer,        BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,        BufferDescriptor const &dstDesc,
+        SRC_BUFFER *varyingSrcBuffer, BufferDescriptor const &varyingSrcDesc,
+        DST_BUFFER *varyingDstBuffer, BufferDescriptor const &varyingDstDesc,
+        STENCIL_TABLE const *stencilTable,
+        STENCIL_TABLE const *varyingStencilTable,
+        const CpuEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        if (varyingStencilTable->GetNumStencils() !=
+                stencilTable->GetNumStencils() or
+            GetLargeStencilOffsets(stencilTable) or
+            GetLargeStencilOffsets(varyingStencilTable)) {
+            return EvalStencils(srcBuffer, srcDesc, dstBuffer, dstDesc,
+                                stencilTable) and
+                   EvalStencils(varyingSrcBuffer, varyingSrcDesc,
+                                varyingDstBuffer, varyingDstDesc,
+                                varyingStencilTable);
+        }
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            varyingSrcBuffer->BindCpuBuffer(), varyingSrcDesc,
+                            varyingDstBuffer->BindCpuBuffer(), varyingDstDesc,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            &varyingStencilTable->GetSizes()[0],
+                            &varyingStencilTable->GetOffsets()[0],
+                            &varyingStencilTable->GetControlIndices()[0],
+                            &varyingStencilTable->GetWeights()[0],
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static fused eval stencils function, which takes raw CPU
+    ///        pointers for input and output (see above).
+    ///
+    /// The ranges [start, end) of both stencil tables are evaluated.
+    ///
+    static bool EvalStencils(
+        const float *src,        BufferDescriptor const &srcDesc,
+        float *dst,              BufferDescriptor const &dstDesc,
+        const float *varyingSrc, BufferDescriptor const &varyingSrcDesc,
+        float *varyingDst,       BufferDescriptor const &varyingDstDesc,
+        const int * sizes,
+        const int * offsets,
+        const int * indices,
+        const float * weights,
+        const int * varyingSizes,
+        const int * varyingOffsets,
+        const int * varyingIndices,
+        const float * varyingWeights,
+        int start, int end);
+
     /// ----------------------------------------------------------------------
     ///
     ///   Limit evaluations with PatchTable
@@ -458,6 +618,355 @@ public:
         const int *patchIndexBuffer,
         PatchParam const *patchParamBuffer);
 
+    /// \brief Generic varying limit eval function. This function has a
+    ///        same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// Varying primvars are interpolated bilinearly between the corners of
+    /// the patches, so that each location only gathers 4 values.
+    ///
+    /// @param srcBuffer        Input varying buffer, refined with varying
+    ///                         stencils (including the varying stencils of
+    ///                         the end cap local points, see
+    ///                         Far::PatchTable::GetLocalPointVaryingStencilTable())
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output varying buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesVarying(
+            srcBuffer->BindCpuBuffer(), srcDesc,
+            dstBuffer->BindCpuBuffer(), dstDesc,
+            numPatchCoords,
+            (const PatchCoord*)patchCoords->BindCpuBuffer(),
+            patchTable->GetPatchArrayBuffer(),
+            patchTable->GetPatchIndexBuffer(),
+            patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static varying limit eval function. It takes an array of
+    ///        PatchCoord and interpolates varying primvars bilinearly
+    ///        between the corner control vertices of the patches.
+    ///
+    /// Legacy Gregory patches (ENDCAP_LEGACY_GREGORY) have no control
+    /// vertices at their corners : the evaluation fails if any of the
+    /// PatchCoords is located on one of them.
+    ///
+    /// @param src                  Input varying pointer. An offset of
+    ///                             srcDesc will be applied internally.
+    ///
+    /// @param srcDesc              vertex buffer descriptor for the input
+    ///                             buffer
+    ///
+    /// @param dst                  Output varying pointer. An offset of
+    ///                             dstDesc will be applied internally.
+    ///
+    /// @param dstDesc              vertex buffer descriptor for the output
+    ///                             buffer
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param patchArrays          an array of Osd::PatchArray struct
+    ///                             indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer     an array of patch indices
+    ///                             indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesVarying(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer);
+
+    /// \brief Generic face-varying limit eval function. This function has a
+    ///        same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// The face-varying patches of Far::PatchTable are bilinear : the values
+    /// are interpolated bilinearly between the face-varying values of the
+    /// corners of the patches. Returns false for channels without patches
+    /// (see CpuPatchTable::GetFVarPatchArrayBuffer()).
+    ///
+    /// @param srcBuffer        Input face-varying buffer, indexed by the
+    ///                         face-varying values of the patch table (see
+    ///                         Far::PatchTable::GetFVarValues())
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output face-varying buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param fvarChannel      face-varying channel of the patch table
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    not used in the cpu evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesFaceVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        int fvarChannel = 0,
+        CpuEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesFaceVarying(
+            srcBuffer->BindCpuBuffer(), srcDesc,
+            dstBuffer->BindCpuBuffer(), dstDesc,
+            numPatchCoords,
+            (const PatchCoord*)patchCoords->BindCpuBuffer(),
+            patchTable->GetFVarPatchArrayBuffer(fvarChannel),
+            patchTable->GetFVarPatchIndexBuffer(fvarChannel),
+            patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static face-varying limit eval function. It takes an array of
+    ///        PatchCoord and interpolates the face-varying values of a
+    ///        channel of the PatchTable.
+    ///
+    /// @param src                  Input face-varying pointer. An offset of
+    ///                             srcDesc will be applied internally.
+    ///
+    /// @param srcDesc              vertex buffer descriptor for the input
+    ///                             buffer
+    ///
+    /// @param dst                  Output face-varying pointer. An offset of
+    ///                             dstDesc will be applied internally.
+    ///
+    /// @param dstDesc              vertex buffer descriptor for the output
+    ///                             buffer
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param fvarPatchArrays      an array of Osd::PatchArray struct of the
+    ///                             face-varying channel, indexed by
+    ///                             PatchCoord::arrayIndex
+    ///
+    /// @param fvarPatchIndexBuffer an array of face-varying value indices
+    ///                             of the channel
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesFaceVarying(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *fvarPatchArrays,
+        const int *fvarPatchIndexBuffer,
+        const PatchParam *patchParamBuffer);
+
+    /// \brief Static limit eval function evaluating the vertex and the
+    ///        face-varying values of the same PatchCoords in a single pass.
+    ///
+    /// Either evaluation is skipped if its input pointer is NULL.
+    ///
+    /// @param src                  Input vertex primvar pointer
+    ///
+    /// @param srcDesc              vertex buffer descriptor for src
+    ///
+    /// @param dst                  Output vertex primvar pointer
+    ///
+    /// @param dstDesc              vertex buffer descriptor for dst
+    ///
+    /// @param fvarSrc              Input face-varying pointer
+    ///
+    /// @param fvarSrcDesc          vertex buffer descriptor for fvarSrc
+    ///
+    /// @param fvarDst              Output face-varying pointer
+    ///
+    /// @param fvarDstDesc          vertex buffer descriptor for fvarDst
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param patchArrays          an array of Osd::PatchArray struct
+    ///                             indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer     an array of patch indices
+    ///                             indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    /// @param fvarPatchArrays      an array of Osd::PatchArray struct of the
+    ///                             face-varying channel
+    ///
+    /// @param fvarPatchIndexBuffer an array of face-varying value indices
+    ///                             of the channel
+    ///
+    static bool EvalPatches(
+        const float *src,     BufferDescriptor const &srcDesc,
+        float *dst,           BufferDescriptor const &dstDesc,
+        const float *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+        float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const PatchArray *fvarPatchArrays,
+        const int *fvarPatchIndexBuffer);
+
+    /// \brief Static limit eval function using the Bezier form of the
+    ///        regular patches (see Far::BezierPatchTable).
+    ///
+    /// The patches with Bezier points are evaluated in Bernstein form from
+    /// their 16 points, the other patches from their control vertices.
+    ///
+    /// @param src                Input primvar pointer, holding the Bezier
+    ///                           points after the vertices of the patch
+    ///                           table. An offset of srcDesc will be applied
+    ///                           internally.
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst                Output primvar pointer. An offset of dstDesc
+    ///                           will be applied internally.
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords     number of patchCoords.
+    ///
+    /// @param patchCoords        array of locations to be evaluated.
+    ///
+    /// @param patchArrays        an array of Osd::PatchArray struct
+    ///                           indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer   an array of patch indices
+    ///                           indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer   an array of Osd::PatchParam struct
+    ///                           indexed by PatchCoord::patchIndex
+    ///
+    /// @param bezierPointIndices the index of the first Bezier point of each
+    ///                           patch, or -1 (see
+    ///                           Far::BezierPatchTable::GetBezierPointIndexTable())
+    ///
+    static bool EvalPatchesBezier(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const int *bezierPointIndices);
+
+    /// \brief Static limit eval function with derivatives using the Bezier
+    ///        form of the regular patches (see Far::BezierPatchTable).
+    ///
+    /// @param src                Input primvar pointer, holding the Bezier
+    ///                           points after the vertices of the patch
+    ///                           table. An offset of srcDesc will be applied
+    ///                           internally.
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst                Output primvar pointer. An offset of dstDesc
+    ///                           will be applied internally.
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the output buffer
+    ///
+    /// @param du                 Output U-derivatives pointer. An offset of
+    ///                           duDesc will be applied internally.
+    ///
+    /// @param duDesc             vertex buffer descriptor for the du buffer
+    ///
+    /// @param dv                 Output V-derivatives pointer. An offset of
+    ///                           dvDesc will be applied internally.
+    ///
+    /// @param dvDesc             vertex buffer descriptor for the dv buffer
+    ///
+    /// @param numPatchCoords     number of patchCoords.
+    ///
+    /// @param patchCoords        array of locations to be evaluated.
+    ///
+    /// @param patchArrays        an array of Osd::PatchArray struct
+    ///                           indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer   an array of patch indices
+    ///                           indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer   an array of Osd::PatchParam struct
+    ///                           indexed by PatchCoord::patchIndex
+    ///
+    /// @param bezierPointIndices the index of the first Bezier point of each
+    ///                           patch, or -1 (see
+    ///                           Far::BezierPatchTable::GetBezierPointIndexTable())
+    ///
+    static bool EvalPatchesBezier(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const int *bezierPointIndices);
+
     /// ----------------------------------------------------------------------
     ///
     ///   Other methods
@@ -35,12 +35,14 @@ namespace Osd {
 
 CpuGLVertexBuffer::CpuGLVertexBuffer(int numElements, int numVertices)
     : _numElements(numElements), _numVertices(numVertices),
-      _vbo(0), _cpuBuffer(0), _dataDirty(true) {
+      _vbo(0), _cpuBuffer(0), _dataDirty(true), _ownsBuffer(true) {
 }
 
 CpuGLVertexBuffer::~CpuGLVertexBuffer() {
 
-    delete[] _cpuBuffer;
+    if (_ownsBuffer) {
+        delete[] _cpuBuffer;
+    }
 
     if (_vbo) {
         glDeleteBuffers(1, &_vbo);
@@ -56,13 +58,37 @@ CpuGLVertexBuffer::Create(int numElements, int numVertices, void *) {
     return NULL;
 }
 
+CpuGLVertexBuffer *
+CpuGLVertexBuffer::Create(float *cpuBuffer, int numElements, int numVertices) {
+
+    if (cpuBuffer == NULL) return NULL;
+
+    CpuGLVertexBuffer *instance =
+        new CpuGLVertexBuffer(numElements, numVertices);
+    instance->SetCpuBuffer(cpuBuffer);
+    return instance;
+}
+
 void
 CpuGLVertexBuffer::UpdateData(const float *src,
                               int startVertex, int numVertices,
                               void * /*deviceContext*/) {
 
-    memcpy(_cpuBuffer + startVertex * GetNumElements(), src,
-           GetNumElements() * numVertices * sizeof(float));
+    float *dst = _cpuBuffer + startVertex * GetNumElements();
+    if (dst != src) {
+        memcpy(dst, src, GetNumElements() * numVertices * sizeof(float));
+    }
+    _dataDirty = true;
+}
+
+void
+CpuGLVertexBuffer::SetCpuBuffer(float *cpuBuffer) {
+
+    if (_ownsBuffer) {
+        delete[] _cpuBuffer;
+    }
+    _cpuBuffer = cpuBuffer;
+    _ownsBuffer = false;
     _dataDirty = true;
 }
 
@@ -44,20 +44,34 @@ namespace Osd {
 /// The buffer interop between Cpu and GL is handled automatically when a
 /// client calls BindCpuBuffer and BindVBO methods.
 ///
+/// The cpu memory can be owned by the client (see CpuVertexBuffer) : primvar
+/// data written in place is then refined without being copied.
+///
 class CpuGLVertexBuffer {
 public:
     /// Creator. Returns NULL if error.
     static CpuGLVertexBuffer * Create(int numElements, int numVertices,
                                       void *deviceContext = NULL);
 
+    /// Creator wrapping client memory (zero-copy). The memory must hold
+    /// numElements * numVertices floats and outlive the buffer, which does
+    /// not release it. Returns NULL if error.
+    static CpuGLVertexBuffer * Create(float *cpuBuffer,
+                                      int numElements, int numVertices);
+
     /// Destructor.
     ~CpuGLVertexBuffer();
 
     /// This method is meant to be used in client code in order to provide
-    /// coarse vertices data to Osd.
+    /// coarse vertices data to Osd. Nothing is copied if src already points
+    /// to the vertices in the buffer (data written in place).
     void UpdateData(const float *src, int startVertex, int numVertices,
                     void *deviceContext = NULL);
 
+    /// Makes the cpu side of the buffer wrap client memory (see Create).
+    /// The storage allocated by the buffer, if any, is released.
+    void SetCpuBuffer(float *cpuBuffer);
+
     /// Returns how many elements defined in this vertex buffer.
     int GetNumElements() const;
 
@@ -85,6 +99,7 @@ private:
     GLuint _vbo;
     float *_cpuBuffer;
     bool _dataDirty;
+    bool _ownsBuffer;
 };
 
 }  // end namespace Osd
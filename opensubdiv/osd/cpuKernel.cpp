@@ -24,12 +24,17 @@
 
 #include "../osd/cpuKernel.h"
 #include "../osd/bufferDescriptor.h"
+#include "../far/patchBasis.h"
 
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <vector>
 
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -38,7 +43,7 @@ namespace Osd {
 template <class T> T *
 elementAtIndex(T * src, int index, BufferDescriptor const &desc) {
 
-    return src + index * desc.stride;
+    return src + (ptrdiff_t)index * desc.stride;
 }
 
 static inline void
@@ -92,15 +97,16 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
         srcDesc.stride == 4 and dstDesc.stride == 4) {
 
         // SIMD fast path for aligned primvar data (4 floats)
+        // (sizes, indices and weights are already offset to 'start')
         ComputeStencilKernel<4>(src, dst,
-            sizes, indices, weights, start,  end);
+            sizes, indices, weights, 0, end-start);
 
     } else if (srcDesc.length == 8 and dstDesc.length == 8 and
                srcDesc.stride == 8 and dstDesc.stride == 8) {
 
         // SIMD fast path for aligned primvar data (8 floats)
         ComputeStencilKernel<8>(src, dst,
-            sizes, indices, weights, start,  end);
+            sizes, indices, weights, 0, end-start);
     } else {
 
         // Slow path for non-aligned data
@@ -169,6 +175,475 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
     }
 }
 
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end) {
+
+    assert(start>=0 and start<end);
+
+    // the 32-bit kernel does not read the offsets of a range starting at 0
+    size_t offset = offsets[start];
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes + start, (int const *)NULL,
+                    indices + offset, weights + offset, 0, end-start);
+}
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end) {
+
+    assert(start>=0 and start<end);
+
+    size_t offset = offsets[start];
+
+    CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                    dstDu, dstDuDesc, dstDv, dstDvDesc,
+                    sizes + start, (int const *)NULL, indices + offset,
+                    weights + offset, duWeights + offset, dvWeights + offset,
+                    0, end-start);
+}
+
+void
+CpuEvalStencils(float const * src,        BufferDescriptor const &srcDesc,
+                float * dst,              BufferDescriptor const &dstDesc,
+                float const * varyingSrc, BufferDescriptor const &varyingSrcDesc,
+                float * varyingDst,       BufferDescriptor const &varyingDstDesc,
+                int const * sizes,
+                int const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * varyingSizes,
+                int const * varyingOffsets,
+                int const * varyingIndices,
+                float const * varyingWeights,
+                int start, int end) {
+
+    assert(start>=0 and start<end);
+
+    // rows holding only vertex or only varying data (length == stride) are
+    // not shared : the tables are evaluated separately, which takes the SIMD
+    // fast paths of aligned primvar data (4 or 8 floats)
+    if ((srcDesc.length == srcDesc.stride and
+         dstDesc.length == dstDesc.stride) or
+        (varyingSrcDesc.length == varyingSrcDesc.stride and
+         varyingDstDesc.length == varyingDstDesc.stride)) {
+
+        CpuEvalStencils(src, srcDesc, dst, dstDesc,
+                        sizes, offsets, indices, weights, start, end);
+        CpuEvalStencils(varyingSrc, varyingSrcDesc, varyingDst, varyingDstDesc,
+                        varyingSizes, varyingOffsets, varyingIndices,
+                        varyingWeights, start, end);
+        return;
+    }
+
+    if (start>0) {
+        sizes += start;
+        indices += offsets[start];
+        weights += offsets[start];
+        varyingSizes += start;
+        varyingIndices += varyingOffsets[start];
+        varyingWeights += varyingOffsets[start];
+    }
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+    varyingSrc += varyingSrcDesc.offset;
+    varyingDst += varyingDstDesc.offset;
+
+    // with interleaved varying data, the vertex and varying results of a
+    // stencil are written to the same row
+    float * result =
+        (float*)alloca((srcDesc.length + varyingSrcDesc.length) * sizeof(float));
+    float * varyingResult = result + srcDesc.length;
+
+    int nstencils = end-start;
+    for (int i=0; i<nstencils; ++i, ++sizes, ++varyingSizes) {
+
+        clear(result, srcDesc);
+        for (int j=0; j<*sizes; ++j) {
+            addWithWeight(result, src, *indices++, *weights++, srcDesc);
+        }
+
+        clear(varyingResult, varyingSrcDesc);
+        for (int j=0; j<*varyingSizes; ++j) {
+            addWithWeight(varyingResult, varyingSrc,
+                *varyingIndices++, *varyingWeights++, varyingSrcDesc);
+        }
+
+        copy(dst, i, result, dstDesc);
+        copy(varyingDst, i, varyingResult, varyingDstDesc);
+    }
+}
+
+int
+CpuGetPatchHullPoints(Far::PatchDescriptor::Type type,
+                      Far::PatchParam const & param,
+                      Far::ConstIndexArray const & cvs,
+                      float const * vertexData, BufferDescriptor const & desc,
+                      float points[20][3]) {
+
+    int n = cvs.size();
+    for (int i=0; i<n; ++i) {
+        float const * p =
+            elementAtIndex(vertexData + desc.offset, cvs[i], desc);
+        points[i][0] = p[0];
+        points[i][1] = p[1];
+        points[i][2] = p[2];
+    }
+
+    // see the boundary weights of Far::internal::GetBSplineWeights()
+    if (type == Far::PatchDescriptor::REGULAR) {
+        int boundary = param.GetBoundary();
+        for (int i=0; i<4; ++i) {
+            for (int k=0; k<3; ++k) {
+                if (boundary & 1) {
+                    points[i][k] = 2.0f*points[4+i][k] - points[8+i][k];
+                }
+                if (boundary & 4) {
+                    points[12+i][k] = 2.0f*points[8+i][k] - points[4+i][k];
+                }
+            }
+        }
+        for (int i=0; i<4; ++i) {
+            for (int k=0; k<3; ++k) {
+                if (boundary & 2) {
+                    points[4*i+3][k] =
+                        2.0f*points[4*i+2][k] - points[4*i+1][k];
+                }
+                if (boundary & 8) {
+                    points[4*i][k] = 2.0f*points[4*i+1][k] - points[4*i+2][k];
+                }
+            }
+        }
+    }
+    return n;
+}
+
+static bool
+hasVaryingCorners(int patchType) {
+
+    switch (patchType) {
+        case Far::PatchDescriptor::REGULAR:
+        case Far::PatchDescriptor::GREGORY_BASIS:
+        case Far::PatchDescriptor::EXTRAORDINARY_BASIS:
+        case Far::PatchDescriptor::QUADS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool
+CpuCheckVaryingPatchCoords(int numPatchCoords,
+                           PatchCoord const * patchCoords,
+                           PatchArray const * patchArrays) {
+
+    for (int i = 0; i < numPatchCoords; ++i) {
+        if (not hasVaryingCorners(
+            patchArrays[patchCoords[i].handle.arrayIndex].GetPatchType())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int
+CpuGetVaryingPatchWeights(PatchCoord const & coord,
+                          PatchArray const * patchArrays,
+                          int const * patchIndexBuffer,
+                          PatchParam const * patchParamBuffer,
+                          float wP[4], int cvs[4]) {
+
+    // control vertices at the corners of the patch domain : the varying
+    // stencils of the end cap points replicate the corner vertices
+    static int const regularCorners[4] = { 5, 6, 10, 9 },
+                     gregoryBasisCorners[4] = { 0, 5, 10, 15 },
+                     quadCorners[4] = { 0, 1, 2, 3 };
+
+    // the control vertices of extraordinary basis patches start with the
+    // 1-ring of the extraordinary vertex, at the corner of the patch domain
+    // stored in the boundary bits of the PatchParam
+    static int const extraordinaryBasisCorners[4][4] = {
+        { 0, 1, 2, 3 }, { 3, 0, 1, 2 }, { 2, 3, 0, 1 }, { 1, 2, 3, 0 } };
+
+    PatchArray const & array = patchArrays[coord.handle.arrayIndex];
+
+    int const * corners = NULL;
+    switch (array.GetPatchType()) {
+        case Far::PatchDescriptor::REGULAR:
+            corners = regularCorners; break;
+        case Far::PatchDescriptor::GREGORY_BASIS:
+            corners = gregoryBasisCorners; break;
+        case Far::PatchDescriptor::EXTRAORDINARY_BASIS:
+            corners = extraordinaryBasisCorners[
+                patchParamBuffer[coord.handle.patchIndex].GetBoundary() & 3];
+            break;
+        case Far::PatchDescriptor::QUADS:
+            corners = quadCorners; break;
+        default:
+            return 0;
+    }
+
+    float wDs[4], wDt[4];
+    Far::internal::GetBilinearWeights(patchParamBuffer[coord.handle.patchIndex],
+                                      coord.s, coord.t, wP, wDs, wDt);
+
+    int const * patchCvs =
+        patchIndexBuffer + array.GetIndexBase() + coord.handle.vertIndex;
+    for (int i = 0; i < 4; ++i) {
+        cvs[i] = patchCvs[corners[i]];
+    }
+    return 4;
+}
+
+int
+CpuGetFVarPatchWeights(PatchCoord const & coord,
+                       PatchArray const * fvarPatchArrays,
+                       int const * fvarPatchIndexBuffer,
+                       PatchParam const * patchParamBuffer,
+                       float wP[4], int const ** fvarValues) {
+
+    PatchArray const & array = fvarPatchArrays[coord.handle.arrayIndex];
+    if (array.GetPatchType() != Far::PatchDescriptor::QUADS) {
+        return 0;
+    }
+
+    // the face-varying patches cover the domain of the vertex patches
+    float wDs[4], wDt[4];
+    Far::internal::GetBilinearWeights(patchParamBuffer[coord.handle.patchIndex],
+                                      coord.s, coord.t, wP, wDs, wDt);
+
+    *fvarValues = fvarPatchIndexBuffer + array.GetIndexBase() +
+        (coord.handle.patchIndex - array.GetPrimitiveIdBase()) * 4;
+    return 4;
+}
+
+// Cubic Bernstein polynomials and their derivatives at t
+static inline void
+getBernsteinWeights(float t, float point[4], float deriv[4]) {
+
+    float tC = 1.0f - t;
+
+    point[0] = tC * tC * tC;
+    point[1] = 3.0f * tC * tC * t;
+    point[2] = 3.0f * tC * t * t;
+    point[3] = t * t * t;
+
+    deriv[0] = -3.0f * tC * tC;
+    deriv[1] =  3.0f * tC * (tC - 2.0f * t);
+    deriv[2] =  3.0f * t * (2.0f * tC - t);
+    deriv[3] =  3.0f * t * t;
+}
+
+void
+CpuEvalPatchesBezier(float const * src, BufferDescriptor const &srcDesc,
+                     float * dst,       BufferDescriptor const &dstDesc,
+                     float * du,        BufferDescriptor const &duDesc,
+                     float * dv,        BufferDescriptor const &dvDesc,
+                     PatchCoord const * patchCoords,
+                     PatchArray const * patchArrays,
+                     int const * patchIndexBuffer,
+                     PatchParam const * patchParamBuffer,
+                     int const * bezierPointIndices,
+                     int start, int end) {
+
+    bool derivatives = (du and dv);
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+    if (derivatives) {
+        du += duDesc.offset;
+        dv += dvDesc.offset;
+    }
+
+    int length = srcDesc.length,
+        stride = srcDesc.stride;
+
+    float wP[20], wDs[20], wDt[20];
+
+    for (int i = start; i < end; ++i) {
+        PatchCoord const & coord = patchCoords[i];
+        PatchParam const & param = patchParamBuffer[coord.handle.patchIndex];
+
+        float * p  = elementAtIndex(dst, i, dstDesc);
+        float * ds = derivatives ? elementAtIndex(du, i, duDesc) : 0;
+        float * dt = derivatives ? elementAtIndex(dv, i, dvDesc) : 0;
+
+        int bezierPoints = bezierPointIndices[coord.handle.patchIndex];
+        if (bezierPoints >= 0) {
+
+            float s = coord.s,
+                  t = coord.t;
+            param.Normalize(s, t);
+
+            float Bs[4], Ds[4], Bt[4], Dt[4];
+            getBernsteinWeights(s, Bs, Ds);
+            getBernsteinWeights(t, Bt, Dt);
+
+            float dScale = (float)(1 << param.GetDepth());
+
+            // reduce each row of 4 points in s, then the 4 rows in t
+            float const * points = elementAtIndex(src, bezierPoints, srcDesc);
+            for (int k = 0; k < length; ++k) {
+                float P = 0.0f, Ps = 0.0f, Pt = 0.0f;
+                for (int row = 0; row < 4; ++row) {
+                    float const * b = points + (ptrdiff_t)(4*row) * stride + k;
+                    float rowP = Bs[0] * b[0]        + Bs[1] * b[stride] +
+                                 Bs[2] * b[2*stride] + Bs[3] * b[3*stride];
+                    P += Bt[row] * rowP;
+                    if (derivatives) {
+                        float rowDs = Ds[0] * b[0]        + Ds[1] * b[stride] +
+                                      Ds[2] * b[2*stride] + Ds[3] * b[3*stride];
+                        Ps += Bt[row] * rowDs;
+                        Pt += Dt[row] * rowP;
+                    }
+                }
+                p[k] = P;
+                if (derivatives) {
+                    ds[k] = Ps * dScale;
+                    dt[k] = Pt * dScale;
+                }
+            }
+            continue;
+        }
+
+        PatchArray const & array = patchArrays[coord.handle.arrayIndex];
+        int const * cvs =
+            patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
+        int numControlVertices = 0;
+        switch (array.GetPatchType()) {
+        case Far::PatchDescriptor::REGULAR:
+            Far::internal::GetBSplineWeights(param,
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 16;
+            break;
+        case Far::PatchDescriptor::GREGORY_BASIS:
+            Far::internal::GetGregoryWeights(param,
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 20;
+            break;
+        case Far::PatchDescriptor::EXTRAORDINARY_BASIS:
+            Far::internal::GetExtraordinaryWeights(param,
+                Far::internal::GetExtraordinaryValence(cvs),
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 20;
+            break;
+        case Far::PatchDescriptor::QUADS:
+            Far::internal::GetBilinearWeights(param,
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 4;
+            break;
+        default:
+            assert(0);
+        }
+
+        clear(p, dstDesc);
+        if (derivatives) {
+            clear(ds, duDesc);
+            clear(dt, dvDesc);
+        }
+        for (int j = 0; j < numControlVertices; ++j) {
+            addWithWeight(p, src, cvs[j], wP[j], srcDesc);
+            if (derivatives) {
+                addWithWeight(ds, src, cvs[j], wDs[j], srcDesc);
+                addWithWeight(dt, src, cvs[j], wDt[j], srcDesc);
+            }
+        }
+    }
+}
+
+//
+// StencilPartition
+//
+
+// Default minimum number of weights in a chunk : below this, the cost of
+// scheduling a chunk is no longer negligible.
+static int const DEFAULT_STENCIL_GRAIN_SIZE = 2048;
+
+// Additional cost of each stencil (clearing and copying the result), in
+// number of weights
+static int const STENCIL_COST_OVERHEAD = 2;
+
+StencilPartition::StencilPartition(int const * sizes, int const * offsets,
+    int start, int end, int maxNumChunks, int grainSize) :
+        _sizes(sizes), _offsets(offsets), _largeOffsets(0),
+        _start(start), _end(end), _numChunks(1), _totalCost(0) {
+
+    initialize(maxNumChunks, grainSize);
+}
+
+StencilPartition::StencilPartition(int const * sizes, size_t const * offsets,
+    int start, int end, int maxNumChunks, int grainSize) :
+        _sizes(sizes), _offsets(0), _largeOffsets(offsets),
+        _start(start), _end(end), _numChunks(1), _totalCost(0) {
+
+    initialize(maxNumChunks, grainSize);
+}
+
+void
+StencilPartition::initialize(int maxNumChunks, int grainSize) {
+
+    assert(_start>=0 and _start<_end);
+
+    _totalCost = getCost(_end);
+
+    if (grainSize <= 0) grainSize = DEFAULT_STENCIL_GRAIN_SIZE;
+
+    size_t numChunks = _totalCost / (size_t)grainSize;
+    if (numChunks > (size_t)maxNumChunks) numChunks = (size_t)maxNumChunks;
+    if (numChunks > (size_t)(_end-_start)) numChunks = (size_t)(_end-_start);
+
+    _numChunks = numChunks > 1 ? (int)numChunks : 1;
+}
+
+inline size_t
+StencilPartition::getCost(int stencil) const {
+
+    // cumulative number of weights of the stencils in [start, stencil)
+    size_t numWeights = (stencil < _end) ?
+        getOffset(stencil) : getOffset(_end-1) + (size_t)_sizes[_end-1];
+
+    return numWeights - getOffset(_start) +
+        (size_t)(stencil - _start) * STENCIL_COST_OVERHEAD;
+}
+
+int
+StencilPartition::GetChunkBegin(int chunk) const {
+
+    if (chunk <= 0) return _start;
+    if (chunk >= _numChunks) return _end;
+
+    size_t target = (_totalCost * (size_t)chunk) / (size_t)_numChunks;
+
+    // first stencil whose cumulative cost reaches the target
+    int first = _start, last = _end;
+    while (first < last) {
+        int mid = first + (last - first) / 2;
+        if (getCost(mid) < target) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
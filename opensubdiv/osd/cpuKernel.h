@@ -26,6 +26,10 @@
 #define OPENSUBDIV3_OSD_CPU_KERNEL_H
 
 #include "../version.h"
+#include "../far/patchDescriptor.h"
+#include "../far/patchParam.h"
+#include "../osd/types.h"
+#include <cstddef>
 #include <cstring>
 
 namespace OpenSubdiv {
@@ -57,6 +61,145 @@ CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * dvWeights,
                 int start, int end);
 
+// 64-bit offsets (stencil tables of more than 2^31 weights) : the weights of
+// [start, end) are located once, and then walked as in the 32-bit kernels
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end);
+
+void
+CpuEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end);
+
+// Fused vertex + varying evaluation : both tables have the same number of
+// stencils, evaluated in a single traversal of the destination rows
+void
+CpuEvalStencils(float const * src,        BufferDescriptor const &srcDesc,
+                float * dst,              BufferDescriptor const &dstDesc,
+                float const * varyingSrc, BufferDescriptor const &varyingSrcDesc,
+                float * varyingDst,       BufferDescriptor const &varyingDstDesc,
+                int const * sizes,
+                int const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * varyingSizes,
+                int const * varyingOffsets,
+                int const * varyingIndices,
+                float const * varyingWeights,
+                int start, int end);
+
+// Gathers the positions (first 3 elements of the vertices) of the control
+// points of a patch, replacing the boundary points of regular patches with the
+// phantom points implied by their boundary weights : the limit surface is then
+// in the convex hull of the points. Returns the number of points.
+int
+CpuGetPatchHullPoints(Far::PatchDescriptor::Type type,
+                      Far::PatchParam const & param,
+                      Far::ConstIndexArray const & cvs,
+                      float const * vertexData, BufferDescriptor const & desc,
+                      float points[20][3]);
+
+// Computes the bilinear weights of the corners of the patch of a PatchCoord
+// for varying interpolation and gathers the indices of the corner control
+// vertices. Returns the number of corners (0 for unsupported patch types).
+int
+CpuGetVaryingPatchWeights(PatchCoord const & coord,
+                          PatchArray const * patchArrays,
+                          int const * patchIndexBuffer,
+                          PatchParam const * patchParamBuffer,
+                          float wP[4], int cvs[4]);
+
+// Returns false if the patch of any of the PatchCoords has no varying corners
+// (the legacy Gregory patches, whose control vertices are not at the corners
+// of the patch domain).
+bool
+CpuCheckVaryingPatchCoords(int numPatchCoords,
+                           PatchCoord const * patchCoords,
+                           PatchArray const * patchArrays);
+
+// Computes the bilinear weights of the face-varying patch of a PatchCoord and
+// locates its face-varying value indices. Returns the number of values (0 if
+// the face-varying patches are not quads).
+int
+CpuGetFVarPatchWeights(PatchCoord const & coord,
+                       PatchArray const * fvarPatchArrays,
+                       int const * fvarPatchIndexBuffer,
+                       PatchParam const * patchParamBuffer,
+                       float wP[4], int const ** fvarValues);
+
+// Evaluates the PatchCoords [start, end) : patches with Bezier points (see
+// Far::BezierPatchTable) are evaluated in Bernstein form from their 16 points,
+// the others from their control vertices and patch basis. The derivatives
+// are skipped if du or dv is NULL.
+void
+CpuEvalPatchesBezier(float const * src, BufferDescriptor const &srcDesc,
+                     float * dst,       BufferDescriptor const &dstDesc,
+                     float * du,        BufferDescriptor const &duDesc,
+                     float * dv,        BufferDescriptor const &dvDesc,
+                     PatchCoord const * patchCoords,
+                     PatchArray const * patchArrays,
+                     int const * patchIndexBuffer,
+                     PatchParam const * patchParamBuffer,
+                     int const * bezierPointIndices,
+                     int start, int end);
+
+//
+// Cost-aware partitioning of a range of stencils between threads (used by the
+// OpenMP and TBB kernels)
+//
+// The number of weights of stencils varies widely (stencils of extraordinary
+// vertices and end-cap points can be 100x larger than regular ones), so the
+// range [start, end) is split into chunks with a similar number of weights --
+// taken from the cumulative stencil offsets -- rather than of stencils.
+//
+class StencilPartition {
+public:
+    // Splits [start, end) in at most 'maxNumChunks' chunks of at least
+    // 'grainSize' weights (0 uses the default grain size)
+    StencilPartition(int const * sizes, int const * offsets,
+                     int start, int end, int maxNumChunks, int grainSize = 0);
+
+    // Same, with 64-bit offsets
+    StencilPartition(int const * sizes, size_t const * offsets,
+                     int start, int end, int maxNumChunks, int grainSize = 0);
+
+    int GetNumChunks() const { return _numChunks; }
+
+    // First stencil of the given chunk (chunk 'GetNumChunks()' returns 'end')
+    int GetChunkBegin(int chunk) const;
+
+private:
+    void initialize(int maxNumChunks, int grainSize);
+
+    size_t getOffset(int stencil) const {
+        return _largeOffsets ? _largeOffsets[stencil] : (size_t)_offsets[stencil];
+    }
+
+    size_t getCost(int stencil) const;
+
+    int const * _sizes;
+    int const * _offsets;
+    size_t const * _largeOffsets;
+    int _start,
+        _end,
+        _numChunks;
+    size_t _totalCost;
+};
+
 //
 // SIMD ICC optimization of the stencil kernel
 //
@@ -0,0 +1,1090 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuPatchBVH.h"
+#include "../osd/cpuKernel.h"
+#include "../far/error.h"
+#include "../far/patchTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+
+    //  Subdivision of the patches stops when the bounds of the sub-patches
+    //  are smaller than this fraction of the bounds of the patch (or after
+    //  maxSubdivisionDepth levels), the intersection is then refined with
+    //  Newton iterations on the limit surface.
+    float const leafFraction = 1.0f / 32.0f;
+    int const maxSubdivisionDepth = 10;
+    int const maxNewtonIterations = 8;
+    int const maxProjectionIterations = 16;
+
+    inline float const *
+    getVertex(float const * vertexData, BufferDescriptor const & desc,
+              Far::Index vertex) {
+        return vertexData + desc.offset + vertex * desc.stride;
+    }
+
+    inline void
+    clearBounds(float min[3], float max[3]) {
+        for (int k=0; k<3; ++k) {
+            min[k] =  FLT_MAX;
+            max[k] = -FLT_MAX;
+        }
+    }
+
+    inline void
+    addBounds(float min[3], float max[3],
+              float const pmin[3], float const pmax[3]) {
+        for (int k=0; k<3; ++k) {
+            min[k] = std::min(min[k], pmin[k]);
+            max[k] = std::max(max[k], pmax[k]);
+        }
+    }
+
+    //
+    //  Bicubic Bezier patch whose control points are bounded by boxes : the
+    //  interior points of Gregory patches vary with (s,t) between their two
+    //  face points. Since the de Casteljau weights are positive, subdividing
+    //  the minimum and maximum corners of the boxes independently bounds the
+    //  control points of the sub-patches.
+    //
+    struct BezierBounds {
+        float min[16][3],
+              max[16][3];
+
+        void GetBounds(float bmin[3], float bmax[3]) const {
+            clearBounds(bmin, bmax);
+            for (int i=0; i<16; ++i) {
+                addBounds(bmin, bmax, min[i], max[i]);
+            }
+        }
+    };
+
+    //  Converts the 4 B-spline points p[0], p[stride]... to Bezier points
+    inline void
+    convertBSplineToBezier(float (*p)[3], int stride) {
+        for (int k=0; k<3; ++k) {
+            float p0 = p[0][k],
+                  p1 = p[stride][k],
+                  p2 = p[2*stride][k],
+                  p3 = p[3*stride][k];
+            p[0][k]        = (p0 + 4.0f*p1 + p2) / 6.0f;
+            p[stride][k]   = (2.0f*p1 + p2) / 3.0f;
+            p[2*stride][k] = (p1 + 2.0f*p2) / 3.0f;
+            p[3*stride][k] = (p1 + 4.0f*p2 + p3) / 6.0f;
+        }
+    }
+
+    //  Splits the 4 points p[0], p[stride]... at tau : a gets the first part
+    //  and b the second part of the curve (both may alias p)
+    inline void
+    splitBezier(float const (*p)[3], float (*a)[3], float (*b)[3],
+                int stride, float tau) {
+        for (int k=0; k<3; ++k) {
+            float p0 = p[0][k],
+                  p1 = p[stride][k],
+                  p2 = p[2*stride][k],
+                  p3 = p[3*stride][k];
+            float p01 = p0 + tau*(p1-p0),
+                  p12 = p1 + tau*(p2-p1),
+                  p23 = p2 + tau*(p3-p2),
+                  p012 = p01 + tau*(p12-p01),
+                  p123 = p12 + tau*(p23-p12),
+                  mid = p012 + tau*(p123-p012);
+            if (a) {
+                a[0][k]        = p0;
+                a[stride][k]   = p01;
+                a[2*stride][k] = p012;
+                a[3*stride][k] = mid;
+            }
+            if (b) {
+                b[0][k]        = mid;
+                b[stride][k]   = p123;
+                b[2*stride][k] = p23;
+                b[3*stride][k] = p3;
+            }
+        }
+    }
+
+    //  Restricts the 4 points p[0], p[stride]... to [t0, t0+size]
+    inline void
+    restrictBezier(float (*p)[3], int stride, float t0, float size) {
+        float t1 = t0 + size;
+        if (t1 < 1.0f) {
+            splitBezier(p, p, 0, stride, t1);
+        }
+        if (t0 > 0.0f) {
+            splitBezier(p, 0, p, stride, t0 / t1);
+        }
+    }
+
+    //  Splits a patch into its 4 quadrants, numbered as (u,v) bits
+    void
+    splitBezierBounds(BezierBounds const & src, BezierBounds quadrants[4]) {
+
+        BezierBounds halves[2];
+        for (int i=0; i<4; ++i) {
+            splitBezier(src.min + 4*i,
+                halves[0].min + 4*i, halves[1].min + 4*i, 1, 0.5f);
+            splitBezier(src.max + 4*i,
+                halves[0].max + 4*i, halves[1].max + 4*i, 1, 0.5f);
+        }
+        for (int h=0; h<2; ++h) {
+            for (int j=0; j<4; ++j) {
+                splitBezier(halves[h].min + j,
+                    quadrants[h].min + j, quadrants[h+2].min + j, 4, 0.5f);
+                splitBezier(halves[h].max + j,
+                    quadrants[h].max + j, quadrants[h+2].max + j, 4, 0.5f);
+            }
+        }
+    }
+
+    //
+    //  Bezier bounds of the sub-domain [u,u+size]x[v,v+size] of a Gregory
+    //  patch : the interior points are the blends g*f+ + (1-g)*f- of their
+    //  face points, where the rational weights g of GetGregoryWeights() are
+    //  monotonic in s and t, so their range over the sub-domain bounds the
+    //  interior points. Unlike the subdivision of the bounds of the whole
+    //  patch, this converges to the surface as the sub-domains shrink.
+    //
+    void
+    getGregoryBezierBounds(float const points[20][3],
+                           float u, float v, float size,
+                           BezierBounds * bezier) {
+
+        //  See the layout of the Gregory points in GetGregoryWeights()
+        static int const boundaryGregory[12] =
+            { 0, 1, 7, 5, 2, 6, 16, 12, 15, 17, 11, 10 };
+        static int const boundaryBezier[12] =
+            { 0, 1, 2, 3, 4, 7,  8, 11, 12, 13, 14, 15 };
+        static int const interiorGregory[4] = { 3, 8, 13, 18 };
+        static int const interiorBezier[4] = { 5, 6, 10, 9 };
+
+        for (int i=0; i<12; ++i) {
+            for (int k=0; k<3; ++k) {
+                bezier->min[boundaryBezier[i]][k] =
+                bezier->max[boundaryBezier[i]][k] =
+                    points[boundaryGregory[i]][k];
+            }
+        }
+
+        //  Range of the weight g = a / (a + b) of the f+ point of each corner
+        float u1 = u + size, uC0 = 1.0f - u, uC1 = 1.0f - u1,
+              v1 = v + size, vC0 = 1.0f - v, vC1 = 1.0f - v1;
+        float gRange[4][2] = {
+            { u   / (u   + v1),   u1  / (u1  + v)   },
+            { v   / (v   + uC0),  v1  / (v1  + uC1) },
+            { uC1 / (uC1 + vC0),  uC0 / (uC0 + vC1) },
+            { vC1 / (vC1 + u1),   vC0 / (vC0 + u)   } };
+
+        for (int i=0; i<4; ++i) {
+            float const * fp = points[interiorGregory[i]],
+                        * fm = points[interiorGregory[i]+1];
+            for (int k=0; k<3; ++k) {
+                float p0 = fm[k] + gRange[i][0] * (fp[k] - fm[k]),
+                      p1 = fm[k] + gRange[i][1] * (fp[k] - fm[k]);
+                bezier->min[interiorBezier[i]][k] = std::min(p0, p1);
+                bezier->max[interiorBezier[i]][k] = std::max(p0, p1);
+            }
+        }
+
+        if (size < 1.0f) {
+            for (int i=0; i<4; ++i) {
+                restrictBezier(bezier->min + 4*i, 1, u, size);
+                restrictBezier(bezier->max + 4*i, 1, u, size);
+            }
+            for (int j=0; j<4; ++j) {
+                restrictBezier(bezier->min + j, 4, v, size);
+                restrictBezier(bezier->max + j, 4, v, size);
+            }
+        }
+    }
+
+    void
+    getBezierBounds(Far::PatchDescriptor::Type type,
+                    float points[20][3], BezierBounds * bezier) {
+
+        if (type == Far::PatchDescriptor::REGULAR) {
+            for (int i=0; i<4; ++i) {
+                convertBSplineToBezier(points + 4*i, 1);
+            }
+            for (int i=0; i<4; ++i) {
+                convertBSplineToBezier(points + i, 4);
+            }
+            std::copy(&points[0][0], &points[16][0], &bezier->min[0][0]);
+            std::copy(&points[0][0], &points[16][0], &bezier->max[0][0]);
+
+        } else if (type == Far::PatchDescriptor::GREGORY_BASIS) {
+            getGregoryBezierBounds(points, 0.0f, 0.0f, 1.0f, bezier);
+
+        } else {
+            //  Bilinear quad elevated to a bicubic
+            for (int i=0; i<4; ++i) {
+                float v = (float)i / 3.0f;
+                for (int j=0; j<4; ++j) {
+                    float u = (float)j / 3.0f;
+                    for (int k=0; k<3; ++k) {
+                        bezier->min[4*i+j][k] =
+                        bezier->max[4*i+j][k] =
+                            (1.0f-u)*(1.0f-v)*points[0][k] +
+                                  u *(1.0f-v)*points[1][k] +
+                                  u *      v *points[2][k] +
+                            (1.0f-u)*      v *points[3][k];
+                    }
+                }
+            }
+        }
+    }
+
+    struct Ray {
+        float origin[3],
+              direction[3],
+              invDirection[3];
+        float tMin;
+
+        Ray(float const o[3], float const d[3], float tmin) : tMin(tmin) {
+            for (int k=0; k<3; ++k) {
+                origin[k] = o[k];
+                direction[k] = d[k];
+                invDirection[k] = 1.0f / d[k];
+            }
+        }
+
+        //  Slab test : NaNs (rays parallel to and on a slab) are ignored
+        bool IntersectBox(float const min[3], float const max[3],
+                          float tMax, float * tNear) const {
+            float t0 = tMin,
+                  t1 = tMax;
+            for (int k=0; k<3; ++k) {
+                float tn = (min[k] - origin[k]) * invDirection[k],
+                      tf = (max[k] - origin[k]) * invDirection[k];
+                if (invDirection[k] < 0.0f) {
+                    std::swap(tn, tf);
+                }
+                if (tn > t0) t0 = tn;
+                if (tf < t1) t1 = tf;
+                if (t0 > t1) {
+                    return false;
+                }
+            }
+            *tNear = t0;
+            return true;
+        }
+    };
+
+    //  Distance from a point to a box
+    inline float
+    getBoxDistance(float const min[3], float const max[3], float const p[3]) {
+        float d2 = 0.0f;
+        for (int k=0; k<3; ++k) {
+            float d = std::max(0.0f, std::max(min[k] - p[k], p[k] - max[k]));
+            d2 += d * d;
+        }
+        return std::sqrt(d2);
+    }
+
+    //
+    //  Query of the limit surface of a patch : the (u,v) domain of the patch
+    //  is subdivided front to back, in the order of the distance of the
+    //  bounds of the sub-patches given by GetBoundsDistance(), and the
+    //  sub-patches that are small enough are refined on the limit surface
+    //
+    class PatchQuery {
+    public:
+        PatchQuery(Far::PatchTable const & table,
+                   Far::PatchTable::PatchHandle const & handle,
+                   float const * vertexData, BufferDescriptor const & desc) :
+            _table(table), _handle(handle), _vertexData(vertexData),
+            _desc(desc) {
+
+            _type = table.GetPatchArrayDescriptor(handle.arrayIndex).GetType();
+            _param = table.GetPatchParam(handle);
+            _cvs = table.GetPatchVertices(handle);
+        }
+
+        virtual ~PatchQuery() { }
+
+        //  Updates the hit if the query finds a closer location on the patch
+        bool Run(CpuPatchBVH::Hit * hit) {
+
+            CpuGetPatchHullPoints(_type, _param, _cvs, _vertexData, _desc,
+                                  _points);
+
+            BezierBounds bezier;
+            getBezierBounds(_type, _points, &bezier);
+
+            float min[3], max[3];
+            bezier.GetBounds(min, max);
+
+            float extent = std::max(max[0]-min[0],
+                std::max(max[1]-min[1], max[2]-min[2]));
+            _leafExtent = extent * leafFraction;
+            float scale = 0.0f;
+            for (int k=0; k<3; ++k) {
+                scale = std::max(scale,
+                    std::max(std::abs(min[k]), std::abs(max[k])));
+            }
+            _tolerance = 1e-5f * extent + 1e-6f * scale;
+            _hit = hit;
+            _found = false;
+
+            float distance;
+            if (GetBoundsDistance(min, max, &distance)) {
+                subdivide(bezier, min, max, distance, 0.0f, 0.0f, 1.0f, 0);
+            }
+            return _found;
+        }
+
+    protected:
+
+        //  Returns false if the bounds cannot contain a location closer than
+        //  the current hit, or the distance ordering the visit of the bounds
+        virtual bool GetBoundsDistance(float const min[3], float const max[3],
+                                       float * distance) const = 0;
+
+        //  Refines a location found by subdivision on the limit surface
+        virtual void Refine(float u, float v, float distance) = 0;
+
+        //  Evaluates the limit surface and its derivatives at (u,v)
+        void evaluate(float u, float v,
+                      float S[3], float Su[3], float Sv[3]) const {
+
+            float frac = _param.GetParamFraction(),
+                  dScale = (float)(1 << _param.GetDepth());
+
+            float wP[20], wDs[20], wDt[20];
+            _table.EvaluateBasis(_handle,
+                (_param.GetU() + u) * frac, (_param.GetV() + v) * frac,
+                wP, wDs, wDt);
+
+            for (int k=0; k<3; ++k) {
+                S[k] = Su[k] = Sv[k] = 0.0f;
+            }
+            for (int i=0; i<_cvs.size(); ++i) {
+                float const * p = getVertex(_vertexData, _desc, _cvs[i]);
+                for (int k=0; k<3; ++k) {
+                    S[k] += wP[i] * p[k];
+                    Su[k] += wDs[i] * p[k];
+                    Sv[k] += wDt[i] * p[k];
+                }
+            }
+            //  Derivatives with respect to the (u,v) domain of the patch
+            for (int k=0; k<3; ++k) {
+                Su[k] /= dScale;
+                Sv[k] /= dScale;
+            }
+        }
+
+        //  Sets the hit to the location (u,v) of the patch
+        void setHit(float u, float v, float distance) {
+
+            u = std::max(0.0f, std::min(1.0f, u));
+            v = std::max(0.0f, std::min(1.0f, v));
+
+            float frac = _param.GetParamFraction();
+            _hit->coord = PatchCoord(_handle,
+                (_param.GetU() + u) * frac, (_param.GetV() + v) * frac);
+            _hit->ptexFace = _param.GetFaceId();
+            _hit->distance = distance;
+            _found = true;
+        }
+
+        float _tolerance;
+        CpuPatchBVH::Hit * _hit;
+
+    private:
+
+        void subdivide(BezierBounds const & bezier,
+                       float const min[3], float const max[3], float distance,
+                       float u, float v, float size, int depth) {
+
+            float extent = std::max(max[0]-min[0],
+                std::max(max[1]-min[1], max[2]-min[2]));
+
+            if (extent <= _leafExtent or depth == maxSubdivisionDepth) {
+                Refine(u + 0.5f*size, v + 0.5f*size, distance);
+                return;
+            }
+
+            //  Visit the quadrants front to back
+            float half = 0.5f * size;
+
+            BezierBounds quadrants[4];
+            if (_type == Far::PatchDescriptor::GREGORY_BASIS) {
+                for (int q=0; q<4; ++q) {
+                    getGregoryBezierBounds(_points,
+                        u + ((q&1) ? half : 0.0f), v + ((q&2) ? half : 0.0f),
+                        half, &quadrants[q]);
+                }
+            } else {
+                splitBezierBounds(bezier, quadrants);
+            }
+
+            float qmin[4][3], qmax[4][3], qdistance[4];
+            int order[4], n = 0;
+            for (int q=0; q<4; ++q) {
+                quadrants[q].GetBounds(qmin[q], qmax[q]);
+                if (GetBoundsDistance(qmin[q], qmax[q], &qdistance[q])) {
+                    int i = n++;
+                    for (; i>0 and qdistance[order[i-1]] > qdistance[q]; --i) {
+                        order[i] = order[i-1];
+                    }
+                    order[i] = q;
+                }
+            }
+
+            for (int i=0; i<n; ++i) {
+                int q = order[i];
+                if (qdistance[q] > _hit->distance) {
+                    break;
+                }
+                subdivide(quadrants[q], qmin[q], qmax[q], qdistance[q],
+                    u + ((q&1) ? half : 0.0f), v + ((q&2) ? half : 0.0f),
+                    half, depth+1);
+            }
+        }
+
+        Far::PatchTable const & _table;
+        Far::PatchTable::PatchHandle const & _handle;
+        float const * _vertexData;
+        BufferDescriptor const & _desc;
+
+        Far::PatchDescriptor::Type _type;
+        Far::PatchParam _param;
+        Far::ConstIndexArray _cvs;
+        float _points[20][3];
+
+        float _leafExtent;
+        bool _found;
+    };
+
+    //
+    //  Intersection of a ray with a patch : the distance is the ray parameter
+    //
+    class RayPatchIntersector : public PatchQuery {
+    public:
+        RayPatchIntersector(Far::PatchTable const & table,
+                            Far::PatchTable::PatchHandle const & handle,
+                            float const * vertexData,
+                            BufferDescriptor const & desc,
+                            Ray const & ray) :
+            PatchQuery(table, handle, vertexData, desc), _ray(ray) { }
+
+    protected:
+
+        virtual bool GetBoundsDistance(float const min[3], float const max[3],
+                                       float * distance) const {
+            return _ray.IntersectBox(min, max, _hit->distance, distance);
+        }
+
+        //  Newton iterations solving S(u,v) = origin + d * direction
+        virtual void Refine(float u, float v, float d) {
+
+            for (int iteration=0; iteration<maxNewtonIterations; ++iteration) {
+
+                float F[3], Su[3], Sv[3];
+                evaluate(u, v, F, Su, Sv);
+
+                float residual = 0.0f;
+                for (int k=0; k<3; ++k) {
+                    F[k] -= _ray.origin[k] + d * _ray.direction[k];
+                    residual = std::max(residual, std::abs(F[k]));
+                }
+                if (residual <= _tolerance) {
+                    accept(u, v, d);
+                    return;
+                }
+
+                //  Solve [Su Sv -D] (du dv dd) = -F with Cramer's rule
+                float const * D = _ray.direction;
+                float c0[3] = { Sv[1]*D[2] - Sv[2]*D[1],
+                                Sv[2]*D[0] - Sv[0]*D[2],
+                                Sv[0]*D[1] - Sv[1]*D[0] },      // Sv x D
+                      c1[3] = { D[1]*Su[2] - D[2]*Su[1],
+                                D[2]*Su[0] - D[0]*Su[2],
+                                D[0]*Su[1] - D[1]*Su[0] },      // D x Su
+                      c2[3] = { Su[1]*Sv[2] - Su[2]*Sv[1],
+                                Su[2]*Sv[0] - Su[0]*Sv[2],
+                                Su[0]*Sv[1] - Su[1]*Sv[0] };    // Su x Sv
+
+                float det = -(Su[0]*c0[0] + Su[1]*c0[1] + Su[2]*c0[2]);
+                if (std::abs(det) < FLT_MIN) {
+                    return;
+                }
+
+                float inv = 1.0f / det,
+                      du =  (F[0]*c0[0] + F[1]*c0[1] + F[2]*c0[2]) * inv,
+                      dv =  (F[0]*c1[0] + F[1]*c1[1] + F[2]*c1[2]) * inv,
+                      dd = -(F[0]*c2[0] + F[1]*c2[1] + F[2]*c2[2]) * inv;
+                u += du;
+                v += dv;
+                d += dd;
+
+                if (u < -0.5f or u > 1.5f or v < -0.5f or v > 1.5f) {
+                    return;
+                }
+                if (std::max(std::abs(du), std::abs(dv)) < 1e-6f) {
+                    accept(u, v, d);
+                    return;
+                }
+            }
+        }
+
+    private:
+
+        void accept(float u, float v, float d) {
+
+            float const eps = 1e-4f;
+            if (u < -eps or u > 1.0f+eps or v < -eps or v > 1.0f+eps or
+                d < _ray.tMin or d >= _hit->distance) {
+                return;
+            }
+            setHit(u, v, d);
+        }
+
+        Ray const & _ray;
+    };
+
+    //
+    //  Closest point of a patch : the distance is the euclidean distance
+    //
+    class ClosestPointFinder : public PatchQuery {
+    public:
+        ClosestPointFinder(Far::PatchTable const & table,
+                           Far::PatchTable::PatchHandle const & handle,
+                           float const * vertexData,
+                           BufferDescriptor const & desc,
+                           float const point[3]) :
+            PatchQuery(table, handle, vertexData, desc), _point(point) { }
+
+    protected:
+
+        virtual bool GetBoundsDistance(float const min[3], float const max[3],
+                                       float * distance) const {
+            *distance = getBoxDistance(min, max, _point);
+            return *distance < _hit->distance;
+        }
+
+        //  Gauss-Newton iterations minimizing |S(u,v) - point|, clamped to
+        //  the domain of the patch, and halving the steps that do not
+        //  decrease the distance (the derivatives may vanish at the corners
+        //  of the patches) or that turn back on the previous one (the
+        //  curvature makes Gauss-Newton overshoot far from the surface)
+        virtual void Refine(float u, float v, float) {
+
+            float uBest = u,
+                  vBest = v,
+                  dBest = FLT_MAX,
+                  du = 0.0f,
+                  dv = 0.0f,
+                  duPrev = 0.0f,
+                  dvPrev = 0.0f;
+
+            for (int i=0; i<maxProjectionIterations; ++i) {
+
+                float F[3], Su[3], Sv[3];
+                evaluate(u, v, F, Su, Sv);
+
+                float d2 = 0.0f;
+                for (int k=0; k<3; ++k) {
+                    F[k] -= _point[k];
+                    d2 += F[k] * F[k];
+                }
+                float distance = std::sqrt(d2);
+
+                if (distance >= dBest) {
+                    du *= 0.5f;
+                    dv *= 0.5f;
+                } else {
+                    uBest = u;
+                    vBest = v;
+                    dBest = distance;
+                    if (distance < _hit->distance) {
+                        setHit(u, v, distance);
+                    }
+                    if (distance <= _tolerance) {
+                        return;
+                    }
+
+                    float a  = Su[0]*Su[0] + Su[1]*Su[1] + Su[2]*Su[2],
+                          b  = Su[0]*Sv[0] + Su[1]*Sv[1] + Su[2]*Sv[2],
+                          c  = Sv[0]*Sv[0] + Sv[1]*Sv[1] + Sv[2]*Sv[2],
+                          gu = Su[0]*F[0] + Su[1]*F[1] + Su[2]*F[2],
+                          gv = Sv[0]*F[0] + Sv[1]*F[1] + Sv[2]*F[2];
+
+                    float det = a*c - b*b;
+                    if (std::abs(det) < FLT_MIN) {
+                        return;
+                    }
+                    du = (b*gv - c*gu) / det;
+                    dv = (b*gu - a*gv) / det;
+
+                    //  Minimize along the boundaries of the domain the step
+                    //  would cross
+                    bool uClamped = (u <= 0.0f and du < 0.0f) or
+                                    (u >= 1.0f and du > 0.0f),
+                         vClamped = (v <= 0.0f and dv < 0.0f) or
+                                    (v >= 1.0f and dv > 0.0f);
+                    if (uClamped or vClamped) {
+                        float du1 = (a > FLT_MIN) ? -gu / a : 0.0f,
+                              dv1 = (c > FLT_MIN) ? -gv / c : 0.0f;
+                        bool uFree = not ((u <= 0.0f and du1 < 0.0f) or
+                                          (u >= 1.0f and du1 > 0.0f)),
+                             vFree = not ((v <= 0.0f and dv1 < 0.0f) or
+                                          (v >= 1.0f and dv1 > 0.0f));
+                        if (vClamped and uFree) {
+                            du = du1;
+                            dv = 0.0f;
+                        } else if (uClamped and vFree) {
+                            du = 0.0f;
+                            dv = dv1;
+                        } else {
+                            return;
+                        }
+                    }
+                    if (du*duPrev + dv*dvPrev < 0.0f) {
+                        du *= 0.5f;
+                        dv *= 0.5f;
+                    }
+                    duPrev = du;
+                    dvPrev = dv;
+                }
+
+                u = std::max(0.0f, std::min(1.0f, uBest + du));
+                v = std::max(0.0f, std::min(1.0f, vBest + dv));
+                if (std::max(std::abs(u-uBest), std::abs(v-vBest)) < 1e-6f) {
+                    return;
+                }
+            }
+        }
+
+    private:
+        float const * _point;
+    };
+
+    //  Probes of the hierarchy traversal : GetBoundsDistance() culls the
+    //  bounds that cannot contain a closer hit and Run() queries a patch
+    class RayProbe {
+    public:
+        RayProbe(float const origin[3], float const direction[3], float tMin) :
+            _ray(origin, direction, tMin) { }
+
+        bool GetBoundsDistance(float const min[3], float const max[3],
+                               float limit, float * distance) const {
+            return _ray.IntersectBox(min, max, limit, distance);
+        }
+
+        bool Run(Far::PatchTable const & table,
+                 Far::PatchTable::PatchHandle const & handle,
+                 float const * vertexData, BufferDescriptor const & desc,
+                 CpuPatchBVH::Hit * hit) const {
+            return RayPatchIntersector(
+                table, handle, vertexData, desc, _ray).Run(hit);
+        }
+
+    private:
+        Ray _ray;
+    };
+
+    class PointProbe {
+    public:
+        PointProbe(float const point[3]) : _point(point) { }
+
+        bool GetBoundsDistance(float const min[3], float const max[3],
+                               float limit, float * distance) const {
+            *distance = getBoxDistance(min, max, _point);
+            return *distance < limit;
+        }
+
+        bool Run(Far::PatchTable const & table,
+                 Far::PatchTable::PatchHandle const & handle,
+                 float const * vertexData, BufferDescriptor const & desc,
+                 CpuPatchBVH::Hit * hit) const {
+            return ClosestPointFinder(
+                table, handle, vertexData, desc, _point).Run(hit);
+        }
+
+    private:
+        float const * _point;
+    };
+
+    //  Orders patches by the centroid of their bounds along an axis
+    struct CentroidLess {
+        CentroidLess(float const * bounds, int axis) :
+            _bounds(bounds), _axis(axis) { }
+
+        bool operator()(int a, int b) const {
+            return (_bounds[6*a+_axis] + _bounds[6*a+3+_axis]) <
+                   (_bounds[6*b+_axis] + _bounds[6*b+3+_axis]);
+        }
+
+        float const * _bounds;
+        int _axis;
+    };
+
+    //  Range of patches of a node during the build
+    struct PatchRange {
+        int node, begin, end;
+    };
+
+}  // end namespace
+
+CpuPatchBVH::CpuPatchBVH(Far::PatchTable const & patchTable) :
+    _patchTable(patchTable), _vertexData(0) {
+}
+
+CpuPatchBVH *
+CpuPatchBVH::Create(Far::PatchTable const & patchTable,
+    float const * vertexData, BufferDescriptor const & vertexDesc,
+    int maxLeafSize) {
+
+    if ((not vertexData) or vertexDesc.length < 3) {
+        return NULL;
+    }
+
+    CpuPatchBVH * bvh = new CpuPatchBVH(patchTable);
+
+    bvh->_patches.reserve(patchTable.GetNumPatchesTotal());
+
+    for (int array=0, patch=0; array<patchTable.GetNumPatchArrays(); ++array) {
+
+        Far::PatchDescriptor desc = patchTable.GetPatchArrayDescriptor(array);
+        if (desc.GetType()==Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "CpuPatchBVH : extraordinary basis end caps are "
+                "not supported\n");
+            delete bvh;
+            return NULL;
+        }
+        if (desc.GetType()!=Far::PatchDescriptor::REGULAR and
+            desc.GetType()!=Far::PatchDescriptor::GREGORY_BASIS and
+            desc.GetType()!=Far::PatchDescriptor::QUADS) {
+            delete bvh;
+            return NULL;
+        }
+
+        int ncvs = desc.GetNumControlVertices();
+        for (int i=0; i<patchTable.GetNumPatches(array); ++i, ++patch) {
+            Far::PatchTable::PatchHandle handle;
+            handle.arrayIndex = array;
+            handle.patchIndex = patch;
+            handle.vertIndex = i * ncvs;
+            bvh->_patches.push_back(handle);
+        }
+    }
+
+    bvh->_vertexData = vertexData;
+    bvh->_vertexDesc = vertexDesc;
+    bvh->boundPatches();
+    bvh->build(std::max(1, maxLeafSize));
+    bvh->refitNodes();
+    return bvh;
+}
+
+void
+CpuPatchBVH::Refit(float const * vertexData,
+    BufferDescriptor const & vertexDesc) {
+
+    _vertexData = vertexData;
+    _vertexDesc = vertexDesc;
+    boundPatches();
+    refitNodes();
+}
+
+void
+CpuPatchBVH::boundPatches() {
+
+    int npatches = (int)_patches.size();
+    _patchBounds.resize(6*npatches);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int patch=0; patch<npatches; ++patch) {
+        Far::PatchTable::PatchHandle const & handle = _patches[patch];
+
+        Far::PatchDescriptor::Type type =
+            _patchTable.GetPatchArrayDescriptor(handle.arrayIndex).GetType();
+
+        float points[20][3];
+        CpuGetPatchHullPoints(type, _patchTable.GetPatchParam(handle),
+            _patchTable.GetPatchVertices(handle),
+            _vertexData, _vertexDesc, points);
+
+        BezierBounds bezier;
+        getBezierBounds(type, points, &bezier);
+
+        bezier.GetBounds(&_patchBounds[6*patch], &_patchBounds[6*patch+3]);
+    }
+}
+
+void
+CpuPatchBVH::build(int maxLeafSize) {
+
+    int npatches = (int)_patches.size();
+
+    std::vector<int> order(npatches);
+    for (int i=0; i<npatches; ++i) {
+        order[i] = i;
+    }
+
+    //  Split the patches at the median of their centroids along the longest
+    //  axis, the children of a node are allocated after their parent
+    std::vector<PatchRange> ranges;
+
+    _nodes.clear();
+    _nodes.reserve(npatches ? 2*((npatches+maxLeafSize-1)/maxLeafSize) : 1);
+    _nodes.push_back(Node());
+
+    PatchRange root = { 0, 0, npatches };
+    ranges.push_back(root);
+
+    while (not ranges.empty()) {
+        PatchRange range = ranges.back();
+        ranges.pop_back();
+
+        Node & node = _nodes[range.node];
+        node.first = range.begin;
+        node.count = range.end - range.begin;
+        if (node.count <= maxLeafSize) {
+            continue;
+        }
+
+        float min[3], max[3];
+        clearBounds(min, max);
+        for (int i=range.begin; i<range.end; ++i) {
+            float const * bounds = &_patchBounds[6*order[i]];
+            float centroid[3] = { bounds[0]+bounds[3],
+                                  bounds[1]+bounds[4],
+                                  bounds[2]+bounds[5] };
+            addBounds(min, max, centroid, centroid);
+        }
+        int axis = 0;
+        for (int k=1; k<3; ++k) {
+            if (max[k]-min[k] > max[axis]-min[axis]) {
+                axis = k;
+            }
+        }
+
+        int mid = (range.begin + range.end) / 2;
+        std::nth_element(order.begin() + range.begin, order.begin() + mid,
+            order.begin() + range.end, CentroidLess(&_patchBounds[0], axis));
+
+        int child = (int)_nodes.size();
+        node.first = child;
+        node.count = 0;
+        _nodes.resize(child + 2);
+
+        PatchRange left = { child, range.begin, mid },
+              right = { child+1, mid, range.end };
+        ranges.push_back(left);
+        ranges.push_back(right);
+    }
+
+    //  Reorder the patches so that the patches of a leaf are contiguous
+    std::vector<Far::PatchTable::PatchHandle> patches(npatches);
+    std::vector<float> patchBounds(6*npatches);
+    for (int i=0; i<npatches; ++i) {
+        patches[i] = _patches[order[i]];
+        std::copy(&_patchBounds[6*order[i]], &_patchBounds[6*order[i]] + 6,
+            &patchBounds[6*i]);
+    }
+    _patches.swap(patches);
+    _patchBounds.swap(patchBounds);
+}
+
+void
+CpuPatchBVH::refitNodes() {
+
+    //  Children are stored after their parent
+    for (int i=(int)_nodes.size()-1; i>=0; --i) {
+        Node & node = _nodes[i];
+        clearBounds(node.min, node.max);
+        if (node.count) {
+            for (int patch=node.first; patch<node.first+node.count; ++patch) {
+                float const * bounds = &_patchBounds[6*patch];
+                addBounds(node.min, node.max, bounds, bounds+3);
+            }
+        } else if (i != 0 or not _patches.empty()) {
+            for (int child=node.first; child<node.first+2; ++child) {
+                addBounds(node.min, node.max,
+                    _nodes[child].min, _nodes[child].max);
+            }
+        }
+    }
+}
+
+template <class PROBE> bool
+CpuPatchBVH::traverse(PROBE const & probe, Hit * hit) const {
+
+    bool found = false;
+
+    //  Front to back traversal, skipping the nodes behind the closest hit
+    struct Entry {
+        int node;
+        float distance;
+    };
+    Entry stack[64];
+    int size = 0;
+
+    float distance;
+    if ((not _patches.empty()) and probe.GetBoundsDistance(
+        _nodes[0].min, _nodes[0].max, hit->distance, &distance)) {
+        stack[size].node = 0;
+        stack[size].distance = distance;
+        ++size;
+    }
+
+    while (size) {
+        Entry entry = stack[--size];
+        if (entry.distance > hit->distance) {
+            continue;
+        }
+
+        Node const & node = _nodes[entry.node];
+        if (node.count) {
+            for (int patch=node.first; patch<node.first+node.count; ++patch) {
+                float const * bounds = &_patchBounds[6*patch];
+                if (probe.GetBoundsDistance(bounds, bounds+3,
+                    hit->distance, &distance)) {
+                    found |= probe.Run(_patchTable, _patches[patch],
+                        _vertexData, _vertexDesc, hit);
+                }
+            }
+        } else {
+            float distances[2];
+            bool hits[2];
+            for (int i=0; i<2; ++i) {
+                Node const & child = _nodes[node.first+i];
+                hits[i] = probe.GetBoundsDistance(child.min, child.max,
+                    hit->distance, &distances[i]);
+            }
+            //  Push the farthest child first
+            int first =
+                (hits[0] and hits[1] and distances[1] < distances[0]) ? 1 : 0;
+            for (int i=1; i>=0; --i) {
+                int c = first ^ i;
+                if (hits[c]) {
+                    stack[size].node = node.first+c;
+                    stack[size].distance = distances[c];
+                    ++size;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+bool
+CpuPatchBVH::Intersect(float const origin[3], float const direction[3],
+    float tMin, float tMax, Hit * hit) const {
+
+    hit->coord = PatchCoord();
+    hit->ptexFace = -1;
+    hit->distance = tMax;
+
+    if (not traverse(RayProbe(origin, direction, tMin), hit)) {
+        hit->distance = -1.0f;
+        return false;
+    }
+    return true;
+}
+
+int
+CpuPatchBVH::IntersectRays(int numRays, float const * origins,
+    float const * directions, float tMin, float tMax, Hit * hits) const {
+
+    int numHits = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:numHits)
+#endif
+    for (int i=0; i<numRays; ++i) {
+        if (Intersect(origins + 3*i, directions + 3*i, tMin, tMax, hits + i)) {
+            ++numHits;
+        }
+    }
+    return numHits;
+}
+
+bool
+CpuPatchBVH::FindClosestPoint(float const point[3], float maxDistance,
+    Hit * hit) const {
+
+    hit->coord = PatchCoord();
+    hit->ptexFace = -1;
+    hit->distance = maxDistance;
+
+    if (not traverse(PointProbe(point), hit)) {
+        hit->distance = -1.0f;
+        return false;
+    }
+    return true;
+}
+
+int
+CpuPatchBVH::FindClosestPoints(int numPoints, float const * points,
+    float maxDistance, Hit * hits) const {
+
+    int numFound = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:numFound)
+#endif
+    for (int i=0; i<numPoints; ++i) {
+        if (FindClosestPoint(points + 3*i, maxDistance, hits + i)) {
+            ++numFound;
+        }
+    }
+    return numFound;
+}
+
+void
+CpuPatchBVH::GetBounds(float min[3], float max[3]) const {
+
+    if (_patches.empty()) {
+        for (int k=0; k<3; ++k) {
+            min[k] = max[k] = 0.0f;
+        }
+    } else {
+        for (int k=0; k<3; ++k) {
+            min[k] = _nodes[0].min[k];
+            max[k] = _nodes[0].max[k];
+        }
+    }
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
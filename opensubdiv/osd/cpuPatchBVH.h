@@ -0,0 +1,228 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_PATCH_BVH_H
+#define OPENSUBDIV3_OSD_CPU_PATCH_BVH_H
+
+#include "../version.h"
+
+#include <vector>
+#include "../osd/bufferDescriptor.h"
+#include "../osd/types.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchTable;
+};
+
+namespace Osd {
+
+/// \brief Bounding volume hierarchy of the patches of a Far::PatchTable
+///
+/// CpuPatchBVH intersects rays with the limit surface of the patches directly,
+/// without tessellating them, and projects points onto the limit surface
+/// (closest point queries, returning the ptex face and (s,t) location of the
+/// projections).
+///
+/// The patches are bounded by their Bezier control points, which contain the
+/// limit surface, and the hierarchy only depends on the topology of the patch
+/// table : once the control points have been updated (typically
+/// with EvalStencils()), Refit() recomputes the bounds of the nodes without
+/// rebuilding the tree.
+///
+/// Rays are intersected with the patches by adaptive subdivision of their
+/// Bezier control points, followed by a few Newton iterations on the limit
+/// surface evaluated with Far::PatchTable::EvaluateBasis().
+///
+/// Regular B-spline, Gregory basis and bilinear (uniform) patches are
+/// supported.
+///
+class CpuPatchBVH {
+public:
+
+    /// \brief Location of the limit surface found by a query
+    struct Hit {
+        PatchCoord coord;   ///< patch handle and (s,t) location of the hit,
+                            ///< ready to be evaluated with EvalPatches()
+        int ptexFace;       ///< ptex face of the hit, the (s,t) location of
+                            ///< the coord being relative to this face (see
+                            ///< Far::PtexIndices)
+        float distance;     ///< ray parameter of a ray hit, or distance from
+                            ///< the point of a closest point query (negative
+                            ///< if nothing was found)
+    };
+
+    /// \brief Creates a hierarchy
+    ///
+    /// @param patchTable    Far::PatchTable, which must remain valid for the
+    ///                      lifetime of the hierarchy
+    ///
+    /// @param vertexData    Refined vertices and local points indexed by the
+    ///                      patches
+    ///
+    /// @param vertexDesc    Vertex buffer descriptor : the first 3 elements
+    ///                      are the positions
+    ///
+    /// @param maxLeafSize   Maximum number of patches per leaf
+    ///
+    /// @return              NULL if the table has patches that are not
+    ///                      supported (extraordinary basis end caps or
+    ///                      legacy Gregory patches)
+    ///
+    static CpuPatchBVH * Create(Far::PatchTable const & patchTable,
+                                float const * vertexData,
+                                BufferDescriptor const & vertexDesc,
+                                int maxLeafSize=4);
+
+    /// \brief Updates the bounds of the nodes after the vertices have moved
+    ///
+    /// The vertices must remain valid until the next call to Refit(), as
+    /// intersections evaluate the patches from them.
+    ///
+    /// \note The patches are bounded concurrently when OpenMP is available.
+    ///
+    void Refit(float const * vertexData, BufferDescriptor const & vertexDesc);
+
+    /// \brief Returns the closest intersection of a ray with the surface
+    ///
+    /// @param origin      Origin of the ray
+    ///
+    /// @param direction   Direction of the ray (not necessarily normalized)
+    ///
+    /// @param tMin        Minimum ray parameter of the intersection
+    ///
+    /// @param tMax        Maximum ray parameter of the intersection
+    ///
+    /// @param hit         Closest intersection (returned)
+    ///
+    /// @return            True if the ray intersects the surface
+    ///
+    bool Intersect(float const origin[3], float const direction[3],
+                   float tMin, float tMax, Hit * hit) const;
+
+    /// \brief Intersects a batch of rays with the surface
+    ///
+    /// \note The rays are processed concurrently when OpenMP is available.
+    ///
+    /// @param numRays     Number of rays
+    ///
+    /// @param origins     Origins of the rays (3 floats per ray)
+    ///
+    /// @param directions  Directions of the rays (3 floats per ray)
+    ///
+    /// @param tMin        Minimum ray parameter of the intersections
+    ///
+    /// @param tMax        Maximum ray parameter of the intersections
+    ///
+    /// @param hits        Closest intersection of each ray (returned)
+    ///
+    /// @return            Number of rays intersecting the surface
+    ///
+    int IntersectRays(int numRays, float const * origins,
+                      float const * directions, float tMin, float tMax,
+                      Hit * hits) const;
+
+    /// \brief Returns the closest point of the surface
+    ///
+    /// The closest point is found by projecting the point onto the patches
+    /// of the hierarchy that are within the search distance, using
+    /// Gauss-Newton iterations with the derivatives of the patches.
+    ///
+    /// @param point        Position to project onto the surface
+    ///
+    /// @param maxDistance  Maximum distance of the closest point
+    ///
+    /// @param hit          Closest point (returned)
+    ///
+    /// @return             True if the surface is within maxDistance
+    ///
+    bool FindClosestPoint(float const point[3], float maxDistance,
+                          Hit * hit) const;
+
+    /// \brief Returns the closest points of the surface of a batch of points
+    ///
+    /// \note The points are processed concurrently when OpenMP is available.
+    ///
+    /// @param numPoints    Number of points
+    ///
+    /// @param points       Positions to project (3 floats per point)
+    ///
+    /// @param maxDistance  Maximum distance of the closest points
+    ///
+    /// @param hits         Closest point of each point (returned)
+    ///
+    /// @return             Number of points within maxDistance of the surface
+    ///
+    int FindClosestPoints(int numPoints, float const * points,
+                          float maxDistance, Hit * hits) const;
+
+    /// \brief Returns the bounds of the surface
+    void GetBounds(float min[3], float max[3]) const;
+
+    /// \brief Returns the number of nodes of the hierarchy
+    int GetNumNodes() const { return (int)_nodes.size(); }
+
+    /// \brief Returns the number of patches of the hierarchy
+    int GetNumPatches() const { return (int)_patches.size(); }
+
+private:
+
+    CpuPatchBVH(Far::PatchTable const & patchTable);
+
+    struct Node {
+        float min[3],
+              max[3];
+        int   first,    // first child (interior) or first patch (leaf)
+              count;    // number of patches (0 for interior nodes)
+    };
+
+    void boundPatches();
+
+    void build(int maxLeafSize);
+
+    void refitNodes();
+
+    template <class PROBE> bool traverse(PROBE const & probe, Hit * hit) const;
+
+    Far::PatchTable const & _patchTable;
+
+    float const *    _vertexData;
+    BufferDescriptor _vertexDesc;
+
+    std::vector<Far::PatchTable::PatchHandle> _patches;
+    std::vector<float> _patchBounds;    // min & max of each patch
+    std::vector<Node>  _nodes;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_PATCH_BVH_H
@@ -0,0 +1,532 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuPatchCuller.h"
+#include "../osd/cpuKernel.h"
+#include "../far/error.h"
+#include "../far/patchTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+
+    float const pi = 3.14159265358979f;
+
+    //  Normals of unbounded cones : the axis is null and the half-angle
+    //  prevents backface culling
+    float const unboundedConeAngle = pi;
+
+    //  Slack added to the half-angle of the cones to absorb round-off errors
+    float const coneAngleEpsilon = 1e-3f;
+
+    inline float
+    dot(float const a[3], float const b[3]) {
+        return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    }
+
+    inline void
+    cross(float const a[3], float const b[3], float c[3]) {
+        c[0] = a[1]*b[2] - a[2]*b[1];
+        c[1] = a[2]*b[0] - a[0]*b[2];
+        c[2] = a[0]*b[1] - a[1]*b[0];
+    }
+
+    inline void
+    subtract(float const a[3], float const b[3], float c[3]) {
+        c[0] = a[0] - b[0];
+        c[1] = a[1] - b[1];
+        c[2] = a[2] - b[2];
+    }
+
+    inline void
+    setUnboundedCone(float cone[4]) {
+        cone[0] = cone[1] = cone[2] = 0.0f;
+        cone[3] = unboundedConeAngle;
+    }
+
+    //
+    //  The derivatives dP/du and dP/dv of the patches are combinations with
+    //  positive weights of differences of their control points (the
+    //  derivatives of the B-spline and bilinear bases), so that the normals
+    //  dP/du x dP/dv are combinations with positive weights of the cross
+    //  products of these differences : the cone bounding the cross products
+    //  bounds the normals.
+    //
+    void
+    boundNormals(float const (*du)[3], int numDu,
+                 float const (*dv)[3], int numDv, float cone[4]) {
+
+        float normals[144][3];
+        int numNormals = 0;
+
+        float axis[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i=0; i<numDu; ++i) {
+            for (int j=0; j<numDv; ++j) {
+                float * n = normals[numNormals];
+                cross(du[i], dv[j], n);
+
+                float length = std::sqrt(dot(n, n));
+                if (length < FLT_MIN) {
+                    continue;
+                }
+                for (int k=0; k<3; ++k) {
+                    n[k] /= length;
+                    axis[k] += n[k];
+                }
+                ++numNormals;
+            }
+        }
+
+        float length = std::sqrt(dot(axis, axis));
+        if (numNormals==0 or length < 1e-6f * numNormals) {
+            setUnboundedCone(cone);
+            return;
+        }
+
+        float minCosine = 1.0f;
+        for (int k=0; k<3; ++k) {
+            cone[k] = axis[k] / length;
+        }
+        for (int i=0; i<numNormals; ++i) {
+            minCosine = std::min(minCosine, dot(normals[i], cone));
+        }
+        cone[3] = std::acos(std::max(-1.0f, minCosine)) + coneAngleEpsilon;
+    }
+
+    void
+    getNormalCone(Far::PatchDescriptor::Type type,
+                  float const points[20][3], float cone[4]) {
+
+        float du[12][3],
+              dv[12][3];
+
+        switch (type) {
+            case Far::PatchDescriptor::REGULAR:
+                for (int i=0; i<4; ++i) {
+                    for (int j=0; j<3; ++j) {
+                        subtract(points[4*i+j+1], points[4*i+j], du[3*i+j]);
+                        subtract(points[4*(j+1)+i], points[4*j+i], dv[3*i+j]);
+                    }
+                }
+                boundNormals(du, 12, dv, 12, cone);
+                break;
+
+            case Far::PatchDescriptor::QUADS:
+                subtract(points[1], points[0], du[0]);
+                subtract(points[2], points[3], du[1]);
+                subtract(points[3], points[0], dv[0]);
+                subtract(points[2], points[1], dv[1]);
+                boundNormals(du, 2, dv, 2, cone);
+                break;
+
+            case Far::PatchDescriptor::TRIANGLES:
+                subtract(points[1], points[0], du[0]);
+                subtract(points[2], points[0], dv[0]);
+                boundNormals(du, 1, dv, 1, cone);
+                break;
+
+            default:
+                //  the rational weights of Gregory patches also contribute
+                //  to their derivatives
+                setUnboundedCone(cone);
+                break;
+        }
+    }
+
+    //  Column-major 4x4 matrix product
+    void
+    multiplyMatrix(float const a[16], float const b[16], float c[16]) {
+        for (int col=0; col<4; ++col) {
+            for (int row=0; row<4; ++row) {
+                c[4*col+row] = 0.0f;
+                for (int k=0; k<4; ++k) {
+                    c[4*col+row] += a[4*k+row] * b[4*col+k];
+                }
+            }
+        }
+    }
+
+    //  Returns the inverse of the 3x3 linear part of a column-major affine
+    //  matrix (row-major)
+    bool
+    invertLinearPart(float const m[16], float inv[3][3]) {
+        float a[3][3];
+        for (int row=0; row<3; ++row) {
+            for (int col=0; col<3; ++col) {
+                a[row][col] = m[4*col+row];
+            }
+        }
+        inv[0][0] = a[1][1]*a[2][2] - a[1][2]*a[2][1];
+        inv[0][1] = a[0][2]*a[2][1] - a[0][1]*a[2][2];
+        inv[0][2] = a[0][1]*a[1][2] - a[0][2]*a[1][1];
+        inv[1][0] = a[1][2]*a[2][0] - a[1][0]*a[2][2];
+        inv[1][1] = a[0][0]*a[2][2] - a[0][2]*a[2][0];
+        inv[1][2] = a[0][2]*a[1][0] - a[0][0]*a[1][2];
+        inv[2][0] = a[1][0]*a[2][1] - a[1][1]*a[2][0];
+        inv[2][1] = a[0][1]*a[2][0] - a[0][0]*a[2][1];
+        inv[2][2] = a[0][0]*a[1][1] - a[0][1]*a[1][0];
+
+        float det = a[0][0]*inv[0][0] + a[0][1]*inv[1][0] + a[0][2]*inv[2][0];
+        if (std::abs(det) < FLT_MIN) {
+            return false;
+        }
+        for (int row=0; row<3; ++row) {
+            for (int col=0; col<3; ++col) {
+                inv[row][col] /= det;
+            }
+        }
+        return true;
+    }
+
+    //
+    //  Camera in the space of the control points
+    //
+    class Camera {
+    public:
+        Camera(float const modelView[16], float const projection[16],
+               bool cullBackfaces) : _cullBackfaces(cullBackfaces) {
+
+            //  Clipping planes of the model-view-projection matrix, pointing
+            //  inside of the frustum
+            float m[16];
+            multiplyMatrix(projection, modelView, m);
+            for (int axis=0; axis<3; ++axis) {
+                for (int k=0; k<4; ++k) {
+                    _planes[2*axis  ][k] = m[4*k+3] + m[4*k+axis];
+                    _planes[2*axis+1][k] = m[4*k+3] - m[4*k+axis];
+                }
+            }
+
+            //  Eye position of perspective projections and view direction of
+            //  orthographic ones
+            float inv[3][3];
+            if (not invertLinearPart(modelView, inv)) {
+                _cullBackfaces = false;
+                return;
+            }
+            _perspective = (projection[11] != 0.0f);
+            for (int k=0; k<3; ++k) {
+                if (_perspective) {
+                    _eye[k] = -(inv[k][0]*modelView[12] +
+                                inv[k][1]*modelView[13] +
+                                inv[k][2]*modelView[14]);
+                } else {
+                    _eye[k] = -inv[k][2];
+                }
+            }
+            if (not _perspective) {
+                float length = std::sqrt(dot(_eye, _eye));
+                for (int k=0; k<3; ++k) {
+                    _eye[k] /= length;
+                }
+            }
+        }
+
+        bool IsVisible(float const bounds[6], float const cone[4]) const {
+            return IsInFrustum(bounds) and
+                   not (_cullBackfaces and IsBackfacing(bounds, cone));
+        }
+
+        bool IsInFrustum(float const bounds[6]) const {
+            float const * min = bounds,
+                        * max = bounds + 3;
+            for (int i=0; i<6; ++i) {
+                float const * plane = _planes[i];
+                float d = plane[3];
+                for (int k=0; k<3; ++k) {
+                    d += plane[k] * (plane[k] > 0.0f ? max[k] : min[k]);
+                }
+                if (d < 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //  The patch faces away from the camera if the angle between any
+        //  normal of the cone and any direction from the eye to the patch is
+        //  less than pi/2 : the directions from the eye to the bounding
+        //  sphere of the bounding box are in a cone of half-angle
+        //  asin(radius / distance).
+        bool IsBackfacing(float const bounds[6], float const cone[4]) const {
+
+            float angle = cone[3];
+            if (angle >= 0.5f*pi) {
+                return false;
+            }
+
+            float direction[3];
+            if (_perspective) {
+                float center[3], radius = 0.0f;
+                for (int k=0; k<3; ++k) {
+                    center[k] = 0.5f * (bounds[k] + bounds[3+k]);
+                    direction[k] = center[k] - _eye[k];
+                    float extent = 0.5f * (bounds[3+k] - bounds[k]);
+                    radius += extent * extent;
+                }
+                radius = std::sqrt(radius);
+
+                float distance = std::sqrt(dot(direction, direction));
+                if (distance <= radius) {
+                    return false;
+                }
+                angle += std::asin(radius / distance);
+                if (angle >= 0.5f*pi) {
+                    return false;
+                }
+                for (int k=0; k<3; ++k) {
+                    direction[k] /= distance;
+                }
+            } else {
+                for (int k=0; k<3; ++k) {
+                    direction[k] = _eye[k];
+                }
+            }
+            return dot(direction, cone) > std::sin(angle);
+        }
+
+    private:
+        float _planes[6][4],
+              _eye[3];
+        bool  _perspective,
+              _cullBackfaces;
+    };
+
+}  // end namespace
+
+CpuPatchCuller::CpuPatchCuller(Far::PatchTable const & patchTable) :
+    _patchTable(patchTable) {
+}
+
+CpuPatchCuller *
+CpuPatchCuller::Create(Far::PatchTable const & patchTable,
+    float const * vertexData, BufferDescriptor const & vertexDesc) {
+
+    if ((not vertexData) or vertexDesc.length < 3) {
+        return NULL;
+    }
+
+    CpuPatchCuller * culler = new CpuPatchCuller(patchTable);
+
+    culler->_patches.reserve(patchTable.GetNumPatchesTotal());
+
+    int numVertices = 0;
+    for (int array=0, patch=0; array<patchTable.GetNumPatchArrays(); ++array) {
+
+        Far::PatchDescriptor desc = patchTable.GetPatchArrayDescriptor(array);
+        if (desc.GetType()==Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "CpuPatchCuller : extraordinary basis end caps are "
+                "not supported\n");
+            delete culler;
+            return NULL;
+        }
+        if (desc.GetType()!=Far::PatchDescriptor::REGULAR and
+            desc.GetType()!=Far::PatchDescriptor::GREGORY_BASIS and
+            desc.GetType()!=Far::PatchDescriptor::QUADS and
+            desc.GetType()!=Far::PatchDescriptor::TRIANGLES) {
+            delete culler;
+            return NULL;
+        }
+
+        int ncvs = desc.GetNumControlVertices();
+        for (int i=0; i<patchTable.GetNumPatches(array); ++i, ++patch) {
+            Far::PatchTable::PatchHandle handle;
+            handle.arrayIndex = array;
+            handle.patchIndex = patch;
+            handle.vertIndex = i * ncvs;
+            culler->_patches.push_back(handle);
+
+            Far::ConstIndexArray cvs = patchTable.GetPatchVertices(handle);
+            for (int j=0; j<cvs.size(); ++j) {
+                numVertices = std::max(numVertices, cvs[j] + 1);
+            }
+        }
+    }
+
+    //  Patches using each vertex, for UpdateVertices()
+    int npatches = (int)culler->_patches.size();
+
+    std::vector<int> & offsets = culler->_vertexPatchOffsets;
+    offsets.assign(numVertices + 1, 0);
+    for (int patch=0; patch<npatches; ++patch) {
+        Far::ConstIndexArray cvs =
+            patchTable.GetPatchVertices(culler->_patches[patch]);
+        for (int j=0; j<cvs.size(); ++j) {
+            ++offsets[cvs[j] + 1];
+        }
+    }
+    for (int vert=0; vert<numVertices; ++vert) {
+        offsets[vert + 1] += offsets[vert];
+    }
+
+    std::vector<int> & patches = culler->_vertexPatches;
+    patches.resize(offsets[numVertices]);
+    std::vector<int> counts(offsets.begin(), offsets.end() - 1);
+    for (int patch=0; patch<npatches; ++patch) {
+        Far::ConstIndexArray cvs =
+            patchTable.GetPatchVertices(culler->_patches[patch]);
+        for (int j=0; j<cvs.size(); ++j) {
+            patches[counts[cvs[j]]++] = patch;
+        }
+    }
+
+    culler->_patchBounds.resize(6*npatches);
+    culler->_patchCones.resize(4*npatches);
+    culler->Update(vertexData, vertexDesc);
+    return culler;
+}
+
+void
+CpuPatchCuller::Update(float const * vertexData,
+    BufferDescriptor const & vertexDesc) {
+
+    boundPatches((int)_patches.size(), NULL, vertexData, vertexDesc);
+}
+
+int
+CpuPatchCuller::UpdateVertices(float const * vertexData,
+    BufferDescriptor const & vertexDesc, int start, int end) {
+
+    int numVertices = (int)_vertexPatchOffsets.size() - 1;
+    start = std::max(0, start);
+    end = std::min(numVertices, end);
+
+    //  A patch is usually shared by several of the vertices
+    std::vector<unsigned char> marked(_patches.size(), 0);
+    std::vector<int> patches;
+    for (int vert=start; vert<end; ++vert) {
+        for (int i=_vertexPatchOffsets[vert];
+                 i<_vertexPatchOffsets[vert+1]; ++i) {
+            int patch = _vertexPatches[i];
+            if (not marked[patch]) {
+                marked[patch] = 1;
+                patches.push_back(patch);
+            }
+        }
+    }
+
+    if (not patches.empty()) {
+        boundPatches((int)patches.size(), &patches[0],
+            vertexData, vertexDesc);
+    }
+    return (int)patches.size();
+}
+
+void
+CpuPatchCuller::boundPatches(int numPatches, int const * patchIndices,
+    float const * vertexData, BufferDescriptor const & vertexDesc) {
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i=0; i<numPatches; ++i) {
+        int patch = patchIndices ? patchIndices[i] : i;
+
+        Far::PatchTable::PatchHandle const & handle = _patches[patch];
+
+        Far::PatchDescriptor::Type type =
+            _patchTable.GetPatchArrayDescriptor(handle.arrayIndex).GetType();
+
+        float points[20][3];
+        int npoints = CpuGetPatchHullPoints(type,
+            _patchTable.GetPatchParam(handle),
+            _patchTable.GetPatchVertices(handle),
+            vertexData, vertexDesc, points);
+
+        float * bounds = &_patchBounds[6*patch];
+        for (int k=0; k<3; ++k) {
+            bounds[k]   =  FLT_MAX;
+            bounds[3+k] = -FLT_MAX;
+        }
+        for (int j=0; j<npoints; ++j) {
+            for (int k=0; k<3; ++k) {
+                bounds[k]   = std::min(bounds[k],   points[j][k]);
+                bounds[3+k] = std::max(bounds[3+k], points[j][k]);
+            }
+        }
+
+        getNormalCone(type, points, &_patchCones[4*patch]);
+    }
+}
+
+int
+CpuPatchCuller::Cull(float const modelViewMatrix[16],
+    float const projectionMatrix[16], bool cullBackfaces,
+    std::vector<Far::PatchTable::PatchHandle> * visiblePatches) {
+
+    Camera camera(modelViewMatrix, projectionMatrix, cullBackfaces);
+
+    int npatches = (int)_patches.size();
+    _visible.resize(npatches);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int patch=0; patch<npatches; ++patch) {
+        _visible[patch] = camera.IsVisible(
+            &_patchBounds[6*patch], &_patchCones[4*patch]);
+    }
+
+    int numVisible = 0;
+    if (visiblePatches) {
+        visiblePatches->clear();
+    }
+    for (int patch=0; patch<npatches; ++patch) {
+        if (_visible[patch]) {
+            if (visiblePatches) {
+                visiblePatches->push_back(_patches[patch]);
+            }
+            ++numVisible;
+        }
+    }
+    return numVisible;
+}
+
+int
+CpuPatchCuller::CullPatchCoords(int numPatchCoords,
+    PatchCoord const * patchCoords,
+    std::vector<PatchCoord> * visibleCoords) const {
+
+    visibleCoords->clear();
+    for (int i=0; i<numPatchCoords; ++i) {
+        if (IsPatchVisible(patchCoords[i].handle.patchIndex)) {
+            visibleCoords->push_back(patchCoords[i]);
+        }
+    }
+    return (int)visibleCoords->size();
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
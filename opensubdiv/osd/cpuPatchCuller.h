@@ -0,0 +1,210 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_PATCH_CULLER_H
+#define OPENSUBDIV3_OSD_CPU_PATCH_CULLER_H
+
+#include "../version.h"
+
+#include <vector>
+#include "../osd/bufferDescriptor.h"
+#include "../osd/types.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchTable;
+};
+
+namespace Osd {
+
+/// \brief View frustum and backface culling of the patches of a
+///        Far::PatchTable
+///
+/// CpuPatchCuller maintains conservative bounds of each patch, computed from
+/// the control points of the patches (the limit surface of B-spline, Gregory
+/// basis and bilinear patches is contained in the convex hull of their
+/// control points) :
+///
+///  - an axis-aligned bounding box
+///  - a cone containing the normals of the patch
+///
+/// Cull() tests the bounds against a camera and returns the compacted list
+/// of the patches that may be visible, so that EvalPatches() and draw calls
+/// can skip the patches that are outside of the view frustum or that face
+/// away from the camera.
+///
+/// The bounds are recomputed by Update() after the control points have been
+/// updated with EvalStencils(). When only a range of the vertices has been
+/// updated (e.g. by EvalStencils() with a range of stencils), UpdateVertices()
+/// recomputes the bounds of the patches that use these vertices only.
+///
+/// Regular B-spline, Gregory basis, bilinear and triangle (uniform) patches
+/// are supported. The normals of Gregory basis patches are not bounded : these
+/// patches are never backface culled.
+///
+class CpuPatchCuller {
+public:
+
+    /// \brief Creates a culler and computes the bounds of the patches
+    ///
+    /// \note The patches are bounded concurrently when OpenMP is available.
+    ///
+    /// @param patchTable    Far::PatchTable, which must remain valid for the
+    ///                      lifetime of the culler
+    ///
+    /// @param vertexData    Refined vertices and local points indexed by the
+    ///                      patches
+    ///
+    /// @param vertexDesc    Vertex buffer descriptor : the first 3 elements
+    ///                      are the positions
+    ///
+    /// @return              NULL if the table has patches that are not
+    ///                      supported (extraordinary basis end caps or
+    ///                      legacy Gregory patches)
+    ///
+    static CpuPatchCuller * Create(Far::PatchTable const & patchTable,
+                                   float const * vertexData,
+                                   BufferDescriptor const & vertexDesc);
+
+    /// \brief Recomputes the bounds of all the patches
+    ///
+    /// \note The patches are bounded concurrently when OpenMP is available.
+    ///
+    void Update(float const * vertexData, BufferDescriptor const & vertexDesc);
+
+    /// \brief Recomputes the bounds of the patches using a range of vertices
+    ///
+    /// Typically called after EvalStencils() has updated the range of
+    /// vertices [start, end) of the patch vertex buffer.
+    ///
+    /// \note The patches are bounded concurrently when OpenMP is available.
+    ///
+    /// @param vertexData    Refined vertices and local points indexed by the
+    ///                      patches
+    ///
+    /// @param vertexDesc    Vertex buffer descriptor : the first 3 elements
+    ///                      are the positions
+    ///
+    /// @param start         Index of the first updated vertex
+    ///
+    /// @param end           Index of the last updated vertex + 1
+    ///
+    /// @return              Number of patches updated
+    ///
+    int UpdateVertices(float const * vertexData,
+                       BufferDescriptor const & vertexDesc,
+                       int start, int end);
+
+    /// \brief Culls the patches outside of the view frustum of a camera
+    ///
+    /// The visibility of each patch is retained until the next call, for
+    /// IsPatchVisible() and CullPatchCoords().
+    ///
+    /// \note The patches are tested concurrently when OpenMP is available.
+    ///
+    /// @param modelViewMatrix   Column-major model-view matrix
+    ///
+    /// @param projectionMatrix  Column-major projection matrix (perspective or
+    ///                          orthographic)
+    ///
+    /// @param cullBackfaces     Also cull the patches facing away from the
+    ///                          camera : the front face of the patches is on
+    ///                          the side of their normals (dP/du x dP/dv)
+    ///
+    /// @param visiblePatches    Patches that may be visible, in the order of
+    ///                          the patch table (optional, returned)
+    ///
+    /// @return                  Number of patches that may be visible
+    ///
+    int Cull(float const modelViewMatrix[16],
+             float const projectionMatrix[16],
+             bool cullBackfaces,
+             std::vector<Far::PatchTable::PatchHandle> * visiblePatches=0);
+
+    /// \brief Returns true if a patch was found visible by the last Cull()
+    bool IsPatchVisible(int patchIndex) const {
+        return _visible.empty() or _visible[patchIndex];
+    }
+
+    /// \brief Compacts the locations on the visible patches
+    ///
+    /// @param numPatchCoords  Number of locations
+    ///
+    /// @param patchCoords     Locations to filter
+    ///
+    /// @param visibleCoords   Locations on the patches found visible by the
+    ///                        last Cull(), in the same order (returned)
+    ///
+    /// @return                Number of visible locations
+    ///
+    int CullPatchCoords(int numPatchCoords, PatchCoord const * patchCoords,
+                        std::vector<PatchCoord> * visibleCoords) const;
+
+    /// \brief Returns the bounding box of a patch (min[3] followed by max[3])
+    float const * GetPatchBounds(int patchIndex) const {
+        return &_patchBounds[6*patchIndex];
+    }
+
+    /// \brief Returns the normal cone of a patch (axis[3] followed by the
+    ///        half-angle of the cone in radians, larger than pi/2 if the
+    ///        normals are not bounded)
+    float const * GetPatchNormalCone(int patchIndex) const {
+        return &_patchCones[4*patchIndex];
+    }
+
+    /// \brief Returns the number of patches
+    int GetNumPatches() const { return (int)_patches.size(); }
+
+private:
+
+    CpuPatchCuller(Far::PatchTable const & patchTable);
+
+    void boundPatches(int numPatches, int const * patchIndices,
+                      float const * vertexData,
+                      BufferDescriptor const & vertexDesc);
+
+    Far::PatchTable const & _patchTable;
+
+    std::vector<Far::PatchTable::PatchHandle> _patches;
+
+    std::vector<float> _patchBounds,    // min & max of each patch
+                       _patchCones;     // axis & half-angle of each patch
+
+    std::vector<int> _vertexPatchOffsets,   // patches using each vertex
+                     _vertexPatches;
+
+    std::vector<unsigned char> _visible;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_PATCH_CULLER_H
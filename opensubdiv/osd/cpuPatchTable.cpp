@@ -23,6 +23,7 @@
 //
 
 #include "../osd/cpuPatchTable.h"
+#include "../far/error.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -97,6 +98,39 @@ CpuPatchTable::CpuPatchTable(const Far::PatchTable *farPatchTable) {
         }
 #endif
     }
+
+    // face-varying channels : the patches of a channel are in the order of
+    // the vertex patches, with a fixed number of values per patch. Only the
+    // bilinear quads of adaptive and uniform quad tables are evaluated : the
+    // channels of triangles are left empty.
+    int nFVarChannels = farPatchTable->GetNumFVarChannels();
+    _fvarPatchArrays.resize(nFVarChannels);
+    _fvarIndexBuffers.resize(nFVarChannels);
+    for (int channel = 0; channel < nFVarChannels; ++channel) {
+        Far::ConstIndexArray values = farPatchTable->GetFVarValues(channel);
+        if (numPatches == 0 or values.size() == 0) {
+            continue;
+        }
+        Far::PatchDescriptor desc(Far::PatchDescriptor::QUADS);
+
+        int nValues = values.size() / numPatches;
+        if (nValues != desc.GetNumFVarControlVertices()) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "CpuPatchTable : face-varying channel %d has triangle "
+                "patches, which are not supported\n", channel);
+            continue;
+        }
+        _fvarIndexBuffers[channel].assign(values.begin(), values.end());
+
+        _fvarPatchArrays[channel].reserve(nPatchArrays);
+        for (int j = 0; j < nPatchArrays; ++j) {
+            PatchArray const & patchArray = _patchArrays[j];
+            _fvarPatchArrays[channel].push_back(
+                PatchArray(desc, patchArray.GetNumPatches(),
+                           patchArray.GetPrimitiveIdBase() * nValues,
+                           patchArray.GetPrimitiveIdBase()));
+        }
+    }
 }
 
 }  // end namespace Osd
@@ -85,10 +85,42 @@ public:
         return _patchParamBuffer.size();
     }
 
+    /// \brief Returns the number of face-varying channels
+    int GetNumFVarChannels() const {
+        return (int)_fvarPatchArrays.size();
+    }
+
+    /// \brief Returns the face-varying patch arrays of a channel : one array
+    ///        of bilinear patches for each patch array of the table, sharing
+    ///        the patch params of the vertex patches
+    ///
+    /// NULL if the channel has no patches, or triangle patches (uniform
+    /// tables of triangulated quads or Loop meshes), which are rejected when
+    /// the table is built.
+    ///
+    const PatchArray *GetFVarPatchArrayBuffer(int fvarChannel = 0) const {
+        return _fvarPatchArrays[fvarChannel].empty() ?
+            NULL : &_fvarPatchArrays[fvarChannel][0];
+    }
+
+    /// \brief Returns the face-varying value indices of a channel (NULL if
+    ///        the channel has no patches)
+    const int *GetFVarPatchIndexBuffer(int fvarChannel = 0) const {
+        return _fvarIndexBuffers[fvarChannel].empty() ?
+            NULL : &_fvarIndexBuffers[fvarChannel][0];
+    }
+
+    size_t GetFVarPatchIndexSize(int fvarChannel = 0) const {
+        return _fvarIndexBuffers[fvarChannel].size();
+    }
+
 protected:
     PatchArrayVector _patchArrays;
     std::vector<int> _indexBuffer;
     PatchParamVector _patchParamBuffer;
+
+    std::vector<PatchArrayVector> _fvarPatchArrays;
+    std::vector<std::vector<int> > _fvarIndexBuffers;
 };
 
 }  // end namespace Osd
@@ -0,0 +1,119 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuRingVertexBuffer.h"
+
+#include <cassert>
+#include <string.h>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+CpuRingVertexBuffer::CpuRingVertexBuffer(int numElements, int numVertices,
+                                         int numSlots)
+    : _numElements(numElements),
+      _numVertices(numVertices),
+      _numSlots(numSlots),
+      _currentSlot(0),
+      _cpuBuffer(NULL) {
+
+    // slots are contiguous : the rows of the whole ring are allocated at once
+    _cpuBuffer = new float[numElements * numVertices * numSlots];
+}
+
+CpuRingVertexBuffer::~CpuRingVertexBuffer() {
+
+    delete[] _cpuBuffer;
+}
+
+CpuRingVertexBuffer *
+CpuRingVertexBuffer::Create(int numElements, int numVertices,
+                            void * /*deviceContext*/, int numSlots) {
+
+    if (numSlots < 1) return NULL;
+
+    return new CpuRingVertexBuffer(numElements, numVertices, numSlots);
+}
+
+void
+CpuRingVertexBuffer::UpdateData(const float *src, int startVertex,
+                                int numVertices, void * /*deviceContext*/) {
+
+    memcpy(BindCpuBuffer() + startVertex * _numElements,
+           src, GetNumElements() * numVertices * sizeof(float));
+}
+
+int
+CpuRingVertexBuffer::GetNumElements() const {
+
+    return _numElements;
+}
+
+int
+CpuRingVertexBuffer::GetNumVertices() const {
+
+    return _numVertices;
+}
+
+int
+CpuRingVertexBuffer::GetNumSlots() const {
+
+    return _numSlots;
+}
+
+int
+CpuRingVertexBuffer::GetCurrentSlot() const {
+
+    return _currentSlot;
+}
+
+int
+CpuRingVertexBuffer::Advance() {
+
+    int slot = _currentSlot;
+    _currentSlot = (_currentSlot + 1) % _numSlots;
+    return slot;
+}
+
+float*
+CpuRingVertexBuffer::BindCpuBuffer() {
+
+    return BindCpuBuffer(_currentSlot);
+}
+
+float*
+CpuRingVertexBuffer::BindCpuBuffer(int slot) {
+
+    assert(slot >= 0 and slot < _numSlots);
+    return _cpuBuffer + slot * _numElements * _numVertices;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
+
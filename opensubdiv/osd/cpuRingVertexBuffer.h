@@ -0,0 +1,121 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_RING_VERTEX_BUFFER_H
+#define OPENSUBDIV3_OSD_CPU_RING_VERTEX_BUFFER_H
+
+#include "../version.h"
+
+#include <cstddef>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+/// \brief Multi-buffered vertex buffer class for cpu subdivision.
+///
+/// CpuRingVertexBuffer holds a ring of identical vertex buffers (slots) so
+/// that the upload of the coarse vertices of a frame, the refinement of the
+/// previous frame and the consumption of the results of an older frame can
+/// run concurrently, each stage working on its own slot.
+///
+/// UpdateData() and BindCpuBuffer() address the current slot, so that an
+/// instance can be passed to the evaluators (or used in an Osd::Mesh) like
+/// a CpuVertexBuffer. Advance() moves to the next slot once the evaluations
+/// of the current one have been issued.
+///
+/// The buffer does not synchronize anything by itself : the client must
+/// ensure that the evaluations of a slot are complete before it is read or
+/// uploaded again (see TbbEvalQueue).
+///
+class CpuRingVertexBuffer {
+public:
+    /// Creator. Returns NULL if error.
+    ///
+    /// @param numElements    number of elements of each vertex
+    ///
+    /// @param numVertices    number of vertices of each slot
+    ///
+    /// @param deviceContext  not used
+    ///
+    /// @param numSlots       number of slots (2 for double buffering,
+    ///                       3 for triple buffering)
+    ///
+    static CpuRingVertexBuffer * Create(int numElements, int numVertices,
+                                        void *deviceContext = NULL,
+                                        int numSlots = 3);
+
+    /// Destructor.
+    ~CpuRingVertexBuffer();
+
+    /// This method is meant to be used in client code in order to provide
+    /// coarse vertices data of the current slot to Osd.
+    void UpdateData(const float *src, int startVertex, int numVertices,
+                    void *deviceContext = NULL);
+
+    /// Returns how many elements defined in this vertex buffer.
+    int GetNumElements() const;
+
+    /// Returns how many vertices allocated in each slot.
+    int GetNumVertices() const;
+
+    /// Returns the number of slots
+    int GetNumSlots() const;
+
+    /// Returns the index of the current slot
+    int GetCurrentSlot() const;
+
+    /// Makes the next slot current and returns the index of the previous
+    /// one (the slot whose evaluations have just been issued)
+    int Advance();
+
+    /// Returns the address of the current slot
+    float * BindCpuBuffer();
+
+    /// Returns the address of the given slot
+    float * BindCpuBuffer(int slot);
+
+protected:
+    /// Constructor.
+    CpuRingVertexBuffer(int numElements, int numVertices, int numSlots);
+
+private:
+    int _numElements;
+    int _numVertices;
+    int _numSlots;
+    int _currentSlot;
+    float *_cpuBuffer;
+};
+
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_RING_VERTEX_BUFFER_H
@@ -0,0 +1,536 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuSharedTableStore.h"
+#include "../osd/cpuPatchTable.h"
+#include "../far/patchTable.h"
+#include "../far/stencilTable.h"
+
+#include <climits>
+#include <cstring>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+//
+// Segment layout
+//
+// The segment starts with a header locating each array by its offset from
+// the start of the segment (0 for absent arrays). Arrays are aligned on
+// cache lines.
+//
+// Stencil offsets are stored as int, or as size_t for tables of more than
+// 2^31 weights.
+//
+// The header version is written last, with release semantics : a segment
+// attached while it is being published is rejected, and once the version is
+// read (with acquire semantics) the rest of the segment is visible.
+//
+namespace {
+
+char const SEGMENT_MAGIC[8] = { 'O', 'S', 'D', 'T', 'A', 'B', 'L', 0 };
+int const SEGMENT_VERSION = 2;
+size_t const SEGMENT_ALIGNMENT = 64;
+
+struct StencilSection {
+    int numStencils,
+        numControlVertices,
+        largeOffsets;
+    size_t numWeights;
+    size_t sizes, offsets, indices, weights;
+};
+
+struct PatchSection {
+    size_t numPatchArrays,
+           numIndices,
+           numPatchParams;
+    size_t patchArrays, indices, patchParams;
+};
+
+struct SegmentHeader {
+    char magic[8];
+    int version;
+    int pointerSize;
+    size_t size;
+    StencilSection vertexStencils,
+                   varyingStencils;
+    PatchSection patches;
+};
+
+void
+storeVersion(SegmentHeader * header, int version) {
+#if defined(_MSC_VER)
+    _WriteBarrier();
+    *(int volatile *)&header->version = version;
+#else
+    __atomic_store_n(&header->version, version, __ATOMIC_RELEASE);
+#endif
+}
+
+int
+loadVersion(SegmentHeader const * header) {
+#if defined(_MSC_VER)
+    int version = *(int const volatile *)&header->version;
+    _ReadBarrier();
+    return version;
+#else
+    return __atomic_load_n(&header->version, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// reserves an aligned block in the segment
+size_t
+reserve(size_t & cursor, size_t numBytes) {
+    if (numBytes == 0) return 0;
+    size_t offset = (cursor + SEGMENT_ALIGNMENT - 1) & ~(SEGMENT_ALIGNMENT - 1);
+    cursor = offset + numBytes;
+    return offset;
+}
+
+void
+layoutStencils(Far::StencilTable const * table,
+               StencilSection & section, size_t & cursor) {
+
+    memset(&section, 0, sizeof(section));
+    if (not table or table->GetNumStencils() == 0) return;
+
+    int numStencils = table->GetNumStencils();
+
+    section.numStencils = numStencils;
+    section.numControlVertices = table->GetNumControlVertices();
+    section.numWeights = table->GetControlIndices().size();
+    section.largeOffsets = section.numWeights > (size_t)INT_MAX;
+    section.sizes = reserve(cursor, numStencils * sizeof(int));
+    section.offsets = reserve(cursor, numStencils *
+        (section.largeOffsets ? sizeof(size_t) : sizeof(int)));
+    section.indices = reserve(cursor, section.numWeights * sizeof(int));
+    section.weights = reserve(cursor, section.numWeights * sizeof(float));
+}
+
+void
+writeStencils(Far::StencilTable const * table,
+              StencilSection const & section, char * base) {
+
+    if (section.numStencils == 0) return;
+
+    int numStencils = section.numStencils;
+
+    memcpy(base + section.sizes, &table->GetSizes()[0],
+        numStencils * sizeof(int));
+
+    // offsets are always stored (the evaluators require them)
+    if (section.largeOffsets) {
+        size_t * offsets = (size_t *)(base + section.offsets);
+        if (table->HasLargeOffsets()) {
+            memcpy(offsets, &table->GetLargeOffsets()[0],
+                numStencils * sizeof(size_t));
+        } else {
+            int const * sizes = &table->GetSizes()[0];
+            size_t offset = 0;
+            for (int i = 0; i < numStencils; ++i) {
+                offsets[i] = offset;
+                offset += sizes[i];
+            }
+        }
+    } else {
+        int * offsets = (int *)(base + section.offsets);
+        if (not table->GetOffsets().empty()) {
+            memcpy(offsets, &table->GetOffsets()[0], numStencils * sizeof(int));
+        } else {
+            int const * sizes = &table->GetSizes()[0];
+            for (int i = 0, offset = 0; i < numStencils; ++i) {
+                offsets[i] = offset;
+                offset += sizes[i];
+            }
+        }
+    }
+
+    if (section.numWeights) {
+        memcpy(base + section.indices, &table->GetControlIndices()[0],
+            section.numWeights * sizeof(int));
+        memcpy(base + section.weights, &table->GetWeights()[0],
+            section.numWeights * sizeof(float));
+    }
+}
+
+void
+layoutPatches(CpuPatchTable const * table,
+              PatchSection & section, size_t & cursor) {
+
+    memset(&section, 0, sizeof(section));
+    if (not table) return;
+
+    section.numPatchArrays = table->GetNumPatchArrays();
+    section.numIndices = table->GetPatchIndexSize();
+    section.numPatchParams = table->GetPatchParamSize();
+    section.patchArrays =
+        reserve(cursor, section.numPatchArrays * sizeof(PatchArray));
+    section.indices =
+        reserve(cursor, section.numIndices * sizeof(int));
+    section.patchParams =
+        reserve(cursor, section.numPatchParams * sizeof(PatchParam));
+}
+
+void
+writePatches(CpuPatchTable const * table,
+             PatchSection const & section, char * base) {
+
+    if (section.patchArrays) {
+        memcpy(base + section.patchArrays, table->GetPatchArrayBuffer(),
+            section.numPatchArrays * sizeof(PatchArray));
+    }
+    if (section.indices) {
+        memcpy(base + section.indices, table->GetPatchIndexBuffer(),
+            section.numIndices * sizeof(int));
+    }
+    if (section.patchParams) {
+        memcpy(base + section.patchParams, table->GetPatchParamBuffer(),
+            section.numPatchParams * sizeof(PatchParam));
+    }
+}
+
+// returns true if an array of 'count' elements at 'offset' is aligned and
+// lies after the header, within the 'size' bytes of the segment (without
+// overflowing)
+bool
+isInside(size_t offset, size_t count, size_t elementSize, size_t size) {
+
+    if (count == 0) return true;
+    return offset >= sizeof(SegmentHeader) and
+           offset % SEGMENT_ALIGNMENT == 0 and
+           offset < size and
+           count <= (size - offset) / elementSize;
+}
+
+bool
+isValid(StencilSection const & section, size_t size) {
+
+    if (section.numStencils == 0) return true;
+    if (section.numStencils < 0 or section.numControlVertices < 0) {
+        return false;
+    }
+
+    size_t numStencils = (size_t)section.numStencils,
+           offsetSize = section.largeOffsets ? sizeof(size_t) : sizeof(int);
+
+    if (not section.largeOffsets and section.numWeights > (size_t)INT_MAX) {
+        return false;
+    }
+
+    if (not isInside(section.sizes, numStencils, sizeof(int), size) or
+        not isInside(section.offsets, numStencils, offsetSize, size) or
+        not isInside(section.indices, section.numWeights, sizeof(int), size) or
+        not isInside(section.weights, section.numWeights, sizeof(float), size)) {
+        return false;
+    }
+    return section.sizes != 0 and section.offsets != 0;
+}
+
+bool
+isValid(PatchSection const & section, size_t size) {
+
+    return isInside(section.patchArrays, section.numPatchArrays,
+                    sizeof(PatchArray), size) and
+           isInside(section.indices, section.numIndices,
+                    sizeof(int), size) and
+           isInside(section.patchParams, section.numPatchParams,
+                    sizeof(PatchParam), size);
+}
+
+// the stencils are contiguous and cover the weights of the table, and each
+// stencil only references the control vertices or the vertices of the
+// stencils before it (intermediate levels that are not factorized) : the
+// evaluators then never read outside of the buffers. Checked once the arrays
+// are known to be inside the segment.
+bool
+isConsistent(StencilSection const & section, char const * base) {
+
+    int numStencils = section.numStencils;
+
+    int const * sizes = (int const *)(base + section.sizes),
+              * indices = (int const *)(base + section.indices);
+    int const * offsets = (int const *)(base + section.offsets);
+    size_t const * largeOffsets = (size_t const *)(base + section.offsets);
+
+    size_t offset = 0;
+    for (int i = 0; i < numStencils; ++i) {
+
+        size_t stencilOffset = section.largeOffsets ?
+            largeOffsets[i] : (size_t)offsets[i];
+
+        if (sizes[i] < 0 or stencilOffset != offset or
+            (size_t)sizes[i] > section.numWeights - offset) {
+            return false;
+        }
+
+        // widened : numControlVertices + i may exceed INT_MAX
+        long long maxIndex = (long long)section.numControlVertices + i;
+        for (int j = 0; j < sizes[i]; ++j) {
+            int index = indices[offset + j];
+            if (index < 0 or (long long)index >= maxIndex) {
+                return false;
+            }
+        }
+        offset += sizes[i];
+    }
+    return offset == section.numWeights;
+}
+
+void
+bindStencils(StencilSection const & section, char const * base,
+             int & numStencils, int & numControlVertices,
+             int const * & sizes, int const * & offsets,
+             int const * & indices, float const * & weights,
+             size_t const * & largeOffsets) {
+
+    numStencils = section.numStencils;
+    numControlVertices = section.numControlVertices;
+    sizes = (int const *)(base + section.sizes);
+    if (section.largeOffsets) {
+        offsets = 0;
+        largeOffsets = (size_t const *)(base + section.offsets);
+    } else {
+        offsets = (int const *)(base + section.offsets);
+        largeOffsets = 0;
+    }
+    indices = (int const *)(base + section.indices);
+    weights = (float const *)(base + section.weights);
+}
+
+} // end namespace
+
+CpuSharedTableStore::CpuSharedTableStore(void * base, size_t size) :
+    _base(base), _size(size),
+    _hasVertexStencils(false), _hasVaryingStencils(false),
+    _hasPatchTable(false) {
+}
+
+CpuSharedTableStore::~CpuSharedTableStore() {
+
+#ifndef _WIN32
+    if (_base) {
+        munmap(_base, _size);
+    }
+#endif
+}
+
+bool
+CpuSharedTableStore::bind() {
+
+    if (_size < sizeof(SegmentHeader)) return false;
+
+    SegmentHeader const * header = (SegmentHeader const *)_base;
+
+    // nothing else is read before the version
+    if (loadVersion(header) != SEGMENT_VERSION or
+        memcmp(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) or
+        header->pointerSize != (int)sizeof(void *) or
+        header->size != _size) {
+        return false;
+    }
+
+    if (not isValid(header->vertexStencils, _size) or
+        not isValid(header->varyingStencils, _size) or
+        not isValid(header->patches, _size)) {
+        return false;
+    }
+
+    char const * base = (char const *)_base;
+
+    if (not isConsistent(header->vertexStencils, base) or
+        not isConsistent(header->varyingStencils, base)) {
+        return false;
+    }
+
+    _hasVertexStencils = header->vertexStencils.numStencils > 0;
+    if (_hasVertexStencils) {
+        CpuSharedStencilTable & t = _vertexStencils;
+        bindStencils(header->vertexStencils, base,
+            t._numStencils, t._numControlVertices,
+            t._sizes, t._offsets, t._indices, t._weights, t._largeOffsets);
+    }
+
+    _hasVaryingStencils = header->varyingStencils.numStencils > 0;
+    if (_hasVaryingStencils) {
+        CpuSharedStencilTable & t = _varyingStencils;
+        bindStencils(header->varyingStencils, base,
+            t._numStencils, t._numControlVertices,
+            t._sizes, t._offsets, t._indices, t._weights, t._largeOffsets);
+    }
+
+    PatchSection const & patches = header->patches;
+    _hasPatchTable = patches.numPatchArrays > 0;
+    if (_hasPatchTable) {
+        _patchTable._numPatchArrays = patches.numPatchArrays;
+        _patchTable._patchIndexSize = patches.numIndices;
+        _patchTable._patchParamSize = patches.numPatchParams;
+        _patchTable._patchArrays =
+            (PatchArray const *)(base + patches.patchArrays);
+        _patchTable._indexBuffer =
+            (int const *)(base + patches.indices);
+        _patchTable._patchParamBuffer =
+            (PatchParam const *)(base + patches.patchParams);
+    }
+    return true;
+}
+
+CpuSharedTableStore *
+CpuSharedTableStore::Publish(char const * name,
+    Far::StencilTable const * vertexStencils,
+    Far::StencilTable const * varyingStencils,
+    Far::PatchTable const * patchTable) {
+
+#if defined(_WIN32)
+    (void)name;
+    (void)vertexStencils;
+    (void)varyingStencils;
+    (void)patchTable;
+    return NULL;
+#else
+    // patches are stored in the representation of the cpu evaluators
+    CpuPatchTable * cpuPatchTable =
+        patchTable ? CpuPatchTable::Create(patchTable) : NULL;
+
+    // the version is published once the segment is written
+    SegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.pointerSize = (int)sizeof(void *);
+
+    size_t cursor = sizeof(SegmentHeader);
+    layoutStencils(vertexStencils, header.vertexStencils, cursor);
+    layoutStencils(varyingStencils, header.varyingStencils, cursor);
+    layoutPatches(cpuPatchTable, header.patches, cursor);
+    header.size = cursor;
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        delete cpuPatchTable;
+        return NULL;
+    }
+
+    void * base = MAP_FAILED;
+    if (ftruncate(fd, (off_t)header.size) == 0) {
+        base = mmap(NULL, header.size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        delete cpuPatchTable;
+        return NULL;
+    }
+
+    writeStencils(vertexStencils, header.vertexStencils, (char *)base);
+    writeStencils(varyingStencils, header.varyingStencils, (char *)base);
+    writePatches(cpuPatchTable, header.patches, (char *)base);
+    delete cpuPatchTable;
+
+    memcpy(base, &header, sizeof(header));
+    storeVersion((SegmentHeader *)base, SEGMENT_VERSION);
+
+    mprotect(base, header.size, PROT_READ);
+
+    CpuSharedTableStore * store = new CpuSharedTableStore(base, header.size);
+    store->bind();
+    return store;
+#endif
+}
+
+CpuSharedTableStore *
+CpuSharedTableStore::Attach(char const * name) {
+
+#if defined(_WIN32)
+    (void)name;
+    return NULL;
+#else
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 or st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void * base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) return NULL;
+
+    CpuSharedTableStore * store = new CpuSharedTableStore(base, size);
+    if (not store->bind()) {
+        delete store;
+        return NULL;
+    }
+    return store;
+#endif
+}
+
+bool
+CpuSharedTableStore::Unlink(char const * name) {
+
+#if defined(_WIN32)
+    (void)name;
+    return false;
+#else
+    return shm_unlink(name) == 0;
+#endif
+}
+
+CpuSharedStencilTable const *
+CpuSharedTableStore::GetVertexStencilTable() const {
+    return _hasVertexStencils ? &_vertexStencils : NULL;
+}
+
+CpuSharedStencilTable const *
+CpuSharedTableStore::GetVaryingStencilTable() const {
+    return _hasVaryingStencils ? &_varyingStencils : NULL;
+}
+
+CpuSharedPatchTable const *
+CpuSharedTableStore::GetPatchTable() const {
+    return _hasPatchTable ? &_patchTable : NULL;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,250 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_SHARED_TABLE_STORE_H
+#define OPENSUBDIV3_OSD_CPU_SHARED_TABLE_STORE_H
+
+#include "../version.h"
+
+#include <cstddef>
+#include "../osd/types.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class StencilTable;
+    class PatchTable;
+};
+
+namespace Osd {
+
+/// \brief Read-only stencil table stored in a CpuSharedTableStore
+///
+/// Provides the accessors of Far::StencilTable used by the cpu evaluators
+/// (CpuEvaluator, OmpEvaluator, TbbEvaluator) so that it can be passed to
+/// their generic EvalStencils functions.
+///
+/// Tables of more than 2^31 weights are stored with 64-bit offsets (see
+/// HasLargeOffsets), as Far::StencilTable.
+///
+class CpuSharedStencilTable {
+public:
+    CpuSharedStencilTable() :
+        _numStencils(0), _numControlVertices(0),
+        _sizes(0), _offsets(0), _indices(0), _weights(0),
+        _largeOffsets(0) { }
+
+    /// Returns the number of stencils in the table
+    int GetNumStencils() const { return _numStencils; }
+
+    /// Returns the number of control vertices indexed in the table
+    int GetNumControlVertices() const { return _numControlVertices; }
+
+    /// Returns the number of control vertices of each stencil
+    int const * GetSizes() const { return _sizes; }
+
+    /// Returns the offset to each stencil (NULL for tables with large
+    /// offsets)
+    int const * GetOffsets() const { return _offsets; }
+
+    /// Returns true if the stencils are located with the 64-bit offsets of
+    /// GetLargeOffsets()
+    bool HasLargeOffsets() const { return _largeOffsets != 0; }
+
+    /// Returns the 64-bit offset to each stencil (NULL for tables with
+    /// 32-bit offsets)
+    size_t const * GetLargeOffsets() const { return _largeOffsets; }
+
+    /// Returns the indices of the control vertices
+    int const * GetControlIndices() const { return _indices; }
+
+    /// Returns the stencil interpolation weights
+    float const * GetWeights() const { return _weights; }
+
+private:
+    friend class CpuSharedTableStore;
+
+    int _numStencils,
+        _numControlVertices;
+
+    int const * _sizes,
+              * _offsets,
+              * _indices;
+    float const * _weights;
+    size_t const * _largeOffsets;
+};
+
+/// \brief Returns the 64-bit offsets of a shared stencil table (see
+///        GetLargeStencilOffsets in osd/types.h)
+inline size_t const *
+GetLargeStencilOffsets(CpuSharedStencilTable const * stencilTable) {
+    return stencilTable->GetLargeOffsets();
+}
+
+/// \brief Read-only patch table stored in a CpuSharedTableStore
+///
+/// Provides the accessors of CpuPatchTable used by the cpu evaluators
+/// (EvalPatches).
+///
+class CpuSharedPatchTable {
+public:
+    CpuSharedPatchTable() :
+        _numPatchArrays(0), _patchIndexSize(0), _patchParamSize(0),
+        _patchArrays(0), _indexBuffer(0), _patchParamBuffer(0) { }
+
+    const PatchArray *GetPatchArrayBuffer() const {
+        return _patchArrays;
+    }
+    const int *GetPatchIndexBuffer() const {
+        return _indexBuffer;
+    }
+    const PatchParam *GetPatchParamBuffer() const {
+        return _patchParamBuffer;
+    }
+
+    size_t GetNumPatchArrays() const {
+        return _numPatchArrays;
+    }
+    size_t GetPatchIndexSize() const {
+        return _patchIndexSize;
+    }
+    size_t GetPatchParamSize() const {
+        return _patchParamSize;
+    }
+
+private:
+    friend class CpuSharedTableStore;
+
+    size_t _numPatchArrays,
+           _patchIndexSize,
+           _patchParamSize;
+
+    PatchArray const * _patchArrays;
+    int const * _indexBuffer;
+    PatchParam const * _patchParamBuffer;
+};
+
+/// \brief Immutable stencil and patch tables in a named shared memory segment
+///
+/// The tables of an asset are published once in a POSIX shared memory
+/// segment, and attached read-only by any process of the machine : all the
+/// processes evaluating the asset then share a single copy of the tables.
+///
+/// The segment is pointer-free : arrays are located by their offset from
+/// the start of the segment, so that it can be mapped at any address.
+/// It is only meant to be shared between processes of the same machine (and
+/// the same build of the library).
+///
+/// Segments persist until they are unlinked (see Unlink), even if no
+/// process has them mapped.
+///
+/// \note Shared memory segments are not supported on Windows : Publish and
+///       Attach return NULL.
+///
+class CpuSharedTableStore {
+public:
+    /// \brief Publishes tables in a new shared memory segment
+    ///
+    /// @param name            name of the segment (POSIX shared memory
+    ///                        object name, e.g. "/asset.tables")
+    ///
+    /// @param vertexStencils  vertex stencil table (optional)
+    ///
+    /// @param varyingStencils varying stencil table (optional)
+    ///
+    /// @param patchTable      patch table (optional)
+    ///
+    /// @return                a read-only mapping of the new segment, or
+    ///                        NULL if the segment could not be created
+    ///                        (e.g. if it already exists)
+    ///
+    static CpuSharedTableStore * Publish(char const * name,
+        Far::StencilTable const * vertexStencils,
+        Far::StencilTable const * varyingStencils,
+        Far::PatchTable const * patchTable);
+
+    /// \brief Attaches to the tables of an existing segment
+    ///
+    /// The whole segment is validated (in time linear in the size of the
+    /// tables) : the stencils must be contiguous and only reference the
+    /// control vertices or the vertices of the stencils before them.
+    ///
+    /// @param name            name of the segment
+    ///
+    /// @return                a read-only mapping of the segment, or NULL if
+    ///                        the segment does not exist or is not valid
+    ///
+    static CpuSharedTableStore * Attach(char const * name);
+
+    /// \brief Removes a segment (existing mappings remain valid)
+    static bool Unlink(char const * name);
+
+    /// \brief Destructor : unmaps the segment
+    ~CpuSharedTableStore();
+
+    /// \brief Returns the vertex stencil table (or NULL)
+    CpuSharedStencilTable const * GetVertexStencilTable() const;
+
+    /// \brief Returns the varying stencil table (or NULL)
+    CpuSharedStencilTable const * GetVaryingStencilTable() const;
+
+    /// \brief Returns the patch table (or NULL)
+    CpuSharedPatchTable const * GetPatchTable() const;
+
+    /// \brief Returns the size of the segment in bytes
+    size_t GetSize() const { return _size; }
+
+private:
+    CpuSharedTableStore(void * base, size_t size);
+
+    CpuSharedTableStore(CpuSharedTableStore const &) { }
+    CpuSharedTableStore & operator=(CpuSharedTableStore const &) {
+        return *this;
+    }
+
+    // validates the segment header and locates the tables
+    bool bind();
+
+    void * _base;
+    size_t _size;
+
+    bool _hasVertexStencils,
+         _hasVaryingStencils,
+         _hasPatchTable;
+
+    CpuSharedStencilTable _vertexStencils,
+                          _varyingStencils;
+    CpuSharedPatchTable _patchTable;
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_SHARED_TABLE_STORE_H
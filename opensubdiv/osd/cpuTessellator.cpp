@@ -0,0 +1,758 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#include "../osd/cpuTessellator.h"
+#include "../far/error.h"
+#include "../far/patchTable.h"
+#include "../far/ptexIndices.h"
+#include "../far/topologyRefiner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Osd {
+
+namespace {
+
+    //
+    //  The edges of the patch domain are numbered counter-clockwise from the
+    //  v=0 edge, each edge starting at the corner of the same index :
+    //
+    //      (0,1) 3 ------- 2 (1,1)
+    //            |    2    |
+    //            | 3     1 |
+    //            |    0    |
+    //      (0,0) 0 ------- 1 (1,0)
+    //
+    //  Each edge is parameterized by u (edges 0 and 2) or v (edges 1 and 3),
+    //  so edges 2 and 3 are traversed backwards.
+    //
+    int const edgeTransitionBits[4] = { 1, 2, 4, 8 };
+
+    //  Corners at the start and the end of the parameterization of the edges
+    int const edgeCorners[4][2] = { {0, 1}, {1, 2}, {3, 2}, {0, 3} };
+
+    inline void
+    getEdgePoint(int edge, float t, float * u, float * v) {
+        switch (edge) {
+            case 0 : *u = t;    *v = 0.0f; break;
+            case 1 : *u = 1.0f; *v = t;    break;
+            case 2 : *u = t;    *v = 1.0f; break;
+            case 3 : *u = 0.0f; *v = t;    break;
+        }
+    }
+
+    //  Index of a vertex unique across the levels of the refiner : vertices
+    //  are followed to their last child, so that the patches of different
+    //  levels sharing a vertex agree on its index
+    Far::Index
+    getUniqueVertex(Far::TopologyRefiner const & refiner,
+        std::vector<Far::Index> const & levelOffsets,
+        int level, Far::Index vertex) {
+
+        for ( ; level < refiner.GetNumLevels()-1; ++level) {
+            Far::Index child =
+                refiner.GetLevel(level).GetVertexChildVertex(vertex);
+            if (not Far::IndexIsValid(child)) {
+                break;
+            }
+            vertex = child;
+        }
+        return levelOffsets[level] + vertex;
+    }
+
+    //  Refined face of a patch : its vertices at the corners of the patch
+    //  domain and the vertices splitting its transition edges, as unique
+    //  indices
+    struct PatchFace {
+        Far::Index corners[4],
+                   midpoints[4];
+        int        level;
+    };
+
+    //  Locates the refined face of a patch by descending from its base face
+    //  along the bits of its (u,v) location : the children of a quad keep
+    //  the orientation of their parent, so the vertices of the refined face
+    //  are at the corners of the patch domain, in order
+    bool
+    findPatchFace(Far::TopologyRefiner const & refiner,
+        Far::PtexIndices const & ptexIndices,
+        std::vector<Far::Index> const & levelOffsets,
+        Far::PatchParam param, PatchFace * patchFace) {
+
+        int quadrant = 0;
+        Far::Index face =
+            ptexIndices.GetCoarseFaceId(param.GetFaceId(), &quadrant);
+        if (not Far::IndexIsValid(face)) {
+            return false;
+        }
+
+        int level = 0,
+            depth = param.GetDepth();
+
+        //  the depth of the sub-faces of non-quads counts their first level
+        if (param.NonQuadRoot()) {
+            face = refiner.GetLevel(0).GetFaceChildFaces(face)[quadrant];
+            level = 1;
+            --depth;
+        }
+
+        for (int i=depth-1; i>=0; --i, ++level) {
+            if (level >= refiner.GetNumLevels()-1 or
+                (not Far::IndexIsValid(face))) {
+                return false;
+            }
+            int ub = (param.GetU() >> i) & 1,
+                vb = (param.GetV() >> i) & 1;
+            int child = vb ? (ub ? 2 : 3) : (ub ? 1 : 0);
+            face = refiner.GetLevel(level).GetFaceChildFaces(face)[child];
+        }
+
+        if (not Far::IndexIsValid(face)) {
+            return false;
+        }
+
+        Far::TopologyLevel const & refLevel = refiner.GetLevel(level);
+        Far::ConstIndexArray verts = refLevel.GetFaceVertices(face);
+        if (verts.size() != 4) {
+            return false;
+        }
+
+        int transitionMask = param.GetTransition();
+        for (int corner=0; corner<4; ++corner) {
+            patchFace->corners[corner] =
+                getUniqueVertex(refiner, levelOffsets, level, verts[corner]);
+        }
+        for (int edge=0; edge<4; ++edge) {
+            patchFace->midpoints[edge] = Far::INDEX_INVALID;
+            if (transitionMask & edgeTransitionBits[edge]) {
+                Far::ConstIndexArray edges = refLevel.GetFaceEdges(face);
+                Far::Index mid = Far::INDEX_INVALID;
+                if (level+1 < refiner.GetNumLevels()) {
+                    mid = refLevel.GetEdgeChildVertex(edges[edge]);
+                }
+                if (not Far::IndexIsValid(mid)) {
+                    return false;
+                }
+                patchFace->midpoints[edge] =
+                    getUniqueVertex(refiner, levelOffsets, level+1, mid);
+            }
+        }
+        patchFace->level = level;
+        return true;
+    }
+
+    //  Segment of the edge of a patch between two vertices of the refined
+    //  mesh : a whole edge, or one half of a transition edge.  The segment is
+    //  identified by its sorted vertices, so that the patches sharing it
+    //  agree on its rate and on the vertices along it.
+    struct SegmentUse {
+        Far::Index v0, v1;   // sorted vertices of the segment
+        int        patch,
+                   edge,
+                   half;     // 0 for a whole edge, 1 or 2 for the halves
+        bool       reversed; // v0 is at the end of the parameterization
+
+        bool operator < (SegmentUse const & other) const {
+            if (v0 != other.v0) return v0 < other.v0;
+            if (v1 != other.v1) return v1 < other.v1;
+            if (patch != other.patch) return patch < other.patch;
+            if (edge != other.edge) return edge < other.edge;
+            return half < other.half;
+        }
+
+        //  Range of the segment in the parameterization of the edge
+        float GetT0() const { return (half==2) ? 0.5f : 0.0f; }
+        float GetT1() const { return (half==1) ? 0.5f : 1.0f; }
+    };
+
+    //  Tessellation of a patch : segments of its edges (the second segment
+    //  of the edges that are not transitional is -1) and interior grid
+    //  (empty if the patch is a pair of triangles)
+    struct PatchTessellation {
+        int  segments[4][2];
+        bool reversed[4][2];
+        int  lo[4],
+             hi[4],
+             nu, nv;
+
+        int GetEdgeRate(int edge) const { return lo[edge] + hi[edge]; }
+
+        int GetNumInteriorVertices() const {
+            return nu ? (nu-1)*(nv-1) : 0;
+        }
+
+        int GetNumTriangles() const {
+            if (not nu) {
+                return 2;
+            }
+            int n = 2*(nu-2)*(nv-2) + 2*(nu-2) + 2*(nv-2);
+            for (int edge=0; edge<4; ++edge) {
+                n += GetEdgeRate(edge);
+            }
+            return n;
+        }
+    };
+
+    //  Limit position at the (u,v) location of the patch domain
+    void
+    evaluatePosition(Far::PatchTable const & table,
+        Far::PatchTable::PatchHandle const & handle, Far::PatchParam param,
+        float u, float v, float const * data, BufferDescriptor const & desc,
+        float * position) {
+
+        float frac = param.GetParamFraction(),
+              s = ((float)param.GetU() + u) * frac,
+              t = ((float)param.GetV() + v) * frac;
+
+        float wP[20], wDs[20], wDt[20];
+        table.EvaluateBasis(handle, s, t, wP, wDs, wDt);
+
+        Far::ConstIndexArray cvs = table.GetPatchVertices(handle);
+
+        position[0] = position[1] = position[2] = 0.0f;
+        for (int i=0; i<cvs.size(); ++i) {
+            float const * src = data + desc.offset + cvs[i]*desc.stride;
+            for (int k=0; k<3; ++k) {
+                position[k] += wP[i] * src[k];
+            }
+        }
+    }
+
+    //  Rate of a segment, computed from the limit points of the patch that
+    //  owns it
+    int
+    computeSegmentRate(Far::PatchTable const & table,
+        Far::PatchTable::PatchHandle const & handle, SegmentUse const & use,
+        int level, float const * data, BufferDescriptor const & desc,
+        CpuTessellator::EdgeMetric const & metric, int maxRate) {
+
+        float points[3][3];
+        float const * p[3] = { 0, 0, 0 };
+
+        if (metric.RequiresPositions() and data) {
+            Far::PatchParam param = table.GetPatchParam(handle);
+
+            float t0 = use.GetT0(),
+                  t1 = use.GetT1(),
+                  ts[3] = { t0, t1, 0.5f * (t0 + t1) };
+            if (use.reversed) {
+                std::swap(ts[0], ts[1]);
+            }
+            for (int i=0; i<3; ++i) {
+                float u, v;
+                getEdgePoint(use.edge, ts[i], &u, &v);
+                evaluatePosition(table, handle, param, u, v, data, desc,
+                    points[i]);
+                p[i] = points[i];
+            }
+        }
+
+        float rate = std::ceil(metric.GetEdgeRate(p[0], p[1], p[2], level));
+        return (rate > (float)maxRate) ? maxRate :
+               ((rate < 1.0f) ? 1 : (int)rate);
+    }
+
+    //  Interior grid of a patch, once the rates of its segments are known
+    void
+    computeInteriorGrid(PatchTessellation & tess,
+        std::vector<int> const & segmentRates) {
+
+        for (int edge=0; edge<4; ++edge) {
+            tess.lo[edge] = segmentRates[tess.segments[edge][0]];
+            tess.hi[edge] = (tess.segments[edge][1] < 0) ?
+                0 : segmentRates[tess.segments[edge][1]];
+        }
+
+        int ru = std::max(tess.GetEdgeRate(0), tess.GetEdgeRate(2)),
+            rv = std::max(tess.GetEdgeRate(1), tess.GetEdgeRate(3));
+        if (ru==1 and rv==1) {
+            tess.nu = tess.nv = 0;
+        } else {
+            tess.nu = std::max(2, ru);
+            tess.nv = std::max(2, rv);
+        }
+    }
+
+    //  Sequence of vertices along an edge of the patch or along the matching
+    //  side of the interior grid, with their location along the edge
+    struct EdgeVertex {
+        int   index;
+        float t;
+    };
+
+    //  Triangulates the strip between an edge and the interior grid by
+    //  advancing along the sequence whose next segment is centered first
+    void
+    stitchStrip(std::vector<EdgeVertex> const & outer,
+        std::vector<EdgeVertex> const & inner, int * tris) {
+
+        int m = (int)outer.size()-1,
+            n = (int)inner.size()-1;
+
+        for (int i=0, j=0; i<m or j<n; ) {
+
+            bool advanceOuter = (j==n) or ((i<m) and
+                (outer[i].t + outer[i+1].t <= inner[j].t + inner[j+1].t));
+
+            *tris++ = outer[i].index;
+            if (advanceOuter) {
+                *tris++ = outer[i+1].index;
+                *tris++ = inner[j].index;
+                ++i;
+            } else {
+                *tris++ = inner[j+1].index;
+                *tris++ = inner[j].index;
+                ++j;
+            }
+        }
+    }
+
+    //  Shared vertices of the tessellation : the vertices of the refined
+    //  mesh at the ends of the segments, then the vertices along each
+    //  segment (from its first to its second sorted vertex)
+    struct SharedVertices {
+        std::vector<Far::Index> corners;    // sorted
+        std::vector<int>        segmentOffsets;
+
+        int GetCorner(Far::Index vertex) const {
+            return (int)(std::lower_bound(corners.begin(), corners.end(),
+                vertex) - corners.begin());
+        }
+    };
+
+    //  Appends the vertices of a segment in the order of the parameterization
+    //  of the edge
+    void
+    appendSegment(SharedVertices const & shared, int segment, int rate,
+        bool reversed, float t0, float t1, std::vector<EdgeVertex> & outer) {
+
+        int first = shared.segmentOffsets[segment];
+        for (int i=1; i<rate; ++i) {
+            EdgeVertex ev;
+            ev.index = first + (reversed ? rate-1-i : i-1);
+            ev.t = t0 + (t1 - t0) * (float)i / (float)rate;
+            outer.push_back(ev);
+        }
+    }
+
+    //  Generates the interior vertices and the triangles of a patch
+    void
+    generateTessellation(Far::PatchTable const & table,
+        Far::PatchTable::PatchHandle const & handle,
+        PatchFace const & face, PatchTessellation const & tess,
+        SharedVertices const & shared, int interiorOffset,
+        PatchCoord * coords, int * tris) {
+
+        int corners[4];
+        for (int corner=0; corner<4; ++corner) {
+            corners[corner] = shared.GetCorner(face.corners[corner]);
+        }
+
+        if (not tess.nu) {
+            int const quad[6] = { 0, 1, 2, 0, 2, 3 };
+            for (int i=0; i<6; ++i) {
+                tris[i] = corners[quad[i]];
+            }
+            return;
+        }
+
+        Far::PatchParam param = table.GetPatchParam(handle);
+
+        float frac = param.GetParamFraction(),
+              s0 = (float)param.GetU() * frac,
+              t0 = (float)param.GetV() * frac;
+
+        int nu = tess.nu,
+            nv = tess.nv;
+
+        for (int j=1; j<nv; ++j) {
+            for (int i=1; i<nu; ++i) {
+                coords[(j-1)*(nu-1) + (i-1)] = PatchCoord(handle,
+                    s0 + frac * (float)i / (float)nu,
+                    t0 + frac * (float)j / (float)nv);
+            }
+        }
+
+        //  Interior quads
+        for (int j=1; j<nv-1; ++j) {
+            for (int i=1; i<nu-1; ++i) {
+                int v00 = interiorOffset + (j-1)*(nu-1) + (i-1),
+                    v10 = v00 + 1,
+                    v01 = v00 + (nu-1),
+                    v11 = v01 + 1;
+                *tris++ = v00; *tris++ = v10; *tris++ = v11;
+                *tris++ = v00; *tris++ = v11; *tris++ = v01;
+            }
+        }
+
+        //  Strips between the edges and the sides of the interior grid, both
+        //  traversed counter-clockwise
+        std::vector<EdgeVertex> outer, inner;
+        for (int edge=0; edge<4; ++edge) {
+
+            bool backwards = (edge>=2);
+            int along = (edge & 1),
+                n = (along ? nv : nu);
+
+            //  Vertices along the edge, in the order of its parameterization
+            outer.clear();
+
+            EdgeVertex ev;
+            ev.index = corners[edgeCorners[edge][0]];
+            ev.t = 0.0f;
+            outer.push_back(ev);
+
+            if (tess.hi[edge]) {
+                appendSegment(shared, tess.segments[edge][0], tess.lo[edge],
+                    tess.reversed[edge][0], 0.0f, 0.5f, outer);
+                ev.index = shared.GetCorner(face.midpoints[edge]);
+                ev.t = 0.5f;
+                outer.push_back(ev);
+                appendSegment(shared, tess.segments[edge][1], tess.hi[edge],
+                    tess.reversed[edge][1], 0.5f, 1.0f, outer);
+            } else {
+                appendSegment(shared, tess.segments[edge][0], tess.lo[edge],
+                    tess.reversed[edge][0], 0.0f, 1.0f, outer);
+            }
+
+            ev.index = corners[edgeCorners[edge][1]];
+            ev.t = 1.0f;
+            outer.push_back(ev);
+
+            if (backwards) {
+                std::reverse(outer.begin(), outer.end());
+                for (size_t i=0; i<outer.size(); ++i) {
+                    outer[i].t = 1.0f - outer[i].t;
+                }
+            }
+
+            inner.clear();
+            for (int i=1; i<n; ++i) {
+                int k = backwards ? n-i : i,
+                    iu, iv;
+                switch (edge) {
+                    case 0 : iu = k;    iv = 1;    break;
+                    case 1 : iu = nu-1; iv = k;    break;
+                    case 2 : iu = k;    iv = nv-1; break;
+                    default: iu = 1;    iv = k;    break;
+                }
+                EdgeVertex ev;
+                ev.index = interiorOffset + (iv-1)*(nu-1) + (iu-1);
+                float t = (float)k / (float)n;
+                ev.t = backwards ? 1.0f-t : t;
+                inner.push_back(ev);
+            }
+
+            stitchStrip(outer, inner, tris);
+
+            tris += 3*(tess.GetEdgeRate(edge) + (n-2));
+        }
+    }
+} // end namespace
+
+//
+//  Metrics
+//
+float
+CpuTessellator::FixedRateMetric::GetEdgeRate(float const * /* p0 */,
+    float const * /* p1 */, float const * /* mid */, int level) const {
+
+    return (float)_rate / (float)(1 << level);
+}
+
+CpuTessellator::ScreenSpaceMetric::ScreenSpaceMetric(
+    float const modelViewMatrix[16], float const projectionMatrix[16],
+    float viewportHeight, float segmentLength) {
+
+    std::copy(modelViewMatrix, modelViewMatrix+16, _modelView);
+    std::copy(projectionMatrix, projectionMatrix+16, _projection);
+
+    // projected extents are in normalized device coordinates (2 units for
+    // the height of the viewport)
+    _scale = 0.5f * viewportHeight / segmentLength;
+}
+
+float
+CpuTessellator::ScreenSpaceMetric::GetEdgeRate(float const * p0,
+    float const * p1, float const * /* mid */, int /* level */) const {
+
+    float center[3], diameter = 0.0f;
+    for (int k=0; k<3; ++k) {
+        center[k] = (p0[k] + p1[k]) * 0.5f;
+        diameter += (p0[k] - p1[k]) * (p0[k] - p1[k]);
+    }
+    diameter = std::sqrt(diameter);
+
+    float view[4];
+    for (int i=0; i<4; ++i) {
+        view[i] = _modelView[i]*center[0] + _modelView[4+i]*center[1] +
+                  _modelView[8+i]*center[2] + _modelView[12+i];
+    }
+    float w = _projection[3]*view[0] + _projection[7]*view[1] +
+              _projection[11]*view[2] + _projection[15]*view[3];
+
+    if (std::fabs(w) < 1e-6f) {
+        return 1.0f;
+    }
+    return std::fabs(diameter * _projection[5] / w) * _scale;
+}
+
+float
+CpuTessellator::CurvatureMetric::GetEdgeRate(float const * p0,
+    float const * p1, float const * mid, int /* level */) const {
+
+    float deviation = 0.0f;
+    for (int k=0; k<3; ++k) {
+        float d = mid[k] - (p0[k] + p1[k]) * 0.5f;
+        deviation += d*d;
+    }
+    return std::sqrt(std::sqrt(deviation) / _tolerance);
+}
+
+//
+//  Tessellation
+//
+bool
+CpuTessellator::Tessellate(Far::TopologyRefiner const & refiner,
+    Far::PatchTable const & patchTable,
+    float const * vertexData, BufferDescriptor const & vertexDesc,
+    EdgeMetric const & metric, int maxRate,
+    std::vector<PatchCoord> * patchCoords, std::vector<int> * triangles,
+    std::vector<int> * triangleOffsets) {
+
+    if ((not patchCoords) or (not triangles)) {
+        return false;
+    }
+    if (metric.RequiresPositions() and
+        ((not vertexData) or vertexDesc.length < 3)) {
+        return false;
+    }
+    maxRate = std::max(1, maxRate);
+
+    //  Gather the handles of the patches
+    std::vector<Far::PatchTable::PatchHandle> handles;
+    handles.reserve(patchTable.GetNumPatchesTotal());
+
+    for (int array=0, patch=0; array<patchTable.GetNumPatchArrays(); ++array) {
+
+        Far::PatchDescriptor desc = patchTable.GetPatchArrayDescriptor(array);
+        if (desc.GetType()==Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "CpuTessellator : extraordinary basis end caps are "
+                "not supported\n");
+            return false;
+        }
+        if (desc.GetType()!=Far::PatchDescriptor::REGULAR and
+            desc.GetType()!=Far::PatchDescriptor::GREGORY_BASIS and
+            desc.GetType()!=Far::PatchDescriptor::QUADS) {
+            return false;
+        }
+
+        int ncvs = desc.GetNumControlVertices();
+        for (int i=0; i<patchTable.GetNumPatches(array); ++i, ++patch) {
+            Far::PatchTable::PatchHandle handle;
+            handle.arrayIndex = array;
+            handle.patchIndex = patch;
+            handle.vertIndex = i * ncvs;
+            handles.push_back(handle);
+        }
+    }
+
+    int npatches = (int)handles.size();
+
+    //  Locate the refined face of each patch
+    Far::PtexIndices ptexIndices(refiner);
+
+    std::vector<Far::Index> levelOffsets(refiner.GetNumLevels(), 0);
+    for (int level=1; level<refiner.GetNumLevels(); ++level) {
+        levelOffsets[level] = levelOffsets[level-1] +
+            refiner.GetLevel(level-1).GetNumVertices();
+    }
+
+    std::vector<PatchFace> faces(npatches);
+    int numInvalid = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:numInvalid)
+#endif
+    for (int patch=0; patch<npatches; ++patch) {
+        if (not findPatchFace(refiner, ptexIndices, levelOffsets,
+                patchTable.GetPatchParam(handles[patch]), &faces[patch])) {
+            ++numInvalid;
+        }
+    }
+    if (numInvalid) {
+        return false;
+    }
+
+    //  Gather the segments of the edges of the patches, sorted so that the
+    //  uses of a segment are contiguous, the first one being the owner that
+    //  computes its rate and the locations of its vertices
+    std::vector<SegmentUse> uses;
+    uses.reserve(4*npatches);
+    for (int patch=0; patch<npatches; ++patch) {
+        PatchFace const & face = faces[patch];
+        for (int edge=0; edge<4; ++edge) {
+            Far::Index start = face.corners[edgeCorners[edge][0]],
+                  end = face.corners[edgeCorners[edge][1]],
+                  mid = face.midpoints[edge];
+
+            Far::Index ends[3][2] = { { start, end },
+                                      { start, mid },
+                                      { mid,   end } };
+            for (int half=0; half<3; ++half) {
+                if (Far::IndexIsValid(mid) == (half==0)) {
+                    continue;
+                }
+                SegmentUse use;
+                use.reversed = ends[half][0] > ends[half][1];
+                use.v0 = use.reversed ? ends[half][1] : ends[half][0];
+                use.v1 = use.reversed ? ends[half][0] : ends[half][1];
+                use.patch = patch;
+                use.edge = edge;
+                use.half = half;
+                uses.push_back(use);
+            }
+        }
+    }
+    std::sort(uses.begin(), uses.end());
+
+    std::vector<PatchTessellation> tessellations(npatches);
+    std::vector<int> owners;
+    SharedVertices shared;
+    shared.corners.reserve(uses.size());
+
+    for (int i=0; i<(int)uses.size(); ++i) {
+        SegmentUse const & use = uses[i];
+        if (i==0 or use.v0!=uses[i-1].v0 or use.v1!=uses[i-1].v1) {
+            owners.push_back(i);
+            shared.corners.push_back(use.v0);
+            shared.corners.push_back(use.v1);
+        }
+        //  the second half of a transition edge fills the second segment
+        PatchTessellation & tess = tessellations[use.patch];
+        int slot = (use.half==2) ? 1 : 0;
+        tess.segments[use.edge][slot] = (int)owners.size()-1;
+        tess.reversed[use.edge][slot] = use.reversed;
+        if (use.half==0) {
+            tess.segments[use.edge][1] = -1;
+        }
+    }
+
+    std::sort(shared.corners.begin(), shared.corners.end());
+    shared.corners.erase(std::unique(shared.corners.begin(),
+        shared.corners.end()), shared.corners.end());
+
+    //  Compute the rate of each segment once, from its owner
+    int nsegments = (int)owners.size();
+    std::vector<int> segmentRates(nsegments);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (int segment=0; segment<nsegments; ++segment) {
+        SegmentUse const & use = uses[owners[segment]];
+        int level = faces[use.patch].level + (use.half ? 1 : 0);
+        segmentRates[segment] = computeSegmentRate(patchTable,
+            handles[use.patch], use, level, vertexData, vertexDesc,
+            metric, maxRate);
+    }
+
+    //  Allocate the shared vertices, then the interior vertices and the
+    //  triangles of each patch
+    int ncorners = (int)shared.corners.size();
+
+    shared.segmentOffsets.resize(nsegments);
+    int nverts = ncorners;
+    for (int segment=0; segment<nsegments; ++segment) {
+        shared.segmentOffsets[segment] = nverts;
+        nverts += segmentRates[segment] - 1;
+    }
+
+    std::vector<int> interiorOffsets(npatches),
+                     offsets(npatches+1);
+    offsets[0] = 0;
+    for (int patch=0; patch<npatches; ++patch) {
+        PatchTessellation & tess = tessellations[patch];
+        computeInteriorGrid(tess, segmentRates);
+        interiorOffsets[patch] = nverts;
+        nverts += tess.GetNumInteriorVertices();
+        offsets[patch+1] = offsets[patch] + tess.GetNumTriangles();
+    }
+
+    patchCoords->resize(nverts);
+    triangles->resize(3*offsets[npatches]);
+
+    //  Locations of the shared vertices on the owners of the segments
+    for (int segment=0; segment<nsegments; ++segment) {
+
+        SegmentUse const & use = uses[owners[segment]];
+        Far::PatchTable::PatchHandle const & handle = handles[use.patch];
+        Far::PatchParam param = patchTable.GetPatchParam(handle);
+
+        float frac = param.GetParamFraction(),
+              s0 = (float)param.GetU() * frac,
+              t0 = (float)param.GetV() * frac;
+
+        float first = use.reversed ? use.GetT1() : use.GetT0(),
+              last = use.reversed ? use.GetT0() : use.GetT1();
+
+        int rate = segmentRates[segment];
+        for (int i=0; i<=rate; ++i) {
+            int vert = (i==0) ? shared.GetCorner(use.v0) :
+                ((i==rate) ? shared.GetCorner(use.v1) :
+                             shared.segmentOffsets[segment] + i-1);
+            float u, v;
+            float t = first + (last - first) * (float)i / (float)rate;
+            getEdgePoint(use.edge, t, &u, &v);
+            (*patchCoords)[vert] = PatchCoord(handle, s0 + u * frac,
+                                                      t0 + v * frac);
+        }
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (int patch=0; patch<npatches; ++patch) {
+        generateTessellation(patchTable, handles[patch], faces[patch],
+            tessellations[patch], shared, interiorOffsets[patch],
+            &(*patchCoords)[0] + interiorOffsets[patch],
+            &(*triangles)[0] + 3*offsets[patch]);
+    }
+
+    if (triangleOffsets) {
+        triangleOffsets->swap(offsets);
+    }
+    return true;
+}
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
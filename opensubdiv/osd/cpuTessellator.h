@@ -0,0 +1,216 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+#ifndef OPENSUBDIV3_OSD_CPU_TESSELLATOR_H
+#define OPENSUBDIV3_OSD_CPU_TESSELLATOR_H
+
+#include "../version.h"
+
+#include <vector>
+#include "../osd/bufferDescriptor.h"
+#include "../osd/types.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Far {
+    class PatchTable;
+    class TopologyRefiner;
+};
+
+namespace Osd {
+
+/// \brief Adaptive tessellation of the patches of a Far::PatchTable on the CPU
+///
+/// CpuTessellator is the CPU counterpart of the hardware tessellation path of
+/// the GLSL and HLSL patch shaders : the edges of each patch are split into a
+/// number of segments given by an EdgeMetric, and the patch domain is
+/// triangulated into an interior grid stitched to those edge segments.
+///
+/// Tessellate() generates the topology only : a PatchCoord for each vertex
+/// and indexed triangles. The vertices are then evaluated with the
+/// EvalPatches() function of any evaluator (CpuEvaluator, OmpEvaluator,
+/// TbbEvaluator...).
+///
+/// The tessellation is watertight : the edges of the patches are located in
+/// the refined mesh, and each edge shared by adjacent patches is given a
+/// single rate and a single set of vertices, referenced by the triangles of
+/// all these patches. The edges of transition patches are split into two
+/// halves that are shared with the edges of their more refined neighbors
+/// (see PatchParam::GetTransition()).
+///
+class CpuTessellator {
+public:
+
+    /// \brief Computes the tessellation rate of the edges of the patches
+    ///
+    /// The rate of an edge shared by several patches is computed once, from
+    /// the limit points of one of them.
+    ///
+    class EdgeMetric {
+    public:
+        virtual ~EdgeMetric() { }
+
+        /// \brief Returns true if GetEdgeRate() requires the limit positions
+        virtual bool RequiresPositions() const { return true; }
+
+        /// \brief Returns the number of segments of an edge
+        ///
+        /// @param p0     Limit position of the first end of the edge
+        ///
+        /// @param p1     Limit position of the second end of the edge
+        ///
+        /// @param mid    Limit position at the middle of the edge
+        ///
+        /// @param level  Refinement level of the edge (0 for the edges of
+        ///               the base quads)
+        ///
+        /// \note The positions are NULL if RequiresPositions() is false.
+        ///
+        virtual float GetEdgeRate(float const * p0, float const * p1,
+                                  float const * mid, int level) const = 0;
+    };
+
+    /// \brief Constant number of segments per edge of the base quads
+    class FixedRateMetric : public EdgeMetric {
+    public:
+        FixedRateMetric(int rate) : _rate(rate) { }
+
+        virtual bool RequiresPositions() const { return false; }
+
+        virtual float GetEdgeRate(float const * p0, float const * p1,
+                                  float const * mid, int level) const;
+    private:
+        int _rate;
+    };
+
+    /// \brief Segments of a target length in screen space
+    ///
+    /// As in the GLSL and HLSL shaders, the projected diameter of the
+    /// bounding sphere of the edge is used instead of the projected length of
+    /// the edge, to avoid under-tessellating edges near silhouettes.
+    ///
+    class ScreenSpaceMetric : public EdgeMetric {
+    public:
+        /// \brief Constructor
+        ///
+        /// @param modelViewMatrix   Column-major model-view matrix
+        ///
+        /// @param projectionMatrix  Column-major projection matrix
+        ///
+        /// @param viewportHeight    Height of the viewport in pixels
+        ///
+        /// @param segmentLength     Target length of the segments in pixels
+        ///
+        ScreenSpaceMetric(float const modelViewMatrix[16],
+                          float const projectionMatrix[16],
+                          float viewportHeight, float segmentLength);
+
+        virtual float GetEdgeRate(float const * p0, float const * p1,
+                                  float const * mid, int level) const;
+    private:
+        float _modelView[16],
+              _projection[16],
+              _scale;
+    };
+
+    /// \brief Segments within a distance of the limit curve of the edge
+    ///
+    /// The deviation of the limit curve from the chord of the edge decreases
+    /// with the square of the number of segments.
+    ///
+    class CurvatureMetric : public EdgeMetric {
+    public:
+        /// \brief Constructor
+        ///
+        /// @param tolerance  Maximum distance between the segments and the
+        ///                   limit surface
+        ///
+        CurvatureMetric(float tolerance) : _tolerance(tolerance) { }
+
+        virtual float GetEdgeRate(float const * p0, float const * p1,
+                                  float const * mid, int level) const;
+    private:
+        float _tolerance;
+    };
+
+    /// \brief Tessellates the patches of a table
+    ///
+    /// The vertices shared by adjacent patches come first : the corners of
+    /// the patches, then the vertices along their edges. They are followed
+    /// by the interior vertices of each patch, in the order of the patches
+    /// in the table. The triangles of each patch are contiguous, and are
+    /// counter-clockwise in the (s,t) domain of the patches.
+    ///
+    /// \note The patches are processed concurrently when OpenMP is available.
+    ///
+    /// @param refiner       TopologyRefiner the patch table was created from
+    ///
+    /// @param patchTable    Far::PatchTable (adaptive or uniform quads)
+    ///
+    /// @param vertexData    Refined vertices and local points indexed by the
+    ///                      patches, used to evaluate the limit positions
+    ///                      passed to the metric (may be NULL if the metric
+    ///                      does not require positions)
+    ///
+    /// @param vertexDesc    Vertex buffer descriptor : the first 3 elements
+    ///                      are the positions
+    ///
+    /// @param metric        EdgeMetric computing the rates of the edges
+    ///
+    /// @param maxRate       Maximum number of segments of an edge
+    ///
+    /// @param patchCoords   Parametric locations of the vertices (returned)
+    ///
+    /// @param triangles     Vertex indices of the triangles (returned)
+    ///
+    /// @param triangleOffsets  Optional offset of the first triangle of
+    ///                         each patch (number of patches + 1 entries,
+    ///                         returned)
+    ///
+    /// @return              False if the table has patches that cannot be
+    ///                      evaluated (extraordinary basis end caps or
+    ///                      legacy Gregory patches), or patches that do not
+    ///                      match the refiner
+    ///
+    static bool Tessellate(Far::TopologyRefiner const & refiner,
+                           Far::PatchTable const & patchTable,
+                           float const * vertexData,
+                           BufferDescriptor const & vertexDesc,
+                           EdgeMetric const & metric,
+                           int maxRate,
+                           std::vector<PatchCoord> * patchCoords,
+                           std::vector<int> * triangles,
+                           std::vector<int> * triangleOffsets=0);
+};
+
+}  // end namespace Osd
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OPENSUBDIV3_OSD_CPU_TESSELLATOR_H
@@ -34,14 +34,25 @@ namespace Osd {
 CpuVertexBuffer::CpuVertexBuffer(int numElements, int numVertices)
     : _numElements(numElements),
       _numVertices(numVertices),
-      _cpuBuffer(NULL) {
+      _cpuBuffer(NULL),
+      _ownsBuffer(true) {
 
     _cpuBuffer = new float[numElements * numVertices];
 }
 
+CpuVertexBuffer::CpuVertexBuffer(float *cpuBuffer,
+                                 int numElements, int numVertices)
+    : _numElements(numElements),
+      _numVertices(numVertices),
+      _cpuBuffer(cpuBuffer),
+      _ownsBuffer(false) {
+}
+
 CpuVertexBuffer::~CpuVertexBuffer() {
 
-    delete[] _cpuBuffer;
+    if (_ownsBuffer) {
+        delete[] _cpuBuffer;
+    }
 }
 
 CpuVertexBuffer *
@@ -51,12 +62,32 @@ CpuVertexBuffer::Create(int numElements, int numVertices,
     return new CpuVertexBuffer(numElements, numVertices);
 }
 
+CpuVertexBuffer *
+CpuVertexBuffer::Create(float *cpuBuffer, int numElements, int numVertices) {
+
+    if (cpuBuffer == NULL) return NULL;
+
+    return new CpuVertexBuffer(cpuBuffer, numElements, numVertices);
+}
+
 void
 CpuVertexBuffer::UpdateData(const float *src, int startVertex, int numVertices,
                             void * /*deviceContext*/) {
 
-    memcpy(_cpuBuffer + startVertex * _numElements,
-           src, GetNumElements() * numVertices * sizeof(float));
+    float *dst = _cpuBuffer + startVertex * _numElements;
+    if (dst == src) return;
+
+    memcpy(dst, src, GetNumElements() * numVertices * sizeof(float));
+}
+
+void
+CpuVertexBuffer::SetCpuBuffer(float *cpuBuffer) {
+
+    if (_ownsBuffer) {
+        delete[] _cpuBuffer;
+    }
+    _cpuBuffer = cpuBuffer;
+    _ownsBuffer = false;
 }
 
 int
@@ -39,20 +39,37 @@ namespace Osd {
 /// CpuVertexBuffer implements the VertexBufferInterface. An instance
 /// of this buffer class can be passed to CpuEvaluator
 ///
+/// The buffer can either allocate its own storage or wrap memory owned by
+/// the client (heap, mmap'd file, shared memory...) : primvar data written
+/// in place is then refined without being copied.
+///
 class CpuVertexBuffer {
 public:
     /// Creator. Returns NULL if error.
     static CpuVertexBuffer * Create(int numElements, int numVertices,
                                     void *deviceContext = NULL);
 
+    /// Creator wrapping client memory (zero-copy). The memory must hold
+    /// numElements * numVertices floats and outlive the buffer, which does
+    /// not release it. Returns NULL if error.
+    static CpuVertexBuffer * Create(float *cpuBuffer,
+                                    int numElements, int numVertices);
+
     /// Destructor.
     ~CpuVertexBuffer();
 
     /// This method is meant to be used in client code in order to provide
-    /// coarse vertices data to Osd.
+    /// coarse vertices data to Osd. Nothing is copied if src already points
+    /// to the vertices in the buffer (data written in place).
     void UpdateData(const float *src, int startVertex, int numVertices,
                     void *deviceContext = NULL);
 
+    /// Makes the buffer wrap client memory (see Create). The storage
+    /// allocated by the buffer, if any, is released. This allows to bind
+    /// the buffers of an Osd::Mesh to client memory, or to switch between
+    /// frames of a cache without copying them.
+    void SetCpuBuffer(float *cpuBuffer);
+
     /// Returns how many elements defined in this vertex buffer.
     int GetNumElements() const;
 
@@ -66,10 +83,14 @@ protected:
     /// Constructor.
     CpuVertexBuffer(int numElements, int numVertices);
 
+    /// Constructor wrapping client memory.
+    CpuVertexBuffer(float *cpuBuffer, int numElements, int numVertices);
+
 private:
     int _numElements;
     int _numVertices;
     float *_cpuBuffer;
+    bool _ownsBuffer;
 };
 
 
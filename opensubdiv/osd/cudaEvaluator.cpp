@@ -27,6 +27,7 @@
 #include <cuda_runtime.h>
 #include <vector>
 
+#include "../far/error.h"
 #include "../far/stencilTable.h"
 #include "../osd/types.h"
 
@@ -89,8 +90,27 @@ createCudaBuffer(std::vector<T> const & src) {
 
 // ----------------------------------------------------------------------------
 
+// The kernels locate the stencils with 32-bit offsets
+bool
+CudaStencilTable::isSupported(Far::StencilTable const *stencilTable) {
+    if (stencilTable->HasLargeOffsets()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "CudaStencilTable : stencil tables with large offsets are "
+            "not supported\n");
+        return false;
+    }
+    return true;
+}
+
+bool
+CudaStencilTable::isSupported(Far::LimitStencilTable const *limitStencilTable) {
+    return isSupported(
+        static_cast<Far::StencilTable const *>(limitStencilTable));
+}
+
 CudaStencilTable::CudaStencilTable(Far::StencilTable const *stencilTable) {
-    _numStencils = stencilTable->GetNumStencils();
+    _numStencils = isSupported(stencilTable) ?
+        stencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         _sizes   = createCudaBuffer(stencilTable->GetSizes());
         _offsets = createCudaBuffer(stencilTable->GetOffsets());
@@ -104,7 +124,8 @@ CudaStencilTable::CudaStencilTable(Far::StencilTable const *stencilTable) {
 }
 
 CudaStencilTable::CudaStencilTable(Far::LimitStencilTable const *limitStencilTable) {
-    _numStencils = limitStencilTable->GetNumStencils();
+    _numStencils = isSupported(limitStencilTable) ?
+        limitStencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         _sizes   = createCudaBuffer(limitStencilTable->GetSizes());
         _offsets = createCudaBuffer(limitStencilTable->GetOffsets());
@@ -54,12 +54,14 @@ public:
     static CudaStencilTable *Create(Far::StencilTable const *stencilTable,
                                     void *deviceContext = NULL) {
         (void)deviceContext;  // unused
-        return new CudaStencilTable(stencilTable);
+        return isSupported(stencilTable) ?
+            new CudaStencilTable(stencilTable) : NULL;
     }
     static CudaStencilTable *Create(Far::LimitStencilTable const *limitStencilTable,
                                     void *deviceContext = NULL) {
         (void)deviceContext;  // unused
-        return new CudaStencilTable(limitStencilTable);
+        return isSupported(limitStencilTable) ?
+            new CudaStencilTable(limitStencilTable) : NULL;
     }
 
     explicit CudaStencilTable(Far::StencilTable const *stencilTable);
@@ -76,6 +78,11 @@ public:
     int GetNumStencils() const { return _numStencils; }
 
 private:
+    // reports and rejects tables with large offsets (see
+    // Far::StencilTable::HasLargeOffsets)
+    static bool isSupported(Far::StencilTable const *stencilTable);
+    static bool isSupported(Far::LimitStencilTable const *limitStencilTable);
+
     void * _sizes,
          * _offsets,
          * _indices,
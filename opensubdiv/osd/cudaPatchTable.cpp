@@ -26,6 +26,7 @@
 
 #include <cuda_runtime.h>
 
+#include "../far/error.h"
 #include "../far/patchTable.h"
 #include "../osd/cpuPatchTable.h"
 
@@ -55,6 +56,17 @@ CudaPatchTable::Create(Far::PatchTable const *farPatchTable,
 
 bool
 CudaPatchTable::allocate(Far::PatchTable const *farPatchTable) {
+    // the kernels and shaders do not evaluate exact end caps
+    for (int i = 0; i < farPatchTable->GetNumPatchArrays(); ++i) {
+        if (farPatchTable->GetPatchArrayDescriptor(i).GetType() ==
+            Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "CudaPatchTable : extraordinary basis end caps are "
+                "not supported\n");
+            return false;
+        }
+    }
+
     CpuPatchTable patchTable(farPatchTable);
 
     size_t numPatchArrays = patchTable.GetNumPatchArrays();
@@ -112,6 +112,18 @@ static ID3D11ShaderResourceView *createSRV(ID3D11Buffer *buffer,
     return srv;
 }
 
+// The kernels locate the stencils with 32-bit offsets
+bool
+D3D11StencilTable::isSupported(Far::StencilTable const *stencilTable) {
+    if (stencilTable->HasLargeOffsets()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "D3D11StencilTable : stencil tables with large offsets are "
+            "not supported\n");
+        return false;
+    }
+    return true;
+}
+
 D3D11StencilTable::D3D11StencilTable(Far::StencilTable const *stencilTable,
                                      ID3D11DeviceContext *deviceContext)
  {
@@ -119,7 +131,8 @@ D3D11StencilTable::D3D11StencilTable(Far::StencilTable const *stencilTable,
     deviceContext->GetDevice(&device);
     assert(device);
 
-    _numStencils = stencilTable->GetNumStencils();
+    _numStencils = isSupported(stencilTable) ?
+        stencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         std::vector<int> const &sizes = stencilTable->GetSizes();
 
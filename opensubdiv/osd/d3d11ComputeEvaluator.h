@@ -58,12 +58,15 @@ public:
     template <typename DEVICE_CONTEXT>
     static D3D11StencilTable *Create(Far::StencilTable const *stencilTable,
                                       DEVICE_CONTEXT context) {
-        return new D3D11StencilTable(stencilTable, context->GetDeviceContext());
+        return isSupported(stencilTable) ?
+            new D3D11StencilTable(stencilTable,
+                                  context->GetDeviceContext()) : NULL;
     }
 
     static D3D11StencilTable *Create(Far::StencilTable const *stencilTable,
                                       ID3D11DeviceContext *deviceContext) {
-        return new D3D11StencilTable(stencilTable, deviceContext);
+        return isSupported(stencilTable) ?
+            new D3D11StencilTable(stencilTable, deviceContext) : NULL;
     }
 
     D3D11StencilTable(Far::StencilTable const *stencilTable,
@@ -79,6 +82,10 @@ public:
     int GetNumStencils() const { return _numStencils; }
 
 private:
+    // reports and rejects tables with large offsets (see
+    // Far::StencilTable::HasLargeOffsets)
+    static bool isSupported(Far::StencilTable const *stencilTable);
+
     ID3D11ShaderResourceView *_sizes;
     ID3D11ShaderResourceView *_offsets;
     ID3D11ShaderResourceView *_indices;
@@ -25,6 +25,7 @@
 #include "../osd/d3d11PatchTable.h"
 
 #include <D3D11.h>
+#include "../far/error.h"
 #include "../far/patchTable.h"
 #include "../osd/cpuPatchTable.h"
 
@@ -56,6 +57,17 @@ D3D11PatchTable::Create(Far::PatchTable const *farPatchTable,
 bool
 D3D11PatchTable::allocate(Far::PatchTable const *farPatchTable,
                           ID3D11DeviceContext *pd3d11DeviceContext) {
+    // the kernels and shaders do not evaluate exact end caps
+    for (int i = 0; i < farPatchTable->GetNumPatchArrays(); ++i) {
+        if (farPatchTable->GetPatchArrayDescriptor(i).GetType() ==
+            Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "D3D11PatchTable : extraordinary basis end caps are "
+                "not supported\n");
+            return false;
+        }
+    }
+
     ID3D11Device *pd3d11Device = NULL;
     pd3d11DeviceContext->GetDevice(&pd3d11Device);
     assert(pd3d11Device);
@@ -65,9 +65,28 @@ createSSBO(std::vector<T> const & src) {
     return devicePtr;
 }
 
+// The kernels locate the stencils with 32-bit offsets
+bool
+GLStencilTableSSBO::isSupported(Far::StencilTable const *stencilTable) {
+    if (stencilTable->HasLargeOffsets()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "GLStencilTableSSBO : stencil tables with large offsets are "
+            "not supported\n");
+        return false;
+    }
+    return true;
+}
+
+bool
+GLStencilTableSSBO::isSupported(Far::LimitStencilTable const *limitStencilTable) {
+    return isSupported(
+        static_cast<Far::StencilTable const *>(limitStencilTable));
+}
+
 GLStencilTableSSBO::GLStencilTableSSBO(
     Far::StencilTable const *stencilTable) {
-    _numStencils = stencilTable->GetNumStencils();
+    _numStencils = isSupported(stencilTable) ?
+        stencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         _sizes   = createSSBO(stencilTable->GetSizes());
         _offsets = createSSBO(stencilTable->GetOffsets());
@@ -82,7 +101,8 @@ GLStencilTableSSBO::GLStencilTableSSBO(
 
 GLStencilTableSSBO::GLStencilTableSSBO(
     Far::LimitStencilTable const *limitStencilTable) {
-    _numStencils = limitStencilTable->GetNumStencils();
+    _numStencils = isSupported(limitStencilTable) ?
+        limitStencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         _sizes   = createSSBO(limitStencilTable->GetSizes());
         _offsets = createSSBO(limitStencilTable->GetOffsets());
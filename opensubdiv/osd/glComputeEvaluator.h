@@ -53,13 +53,15 @@ public:
     static GLStencilTableSSBO *Create(Far::StencilTable const *stencilTable,
                                        void *deviceContext = NULL) {
         (void)deviceContext;  // unused
-        return new GLStencilTableSSBO(stencilTable);
+        return isSupported(stencilTable) ?
+            new GLStencilTableSSBO(stencilTable) : NULL;
     }
     static GLStencilTableSSBO *Create(
         Far::LimitStencilTable const *limitStencilTable,
         void *deviceContext = NULL) {
         (void)deviceContext;  // unused
-        return new GLStencilTableSSBO(limitStencilTable);
+        return isSupported(limitStencilTable) ?
+            new GLStencilTableSSBO(limitStencilTable) : NULL;
     }
 
     explicit GLStencilTableSSBO(Far::StencilTable const *stencilTable);
@@ -76,6 +78,11 @@ public:
     int GetNumStencils() const { return _numStencils; }
 
 private:
+    // reports and rejects tables with large offsets (see
+    // Far::StencilTable::HasLargeOffsets)
+    static bool isSupported(Far::StencilTable const *stencilTable);
+    static bool isSupported(Far::LimitStencilTable const *limitStencilTable);
+
     GLuint _sizes;
     GLuint _offsets;
     GLuint _indices;
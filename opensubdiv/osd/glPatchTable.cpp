@@ -24,6 +24,7 @@
 
 #include "../osd/glPatchTable.h"
 
+#include "../far/error.h"
 #include "../far/patchTable.h"
 #include "../osd/opengl.h"
 #include "../osd/cpuPatchTable.h"
@@ -56,6 +57,17 @@ GLPatchTable::Create(Far::PatchTable const *farPatchTable,
 
 bool
 GLPatchTable::allocate(Far::PatchTable const *farPatchTable) {
+    // the kernels and shaders do not evaluate exact end caps
+    for (int i = 0; i < farPatchTable->GetNumPatchArrays(); ++i) {
+        if (farPatchTable->GetPatchArrayDescriptor(i).GetType() ==
+            Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::Error(Far::FAR_RUNTIME_ERROR,
+                "GLPatchTable : extraordinary basis end caps are "
+                "not supported\n");
+            return false;
+        }
+    }
+
     glGenBuffers(1, &_patchIndexBuffer);
     glGenBuffers(1, &_patchParamBuffer);
 
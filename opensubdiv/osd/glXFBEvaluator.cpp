@@ -82,10 +82,29 @@ createGLTextureBuffer(std::vector<T> const & src, GLenum type) {
     return devicePtr;
 }
 
+// The kernels locate the stencils with 32-bit offsets
+bool
+GLStencilTableTBO::isSupported(Far::StencilTable const *stencilTable) {
+    if (stencilTable->HasLargeOffsets()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "GLStencilTableTBO : stencil tables with large offsets are "
+            "not supported\n");
+        return false;
+    }
+    return true;
+}
+
+bool
+GLStencilTableTBO::isSupported(Far::LimitStencilTable const *limitStencilTable) {
+    return isSupported(
+        static_cast<Far::StencilTable const *>(limitStencilTable));
+}
+
 GLStencilTableTBO::GLStencilTableTBO(
     Far::StencilTable const *stencilTable) {
 
-    _numStencils = stencilTable->GetNumStencils();
+    _numStencils = isSupported(stencilTable) ?
+        stencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         _sizes   = createGLTextureBuffer(stencilTable->GetSizes(), GL_R32UI);
         _offsets = createGLTextureBuffer(
@@ -103,7 +122,8 @@ GLStencilTableTBO::GLStencilTableTBO(
 GLStencilTableTBO::GLStencilTableTBO(
     Far::LimitStencilTable const *limitStencilTable) {
 
-    _numStencils = limitStencilTable->GetNumStencils();
+    _numStencils = isSupported(limitStencilTable) ?
+        limitStencilTable->GetNumStencils() : 0;
     if (_numStencils > 0) {
         _sizes   = createGLTextureBuffer(
             limitStencilTable->GetSizes(), GL_R32UI);
@@ -54,14 +54,16 @@ public:
     static GLStencilTableTBO *Create(
         Far::StencilTable const *stencilTable, void *deviceContext = NULL) {
         (void)deviceContext;  // unused
-        return new GLStencilTableTBO(stencilTable);
+        return isSupported(stencilTable) ?
+            new GLStencilTableTBO(stencilTable) : NULL;
     }
 
     static GLStencilTableTBO *Create(
         Far::LimitStencilTable const *limitStencilTable,
         void *deviceContext = NULL) {
         (void)deviceContext;  // unused
-        return new GLStencilTableTBO(limitStencilTable);
+        return isSupported(limitStencilTable) ?
+            new GLStencilTableTBO(limitStencilTable) : NULL;
     }
 
     explicit GLStencilTableTBO(Far::StencilTable const *stencilTable);
@@ -78,6 +80,11 @@ public:
     int GetNumStencils() const { return _numStencils; }
 
 private:
+    // reports and rejects tables with large offsets (see
+    // Far::StencilTable::HasLargeOffsets)
+    static bool isSupported(Far::StencilTable const *stencilTable);
+    static bool isSupported(Far::LimitStencilTable const *limitStencilTable);
+
     GLuint _sizes;
     GLuint _offsets;
     GLuint _indices;
@@ -155,7 +155,7 @@ ivec3 OsdGetPatchParam(int patchIndex)
 
 int OsdGetPatchFaceId(ivec3 patchParam)
 {
-    return (patchParam.x & 0xfffffff);
+    return (patchParam.x & 0xfffffff) | (((patchParam.y >> 5) & 0x7) << 28);
 }
 
 int OsdGetPatchFaceLevel(ivec3 patchParam)
@@ -130,7 +130,7 @@ int3 OsdGetPatchParam(int patchIndex)
 
 int OsdGetPatchFaceId(int3 patchParam)
 {
-    return (patchParam.x & 0xfffffff);
+    return (patchParam.x & 0xfffffff) | (((patchParam.y >> 5) & 0x7) << 28);
 }
 
 int OsdGetPatchFaceLevel(int3 patchParam)
@@ -32,6 +32,10 @@
 #include <cstring>
 #include <vector>
 
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
 #include "../far/topologyRefiner.h"
 #include "../far/patchTableFactory.h"
 #include "../far/stencilTable.h"
@@ -46,6 +50,8 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
+class TbbEvalQueue;
+
 enum MeshBits {
     MeshAdaptive             = 0,
     MeshInterleaveVarying    = 1,
@@ -54,7 +60,8 @@ enum MeshBits {
     MeshEndCapBSplineBasis   = 4,  // exclusive
     MeshEndCapGregoryBasis   = 5,  // exclusive
     MeshEndCapLegacyGregory  = 6,  // exclusive
-    NUM_MESH_BITS            = 7,
+    MeshFuseVaryingStencils  = 7,
+    NUM_MESH_BITS            = 8,
 };
 typedef std::bitset<NUM_MESH_BITS> MeshBitset;
 
@@ -153,6 +160,62 @@ convertToCompatibleStencilTable<Far::StencilTable, Far::StencilTable, ID3D11Devi
     return new Far::StencilTable(*table);
 }
 
+// The TBB evaluator evaluates Far stencil tables, queued or not
+template <>
+inline Far::StencilTable const *
+convertToCompatibleStencilTable<Far::StencilTable, Far::StencilTable, TbbEvalQueue>(
+    Far::StencilTable const *table, TbbEvalQueue *  /*context*/) {
+    // no need for conversion
+    if (not table) return NULL;
+    return new Far::StencilTable(*table);
+}
+
+template <>
+inline Far::LimitStencilTable const *
+convertToCompatibleStencilTable<Far::LimitStencilTable, Far::LimitStencilTable, TbbEvalQueue>(
+    Far::LimitStencilTable const *table, TbbEvalQueue *  /*context*/) {
+    // no need for conversion
+    if (not table) return NULL;
+    return new Far::LimitStencilTable(*table);
+}
+
+// Converts a stencil table created by Osd::Mesh and releases it, or adopts it
+// when no conversion is needed.
+template <typename STENCIL_TABLE, typename DEVICE_CONTEXT>
+struct stencilTableAdopter {
+    static STENCIL_TABLE const *Adopt(
+        Far::StencilTable const *table, DEVICE_CONTEXT *context) {
+        STENCIL_TABLE const *result =
+            convertToCompatibleStencilTable<STENCIL_TABLE>(table, context);
+        delete table;
+        return result;
+    }
+};
+
+template <>
+struct stencilTableAdopter<Far::StencilTable, void> {
+    static Far::StencilTable const *Adopt(
+        Far::StencilTable const *table, void * /*context*/) {
+        return table;
+    }
+};
+
+template <>
+struct stencilTableAdopter<Far::StencilTable, ID3D11DeviceContext> {
+    static Far::StencilTable const *Adopt(
+        Far::StencilTable const *table, ID3D11DeviceContext * /*context*/) {
+        return table;
+    }
+};
+
+template <>
+struct stencilTableAdopter<Far::StencilTable, TbbEvalQueue> {
+    static Far::StencilTable const *Adopt(
+        Far::StencilTable const *table, TbbEvalQueue * /*context*/) {
+        return table;
+    }
+};
+
 // ---------------------------------------------------------------------------
 
 // Osd evaluator cache: for the GPU backends require compiled instance
@@ -245,6 +308,17 @@ struct instantiatable
     template <typename C> static no  &chk(...);
     static bool const value = sizeof(chk<EVALUATOR>(0)) == sizeof(yes);
 };
+// template helpers to see if the evaluator can evaluate vertex and varying
+// stencils together.
+template <typename EVALUATOR>
+struct fusible
+{
+    typedef char yes[1];
+    typedef char no[2];
+    template <typename C> static yes &chk(typename C::FusedStencils *t=0);
+    template <typename C> static no  &chk(...);
+    static bool const value = sizeof(chk<EVALUATOR>(0)) == sizeof(yes);
+};
 template <bool C, typename T=void>
 struct enable_if { typedef T type; };
 template <typename T>
@@ -307,6 +381,43 @@ static EVALUATOR *GetEvaluator(
     return NULL;
 }
 
+// evaluate vertex and varying stencils in a single pass if available
+template <typename EVALUATOR, typename VERTEX_BUFFER,
+          typename STENCIL_TABLE, typename DEVICE_CONTEXT>
+static bool EvalFusedStencils(
+    VERTEX_BUFFER *srcBuffer,        BufferDescriptor const &srcDesc,
+    VERTEX_BUFFER *dstBuffer,        BufferDescriptor const &dstDesc,
+    VERTEX_BUFFER *varyingSrcBuffer, BufferDescriptor const &varyingSrcDesc,
+    VERTEX_BUFFER *varyingDstBuffer, BufferDescriptor const &varyingDstDesc,
+    STENCIL_TABLE const *stencilTable,
+    STENCIL_TABLE const *varyingStencilTable,
+    DEVICE_CONTEXT deviceContext,
+    typename enable_if<fusible<EVALUATOR>::value, void>::type*t=0) {
+    (void)t;
+    return EVALUATOR::EvalStencils(srcBuffer, srcDesc,
+                                   dstBuffer, dstDesc,
+                                   varyingSrcBuffer, varyingSrcDesc,
+                                   varyingDstBuffer, varyingDstDesc,
+                                   stencilTable, varyingStencilTable,
+                                   NULL, deviceContext);
+}
+
+// fallback
+template <typename EVALUATOR, typename VERTEX_BUFFER,
+          typename STENCIL_TABLE, typename DEVICE_CONTEXT>
+static bool EvalFusedStencils(
+    VERTEX_BUFFER *, BufferDescriptor const &,
+    VERTEX_BUFFER *, BufferDescriptor const &,
+    VERTEX_BUFFER *, BufferDescriptor const &,
+    VERTEX_BUFFER *, BufferDescriptor const &,
+    STENCIL_TABLE const *,
+    STENCIL_TABLE const *,
+    DEVICE_CONTEXT,
+    typename enable_if<!fusible<EVALUATOR>::value, void>::type*t=0) {
+    (void)t;
+    return false;
+}
+
 // ---------------------------------------------------------------------------
 
 template <typename VERTEX_BUFFER,
@@ -342,7 +453,9 @@ public:
             _varyingStencilTable(NULL),
             _evaluatorCache(evaluatorCache),
             _patchTable(NULL),
-            _deviceContext(deviceContext) {
+            _deviceContext(deviceContext),
+            _fuseVaryingStencils(bits.test(MeshFuseVaryingStencils)),
+            _tables(NULL) {
 
         assert(_refiner);
 
@@ -351,39 +464,74 @@ public:
             bits.test(MeshAdaptive),
             bits.test(MeshUseSingleCreasePatch));
 
-        int vertexBufferStride = numVertexElements +
-            (bits.test(MeshInterleaveVarying) ? numVaryingElements : 0);
-        int varyingBufferStride =
-            (bits.test(MeshInterleaveVarying) ? 0 : numVaryingElements);
-
         initializeContext(numVertexElements,
                           numVaryingElements,
                           level, bits);
 
-        initializeVertexBuffers(_numVertices,
-                                vertexBufferStride,
-                                varyingBufferStride);
+        _tables = new Tables(_refiner, _farPatchTable,
+                             _vertexStencilTable, _varyingStencilTable,
+                             _patchTable);
 
-        // configure vertex buffer descriptor
-        _vertexDesc =
-            BufferDescriptor(0, numVertexElements, vertexBufferStride);
-        if (bits.test(MeshInterleaveVarying)) {
-            _varyingDesc = BufferDescriptor(
-                numVertexElements, numVaryingElements, vertexBufferStride);
-        } else {
-            _varyingDesc = BufferDescriptor(
-                0, numVaryingElements, varyingBufferStride);
-        }
+        initializeBuffers(numVertexElements, numVaryingElements, bits);
+    }
+
+    /// \brief Constructor sharing the refined topology, the stencil tables
+    ///        and the patch tables of an existing mesh
+    ///
+    /// The tables are immutable once built : meshes with identical topology
+    /// (e.g. instances of a crowd) can reference a single copy of them and
+    /// only allocate their own vertex buffers. The tables are released with
+    /// the last mesh using them : meshes sharing tables can be created and
+    /// deleted from different threads, as long as the source mesh outlives
+    /// this constructor.
+    ///
+    /// Varying primvars can only be shared from a mesh created with varying
+    /// elements, and device tables require the same device context.
+    ///
+    /// @param source              mesh to share the tables of
+    ///
+    /// @param numVertexElements   number of vertex elements of this mesh
+    ///
+    /// @param numVaryingElements  number of varying elements of this mesh
+    ///
+    /// @param bits                buffer layout bits (MeshInterleaveVarying,
+    ///                            MeshFuseVaryingStencils) : the topology bits
+    ///                            of the source mesh apply
+    ///
+    Mesh(Mesh const & source,
+         int numVertexElements,
+         int numVaryingElements,
+         MeshBitset bits = MeshBitset(),
+         EvaluatorCache * evaluatorCache = NULL,
+         DeviceContext * deviceContext = NULL) :
+
+            _refiner(source._refiner),
+            _farPatchTable(source._farPatchTable),
+            _numVertices(source._numVertices),
+            _maxValence(source._maxValence),
+            _vertexBuffer(NULL),
+            _varyingBuffer(NULL),
+            _vertexStencilTable(source._vertexStencilTable),
+            _varyingStencilTable(source._varyingStencilTable),
+            _evaluatorCache(evaluatorCache),
+            _patchTable(source._patchTable),
+            _deviceContext(deviceContext),
+            _fuseVaryingStencils(bits.test(MeshFuseVaryingStencils)),
+            _tables(source._tables) {
+
+        assert(numVaryingElements == 0 or _varyingStencilTable);
+
+        _tables->Retain();
+
+        initializeBuffers(numVertexElements, numVaryingElements, bits);
     }
 
     virtual ~Mesh() {
-        delete _refiner;
-        delete _farPatchTable;
         delete _vertexBuffer;
         delete _varyingBuffer;
-        delete _vertexStencilTable;
-        delete _varyingStencilTable;
-        delete _patchTable;
+        if (_tables->Release()) {
+            delete _tables;
+        }
         // deviceContext and evaluatorCache are not owned by this class.
     }
 
@@ -401,12 +549,39 @@ public:
 
     virtual void Refine() {
 
+        // device stencil tables are NULL if the device rejected the Far
+        // tables (e.g. tables with large offsets)
+        if (not _vertexStencilTable) return;
+
         int numControlVertices = _refiner->GetLevel(0).GetNumVertices();
 
         BufferDescriptor srcDesc = _vertexDesc;
         BufferDescriptor dstDesc(srcDesc);
         dstDesc.offset += numControlVertices * dstDesc.stride;
 
+        bool hasVarying = _varyingDesc.length > 0 and _varyingStencilTable;
+
+        if (_fuseVaryingStencils and hasVarying) {
+            BufferDescriptor varyingSrcDesc = _varyingDesc;
+            BufferDescriptor varyingDstDesc(varyingSrcDesc);
+            varyingDstDesc.offset += numControlVertices * varyingDstDesc.stride;
+
+            VertexBuffer * varyingBuffer =
+                _varyingBuffer ? _varyingBuffer : _vertexBuffer;
+
+            // single traversal of the stencils (evaluators without a fused
+            // kernel fall through to separate passes)
+            if (EvalFusedStencils<Evaluator>(_vertexBuffer, srcDesc,
+                                             _vertexBuffer, dstDesc,
+                                             varyingBuffer, varyingSrcDesc,
+                                             varyingBuffer, varyingDstDesc,
+                                             _vertexStencilTable,
+                                             _varyingStencilTable,
+                                             _deviceContext)) {
+                return;
+            }
+        }
+
         // note that the _evaluatorCache can be NULL and thus
         // the evaluatorInstance can be NULL
         //  (for uninstantiatable kernels CPU,TBB etc)
@@ -419,7 +594,7 @@ public:
                                 _vertexStencilTable,
                                 instance, _deviceContext);
 
-        if (_varyingDesc.length > 0) {
+        if (hasVarying) {
             BufferDescriptor srcDesc = _varyingDesc;
             BufferDescriptor dstDesc(srcDesc);
             dstDesc.offset += numControlVertices * dstDesc.stride;
@@ -559,17 +734,39 @@ private:
         _numVertices = vertexStencils->GetNumControlVertices()
             + vertexStencils->GetNumStencils();
 
-        // convert to device stenciltable if necessary.
+        // convert to device stenciltable if necessary (Far::Stencils are
+        // adopted as is).
         _vertexStencilTable =
-            convertToCompatibleStencilTable<StencilTable>(
+            stencilTableAdopter<StencilTable, DeviceContext>::Adopt(
             vertexStencils, _deviceContext);
-        _varyingStencilTable =
-            convertToCompatibleStencilTable<StencilTable>(
-            varyingStencils, _deviceContext);
+        _varyingStencilTable = varyingStencils ?
+            stencilTableAdopter<StencilTable, DeviceContext>::Adopt(
+            varyingStencils, _deviceContext) : NULL;
+    }
+
+    void initializeBuffers(int numVertexElements,
+                           int numVaryingElements,
+                           MeshBitset bits) {
 
-        // FIXME: we do extra copyings for Far::Stencils.
-        delete vertexStencils;
-        delete varyingStencils;
+        int vertexBufferStride = numVertexElements +
+            (bits.test(MeshInterleaveVarying) ? numVaryingElements : 0);
+        int varyingBufferStride =
+            (bits.test(MeshInterleaveVarying) ? 0 : numVaryingElements);
+
+        initializeVertexBuffers(_numVertices,
+                                vertexBufferStride,
+                                varyingBufferStride);
+
+        // configure vertex buffer descriptor
+        _vertexDesc =
+            BufferDescriptor(0, numVertexElements, vertexBufferStride);
+        if (bits.test(MeshInterleaveVarying)) {
+            _varyingDesc = BufferDescriptor(
+                numVertexElements, numVaryingElements, vertexBufferStride);
+        } else {
+            _varyingDesc = BufferDescriptor(
+                0, numVaryingElements, varyingBufferStride);
+        }
     }
 
     void initializeVertexBuffers(int numVertices,
@@ -605,6 +802,58 @@ private:
 
     PatchTable *_patchTable;
     DeviceContext *_deviceContext;
+
+    bool _fuseVaryingStencils;
+
+    // Immutable tables, reference counted between the meshes sharing them.
+    // The count is updated atomically since the meshes can be created and
+    // deleted from different threads.
+    struct Tables {
+        Tables(Far::TopologyRefiner * refiner,
+               Far::PatchTable * farPatchTable,
+               StencilTable const * vertexStencilTable,
+               StencilTable const * varyingStencilTable,
+               PatchTable * patchTable) :
+            refiner(refiner), farPatchTable(farPatchTable),
+            vertexStencilTable(vertexStencilTable),
+            varyingStencilTable(varyingStencilTable),
+            patchTable(patchTable), refCount(1) { }
+
+        ~Tables() {
+            delete refiner;
+            delete farPatchTable;
+            delete vertexStencilTable;
+            delete varyingStencilTable;
+            delete patchTable;
+        }
+
+        // Adds a reference to the tables
+        void Retain() {
+#if defined(_MSC_VER)
+            _InterlockedIncrement(&refCount);
+#else
+            __atomic_add_fetch(&refCount, 1, __ATOMIC_RELAXED);
+#endif
+        }
+
+        // Removes a reference to the tables, returns true for the last one
+        bool Release() {
+#if defined(_MSC_VER)
+            return _InterlockedDecrement(&refCount) == 0;
+#else
+            return __atomic_sub_fetch(&refCount, 1, __ATOMIC_ACQ_REL) == 0;
+#endif
+        }
+
+        Far::TopologyRefiner * refiner;
+        Far::PatchTable * farPatchTable;
+        StencilTable const * vertexStencilTable;
+        StencilTable const * varyingStencilTable;
+        PatchTable * patchTable;
+        long volatile refCount;
+    };
+
+    Tables * _tables;
 };
 
 } // end namespace Osd
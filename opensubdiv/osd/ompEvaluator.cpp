@@ -24,7 +24,13 @@
 
 #include "../osd/ompEvaluator.h"
 #include "../osd/ompKernel.h"
+#include "../osd/cpuKernel.h"
+#include "../far/error.h"
 #include "../far/patchBasis.h"
+#include "../far/stencilTable.h"
+
+#include <algorithm>
+#include <cassert>
 #include <omp.h>
 
 namespace OpenSubdiv {
@@ -32,6 +38,155 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
+// Minimum number of patch coords scheduled at once : the cost of evaluating
+// a coord depends on the type of its patch, so a guided schedule is used
+// rather than static ranges of equal size.
+static int const PATCH_COORD_GRAIN_SIZE = 64;
+
+// ---------------------------------------------------------------------------
+
+/* static */
+OmpNumaTopology
+OmpNumaTopology::Detect() {
+
+    int numThreads = omp_get_max_threads();
+
+#if _OPENMP >= 201511
+    int numPlaces = omp_get_num_places();
+    if (numPlaces > 1 and numThreads >= numPlaces) {
+        return OmpNumaTopology(numPlaces, numThreads / numPlaces);
+    }
+#endif
+    return OmpNumaTopology(1, numThreads);
+}
+
+// The ranges are copied with 32-bit offsets
+bool
+OmpStencilTable::isSupported(Far::StencilTable const *stencilTable) {
+    if (stencilTable->HasLargeOffsets()) {
+        Far::Error(Far::FAR_RUNTIME_ERROR,
+            "OmpStencilTable : stencil tables with large offsets are "
+            "not supported\n");
+        return false;
+    }
+    return true;
+}
+
+bool
+OmpStencilTable::isSupported(Far::LimitStencilTable const *limitStencilTable) {
+    return isSupported(
+        static_cast<Far::StencilTable const *>(limitStencilTable));
+}
+
+OmpStencilTable::OmpStencilTable(Far::StencilTable const *stencilTable,
+                                 OmpNumaTopology const &topology) :
+    _sizes(0), _offsets(0), _indices(0), _weights(0),
+    _duWeights(0), _dvWeights(0), _numStencils(0), _numWeights(0),
+    _topology(topology) {
+
+    _numStencils = isSupported(stencilTable) ?
+        stencilTable->GetNumStencils() : 0;
+    if (_numStencils > 0) {
+        initialize(&stencilTable->GetSizes()[0],
+                   &stencilTable->GetOffsets()[0],
+                   &stencilTable->GetControlIndices()[0],
+                   &stencilTable->GetWeights()[0], 0, 0);
+    } else {
+        _partitions.assign(1, 0);
+    }
+}
+
+OmpStencilTable::OmpStencilTable(Far::LimitStencilTable const *limitStencilTable,
+                                 OmpNumaTopology const &topology) :
+    _sizes(0), _offsets(0), _indices(0), _weights(0),
+    _duWeights(0), _dvWeights(0), _numStencils(0), _numWeights(0),
+    _topology(topology) {
+
+    _numStencils = isSupported(limitStencilTable) ?
+        limitStencilTable->GetNumStencils() : 0;
+    if (_numStencils > 0) {
+        initialize(&limitStencilTable->GetSizes()[0],
+                   &limitStencilTable->GetOffsets()[0],
+                   &limitStencilTable->GetControlIndices()[0],
+                   &limitStencilTable->GetWeights()[0],
+                   &limitStencilTable->GetDuWeights()[0],
+                   &limitStencilTable->GetDvWeights()[0]);
+    } else {
+        _partitions.assign(1, 0);
+    }
+}
+
+OmpStencilTable::~OmpStencilTable() {
+
+    delete [] _sizes;
+    delete [] _offsets;
+    delete [] _indices;
+    delete [] _weights;
+    delete [] _duWeights;
+    delete [] _dvWeights;
+}
+
+void
+OmpStencilTable::initialize(int const * sizes, int const * offsets,
+                            int const * indices, float const * weights,
+                            float const * duWeights, float const * dvWeights) {
+
+    // the stencils are first split into one contiguous range per node, then
+    // each node range into one range per thread of the node, both balanced
+    // by number of weights : the arrays of a node are contiguous, and only
+    // the pages at the boundaries of the node ranges are shared by nodes.
+    int numNodes = std::max(_topology.numNodes, 1),
+        numThreadsPerNode = std::max(_topology.numThreadsPerNode, 1);
+
+    StencilPartition nodePartition(sizes, offsets, 0, _numStencils,
+        numNodes, /*grainSize*/ 1);
+
+    _partitions.resize(numNodes*numThreadsPerNode+1);
+    _partitions[0] = 0;
+    for (int node = 0; node < numNodes; ++node) {
+
+        int first = nodePartition.GetChunkBegin(node),
+            last = nodePartition.GetChunkBegin(node+1);
+
+        int * nodePartitions = &_partitions[node*numThreadsPerNode];
+        if (first == last) {
+            // empty node range
+            for (int i = 1; i <= numThreadsPerNode; ++i) {
+                nodePartitions[i] = last;
+            }
+            continue;
+        }
+
+        StencilPartition threadPartition(sizes, offsets, first, last,
+            numThreadsPerNode, /*grainSize*/ 1);
+        for (int i = 1; i <= numThreadsPerNode; ++i) {
+            nodePartitions[i] = threadPartition.GetChunkBegin(i);
+        }
+    }
+
+    _numWeights = offsets[_numStencils-1] + sizes[_numStencils-1];
+
+    // new[] does not initialize (nor touch) the storage : pages are placed
+    // on the nodes of the threads copying the ranges.
+    _sizes = new int[_numStencils];
+    _offsets = new int[_numStencils];
+    _indices = new int[_numWeights];
+    _weights = new float[_numWeights];
+    if (duWeights and dvWeights) {
+        _duWeights = new float[_numWeights];
+        _dvWeights = new float[_numWeights];
+    }
+
+    OmpCopyStencilPartitions(sizes, offsets, indices, weights,
+                             duWeights, dvWeights,
+                             _sizes, _offsets, _indices, _weights,
+                             _duWeights, _dvWeights,
+                             _topology.GetNumThreads(), GetNumPartitions(),
+                             &_partitions[0]);
+}
+
+// ---------------------------------------------------------------------------
+
 /* static */
 bool
 OmpEvaluator::EvalStencils(
@@ -41,14 +196,14 @@ OmpEvaluator::EvalStencils(
     const int * offsets,
     const int * indices,
     const float * weights,
-    int start, int end) {
+    int start, int end, int grainSize) {
 
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
 
     // XXX: we can probably expand cpuKernel.cpp to here.
     OmpEvalStencils(src, srcDesc, dst, dstDesc,
-                    sizes, offsets, indices, weights, start, end);
+                    sizes, offsets, indices, weights, start, end, grainSize);
 
     return true;
 }
@@ -66,7 +221,7 @@ OmpEvaluator::EvalStencils(
     const float * weights,
     const float * duWeights,
     const float * dvWeights,
-    int start, int end) {
+    int start, int end, int grainSize) {
 
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
@@ -79,11 +234,162 @@ OmpEvaluator::EvalStencils(
                     dv,  dvDesc,
                     sizes, offsets, indices,
                     weights, duWeights, dvWeights,
-                    start, end);
+                    start, end, grainSize);
+
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    const int * sizes,
+    const size_t * offsets,
+    const int * indices,
+    const float * weights,
+    int start, int end, int grainSize) {
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    OmpEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end, grainSize);
+
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    const int * sizes,
+    const size_t * offsets,
+    const int * indices,
+    const float * weights,
+    const float * duWeights,
+    const float * dvWeights,
+    int start, int end, int grainSize) {
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+
+    OmpEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end, grainSize);
+
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalStencils(
+    const float *src,        BufferDescriptor const &srcDesc,
+    float *dst,              BufferDescriptor const &dstDesc,
+    const float *varyingSrc, BufferDescriptor const &varyingSrcDesc,
+    float *varyingDst,       BufferDescriptor const &varyingDstDesc,
+    const int * sizes,
+    const int * offsets,
+    const int * indices,
+    const float * weights,
+    const int * varyingSizes,
+    const int * varyingOffsets,
+    const int * varyingIndices,
+    const float * varyingWeights,
+    int start, int end, int grainSize) {
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (varyingSrcDesc.length != varyingDstDesc.length) return false;
+
+    OmpEvalStencils(src, srcDesc, dst, dstDesc,
+                    varyingSrc, varyingSrcDesc,
+                    varyingDst, varyingDstDesc,
+                    sizes, offsets, indices, weights,
+                    varyingSizes, varyingOffsets,
+                    varyingIndices, varyingWeights,
+                    start, end, grainSize);
+
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    OmpStencilTable const *stencilTable) {
+
+    if (stencilTable->GetNumStencils() == 0) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    OmpEvalStencilPartitions(src, srcDesc,
+                             dst, dstDesc,
+                             0, BufferDescriptor(),
+                             0, BufferDescriptor(),
+                             stencilTable->GetSizesBuffer(),
+                             stencilTable->GetOffsetsBuffer(),
+                             stencilTable->GetIndicesBuffer(),
+                             stencilTable->GetWeightsBuffer(), 0, 0,
+                             stencilTable->GetTopology().GetNumThreads(),
+                             stencilTable->GetNumPartitions(),
+                             stencilTable->GetPartitionsBuffer());
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    OmpStencilTable const *stencilTable) {
 
+    if (stencilTable->GetNumStencils() == 0) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+    if (not stencilTable->GetDuWeightsBuffer()) return false;
+
+    OmpEvalStencilPartitions(src, srcDesc,
+                             dst, dstDesc,
+                             du,  duDesc,
+                             dv,  dvDesc,
+                             stencilTable->GetSizesBuffer(),
+                             stencilTable->GetOffsetsBuffer(),
+                             stencilTable->GetIndicesBuffer(),
+                             stencilTable->GetWeightsBuffer(),
+                             stencilTable->GetDuWeightsBuffer(),
+                             stencilTable->GetDvWeightsBuffer(),
+                             stencilTable->GetTopology().GetNumThreads(),
+                             stencilTable->GetNumPartitions(),
+                             stencilTable->GetPartitionsBuffer());
     return true;
 }
 
+/* static */
+void
+OmpEvaluator::FirstTouch(float *dst, BufferDescriptor const &dstDesc,
+                         OmpStencilTable const *stencilTable) {
+
+    if (stencilTable->GetNumStencils() == 0) return;
+
+    OmpFirstTouchStencilPartitions(dst, dstDesc,
+                                   stencilTable->GetTopology().GetNumThreads(),
+                                   stencilTable->GetNumPartitions(),
+                                   stencilTable->GetPartitionsBuffer());
+}
+
 template <typename T>
 struct BufferAdapter {
     BufferAdapter(T *p, int length, int stride) :
@@ -100,7 +406,7 @@ struct BufferAdapter {
         }
     }
     const T *operator[] (int index) const {
-        return _p + _stride * index;
+        return _p + (ptrdiff_t)_stride * index;
     }
     BufferAdapter<T> & operator ++() {
         if (_p) {
@@ -130,7 +436,7 @@ OmpEvaluator::EvalPatches(
     else return false;
     BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(guided, PATCH_COORD_GRAIN_SIZE)
     for (int i = 0; i < numPatchCoords; ++i) {
         BufferAdapter<float> dstT(dst + dstDesc.stride*i, dstDesc.length, dstDesc.stride);
 
@@ -145,6 +451,9 @@ OmpEvaluator::EvalPatches(
         Far::PatchParam const & param =
             patchParamBuffer[coord.handle.patchIndex];
 
+        const int *cvs =
+            patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
         int numControlVertices = 0;
         if (patchType == Far::PatchDescriptor::REGULAR) {
             Far::internal::GetBSplineWeights(param,
@@ -154,6 +463,11 @@ OmpEvaluator::EvalPatches(
             Far::internal::GetGregoryWeights(param,
                                              coord.s, coord.t, wP, wDs, wDt);
             numControlVertices = 20;
+        } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::internal::GetExtraordinaryWeights(param,
+                Far::internal::GetExtraordinaryValence(cvs),
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 20;
         } else if (patchType == Far::PatchDescriptor::QUADS) {
             Far::internal::GetBilinearWeights(param,
                                               coord.s, coord.t, wP, wDs, wDt);
@@ -161,8 +475,6 @@ OmpEvaluator::EvalPatches(
         } else {
             continue;
         }
-        const int *cvs =
-            &patchIndexBuffer[array.indexBase + coord.handle.vertIndex];
 
         dstT.Clear();
         for (int j = 0; j < numControlVertices; ++j) {
@@ -192,7 +504,7 @@ OmpEvaluator::EvalPatches(
 
     BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(guided, PATCH_COORD_GRAIN_SIZE)
     for (int i = 0; i < numPatchCoords; ++i) {
         float wP[20], wDs[20], wDt[20];
         BufferAdapter<float> dstT(dst + dstDesc.stride*i, dstDesc.length, dstDesc.stride);
@@ -206,6 +518,9 @@ OmpEvaluator::EvalPatches(
         Far::PatchParam const & param =
             patchParamBuffer[coord.handle.patchIndex];
 
+        const int *cvs =
+            patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
         int numControlVertices = 0;
         if (patchType == Far::PatchDescriptor::REGULAR) {
             Far::internal::GetBSplineWeights(param,
@@ -215,6 +530,11 @@ OmpEvaluator::EvalPatches(
             Far::internal::GetGregoryWeights(param,
                                              coord.s, coord.t, wP, wDs, wDt);
             numControlVertices = 20;
+        } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+            Far::internal::GetExtraordinaryWeights(param,
+                Far::internal::GetExtraordinaryValence(cvs),
+                coord.s, coord.t, wP, wDs, wDt);
+            numControlVertices = 20;
         } else if (patchType == Far::PatchDescriptor::QUADS) {
             Far::internal::GetBilinearWeights(param,
                                               coord.s, coord.t, wP, wDs, wDt);
@@ -222,8 +542,6 @@ OmpEvaluator::EvalPatches(
         } else {
             continue;
         }
-        const int *cvs =
-            &patchIndexBuffer[array.indexBase + coord.handle.vertIndex];
 
         dstT.Clear();
         duT.Clear();
@@ -240,6 +558,164 @@ OmpEvaluator::EvalPatches(
     return true;
 }
 
+/* static */
+bool
+OmpEvaluator::EvalPatchesVarying(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer) {
+
+    if ((not src) or (not dst)) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    // the legacy Gregory patches have no varying corners
+    if (not CpuCheckVaryingPatchCoords(numPatchCoords, patchCoords,
+                                       patchArrays)) {
+        return false;
+    }
+
+    src += srcDesc.offset;
+    dst += dstDesc.offset;
+
+    BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
+
+#pragma omp parallel for schedule(guided, PATCH_COORD_GRAIN_SIZE)
+    for (int i = 0; i < numPatchCoords; ++i) {
+        BufferAdapter<float> dstT(dst + dstDesc.stride*i,
+                                  dstDesc.length, dstDesc.stride);
+        float wP[4];
+        int cvs[4];
+        int numCorners = CpuGetVaryingPatchWeights(patchCoords[i],
+            patchArrays, patchIndexBuffer, patchParamBuffer, wP, cvs);
+
+        dstT.Clear();
+        for (int j = 0; j < numCorners; ++j) {
+            dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
+        }
+    }
+    return true;
+}
+
+/* static */
+bool
+OmpEvaluator::EvalPatchesFaceVarying(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *fvarPatchArrays,
+    const int *fvarPatchIndexBuffer,
+    const PatchParam *patchParamBuffer) {
+
+    if ((not src) or (not dst)) return false;
+
+    return EvalPatches(NULL, BufferDescriptor(), NULL, BufferDescriptor(),
+                       src, srcDesc, dst, dstDesc,
+                       numPatchCoords, patchCoords,
+                       NULL, NULL, patchParamBuffer,
+                       fvarPatchArrays, fvarPatchIndexBuffer);
+}
+
+/* static */
+bool
+OmpEvaluator::EvalPatches(
+    const float *src,     BufferDescriptor const &srcDesc,
+    float *dst,           BufferDescriptor const &dstDesc,
+    const float *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+    float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const PatchArray *fvarPatchArrays,
+    const int *fvarPatchIndexBuffer) {
+
+    if (src) {
+        if ((not dst) or srcDesc.length != dstDesc.length) return false;
+        src += srcDesc.offset;
+        dst += dstDesc.offset;
+    }
+    if (fvarSrc) {
+        if ((not fvarDst) or fvarSrcDesc.length != fvarDstDesc.length or
+            (not fvarPatchArrays) or (not fvarPatchIndexBuffer)) {
+            return false;
+        }
+        fvarSrc += fvarSrcDesc.offset;
+        fvarDst += fvarDstDesc.offset;
+    }
+
+    BufferAdapter<const float> srcT(src, srcDesc.length, srcDesc.stride);
+    BufferAdapter<const float> fvarSrcT(fvarSrc, fvarSrcDesc.length,
+                                                 fvarSrcDesc.stride);
+
+#pragma omp parallel for schedule(guided, PATCH_COORD_GRAIN_SIZE)
+    for (int i = 0; i < numPatchCoords; ++i) {
+        float wP[20], wDs[20], wDt[20];
+        PatchCoord const &coord = patchCoords[i];
+
+        if (src) {
+            BufferAdapter<float> dstT(dst + dstDesc.stride*i,
+                                      dstDesc.length, dstDesc.stride);
+
+            PatchArray const &array = patchArrays[coord.handle.arrayIndex];
+
+            int patchType = array.GetPatchType();
+            Far::PatchParam const & param =
+                patchParamBuffer[coord.handle.patchIndex];
+
+            const int *cvs =
+                patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
+            int numControlVertices = 0;
+            if (patchType == Far::PatchDescriptor::REGULAR) {
+                Far::internal::GetBSplineWeights(param,
+                                                 coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 16;
+            } else if (patchType == Far::PatchDescriptor::GREGORY_BASIS) {
+                Far::internal::GetGregoryWeights(param,
+                                                 coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 20;
+            } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+                Far::internal::GetExtraordinaryWeights(param,
+                    Far::internal::GetExtraordinaryValence(cvs),
+                    coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 20;
+            } else if (patchType == Far::PatchDescriptor::QUADS) {
+                Far::internal::GetBilinearWeights(param,
+                                                  coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 4;
+            }
+
+            dstT.Clear();
+            for (int j = 0; j < numControlVertices; ++j) {
+                dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
+            }
+        }
+
+        if (fvarSrc) {
+            BufferAdapter<float> fvarDstT(fvarDst + fvarDstDesc.stride*i,
+                                          fvarDstDesc.length,
+                                          fvarDstDesc.stride);
+
+            const int *values = NULL;
+            int numValues = CpuGetFVarPatchWeights(coord,
+                fvarPatchArrays, fvarPatchIndexBuffer, patchParamBuffer,
+                wP, &values);
+
+            fvarDstT.Clear();
+            for (int j = 0; j < numValues; ++j) {
+                fvarDstT.AddWithWeight(fvarSrcT[values[j]], wP[j]);
+            }
+        }
+    }
+    return true;
+}
+
 /* static */
 void
 OmpEvaluator::Synchronize(void * /*deviceContext*/) {
@@ -252,6 +728,55 @@ OmpEvaluator::SetNumThreads(int numThreads) {
     omp_set_num_threads(numThreads);
 }
 
+/* static */
+bool
+OmpEvaluator::EvalPatchesBezier(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const int *bezierPointIndices) {
+
+    return EvalPatchesBezier(src, srcDesc, dst, dstDesc,
+                             NULL, BufferDescriptor(), NULL, BufferDescriptor(),
+                             numPatchCoords, patchCoords,
+                             patchArrays, patchIndexBuffer, patchParamBuffer,
+                             bezierPointIndices);
+}
+
+/* static */
+bool
+OmpEvaluator::EvalPatchesBezier(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const int *bezierPointIndices) {
+
+    if ((not src) or (not dst)) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (du and srcDesc.length != duDesc.length) return false;
+    if (dv and srcDesc.length != dvDesc.length) return false;
+
+#pragma omp parallel for schedule(guided, PATCH_COORD_GRAIN_SIZE)
+    for (int i = 0; i < numPatchCoords; ++i) {
+        CpuEvalPatchesBezier(src, srcDesc, dst, dstDesc, du, duDesc, dv, dvDesc,
+                             patchCoords, patchArrays, patchIndexBuffer,
+                             patchParamBuffer, bezierPointIndices,
+                             i, i + 1);
+    }
+
+    return true;
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
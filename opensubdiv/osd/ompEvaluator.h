@@ -27,17 +27,160 @@
 
 #include "../version.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <vector>
 #include "../osd/types.h"
 #include "../osd/bufferDescriptor.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+namespace Far {
+    class StencilTable;
+    class LimitStencilTable;
+}
+
 namespace Osd {
 
+/// \brief Description of the NUMA nodes and of the threads evaluating
+///        stencils on each of them
+///
+/// Thread t of the OpenMP team is expected to run on node
+/// t / numThreadsPerNode : teams are bound with proc_bind(close), so this
+/// holds when the OpenMP places match the nodes (e.g. OMP_PLACES=sockets).
+///
+/// Any topology can be described explicitly, which allows to simulate
+/// several nodes on a single-socket machine.
+///
+struct OmpNumaTopology {
+
+    OmpNumaTopology(int numNodes_ = 1, int numThreadsPerNode_ = 1) :
+        numNodes(numNodes_), numThreadsPerNode(numThreadsPerNode_) { }
+
+    /// \brief Returns the topology of the OpenMP places (one node per place,
+    ///        sharing the default number of threads) or a single node if no
+    ///        places are defined
+    static OmpNumaTopology Detect();
+
+    /// \brief Returns the number of threads in the team
+    int GetNumThreads() const { return numNodes * numThreadsPerNode; }
+
+    /// \brief Returns the node of the given thread
+    int GetThreadNode(int thread) const { return thread / numThreadsPerNode; }
+
+    int numNodes,
+        numThreadsPerNode;
+};
+
+/// \brief NUMA-aware stencil table for the OpenMP evaluator
+///
+/// The stencils are split into one contiguous range per node, and each node
+/// range into one contiguous range per thread of the node, both balanced by
+/// number of weights. The arrays of each range are copied -- and therefore
+/// first-touched, i.e. allocated on its node -- by the thread that evaluates
+/// the range : evaluation always assigns the same range to the same thread,
+/// so each thread only reads stencils from local memory, frame after frame.
+///
+/// The destination rows of each range can also be placed on the node of its
+/// thread with OmpEvaluator::FirstTouch(), as long as the vertex buffer was
+/// not written before (CpuVertexBuffer does not initialize its storage).
+///
+/// \note Stencil tables with 64-bit offsets (more than 2^31 weights) are
+///       not supported : Create reports an error and returns NULL for them
+///       (evaluate them with the Far tables directly).
+///
+class OmpStencilTable {
+public:
+    static OmpStencilTable *Create(Far::StencilTable const *stencilTable,
+                                   void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return isSupported(stencilTable) ?
+            new OmpStencilTable(stencilTable, OmpNumaTopology::Detect()) : NULL;
+    }
+
+    static OmpStencilTable *Create(Far::LimitStencilTable const *limitStencilTable,
+                                   void *deviceContext = NULL) {
+        (void)deviceContext;  // unused
+        return isSupported(limitStencilTable) ?
+            new OmpStencilTable(limitStencilTable,
+                                OmpNumaTopology::Detect()) : NULL;
+    }
+
+    OmpStencilTable(Far::StencilTable const *stencilTable,
+                    OmpNumaTopology const &topology);
+    OmpStencilTable(Far::LimitStencilTable const *limitStencilTable,
+                    OmpNumaTopology const &topology);
+    ~OmpStencilTable();
+
+    int GetNumStencils() const { return _numStencils; }
+
+    int const * GetSizesBuffer() const { return _sizes; }
+    int const * GetOffsetsBuffer() const { return _offsets; }
+    int const * GetIndicesBuffer() const { return _indices; }
+    float const * GetWeightsBuffer() const { return _weights; }
+    float const * GetDuWeightsBuffer() const { return _duWeights; }
+    float const * GetDvWeightsBuffer() const { return _dvWeights; }
+
+    OmpNumaTopology const & GetTopology() const { return _topology; }
+
+    /// \brief Returns the number of ranges of stencils (one per thread of
+    ///        the topology, some of them empty if there are too few stencils)
+    int GetNumPartitions() const { return (int)_partitions.size()-1; }
+
+    /// \brief Returns the node of the thread evaluating a range
+    int GetPartitionNode(int partition) const {
+        return _topology.GetThreadNode(partition);
+    }
+
+    /// \brief Returns the first stencil of the ranges of a node (the end of
+    ///        the last node is the number of stencils)
+    int GetNodeBegin(int node) const {
+        return _partitions[std::min(node*_topology.numThreadsPerNode,
+                                    GetNumPartitions())];
+    }
+
+    /// \brief Returns the first stencil of a range (the end of the last
+    ///        range is the number of stencils)
+    int GetPartitionBegin(int partition) const { return _partitions[partition]; }
+
+    /// \brief Returns the ranges boundaries (GetNumPartitions()+1 values)
+    int const * GetPartitionsBuffer() const { return &_partitions[0]; }
+
+private:
+    // reports and rejects tables with large offsets (see
+    // Far::StencilTable::HasLargeOffsets)
+    static bool isSupported(Far::StencilTable const *stencilTable);
+    static bool isSupported(Far::LimitStencilTable const *limitStencilTable);
+
+    void initialize(int const * sizes, int const * offsets,
+                    int const * indices, float const * weights,
+                    float const * duWeights, float const * dvWeights);
+
+    // Non-copyable:
+    OmpStencilTable(OmpStencilTable const &) { }
+    OmpStencilTable & operator=(OmpStencilTable const &) { return *this; }
+
+    int * _sizes;
+    int * _offsets;
+    int * _indices;
+    float * _weights;
+    float * _duWeights;
+    float * _dvWeights;
+
+    int _numStencils,
+        _numWeights;
+
+    OmpNumaTopology _topology;
+    std::vector<int> _partitions;
+};
+
 class OmpEvaluator {
 public:
+    /// Vertex and varying stencils can be evaluated together
+    /// (see Osd::MeshFuseVaryingStencils)
+    typedef bool FusedStencils;
+
     /// ----------------------------------------------------------------------
     ///
     ///   Stencil evaluations with StencilTable
@@ -79,6 +222,18 @@ public:
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
+        size_t const * largeOffsets = GetLargeStencilOffsets(stencilTable);
+        if (largeOffsets) {
+            return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                &stencilTable->GetSizes()[0],
+                                largeOffsets,
+                                &stencilTable->GetControlIndices()[0],
+                                &stencilTable->GetWeights()[0],
+                                /*start = */ 0,
+                                /*end   = */ stencilTable->GetNumStencils());
+        }
+
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
                             &stencilTable->GetSizes()[0],
@@ -116,6 +271,9 @@ public:
     ///
     /// @param end            end index of stencil table
     ///
+    /// @param grainSize      minimum number of stencil weights evaluated by
+    ///                       a single thread (0 uses the default)
+    ///
     static bool EvalStencils(
         const float *src,  BufferDescriptor const &srcDesc,
         float *dst,        BufferDescriptor const &dstDesc,
@@ -123,7 +281,19 @@ public:
         const int * offsets,
         const int * indices,
         const float * weights,
-        int start, int end);
+        int start, int end, int grainSize = 0);
+
+    /// \brief Same as above, with the 64-bit offsets of stencil tables of
+    ///        more than 2^31 weights (see Far::StencilTable::HasLargeOffsets)
+    ///
+    static bool EvalStencils(
+        const float *src,  BufferDescriptor const &srcDesc,
+        float *dst,        BufferDescriptor const &dstDesc,
+        const int * sizes,
+        const size_t * offsets,
+        const int * indices,
+        const float * weights,
+        int start, int end, int grainSize = 0);
 
     /// \brief Generic static eval stencils function with derivatives.
     ///        This function has a same signature as other device kernels
@@ -175,6 +345,22 @@ public:
         (void)instance;       // unused
         (void)deviceContext;  // unused
 
+        size_t const * largeOffsets = GetLargeStencilOffsets(stencilTable);
+        if (largeOffsets) {
+            return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                duBuffer->BindCpuBuffer(),  duDesc,
+                                dvBuffer->BindCpuBuffer(),  dvDesc,
+                                &stencilTable->GetSizes()[0],
+                                largeOffsets,
+                                &stencilTable->GetControlIndices()[0],
+                                &stencilTable->GetWeights()[0],
+                                &stencilTable->GetDuWeights()[0],
+                                &stencilTable->GetDvWeights()[0],
+                                /*start = */ 0,
+                                /*end   = */ stencilTable->GetNumStencils());
+        }
+
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
                             duBuffer->BindCpuBuffer(),  duDesc,
@@ -229,6 +415,9 @@ public:
     ///
     /// @param end            end index of stencil table
     ///
+    /// @param grainSize      minimum number of stencil weights evaluated by
+    ///                       a single thread (0 uses the default)
+    ///
     static bool EvalStencils(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
@@ -240,7 +429,259 @@ public:
         const float * weights,
         const float * duWeights,
         const float * dvWeights,
-        int start, int end);
+        int start, int end, int grainSize = 0);
+
+    /// \brief Same as above, with the 64-bit offsets of stencil tables of
+    ///        more than 2^31 weights (see Far::StencilTable::HasLargeOffsets)
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const size_t * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end, int grainSize = 0);
+
+    /// \brief Generic static fused eval stencils function. Evaluates the
+    ///        vertex and varying stencil tables of a mesh in a single
+    ///        traversal of the stencils (the varying table is expected to
+    ///        have the same number of stencils as the vertex table).
+    ///
+    /// With interleaved varying data, the source and destination buffers
+    /// of both tables are the same and each row is written once.
+    ///
+    /// @param srcBuffer        Input primvar buffer.
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output primvar buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param varyingSrcBuffer Input varying primvar buffer.
+    ///
+    /// @param varyingSrcDesc   vertex buffer descriptor for the varying input
+    ///
+    /// @param varyingDstBuffer Output varying primvar buffer
+    ///
+    /// @param varyingDstDesc   vertex buffer descriptor for the varying output
+    ///
+    /// @param stencilTable     vertex stencil table
+    ///
+    /// @param varyingStencilTable  varying stencil table
+    ///
+    /// @param instance         not used in the omp kernel
+    ///
+    /// @param deviceContext    not used in the omp kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer,        BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,        BufferDescriptor const &dstDesc,
+        SRC_BUFFER *varyingSrcBuffer, BufferDescriptor const &varyingSrcDesc,
+        DST_BUFFER *varyingDstBuffer, BufferDescriptor const &varyingDstDesc,
+        STENCIL_TABLE const *stencilTable,
+        STENCIL_TABLE const *varyingStencilTable,
+        const OmpEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        if (stencilTable->GetNumStencils() == 0)
+            return false;
+
+        if (varyingStencilTable->GetNumStencils() !=
+                stencilTable->GetNumStencils() or
+            GetLargeStencilOffsets(stencilTable) or
+            GetLargeStencilOffsets(varyingStencilTable)) {
+            return EvalStencils(srcBuffer, srcDesc, dstBuffer, dstDesc,
+                                stencilTable) and
+                   EvalStencils(varyingSrcBuffer, varyingSrcDesc,
+                                varyingDstBuffer, varyingDstDesc,
+                                varyingStencilTable);
+        }
+
+        return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            varyingSrcBuffer->BindCpuBuffer(), varyingSrcDesc,
+                            varyingDstBuffer->BindCpuBuffer(), varyingDstDesc,
+                            &stencilTable->GetSizes()[0],
+                            &stencilTable->GetOffsets()[0],
+                            &stencilTable->GetControlIndices()[0],
+                            &stencilTable->GetWeights()[0],
+                            &varyingStencilTable->GetSizes()[0],
+                            &varyingStencilTable->GetOffsets()[0],
+                            &varyingStencilTable->GetControlIndices()[0],
+                            &varyingStencilTable->GetWeights()[0],
+                            /*start = */ 0,
+                            /*end   = */ stencilTable->GetNumStencils());
+    }
+
+    /// \brief Static fused eval stencils function, which takes raw CPU
+    ///        pointers for input and output (see above).
+    ///
+    /// The ranges [start, end) of both stencil tables are evaluated.
+    ///
+    static bool EvalStencils(
+        const float *src,        BufferDescriptor const &srcDesc,
+        float *dst,              BufferDescriptor const &dstDesc,
+        const float *varyingSrc, BufferDescriptor const &varyingSrcDesc,
+        float *varyingDst,       BufferDescriptor const &varyingDstDesc,
+        const int * sizes,
+        const int * offsets,
+        const int * indices,
+        const float * weights,
+        const int * varyingSizes,
+        const int * varyingOffsets,
+        const int * varyingIndices,
+        const float * varyingWeights,
+        int start, int end, int grainSize = 0);
+
+    /// ----------------------------------------------------------------------
+    ///
+    ///   NUMA-aware stencil evaluations with OmpStencilTable
+    ///
+    /// ----------------------------------------------------------------------
+
+    /// \brief Generic static eval stencils function with an OmpStencilTable :
+    ///        each range of stencils is evaluated by the thread (and on the
+    ///        node) on which it was allocated.
+    ///
+    /// @param srcBuffer      Input primvar buffer.
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       const float pointer for read
+    ///
+    /// @param srcDesc        vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   OmpStencilTable
+    ///
+    /// @param instance       not used in the omp kernel
+    ///
+    /// @param deviceContext  not used in the omp kernel
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        OmpStencilTable const *stencilTable,
+        const OmpEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencils(static_cast<const float *>(
+                                srcBuffer->BindCpuBuffer()), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            stencilTable);
+    }
+
+    /// \brief Static eval stencils function with an OmpStencilTable, which
+    ///        takes raw CPU pointers for input and output.
+    static bool EvalStencils(
+        const float *src,  BufferDescriptor const &srcDesc,
+        float *dst,        BufferDescriptor const &dstDesc,
+        OmpStencilTable const *stencilTable);
+
+    /// \brief Generic static eval stencils function with derivatives and an
+    ///        OmpStencilTable (created from a Far::LimitStencilTable).
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        OmpStencilTable const *stencilTable,
+        const OmpEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencils(static_cast<const float *>(
+                                srcBuffer->BindCpuBuffer()), srcDesc,
+                            dstBuffer->BindCpuBuffer(), dstDesc,
+                            duBuffer->BindCpuBuffer(),  duDesc,
+                            dvBuffer->BindCpuBuffer(),  dvDesc,
+                            stencilTable);
+    }
+
+    /// \brief Static eval stencils function with derivatives and an
+    ///        OmpStencilTable, which takes raw CPU pointers for input and
+    ///        output.
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        OmpStencilTable const *stencilTable);
+
+    /// \brief Generic vertex + varying eval stencils function with
+    ///        OmpStencilTables. Each table keeps its own partitions : they
+    ///        are evaluated one after the other.
+    template <typename SRC_BUFFER, typename DST_BUFFER>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer,        BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer,        BufferDescriptor const &dstDesc,
+        SRC_BUFFER *varyingSrcBuffer, BufferDescriptor const &varyingSrcDesc,
+        DST_BUFFER *varyingDstBuffer, BufferDescriptor const &varyingDstDesc,
+        OmpStencilTable const *stencilTable,
+        OmpStencilTable const *varyingStencilTable,
+        const OmpEvaluator *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalStencils(srcBuffer, srcDesc, dstBuffer, dstDesc,
+                            stencilTable) and
+               EvalStencils(varyingSrcBuffer, varyingSrcDesc,
+                            varyingDstBuffer, varyingDstDesc,
+                            varyingStencilTable);
+    }
+
+    /// \brief Places the destination rows of each range of stencils on the
+    ///        node of the thread evaluating it (first-touch policy).
+    ///
+    /// Must be called before anything else writes to the buffer : the
+    /// operating system allocates a page on the node of the first thread
+    /// touching it. The rows are cleared.
+    ///
+    /// @param dstBuffer      Output primvar buffer
+    ///                       must have BindCpuBuffer() method returning a
+    ///                       float pointer for write
+    ///
+    /// @param dstDesc        vertex buffer descriptor for the output buffer
+    ///
+    /// @param stencilTable   OmpStencilTable
+    ///
+    template <typename DST_BUFFER>
+    static void FirstTouch(DST_BUFFER *dstBuffer,
+                           BufferDescriptor const &dstDesc,
+                           OmpStencilTable const *stencilTable) {
+        FirstTouch(dstBuffer->BindCpuBuffer(), dstDesc, stencilTable);
+    }
+
+    /// \brief Places the destination rows of each range of stencils on the
+    ///        node of the thread evaluating it (raw CPU pointer version).
+    static void FirstTouch(float *dst, BufferDescriptor const &dstDesc,
+                           OmpStencilTable const *stencilTable);
 
     /// ----------------------------------------------------------------------
     ///
@@ -454,6 +895,355 @@ public:
         const int *patchIndexBuffer,
         PatchParam const *patchParamBuffer);
 
+    /// \brief Generic varying limit eval function. This function has a
+    ///        same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// Varying primvars are interpolated bilinearly between the corners of
+    /// the patches, so that each location only gathers 4 values.
+    ///
+    /// @param srcBuffer        Input varying buffer, refined with varying
+    ///                         stencils (including the varying stencils of
+    ///                         the end cap local points, see
+    ///                         Far::PatchTable::GetLocalPointVaryingStencilTable())
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output varying buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the omp evaluator
+    ///
+    /// @param deviceContext    not used in the omp evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        OmpEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesVarying(
+            srcBuffer->BindCpuBuffer(), srcDesc,
+            dstBuffer->BindCpuBuffer(), dstDesc,
+            numPatchCoords,
+            (const PatchCoord*)patchCoords->BindCpuBuffer(),
+            patchTable->GetPatchArrayBuffer(),
+            patchTable->GetPatchIndexBuffer(),
+            patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static varying limit eval function. It takes an array of
+    ///        PatchCoord and interpolates varying primvars bilinearly
+    ///        between the corner control vertices of the patches.
+    ///
+    /// Legacy Gregory patches (ENDCAP_LEGACY_GREGORY) have no control
+    /// vertices at their corners : the evaluation fails if any of the
+    /// PatchCoords is located on one of them.
+    ///
+    /// @param src                  Input varying pointer. An offset of
+    ///                             srcDesc will be applied internally.
+    ///
+    /// @param srcDesc              vertex buffer descriptor for the input
+    ///                             buffer
+    ///
+    /// @param dst                  Output varying pointer. An offset of
+    ///                             dstDesc will be applied internally.
+    ///
+    /// @param dstDesc              vertex buffer descriptor for the output
+    ///                             buffer
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param patchArrays          an array of Osd::PatchArray struct
+    ///                             indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer     an array of patch indices
+    ///                             indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesVarying(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer);
+
+    /// \brief Generic face-varying limit eval function. This function has a
+    ///        same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// The face-varying patches of Far::PatchTable are bilinear : the values
+    /// are interpolated bilinearly between the face-varying values of the
+    /// corners of the patches. Returns false for channels without patches
+    /// (see CpuPatchTable::GetFVarPatchArrayBuffer()).
+    ///
+    /// @param srcBuffer        Input face-varying buffer, indexed by the
+    ///                         face-varying values of the patch table (see
+    ///                         Far::PatchTable::GetFVarValues())
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output face-varying buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param fvarChannel      face-varying channel of the patch table
+    ///
+    /// @param instance         not used in the omp evaluator
+    ///
+    /// @param deviceContext    not used in the omp evaluator
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesFaceVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        int fvarChannel = 0,
+        OmpEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)instance;       // unused
+        (void)deviceContext;  // unused
+
+        return EvalPatchesFaceVarying(
+            srcBuffer->BindCpuBuffer(), srcDesc,
+            dstBuffer->BindCpuBuffer(), dstDesc,
+            numPatchCoords,
+            (const PatchCoord*)patchCoords->BindCpuBuffer(),
+            patchTable->GetFVarPatchArrayBuffer(fvarChannel),
+            patchTable->GetFVarPatchIndexBuffer(fvarChannel),
+            patchTable->GetPatchParamBuffer());
+    }
+
+    /// \brief Static face-varying limit eval function. It takes an array of
+    ///        PatchCoord and interpolates the face-varying values of a
+    ///        channel of the PatchTable.
+    ///
+    /// @param src                  Input face-varying pointer. An offset of
+    ///                             srcDesc will be applied internally.
+    ///
+    /// @param srcDesc              vertex buffer descriptor for the input
+    ///                             buffer
+    ///
+    /// @param dst                  Output face-varying pointer. An offset of
+    ///                             dstDesc will be applied internally.
+    ///
+    /// @param dstDesc              vertex buffer descriptor for the output
+    ///                             buffer
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param fvarPatchArrays      an array of Osd::PatchArray struct of the
+    ///                             face-varying channel, indexed by
+    ///                             PatchCoord::arrayIndex
+    ///
+    /// @param fvarPatchIndexBuffer an array of face-varying value indices
+    ///                             of the channel
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    static bool EvalPatchesFaceVarying(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *fvarPatchArrays,
+        const int *fvarPatchIndexBuffer,
+        const PatchParam *patchParamBuffer);
+
+    /// \brief Static limit eval function evaluating the vertex and the
+    ///        face-varying values of the same PatchCoords in a single pass.
+    ///
+    /// Either evaluation is skipped if its input pointer is NULL.
+    ///
+    /// @param src                  Input vertex primvar pointer
+    ///
+    /// @param srcDesc              vertex buffer descriptor for src
+    ///
+    /// @param dst                  Output vertex primvar pointer
+    ///
+    /// @param dstDesc              vertex buffer descriptor for dst
+    ///
+    /// @param fvarSrc              Input face-varying pointer
+    ///
+    /// @param fvarSrcDesc          vertex buffer descriptor for fvarSrc
+    ///
+    /// @param fvarDst              Output face-varying pointer
+    ///
+    /// @param fvarDstDesc          vertex buffer descriptor for fvarDst
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param patchArrays          an array of Osd::PatchArray struct
+    ///                             indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer     an array of patch indices
+    ///                             indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    /// @param fvarPatchArrays      an array of Osd::PatchArray struct of the
+    ///                             face-varying channel
+    ///
+    /// @param fvarPatchIndexBuffer an array of face-varying value indices
+    ///                             of the channel
+    ///
+    static bool EvalPatches(
+        const float *src,     BufferDescriptor const &srcDesc,
+        float *dst,           BufferDescriptor const &dstDesc,
+        const float *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+        float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const PatchArray *fvarPatchArrays,
+        const int *fvarPatchIndexBuffer);
+
+    /// \brief Static limit eval function using the Bezier form of the
+    ///        regular patches (see Far::BezierPatchTable).
+    ///
+    /// The patches with Bezier points are evaluated in Bernstein form from
+    /// their 16 points, the other patches from their control vertices.
+    ///
+    /// @param src                Input primvar pointer, holding the Bezier
+    ///                           points after the vertices of the patch
+    ///                           table. An offset of srcDesc will be applied
+    ///                           internally.
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst                Output primvar pointer. An offset of dstDesc
+    ///                           will be applied internally.
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords     number of patchCoords.
+    ///
+    /// @param patchCoords        array of locations to be evaluated.
+    ///
+    /// @param patchArrays        an array of Osd::PatchArray struct
+    ///                           indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer   an array of patch indices
+    ///                           indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer   an array of Osd::PatchParam struct
+    ///                           indexed by PatchCoord::patchIndex
+    ///
+    /// @param bezierPointIndices the index of the first Bezier point of each
+    ///                           patch, or -1 (see
+    ///                           Far::BezierPatchTable::GetBezierPointIndexTable())
+    ///
+    static bool EvalPatchesBezier(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const int *bezierPointIndices);
+
+    /// \brief Static limit eval function with derivatives using the Bezier
+    ///        form of the regular patches (see Far::BezierPatchTable).
+    ///
+    /// @param src                Input primvar pointer, holding the Bezier
+    ///                           points after the vertices of the patch
+    ///                           table. An offset of srcDesc will be applied
+    ///                           internally.
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst                Output primvar pointer. An offset of dstDesc
+    ///                           will be applied internally.
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the output buffer
+    ///
+    /// @param du                 Output U-derivatives pointer. An offset of
+    ///                           duDesc will be applied internally.
+    ///
+    /// @param duDesc             vertex buffer descriptor for the du buffer
+    ///
+    /// @param dv                 Output V-derivatives pointer. An offset of
+    ///                           dvDesc will be applied internally.
+    ///
+    /// @param dvDesc             vertex buffer descriptor for the dv buffer
+    ///
+    /// @param numPatchCoords     number of patchCoords.
+    ///
+    /// @param patchCoords        array of locations to be evaluated.
+    ///
+    /// @param patchArrays        an array of Osd::PatchArray struct
+    ///                           indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer   an array of patch indices
+    ///                           indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer   an array of Osd::PatchParam struct
+    ///                           indexed by PatchCoord::patchIndex
+    ///
+    /// @param bezierPointIndices the index of the first Bezier point of each
+    ///                           patch, or -1 (see
+    ///                           Far::BezierPatchTable::GetBezierPointIndexTable())
+    ///
+    static bool EvalPatchesBezier(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const int *bezierPointIndices);
+
     /// ----------------------------------------------------------------------
     ///
     ///   Other methods
@@ -23,98 +23,115 @@
 //
 
 #include "../osd/ompKernel.h"
+#include "../osd/cpuKernel.h"
 #include "../osd/bufferDescriptor.h"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <omp.h>
-#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
-template <class T> T *
-elementAtIndex(T * src, int index, BufferDescriptor const &desc) {
+// Number of chunks of stencils per thread : more chunks than threads allow
+// the dynamic schedule to compensate for threads being delayed (unequal
+// memory access costs, other work...)
+static int const CHUNKS_PER_THREAD = 4;
 
-    return src + index * desc.stride;
-}
-
-static inline void
-clear(float *dst, BufferDescriptor const &desc) {
+// Each chunk of stencils is evaluated serially : results are accumulated in
+// stack buffers private to the thread and written to a contiguous range of
+// the destination, so threads only share cache lines at chunk boundaries.
 
-    assert(dst);
-    memset(dst, 0, desc.length*sizeof(float));
-}
+// The kernels are instantiated for 32-bit and 64-bit stencil offsets
+template <class OFFSET> static void
+ompEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                OFFSET const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize) {
 
-static inline void
-addWithWeight(float *dst, const float *src, int srcIndex, float weight,
-              BufferDescriptor const &desc) {
+    StencilPartition partition(sizes, offsets, start, end,
+        omp_get_max_threads() * CHUNKS_PER_THREAD, grainSize);
 
-    assert(src and dst);
-    src = elementAtIndex(src, srcIndex, desc);
-    for (int k = 0; k < desc.length; ++k) {
-        dst[k] += src[k] * weight;
-    }
-}
+    int numChunks = partition.GetNumChunks();
 
-static inline void
-copy(float *dst, int dstIndex, const float *src,
-     BufferDescriptor const &desc) {
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
 
-    assert(src and dst);
+        int first = partition.GetChunkBegin(chunk),
+            last = partition.GetChunkBegin(chunk+1);
+        if (first == last) continue;
 
-    dst = elementAtIndex(dst, dstIndex, desc);
-    memcpy(dst, src, desc.length*sizeof(float));
+        CpuEvalStencils(src, srcDesc,
+                        dst + (ptrdiff_t)(first-start)*dstDesc.stride, dstDesc,
+                        sizes, offsets, indices, weights, first, last);
+    }
 }
 
-
-// XXXX manuelk this should be optimized further by using SIMD - considering
-//              OMP is somewhat obsolete - this is probably not worth it.
-void
-OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+template <class OFFSET> static void
+ompEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
                 int const * sizes,
-                int const * offsets,
+                OFFSET const * offsets,
                 int const * indices,
                 float const * weights,
-                int start, int end) {
-    if (start > 0) {
-        sizes += start;
-        indices += offsets[start];
-        weights += offsets[start];
-    }
-    src += srcDesc.offset;
-    dst += dstDesc.offset;
-
-    int numThreads = omp_get_max_threads();
-    int n = end - start;
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end, int grainSize) {
 
-    float * result = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
+    StencilPartition partition(sizes, offsets, start, end,
+        omp_get_max_threads() * CHUNKS_PER_THREAD, grainSize);
 
-#pragma omp parallel for
-    for (int i = 0; i < n; ++i) {
+    int numChunks = partition.GetNumChunks();
 
-        int index = i + (start > 0 ? start : 0); // Stencil index
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
 
-        // Get thread-local pointers
-        int const           * threadIndices = indices + offsets[index];
-        float const         * threadWeights = weights + offsets[index];
+        int first = partition.GetChunkBegin(chunk),
+            last = partition.GetChunkBegin(chunk+1);
+        if (first == last) continue;
 
-        int threadId = omp_get_thread_num();
+        CpuEvalStencils(src, srcDesc,
+                        dst + (ptrdiff_t)(first-start)*dstDesc.stride, dstDesc,
+                        dstDu + (ptrdiff_t)(first-start)*dstDuDesc.stride, dstDuDesc,
+                        dstDv + (ptrdiff_t)(first-start)*dstDvDesc.stride, dstDvDesc,
+                        sizes, offsets, indices,
+                        weights, duWeights, dvWeights, first, last);
+    }
+}
 
-        float * threadResult = result + threadId*srcDesc.length;
+void
+OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                int const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize) {
 
-        clear(threadResult, dstDesc);
+    ompEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end, grainSize);
+}
 
-        for (int j=0; j<(int)sizes[index]; ++j) {
-            addWithWeight(threadResult, src,
-                threadIndices[j], threadWeights[j], srcDesc);
-        }
+void
+OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize) {
 
-        copy(dst, i, threadResult, dstDesc);
-    }
+    ompEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end, grainSize);
 }
 
 void
@@ -128,62 +145,203 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * weights,
                 float const * duWeights,
                 float const * dvWeights,
-                int start, int end) {
-    if (start > 0) {
-        sizes += start;
-        indices += offsets[start];
-        weights += offsets[start];
-        duWeights += offsets[start];
-        dvWeights += offsets[start];
-    }
-
-    src += srcDesc.offset;
-    dst += dstDesc.offset;
-    dstDu += dstDuDesc.offset;
-    dstDv += dstDvDesc.offset;
+                int start, int end, int grainSize) {
 
-    int numThreads = omp_get_max_threads();
-    int n = end - start;
+    ompEvalStencils(src, srcDesc, dst, dstDesc,
+                    dstDu, dstDuDesc, dstDv, dstDvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights, start, end, grainSize);
+}
 
-    float * result = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
-    float * resultDu = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
-    float * resultDv = (float*)alloca(srcDesc.length * numThreads * sizeof(float));
+void
+OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end, int grainSize) {
 
-#pragma omp parallel for
-    for (int i = 0; i < n; ++i) {
+    ompEvalStencils(src, srcDesc, dst, dstDesc,
+                    dstDu, dstDuDesc, dstDv, dstDvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights, start, end, grainSize);
+}
 
-        int index = i + (start > 0 ? start : 0); // Stencil index
+void
+OmpEvalStencils(float const * src,        BufferDescriptor const &srcDesc,
+                float * dst,              BufferDescriptor const &dstDesc,
+                float const * varyingSrc, BufferDescriptor const &varyingSrcDesc,
+                float * varyingDst,       BufferDescriptor const &varyingDstDesc,
+                int const * sizes,
+                int const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * varyingSizes,
+                int const * varyingOffsets,
+                int const * varyingIndices,
+                float const * varyingWeights,
+                int start, int end, int grainSize) {
+
+    // chunks are balanced on the vertex stencils, usually the larger ones
+    StencilPartition partition(sizes, offsets, start, end,
+        omp_get_max_threads() * CHUNKS_PER_THREAD, grainSize);
+
+    int numChunks = partition.GetNumChunks();
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+
+        int first = partition.GetChunkBegin(chunk),
+            last = partition.GetChunkBegin(chunk+1);
+        if (first == last) continue;
+
+        CpuEvalStencils(src, srcDesc,
+                        dst + (ptrdiff_t)(first-start)*dstDesc.stride, dstDesc,
+                        varyingSrc, varyingSrcDesc,
+                        varyingDst + (ptrdiff_t)(first-start)*varyingDstDesc.stride,
+                        varyingDstDesc,
+                        sizes, offsets, indices, weights,
+                        varyingSizes, varyingOffsets,
+                        varyingIndices, varyingWeights, first, last);
+    }
+}
 
-        // Get thread-local pointers
-        int const           * threadIndices = indices + offsets[index];
-        float const         * threadWeights = weights + offsets[index];
-        float const         * threadWeightsDu = duWeights + offsets[index];
-        float const         * threadWeightsDv = dvWeights + offsets[index];
+//
+// NUMA-aware evaluation
+//
+// Each thread of the team handles the same range(s) of stencils in every
+// parallel region : as long as the team is bound the same way, the arrays
+// of a range are first-touched, and then read, from the same node.
+//
+// (proc_bind requires OpenMP 4.0, older runtimes rely on OMP_PROC_BIND)
+//
+void
+OmpEvalStencilPartitions(float const * src, BufferDescriptor const &srcDesc,
+                         float * dst,       BufferDescriptor const &dstDesc,
+                         float * dstDu,     BufferDescriptor const &dstDuDesc,
+                         float * dstDv,     BufferDescriptor const &dstDvDesc,
+                         int const * sizes,
+                         int const * offsets,
+                         int const * indices,
+                         float const * weights,
+                         float const * duWeights,
+                         float const * dvWeights,
+                         int numThreads, int numPartitions,
+                         int const * partitions) {
+
+#if _OPENMP >= 201307
+#pragma omp parallel num_threads(numThreads) proc_bind(close)
+#else
+#pragma omp parallel num_threads(numThreads)
+#endif
+    {
+        for (int p = omp_get_thread_num(); p < numPartitions;
+            p += omp_get_num_threads()) {
+
+            int first = partitions[p],
+                last = partitions[p+1];
+            if (first == last) continue;
+
+            if (dst and dstDu and dstDv) {
+                CpuEvalStencils(src, srcDesc,
+                                dst + (ptrdiff_t)first*dstDesc.stride, dstDesc,
+                                dstDu + (ptrdiff_t)first*dstDuDesc.stride, dstDuDesc,
+                                dstDv + (ptrdiff_t)first*dstDvDesc.stride, dstDvDesc,
+                                sizes, offsets, indices,
+                                weights, duWeights, dvWeights, first, last);
+                continue;
+            }
+            if (dst) {
+                CpuEvalStencils(src, srcDesc,
+                                dst + (ptrdiff_t)first*dstDesc.stride, dstDesc,
+                                sizes, offsets, indices, weights, first, last);
+            }
+            if (dstDu) {
+                CpuEvalStencils(src, srcDesc,
+                                dstDu + (ptrdiff_t)first*dstDuDesc.stride, dstDuDesc,
+                                sizes, offsets, indices, duWeights, first, last);
+            }
+            if (dstDv) {
+                CpuEvalStencils(src, srcDesc,
+                                dstDv + (ptrdiff_t)first*dstDvDesc.stride, dstDvDesc,
+                                sizes, offsets, indices, dvWeights, first, last);
+            }
+        }
+    }
+}
 
-        int threadId = omp_get_thread_num();
+void
+OmpCopyStencilPartitions(int const * srcSizes, int const * srcOffsets,
+                         int const * srcIndices, float const * srcWeights,
+                         float const * srcDuWeights, float const * srcDvWeights,
+                         int * sizes, int * offsets,
+                         int * indices, float * weights,
+                         float * duWeights, float * dvWeights,
+                         int numThreads, int numPartitions,
+                         int const * partitions) {
+
+#if _OPENMP >= 201307
+#pragma omp parallel num_threads(numThreads) proc_bind(close)
+#else
+#pragma omp parallel num_threads(numThreads)
+#endif
+    {
+        for (int p = omp_get_thread_num(); p < numPartitions;
+            p += omp_get_num_threads()) {
+
+            int first = partitions[p],
+                last = partitions[p+1];
+            if (first == last) continue;
+
+            int numStencils = last - first,
+                firstWeight = srcOffsets[first],
+                numWeights = srcOffsets[last-1] + srcSizes[last-1] - firstWeight;
+
+            memcpy(sizes + first, srcSizes + first, numStencils*sizeof(int));
+            memcpy(offsets + first, srcOffsets + first, numStencils*sizeof(int));
+
+            memcpy(indices + firstWeight, srcIndices + firstWeight,
+                numWeights*sizeof(int));
+            memcpy(weights + firstWeight, srcWeights + firstWeight,
+                numWeights*sizeof(float));
+            if (duWeights) {
+                memcpy(duWeights + firstWeight, srcDuWeights + firstWeight,
+                    numWeights*sizeof(float));
+            }
+            if (dvWeights) {
+                memcpy(dvWeights + firstWeight, srcDvWeights + firstWeight,
+                    numWeights*sizeof(float));
+            }
+        }
+    }
+}
 
-        float * threadResult = result + threadId*srcDesc.length;
-        float * threadResultDu = resultDu + threadId*srcDesc.length;
-        float * threadResultDv = resultDv + threadId*srcDesc.length;
+void
+OmpFirstTouchStencilPartitions(float * dst, BufferDescriptor const &dstDesc,
+                               int numThreads, int numPartitions,
+                               int const * partitions) {
 
-        clear(threadResult, dstDesc);
-        clear(threadResultDu, dstDuDesc);
-        clear(threadResultDv, dstDvDesc);
+    dst += dstDesc.offset;
 
-        for (int j=0; j<(int)sizes[index]; ++j) {
-            addWithWeight(threadResult, src,
-                threadIndices[j], threadWeights[j], srcDesc);
-            addWithWeight(threadResultDu, src,
-                threadIndices[j], threadWeightsDu[j], srcDesc);
-            addWithWeight(threadResultDv, src,
-                threadIndices[j], threadWeightsDv[j], srcDesc);
+#if _OPENMP >= 201307
+#pragma omp parallel num_threads(numThreads) proc_bind(close)
+#else
+#pragma omp parallel num_threads(numThreads)
+#endif
+    {
+        for (int p = omp_get_thread_num(); p < numPartitions;
+            p += omp_get_num_threads()) {
+
+            for (int i = partitions[p]; i < partitions[p+1]; ++i) {
+                memset(dst + (ptrdiff_t)i*dstDesc.stride, 0, dstDesc.length*sizeof(float));
+            }
         }
-
-        copy(dst, i, threadResult, dstDesc);
-        copy(dstDu, i, threadResultDu, dstDuDesc);
-        copy(dstDv, i, threadResultDv, dstDvDesc);
     }
-
 }
 
 }  // end namespace Osd
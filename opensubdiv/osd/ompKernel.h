@@ -27,6 +27,8 @@
 
 #include "../version.h"
 
+#include <cstddef>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -34,6 +36,8 @@ namespace Osd {
 
 struct BufferDescriptor;
 
+// The stencils [start, end) are split into chunks of at least 'grainSize'
+// weights (0 uses the default grain size, see StencilPartition)
 void
 OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
@@ -41,7 +45,7 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 int const * offsets,
                 int const * indices,
                 float const * weights,
-                int start, int end);
+                int start, int end, int grainSize = 0);
 
 void
 OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
@@ -54,7 +58,85 @@ OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * weights,
                 float const * duWeights,
                 float const * dvWeights,
-                int start, int end);
+                int start, int end, int grainSize = 0);
+
+// 64-bit offsets (stencil tables of more than 2^31 weights)
+void
+OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize = 0);
+
+void
+OmpEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end, int grainSize = 0);
+
+// Fused vertex + varying evaluation : both tables have the same number of
+// stencils, evaluated in a single traversal of the destination rows
+void
+OmpEvalStencils(float const * src,        BufferDescriptor const &srcDesc,
+                float * dst,              BufferDescriptor const &dstDesc,
+                float const * varyingSrc, BufferDescriptor const &varyingSrcDesc,
+                float * varyingDst,       BufferDescriptor const &varyingDstDesc,
+                int const * sizes,
+                int const * offsets,
+                int const * indices,
+                float const * weights,
+                int const * varyingSizes,
+                int const * varyingOffsets,
+                int const * varyingIndices,
+                float const * varyingWeights,
+                int start, int end, int grainSize = 0);
+
+// NUMA-aware evaluation : the stencils are split in the given ranges
+// ('numPartitions'+1 boundaries), range p being always evaluated by thread p
+// of a team of 'numThreads' threads bound close to their places. du and dv
+// are optional.
+void
+OmpEvalStencilPartitions(float const * src, BufferDescriptor const &srcDesc,
+                         float * dst,       BufferDescriptor const &dstDesc,
+                         float * dstDu,     BufferDescriptor const &dstDuDesc,
+                         float * dstDv,     BufferDescriptor const &dstDvDesc,
+                         int const * sizes,
+                         int const * offsets,
+                         int const * indices,
+                         float const * weights,
+                         float const * duWeights,
+                         float const * dvWeights,
+                         int numThreads, int numPartitions,
+                         int const * partitions);
+
+// Copies the ranges of a stencil table from the threads that evaluate them,
+// so that each range is first-touched on the node of its thread (duWeights
+// and dvWeights are optional).
+void
+OmpCopyStencilPartitions(int const * srcSizes, int const * srcOffsets,
+                         int const * srcIndices, float const * srcWeights,
+                         float const * srcDuWeights, float const * srcDvWeights,
+                         int * sizes, int * offsets,
+                         int * indices, float * weights,
+                         float * duWeights, float * dvWeights,
+                         int numThreads, int numPartitions,
+                         int const * partitions);
+
+// Clears the destination rows of the ranges from the threads that evaluate
+// them.
+void
+OmpFirstTouchStencilPartitions(float * dst, BufferDescriptor const &dstDesc,
+                               int numThreads, int numPartitions,
+                               int const * partitions);
 
 } // end namespace Osd
 
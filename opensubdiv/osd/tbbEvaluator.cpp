@@ -24,14 +24,274 @@
 
 #include "../osd/tbbEvaluator.h"
 #include "../osd/tbbKernel.h"
+#include "../osd/cpuKernel.h"
 
+#include <tbb/spin_mutex.h>
+#include <tbb/task_group.h>
 #include <tbb/task_scheduler_init.h>
 
+#include <algorithm>
+#include <cassert>
+#include <deque>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
+//
+// TbbEvalQueue
+//
+// The queued tasks run one after the other : a single drain task at a time
+// pops them in submission order. The drain task of a batch runs in the task
+// group of the batch, recycled every numFences batches, and hands the tasks
+// of the next batch over to a new drain task in the group of that batch, so
+// that waiting for the groups of the batches in order waits for all their
+// tasks.
+//
+struct TbbEvalQueue::Task {
+    explicit Task(int batch_) : batch(batch_) { }
+    virtual ~Task() { }
+    virtual void Run() const = 0;
+
+    int batch;
+};
+
+template <class TASK>
+struct TbbEvalQueue::TaskAdapter : public TbbEvalQueue::Task {
+    TaskAdapter(int batch_, TASK const &task_) : Task(batch_), task(task_) { }
+    virtual void Run() const { task(); }
+
+    TASK task;
+};
+
+struct TbbEvalQueue::Batch {
+    tbb::task_group group;
+};
+
+struct TbbEvalQueue::Drain {
+    Drain(TbbEvalQueue *queue_, int batch_) : queue(queue_), batch(batch_) { }
+    void operator() () const { queue->drain(batch); }
+
+    TbbEvalQueue *queue;
+    int batch;
+};
+
+struct TbbEvalQueue::PendingTasks {
+    PendingTasks() : draining(false) { }
+
+    tbb::spin_mutex mutex;
+    std::deque<Task *> tasks;
+    bool draining;
+};
+
+TbbEvalQueue::TbbEvalQueue(int numFences) :
+    _numFences(numFences > 0 ? numFences : 1), _currentBatch(0),
+    _completedBatch(-1) {
+
+    _batches = new Batch[_numFences];
+    _pending = new PendingTasks;
+}
+
+TbbEvalQueue::~TbbEvalQueue() {
+
+    Finish();
+    delete [] _batches;
+    delete _pending;
+}
+
+int
+TbbEvalQueue::Submit() {
+
+    int fence = _currentBatch++;
+
+    // the new batch reuses the task group (and the buffers) of the batch
+    // numFences behind it
+    if (_currentBatch >= _numFences) {
+        Wait(_currentBatch - _numFences);
+    }
+    return fence;
+}
+
+void
+TbbEvalQueue::Wait(int fence) {
+
+    assert(fence <= _currentBatch);
+
+    // batches complete in order : the groups are waited for in order, each
+    // one receiving the tasks of its batch before the previous one completes
+    for (int batch = _completedBatch+1; batch <= fence; ++batch) {
+        _batches[batch % _numFences].group.wait();
+    }
+
+    // the current batch is still open
+    _completedBatch = std::max(_completedBatch,
+                               std::min(fence, _currentBatch-1));
+}
+
+void
+TbbEvalQueue::Finish() {
+
+    Wait(_currentBatch);
+}
+
+void
+TbbEvalQueue::drain(int batch) {
+
+    for (;;) {
+        Task * task = 0;
+        {
+            tbb::spin_mutex::scoped_lock lock(_pending->mutex);
+
+            if (_pending->tasks.empty()) {
+                _pending->draining = false;
+                return;
+            }
+
+            task = _pending->tasks.front();
+            if (task->batch != batch) {
+                // hand over to the group of the next batch before this one
+                // completes
+                _batches[task->batch % _numFences].group.run(
+                    Drain(this, task->batch));
+                return;
+            }
+            _pending->tasks.pop_front();
+        }
+        task->Run();
+        delete task;
+    }
+}
+
+template <class TASK> void
+TbbEvalQueue::run(TASK const &task) {
+
+    Task * queued = new TaskAdapter<TASK>(_currentBatch, task);
+
+    tbb::spin_mutex::scoped_lock lock(_pending->mutex);
+
+    _pending->tasks.push_back(queued);
+    if (not _pending->draining) {
+        _pending->draining = true;
+        _batches[_currentBatch % _numFences].group.run(
+            Drain(this, _currentBatch));
+    }
+}
+
+//
+// Asynchronous evaluation tasks : the arguments of the evaluations are
+// copied, the buffers they point to belong to the client.
+//
+namespace {
+
+template <class OFFSET>
+struct EvalStencilsTask {
+    const float *src; BufferDescriptor srcDesc;
+    float *dst;       BufferDescriptor dstDesc;
+    float *du;        BufferDescriptor duDesc;
+    float *dv;        BufferDescriptor dvDesc;
+    const int *sizes;
+    const OFFSET *offsets;
+    const int *indices;
+    const float *weights, *duWeights, *dvWeights;
+    int start, end, grainSize;
+
+    void operator() () const {
+        if (du or dv) {
+            TbbEvalStencils(src, srcDesc, dst, dstDesc,
+                            du, duDesc, dv, dvDesc,
+                            sizes, offsets, indices,
+                            weights, duWeights, dvWeights,
+                            start, end, grainSize);
+        } else {
+            TbbEvalStencils(src, srcDesc, dst, dstDesc,
+                            sizes, offsets, indices, weights,
+                            start, end, grainSize);
+        }
+    }
+};
+
+struct EvalPatchesTask {
+    const float *src; BufferDescriptor srcDesc;
+    float *dst;       BufferDescriptor dstDesc;
+    float *du;        BufferDescriptor duDesc;
+    float *dv;        BufferDescriptor dvDesc;
+    int numPatchCoords;
+    const PatchCoord *patchCoords;
+    const PatchArray *patchArrayBuffer;
+    const int *patchIndexBuffer;
+    const PatchParam *patchParamBuffer;
+
+    void operator() () const {
+        TbbEvalPatches(src, srcDesc, dst, dstDesc,
+                       du, duDesc, dv, dvDesc,
+                       numPatchCoords, patchCoords,
+                       patchArrayBuffer, patchIndexBuffer, patchParamBuffer);
+    }
+};
+
+struct EvalPatchesVaryingTask {
+    const float *src; BufferDescriptor srcDesc;
+    float *dst;       BufferDescriptor dstDesc;
+    int numPatchCoords;
+    const PatchCoord *patchCoords;
+    const PatchArray *patchArrayBuffer;
+    const int *patchIndexBuffer;
+    const PatchParam *patchParamBuffer;
+
+    void operator() () const {
+        TbbEvalPatchesVarying(src, srcDesc, dst, dstDesc,
+                              numPatchCoords, patchCoords,
+                              patchArrayBuffer, patchIndexBuffer,
+                              patchParamBuffer);
+    }
+};
+
+struct EvalPatchesFaceVaryingTask {
+    const float *src;     BufferDescriptor srcDesc;
+    float *dst;           BufferDescriptor dstDesc;
+    const float *fvarSrc; BufferDescriptor fvarSrcDesc;
+    float *fvarDst;       BufferDescriptor fvarDstDesc;
+    int numPatchCoords;
+    const PatchCoord *patchCoords;
+    const PatchArray *patchArrayBuffer;
+    const int *patchIndexBuffer;
+    const PatchParam *patchParamBuffer;
+    const PatchArray *fvarPatchArrayBuffer;
+    const int *fvarPatchIndexBuffer;
+
+    void operator() () const {
+        TbbEvalPatches(src, srcDesc, dst, dstDesc,
+                       fvarSrc, fvarSrcDesc, fvarDst, fvarDstDesc,
+                       numPatchCoords, patchCoords,
+                       patchArrayBuffer, patchIndexBuffer, patchParamBuffer,
+                       fvarPatchArrayBuffer, fvarPatchIndexBuffer);
+    }
+};
+
+struct EvalPatchesBezierTask {
+    const float *src; BufferDescriptor srcDesc;
+    float *dst;       BufferDescriptor dstDesc;
+    float *du;        BufferDescriptor duDesc;
+    float *dv;        BufferDescriptor dvDesc;
+    int numPatchCoords;
+    const PatchCoord *patchCoords;
+    const PatchArray *patchArrayBuffer;
+    const int *patchIndexBuffer;
+    const PatchParam *patchParamBuffer;
+    const int *bezierPointIndices;
+
+    void operator() () const {
+        TbbEvalPatchesBezier(src, srcDesc, dst, dstDesc,
+                             du, duDesc, dv, dvDesc,
+                             numPatchCoords, patchCoords,
+                             patchArrayBuffer, patchIndexBuffer,
+                             patchParamBuffer, bezierPointIndices);
+    }
+};
+
+} // end namespace
+
 /* static */
 bool
 TbbEvaluator::EvalStencils(
@@ -41,12 +301,24 @@ TbbEvaluator::EvalStencils(
     const int * offsets,
     const int * indices,
     const float * weights,
-    int start, int end) {
+    int start, int end,
+    TbbEvalQueue *queue, int grainSize) {
 
     if (end <= start) return true;
 
+    if (queue) {
+        EvalStencilsTask<int> task = { src, srcDesc, dst, dstDesc,
+                                       NULL, BufferDescriptor(),
+                                       NULL, BufferDescriptor(),
+                                       sizes, offsets, indices,
+                                       weights, NULL, NULL,
+                                       start, end, grainSize };
+        queue->run(task);
+        return true;
+    }
+
     TbbEvalStencils(src, srcDesc, dst, dstDesc,
-                    sizes, offsets, indices, weights, start, end);
+                    sizes, offsets, indices, weights, start, end, grainSize);
 
     return true;
 }
@@ -64,20 +336,104 @@ TbbEvaluator::EvalStencils(
     const float * weights,
     const float * duWeights,
     const float * dvWeights,
-    int start, int end) {
+    int start, int end,
+    TbbEvalQueue *queue, int grainSize) {
+
+    if (end <= start) return true;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (srcDesc.length != duDesc.length) return false;
+    if (srcDesc.length != dvDesc.length) return false;
+
+    if (queue) {
+        EvalStencilsTask<int> task = { src, srcDesc, dst, dstDesc,
+                                       du, duDesc, dv, dvDesc,
+                                       sizes, offsets, indices,
+                                       weights, duWeights, dvWeights,
+                                       start, end, grainSize };
+        queue->run(task);
+        return true;
+    }
+
+    TbbEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    du,  duDesc,
+                    dv,  dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end, grainSize);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    const int * sizes,
+    const size_t * offsets,
+    const int * indices,
+    const float * weights,
+    int start, int end,
+    TbbEvalQueue *queue, int grainSize) {
+
+    if (end <= start) return true;
+
+    if (queue) {
+        EvalStencilsTask<size_t> task = { src, srcDesc, dst, dstDesc,
+                                          NULL, BufferDescriptor(),
+                                          NULL, BufferDescriptor(),
+                                          sizes, offsets, indices,
+                                          weights, NULL, NULL,
+                                          start, end, grainSize };
+        queue->run(task);
+        return true;
+    }
+
+    TbbEvalStencils(src, srcDesc, dst, dstDesc,
+                    sizes, offsets, indices, weights, start, end, grainSize);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalStencils(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    const int * sizes,
+    const size_t * offsets,
+    const int * indices,
+    const float * weights,
+    const float * duWeights,
+    const float * dvWeights,
+    int start, int end,
+    TbbEvalQueue *queue, int grainSize) {
 
     if (end <= start) return true;
     if (srcDesc.length != dstDesc.length) return false;
     if (srcDesc.length != duDesc.length) return false;
     if (srcDesc.length != dvDesc.length) return false;
 
+    if (queue) {
+        EvalStencilsTask<size_t> task = { src, srcDesc, dst, dstDesc,
+                                          du, duDesc, dv, dvDesc,
+                                          sizes, offsets, indices,
+                                          weights, duWeights, dvWeights,
+                                          start, end, grainSize };
+        queue->run(task);
+        return true;
+    }
+
     TbbEvalStencils(src, srcDesc,
                     dst, dstDesc,
                     du,  duDesc,
                     dv,  dvDesc,
                     sizes, offsets, indices,
                     weights, duWeights, dvWeights,
-                    start, end);
+                    start, end, grainSize);
 
     return true;
 }
@@ -91,10 +447,22 @@ TbbEvaluator::EvalPatches(
     const PatchCoord *patchCoords,
     const PatchArray *patchArrayBuffer,
     const int *patchIndexBuffer,
-    const PatchParam *patchParamBuffer) {
+    const PatchParam *patchParamBuffer,
+    TbbEvalQueue *queue) {
 
     if (srcDesc.length != dstDesc.length) return false;
 
+    if (queue) {
+        EvalPatchesTask task = { src, srcDesc, dst, dstDesc,
+                                 NULL, BufferDescriptor(),
+                                 NULL, BufferDescriptor(),
+                                 numPatchCoords, patchCoords,
+                                 patchArrayBuffer, patchIndexBuffer,
+                                 patchParamBuffer };
+        queue->run(task);
+        return true;
+    }
+
     TbbEvalPatches(src, srcDesc, dst, dstDesc,
                    NULL, BufferDescriptor(),
                    NULL, BufferDescriptor(),
@@ -115,10 +483,21 @@ TbbEvaluator::EvalPatches(
     const PatchCoord *patchCoords,
     const PatchArray *patchArrayBuffer,
     const int *patchIndexBuffer,
-    const PatchParam *patchParamBuffer) {
+    const PatchParam *patchParamBuffer,
+    TbbEvalQueue *queue) {
 
     if (srcDesc.length != dstDesc.length) return false;
 
+    if (queue) {
+        EvalPatchesTask task = { src, srcDesc, dst, dstDesc,
+                                 du, duDesc, dv, dvDesc,
+                                 numPatchCoords, patchCoords,
+                                 patchArrayBuffer, patchIndexBuffer,
+                                 patchParamBuffer };
+        queue->run(task);
+        return true;
+    }
+
     TbbEvalPatches(src, srcDesc, dst, dstDesc,
                    du,  duDesc,  dv,  dvDesc,
                    numPatchCoords, patchCoords,
@@ -127,6 +506,165 @@ TbbEvaluator::EvalPatches(
     return true;
 }
 
+/* static */
+bool
+TbbEvaluator::EvalPatchesVarying(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    TbbEvalQueue *queue) {
+
+    if ((not src) or (not dst)) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+
+    // the legacy Gregory patches have no varying corners
+    if (not CpuCheckVaryingPatchCoords(numPatchCoords, patchCoords,
+                                       patchArrays)) {
+        return false;
+    }
+
+    if (queue) {
+        EvalPatchesVaryingTask task = {
+            src, srcDesc, dst, dstDesc,
+            numPatchCoords, patchCoords,
+            patchArrays, patchIndexBuffer, patchParamBuffer };
+        queue->run(task);
+        return true;
+    }
+
+    TbbEvalPatchesVarying(src, srcDesc, dst, dstDesc,
+                          numPatchCoords, patchCoords,
+                          patchArrays, patchIndexBuffer, patchParamBuffer);
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalPatchesFaceVarying(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *fvarPatchArrays,
+    const int *fvarPatchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    TbbEvalQueue *queue) {
+
+    if ((not src) or (not dst)) return false;
+
+    return EvalPatches(NULL, BufferDescriptor(), NULL, BufferDescriptor(),
+                       src, srcDesc, dst, dstDesc,
+                       numPatchCoords, patchCoords,
+                       NULL, NULL, patchParamBuffer,
+                       fvarPatchArrays, fvarPatchIndexBuffer, queue);
+}
+
+/* static */
+bool
+TbbEvaluator::EvalPatches(
+    const float *src,     BufferDescriptor const &srcDesc,
+    float *dst,           BufferDescriptor const &dstDesc,
+    const float *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+    float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrayBuffer,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const PatchArray *fvarPatchArrays,
+    const int *fvarPatchIndexBuffer,
+    TbbEvalQueue *queue) {
+
+    if (src and ((not dst) or srcDesc.length != dstDesc.length)) {
+        return false;
+    }
+    if (fvarSrc and ((not fvarDst) or
+                     fvarSrcDesc.length != fvarDstDesc.length or
+                     (not fvarPatchArrays) or (not fvarPatchIndexBuffer))) {
+        return false;
+    }
+
+    if (queue) {
+        EvalPatchesFaceVaryingTask task = {
+            src, srcDesc, dst, dstDesc,
+            fvarSrc, fvarSrcDesc, fvarDst, fvarDstDesc,
+            numPatchCoords, patchCoords,
+            patchArrayBuffer, patchIndexBuffer, patchParamBuffer,
+            fvarPatchArrays, fvarPatchIndexBuffer };
+        queue->run(task);
+        return true;
+    }
+
+    TbbEvalPatches(src, srcDesc, dst, dstDesc,
+                   fvarSrc, fvarSrcDesc, fvarDst, fvarDstDesc,
+                   numPatchCoords, patchCoords,
+                   patchArrayBuffer, patchIndexBuffer, patchParamBuffer,
+                   fvarPatchArrays, fvarPatchIndexBuffer);
+
+    return true;
+}
+
+/* static */
+bool
+TbbEvaluator::EvalPatchesBezier(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const int *bezierPointIndices,
+    TbbEvalQueue *queue) {
+
+    return EvalPatchesBezier(src, srcDesc, dst, dstDesc,
+                             NULL, BufferDescriptor(), NULL, BufferDescriptor(),
+                             numPatchCoords, patchCoords,
+                             patchArrays, patchIndexBuffer, patchParamBuffer,
+                             bezierPointIndices, queue);
+}
+
+/* static */
+bool
+TbbEvaluator::EvalPatchesBezier(
+    const float *src, BufferDescriptor const &srcDesc,
+    float *dst,       BufferDescriptor const &dstDesc,
+    float *du,        BufferDescriptor const &duDesc,
+    float *dv,        BufferDescriptor const &dvDesc,
+    int numPatchCoords,
+    const PatchCoord *patchCoords,
+    const PatchArray *patchArrays,
+    const int *patchIndexBuffer,
+    const PatchParam *patchParamBuffer,
+    const int *bezierPointIndices,
+    TbbEvalQueue *queue) {
+
+    if ((not src) or (not dst)) return false;
+    if (srcDesc.length != dstDesc.length) return false;
+    if (du and srcDesc.length != duDesc.length) return false;
+    if (dv and srcDesc.length != dvDesc.length) return false;
+
+    if (queue) {
+        EvalPatchesBezierTask task = {
+            src, srcDesc, dst, dstDesc, du, duDesc, dv, dvDesc,
+            numPatchCoords, patchCoords,
+            patchArrays, patchIndexBuffer, patchParamBuffer,
+            bezierPointIndices };
+        queue->run(task);
+        return true;
+    }
+
+    TbbEvalPatchesBezier(src, srcDesc, dst, dstDesc, du, duDesc, dv, dvDesc,
+                         numPatchCoords, patchCoords,
+                         patchArrays, patchIndexBuffer, patchParamBuffer,
+                         bezierPointIndices);
+    return true;
+}
+
 /* static */
 void
 TbbEvaluator::Synchronize(void *) {
@@ -37,6 +37,89 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
+/// \brief Queue of asynchronous TbbEvaluator evaluations
+///
+/// When a TbbEvalQueue is passed as the device context of the TbbEvaluator
+/// (or as the DeviceContext of an Osd::Mesh), EvalStencils and EvalPatches
+/// queue their evaluation and return immediately. The buffers, tables and
+/// patch coordinates referenced by an evaluation must remain valid until it
+/// completes.
+///
+/// Queued evaluations run one after the other, in submission order (each of
+/// them being parallel) : an evaluation can read the results of the previous
+/// ones, e.g. patches evaluated from the vertices refined by the stencils
+/// queued before them.
+///
+/// Evaluations are grouped in batches (typically one per frame) : Submit()
+/// closes the current batch and returns a fence that can be waited for
+/// with Wait(). The queue keeps up to numFences batches in flight : Submit()
+/// blocks until the oldest one completes before opening a new batch, which
+/// makes it safe to reuse the buffers of that batch. This matches the slots
+/// of a CpuRingVertexBuffer advanced once per Submit() :
+///
+///     for (each frame) {
+///         mesh->UpdateVertexBuffer(...);  // upload to the current slot
+///         mesh->Refine();                 // returns immediately
+///         int fence = queue.Submit();     // waits for slot reuse
+///         int slot = mesh->GetVertexBuffer()->Advance();
+///         ...
+///         queue.Wait(olderFence);         // consume an older slot
+///     }
+///
+/// All the methods of the queue must be called from the same thread.
+///
+class TbbEvalQueue {
+public:
+    /// \brief Constructor
+    ///
+    /// @param numFences    maximum number of batches in flight (the number
+    ///                     of slots of the buffers the batches write to)
+    ///
+    explicit TbbEvalQueue(int numFences = 3);
+
+    /// \brief Destructor : waits for all the evaluations of the queue
+    ~TbbEvalQueue();
+
+    /// \brief Closes the current batch of evaluations and returns its fence
+    int Submit();
+
+    /// \brief Waits for the evaluations of the batch of the given fence
+    ///        (and of all the batches submitted before it)
+    void Wait(int fence);
+
+    /// \brief Waits for all the evaluations of the queue
+    void Finish();
+
+    /// \brief Returns the maximum number of batches in flight
+    int GetNumFences() const { return _numFences; }
+
+private:
+    friend class TbbEvaluator;
+
+    // queues an evaluation task in the current batch
+    template <class TASK> void run(TASK const &task);
+
+    // runs the queued tasks of a batch in order, then hands the tasks of the
+    // next batch over to the task group of that batch
+    void drain(int batch);
+
+    TbbEvalQueue(TbbEvalQueue const &) { }
+    TbbEvalQueue & operator=(TbbEvalQueue const &) { return *this; }
+
+    struct Task;
+    template <class TASK> struct TaskAdapter;
+    struct Batch;
+    struct Drain;
+    struct PendingTasks;
+
+    int _numFences,
+        _currentBatch,
+        _completedBatch;
+
+    Batch * _batches;
+    PendingTasks * _pending;
+};
+
 class TbbEvaluator {
 public:
     /// ----------------------------------------------------------------------
@@ -67,7 +150,8 @@ public:
     ///                       (declared as a typed pointer to prevent
     ///                        undesirable template resolution)
     ///
-    /// @param deviceContext  not used in the tbb kernel
+    /// @param deviceContext  device context : the evaluation is spawned
+    ///                       asynchronously if it is a TbbEvalQueue
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
     static bool EvalStencils(
@@ -77,8 +161,42 @@ public:
         TbbEvaluator const *instance = NULL,
         void *deviceContext = NULL) {
 
+        (void)deviceContext;  // not a TbbEvalQueue : evaluated synchronously
+
+        return EvalStencils(srcBuffer, srcDesc,
+                            dstBuffer, dstDesc,
+                            stencilTable,
+                            instance,
+                            (TbbEvalQueue *)NULL);
+    }
+
+    /// \brief Same as above : if deviceContext is a TbbEvalQueue, the
+    ///        evaluation is spawned asynchronously in the queue (other
+    ///        device contexts are ignored)
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE,
+              typename DEVICE_CONTEXT>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        STENCIL_TABLE const *stencilTable,
+        TbbEvaluator const *instance,
+        DEVICE_CONTEXT *deviceContext) {
+
         (void)instance;   // unused
-        (void)deviceContext;  // unused
+
+        size_t const * largeOffsets = GetLargeStencilOffsets(stencilTable);
+        if (largeOffsets) {
+            return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                &stencilTable->GetSizes()[0],
+                                largeOffsets,
+                                &stencilTable->GetControlIndices()[0],
+                                &stencilTable->GetWeights()[0],
+                                /*start = */ 0,
+                                /*end   = */ stencilTable->GetNumStencils(),
+                                getEvalQueue(deviceContext));
+        }
 
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
@@ -87,7 +205,8 @@ public:
                             &stencilTable->GetControlIndices()[0],
                             &stencilTable->GetWeights()[0],
                             /*start = */ 0,
-                            /*end   = */ stencilTable->GetNumStencils());
+                            /*end   = */ stencilTable->GetNumStencils(),
+                            getEvalQueue(deviceContext));
     }
 
     /// \brief Static eval stencils function which takes raw CPU pointers for
@@ -117,6 +236,12 @@ public:
     ///
     /// @param end            end index of stencil table
     ///
+    /// @param queue          optional TbbEvalQueue : if not NULL, the
+    ///                       evaluation is spawned asynchronously
+    ///
+    /// @param grainSize      minimum number of stencil weights evaluated by
+    ///                       a single task (0 uses the default)
+    ///
     static bool EvalStencils(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
@@ -124,7 +249,21 @@ public:
         const int *offsets,
         const int *indices,
         const float *weights,
-        int start, int end);
+        int start, int end,
+        TbbEvalQueue *queue = NULL, int grainSize = 0);
+
+    /// \brief Same as above, with the 64-bit offsets of stencil tables of
+    ///        more than 2^31 weights (see Far::StencilTable::HasLargeOffsets)
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        const int *sizes,
+        const size_t *offsets,
+        const int *indices,
+        const float *weights,
+        int start, int end,
+        TbbEvalQueue *queue = NULL, int grainSize = 0);
 
     /// \brief Generic static eval stencils function with derivatives.
     ///        This function has a same signature as other device kernels
@@ -161,7 +300,8 @@ public:
     ///                       (declared as a typed pointer to prevent
     ///                        undesirable template resolution)
     ///
-    /// @param deviceContext  not used in the tbb kernel
+    /// @param deviceContext  device context : the evaluation is spawned
+    ///                       asynchronously if it is a TbbEvalQueue
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
     static bool EvalStencils(
@@ -173,8 +313,50 @@ public:
         const TbbEvaluator *instance = NULL,
         void * deviceContext = NULL) {
 
+        (void)deviceContext;  // not a TbbEvalQueue : evaluated synchronously
+
+        return EvalStencils(srcBuffer, srcDesc,
+                            dstBuffer, dstDesc,
+                            duBuffer, duDesc,
+                            dvBuffer, dvDesc,
+                            stencilTable,
+                            instance,
+                            (TbbEvalQueue *)NULL);
+    }
+
+    /// \brief Same as above : if deviceContext is a TbbEvalQueue, the
+    ///        evaluation is spawned asynchronously in the queue (other
+    ///        device contexts are ignored)
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE,
+              typename DEVICE_CONTEXT>
+    static bool EvalStencils(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        STENCIL_TABLE const *stencilTable,
+        const TbbEvaluator *instance,
+        DEVICE_CONTEXT *deviceContext) {
+
         (void)instance;   // unused
-        (void)deviceContext;   // unused
+
+        size_t const * largeOffsets = GetLargeStencilOffsets(stencilTable);
+        if (largeOffsets) {
+            return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
+                                dstBuffer->BindCpuBuffer(), dstDesc,
+                                duBuffer->BindCpuBuffer(),  duDesc,
+                                dvBuffer->BindCpuBuffer(),  dvDesc,
+                                &stencilTable->GetSizes()[0],
+                                largeOffsets,
+                                &stencilTable->GetControlIndices()[0],
+                                &stencilTable->GetWeights()[0],
+                                &stencilTable->GetDuWeights()[0],
+                                &stencilTable->GetDvWeights()[0],
+                                /*start = */ 0,
+                                /*end   = */ stencilTable->GetNumStencils(),
+                                getEvalQueue(deviceContext));
+        }
 
         return EvalStencils(srcBuffer->BindCpuBuffer(), srcDesc,
                             dstBuffer->BindCpuBuffer(), dstDesc,
@@ -187,7 +369,8 @@ public:
                             &stencilTable->GetDuWeights()[0],
                             &stencilTable->GetDvWeights()[0],
                             /*start = */ 0,
-                            /*end   = */ stencilTable->GetNumStencils());
+                            /*end   = */ stencilTable->GetNumStencils(),
+                            getEvalQueue(deviceContext));
     }
 
     /// \brief Static eval stencils function with derivatives, which takes
@@ -231,6 +414,12 @@ public:
     ///
     /// @param end            end index of stencil table
     ///
+    /// @param queue          optional TbbEvalQueue : if not NULL, the
+    ///                       evaluation is spawned asynchronously
+    ///
+    /// @param grainSize      minimum number of stencil weights evaluated by
+    ///                       a single task (0 uses the default)
+    ///
     static bool EvalStencils(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
@@ -242,7 +431,25 @@ public:
         const float * weights,
         const float * duWeights,
         const float * dvWeights,
-        int start, int end);
+        int start, int end,
+        TbbEvalQueue *queue = NULL, int grainSize = 0);
+
+    /// \brief Same as above, with the 64-bit offsets of stencil tables of
+    ///        more than 2^31 weights (see Far::StencilTable::HasLargeOffsets)
+    ///
+    static bool EvalStencils(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        const int * sizes,
+        const size_t * offsets,
+        const int * indices,
+        const float * weights,
+        const float * duWeights,
+        const float * dvWeights,
+        int start, int end,
+        TbbEvalQueue *queue = NULL, int grainSize = 0);
 
     /// ----------------------------------------------------------------------
     ///
@@ -274,7 +481,8 @@ public:
     ///
     /// @param instance         not used in the cpu evaluator
     ///
-    /// @param deviceContext    not used in the cpu evaluator
+    /// @param deviceContext    device context : the evaluation is spawned
+    ///                         asynchronously if it is a TbbEvalQueue
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER,
               typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
@@ -287,8 +495,34 @@ public:
         TbbEvaluator const *instance = NULL,
         void * deviceContext = NULL) {
 
+        (void)deviceContext;  // not a TbbEvalQueue : evaluated synchronously
+
+        return EvalPatches(srcBuffer, srcDesc,
+                           dstBuffer, dstDesc,
+                           numPatchCoords,
+                           patchCoords,
+                           patchTable,
+                           instance,
+                           (TbbEvalQueue *)NULL);
+    }
+
+    /// \brief Same as above : if deviceContext is a TbbEvalQueue, the
+    ///        evaluation is spawned asynchronously in the queue (other
+    ///        device contexts are ignored)
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename DEVICE_CONTEXT>
+    static bool EvalPatches(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance,
+        DEVICE_CONTEXT *deviceContext) {
+
         (void)instance;       // unused
-        (void)deviceContext;  // unused
 
         return EvalPatches(srcBuffer->BindCpuBuffer(),
                            srcDesc,
@@ -298,7 +532,8 @@ public:
                            (const PatchCoord*)patchCoords->BindCpuBuffer(),
                            patchTable->GetPatchArrayBuffer(),
                            patchTable->GetPatchIndexBuffer(),
-                           patchTable->GetPatchParamBuffer());
+                           patchTable->GetPatchParamBuffer(),
+                           getEvalQueue(deviceContext));
     }
 
     /// \brief Generic limit eval function with derivatives. This function has
@@ -337,7 +572,8 @@ public:
     ///
     /// @param instance         not used in the cpu evaluator
     ///
-    /// @param deviceContext    not used in the cpu evaluator
+    /// @param deviceContext    device context : the evaluation is spawned
+    ///                         asynchronously if it is a TbbEvalQueue
     ///
     template <typename SRC_BUFFER, typename DST_BUFFER,
               typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
@@ -352,8 +588,38 @@ public:
         TbbEvaluator const *instance = NULL,
         void * deviceContext = NULL) {
 
+        (void)deviceContext;  // not a TbbEvalQueue : evaluated synchronously
+
+        return EvalPatches(srcBuffer, srcDesc,
+                           dstBuffer, dstDesc,
+                           duBuffer, duDesc,
+                           dvBuffer, dvDesc,
+                           numPatchCoords,
+                           patchCoords,
+                           patchTable,
+                           instance,
+                           (TbbEvalQueue *)NULL);
+    }
+
+    /// \brief Same as above : if deviceContext is a TbbEvalQueue, the
+    ///        evaluation is spawned asynchronously in the queue (other
+    ///        device contexts are ignored)
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename DEVICE_CONTEXT>
+    static bool EvalPatches(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        DST_BUFFER *duBuffer,  BufferDescriptor const &duDesc,
+        DST_BUFFER *dvBuffer,  BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance,
+        DEVICE_CONTEXT *deviceContext) {
+
         (void)instance;       // unused
-        (void)deviceContext;  // unused
 
         return EvalPatches(
             srcBuffer->BindCpuBuffer(), srcDesc,
@@ -364,7 +630,8 @@ public:
             (const PatchCoord*)patchCoords->BindCpuBuffer(),
             patchTable->GetPatchArrayBuffer(),
             patchTable->GetPatchIndexBuffer(),
-            patchTable->GetPatchParamBuffer());
+            patchTable->GetPatchParamBuffer(),
+            getEvalQueue(deviceContext));
     }
 
     /// \brief Static limit eval function. It takes an array of PatchCoord
@@ -394,6 +661,9 @@ public:
     /// @param patchParamBuffer an array of Osd::PatchParam struct
     ///                         indexed by PatchCoord::patchIndex
     ///
+    /// @param queue            optional TbbEvalQueue : if not NULL, the
+    ///                         evaluation is spawned asynchronously
+    ///
     static bool EvalPatches(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
@@ -401,7 +671,8 @@ public:
         const PatchCoord *patchCoords,
         const PatchArray *patchArrays,
         const int *patchIndexBuffer,
-        const PatchParam *patchParamBuffer);
+        const PatchParam *patchParamBuffer,
+        TbbEvalQueue *queue = NULL);
 
     /// \brief Static limit eval function. It takes an array of PatchCoord
     ///        and evaluate limit values on given PatchTable.
@@ -440,6 +711,9 @@ public:
     /// @param patchParamBuffer an array of Osd::PatchParam struct
     ///                         indexed by PatchCoord::patchIndex
     ///
+    /// @param queue            optional TbbEvalQueue : if not NULL, the
+    ///                         evaluation is spawned asynchronously
+    ///
     static bool EvalPatches(
         const float *src, BufferDescriptor const &srcDesc,
         float *dst,       BufferDescriptor const &dstDesc,
@@ -449,7 +723,435 @@ public:
         const PatchCoord *patchCoords,
         const PatchArray *patchArrays,
         const int *patchIndexBuffer,
-        const PatchParam *patchParamBuffer);
+        const PatchParam *patchParamBuffer,
+        TbbEvalQueue *queue = NULL);
+
+    /// \brief Generic varying limit eval function. This function has a
+    ///        same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// Varying primvars are interpolated bilinearly between the corners of
+    /// the patches, so that each location only gathers 4 values.
+    ///
+    /// @param srcBuffer        Input varying buffer, refined with varying
+    ///                         stencils (including the varying stencils of
+    ///                         the end cap local points, see
+    ///                         Far::PatchTable::GetLocalPointVaryingStencilTable())
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output varying buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    device context : the evaluation is spawned
+    ///                         asynchronously if it is a TbbEvalQueue
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)deviceContext;  // not a TbbEvalQueue : evaluated synchronously
+
+        return EvalPatchesVarying(srcBuffer, srcDesc,
+                                  dstBuffer, dstDesc,
+                                  numPatchCoords,
+                                  patchCoords,
+                                  patchTable,
+                                  instance,
+                                  (TbbEvalQueue *)NULL);
+    }
+
+    /// \brief Same as above : if deviceContext is a TbbEvalQueue, the
+    ///        evaluation is spawned asynchronously in the queue (other
+    ///        device contexts are ignored)
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename DEVICE_CONTEXT>
+    static bool EvalPatchesVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        TbbEvaluator const *instance,
+        DEVICE_CONTEXT *deviceContext) {
+
+        (void)instance;       // unused
+
+        return EvalPatchesVarying(
+            srcBuffer->BindCpuBuffer(), srcDesc,
+            dstBuffer->BindCpuBuffer(), dstDesc,
+            numPatchCoords,
+            (const PatchCoord*)patchCoords->BindCpuBuffer(),
+            patchTable->GetPatchArrayBuffer(),
+            patchTable->GetPatchIndexBuffer(),
+            patchTable->GetPatchParamBuffer(),
+            getEvalQueue(deviceContext));
+    }
+
+    /// \brief Static varying limit eval function. It takes an array of
+    ///        PatchCoord and interpolates varying primvars bilinearly
+    ///        between the corner control vertices of the patches.
+    ///
+    /// Legacy Gregory patches (ENDCAP_LEGACY_GREGORY) have no control
+    /// vertices at their corners : the evaluation fails if any of the
+    /// PatchCoords is located on one of them.
+    ///
+    /// @param src                  Input varying pointer. An offset of
+    ///                             srcDesc will be applied internally.
+    ///
+    /// @param srcDesc              vertex buffer descriptor for the input
+    ///                             buffer
+    ///
+    /// @param dst                  Output varying pointer. An offset of
+    ///                             dstDesc will be applied internally.
+    ///
+    /// @param dstDesc              vertex buffer descriptor for the output
+    ///                             buffer
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param patchArrays          an array of Osd::PatchArray struct
+    ///                             indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer     an array of patch indices
+    ///                             indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    /// @param queue                optional TbbEvalQueue : if not NULL, the
+    ///                             evaluation is spawned asynchronously
+    ///
+    static bool EvalPatchesVarying(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        TbbEvalQueue *queue = NULL);
+
+    /// \brief Generic face-varying limit eval function. This function has a
+    ///        same signature as other device kernels have so that it can be
+    ///        called in the same way.
+    ///
+    /// The face-varying patches of Far::PatchTable are bilinear : the values
+    /// are interpolated bilinearly between the face-varying values of the
+    /// corners of the patches. Returns false for channels without patches
+    /// (see CpuPatchTable::GetFVarPatchArrayBuffer()).
+    ///
+    /// @param srcBuffer        Input face-varying buffer, indexed by the
+    ///                         face-varying values of the patch table (see
+    ///                         Far::PatchTable::GetFVarValues())
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         const float pointer for read
+    ///
+    /// @param srcDesc          vertex buffer descriptor for the input buffer
+    ///
+    /// @param dstBuffer        Output face-varying buffer
+    ///                         must have BindCpuBuffer() method returning a
+    ///                         float pointer for write
+    ///
+    /// @param dstDesc          vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords   number of patchCoords.
+    ///
+    /// @param patchCoords      array of locations to be evaluated.
+    ///
+    /// @param patchTable       CpuPatchTable or equivalent
+    ///
+    /// @param fvarChannel      face-varying channel of the patch table
+    ///
+    /// @param instance         not used in the cpu evaluator
+    ///
+    /// @param deviceContext    device context : the evaluation is spawned
+    ///                         asynchronously if it is a TbbEvalQueue
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE>
+    static bool EvalPatchesFaceVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        int fvarChannel = 0,
+        TbbEvaluator const *instance = NULL,
+        void * deviceContext = NULL) {
+
+        (void)deviceContext;  // not a TbbEvalQueue : evaluated synchronously
+
+        return EvalPatchesFaceVarying(srcBuffer, srcDesc,
+                                      dstBuffer, dstDesc,
+                                      numPatchCoords,
+                                      patchCoords,
+                                      patchTable,
+                                      fvarChannel,
+                                      instance,
+                                      (TbbEvalQueue *)NULL);
+    }
+
+    /// \brief Same as above : if deviceContext is a TbbEvalQueue, the
+    ///        evaluation is spawned asynchronously in the queue (other
+    ///        device contexts are ignored)
+    ///
+    template <typename SRC_BUFFER, typename DST_BUFFER,
+              typename PATCHCOORD_BUFFER, typename PATCH_TABLE,
+              typename DEVICE_CONTEXT>
+    static bool EvalPatchesFaceVarying(
+        SRC_BUFFER *srcBuffer, BufferDescriptor const &srcDesc,
+        DST_BUFFER *dstBuffer, BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        PATCHCOORD_BUFFER *patchCoords,
+        PATCH_TABLE *patchTable,
+        int fvarChannel,
+        TbbEvaluator const *instance,
+        DEVICE_CONTEXT *deviceContext) {
+
+        (void)instance;       // unused
+
+        return EvalPatchesFaceVarying(
+            srcBuffer->BindCpuBuffer(), srcDesc,
+            dstBuffer->BindCpuBuffer(), dstDesc,
+            numPatchCoords,
+            (const PatchCoord*)patchCoords->BindCpuBuffer(),
+            patchTable->GetFVarPatchArrayBuffer(fvarChannel),
+            patchTable->GetFVarPatchIndexBuffer(fvarChannel),
+            patchTable->GetPatchParamBuffer(),
+            getEvalQueue(deviceContext));
+    }
+
+    /// \brief Static face-varying limit eval function. It takes an array of
+    ///        PatchCoord and interpolates the face-varying values of a
+    ///        channel of the PatchTable.
+    ///
+    /// @param src                  Input face-varying pointer. An offset of
+    ///                             srcDesc will be applied internally.
+    ///
+    /// @param srcDesc              vertex buffer descriptor for the input
+    ///                             buffer
+    ///
+    /// @param dst                  Output face-varying pointer. An offset of
+    ///                             dstDesc will be applied internally.
+    ///
+    /// @param dstDesc              vertex buffer descriptor for the output
+    ///                             buffer
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param fvarPatchArrays      an array of Osd::PatchArray struct of the
+    ///                             face-varying channel, indexed by
+    ///                             PatchCoord::arrayIndex
+    ///
+    /// @param fvarPatchIndexBuffer an array of face-varying value indices
+    ///                             of the channel
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    /// @param queue                optional TbbEvalQueue : if not NULL, the
+    ///                             evaluation is spawned asynchronously
+    ///
+    static bool EvalPatchesFaceVarying(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *fvarPatchArrays,
+        const int *fvarPatchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        TbbEvalQueue *queue = NULL);
+
+    /// \brief Static limit eval function evaluating the vertex and the
+    ///        face-varying values of the same PatchCoords in a single pass.
+    ///
+    /// Either evaluation is skipped if its input pointer is NULL.
+    ///
+    /// @param src                  Input vertex primvar pointer
+    ///
+    /// @param srcDesc              vertex buffer descriptor for src
+    ///
+    /// @param dst                  Output vertex primvar pointer
+    ///
+    /// @param dstDesc              vertex buffer descriptor for dst
+    ///
+    /// @param fvarSrc              Input face-varying pointer
+    ///
+    /// @param fvarSrcDesc          vertex buffer descriptor for fvarSrc
+    ///
+    /// @param fvarDst              Output face-varying pointer
+    ///
+    /// @param fvarDstDesc          vertex buffer descriptor for fvarDst
+    ///
+    /// @param numPatchCoords       number of patchCoords.
+    ///
+    /// @param patchCoords          array of locations to be evaluated.
+    ///
+    /// @param patchArrays          an array of Osd::PatchArray struct
+    ///                             indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer     an array of patch indices
+    ///                             indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer     an array of Osd::PatchParam struct
+    ///                             indexed by PatchCoord::patchIndex
+    ///
+    /// @param fvarPatchArrays      an array of Osd::PatchArray struct of the
+    ///                             face-varying channel
+    ///
+    /// @param fvarPatchIndexBuffer an array of face-varying value indices
+    ///                             of the channel
+    ///
+    /// @param queue                optional TbbEvalQueue : if not NULL, the
+    ///                             evaluation is spawned asynchronously
+    ///
+    static bool EvalPatches(
+        const float *src,     BufferDescriptor const &srcDesc,
+        float *dst,           BufferDescriptor const &dstDesc,
+        const float *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+        float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const PatchArray *fvarPatchArrays,
+        const int *fvarPatchIndexBuffer,
+        TbbEvalQueue *queue = NULL);
+
+    /// \brief Static limit eval function using the Bezier form of the
+    ///        regular patches (see Far::BezierPatchTable).
+    ///
+    /// The patches with Bezier points are evaluated in Bernstein form from
+    /// their 16 points, the other patches from their control vertices.
+    ///
+    /// @param src                Input primvar pointer, holding the Bezier
+    ///                           points after the vertices of the patch
+    ///                           table. An offset of srcDesc will be applied
+    ///                           internally.
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst                Output primvar pointer. An offset of dstDesc
+    ///                           will be applied internally.
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the output buffer
+    ///
+    /// @param numPatchCoords     number of patchCoords.
+    ///
+    /// @param patchCoords        array of locations to be evaluated.
+    ///
+    /// @param patchArrays        an array of Osd::PatchArray struct
+    ///                           indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer   an array of patch indices
+    ///                           indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer   an array of Osd::PatchParam struct
+    ///                           indexed by PatchCoord::patchIndex
+    ///
+    /// @param bezierPointIndices the index of the first Bezier point of each
+    ///                           patch, or -1 (see
+    ///                           Far::BezierPatchTable::GetBezierPointIndexTable())
+    ///
+    /// @param queue              optional TbbEvalQueue : if not NULL, the
+    ///                           evaluation is spawned asynchronously
+    ///
+    static bool EvalPatchesBezier(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const int *bezierPointIndices,
+        TbbEvalQueue *queue = NULL);
+
+    /// \brief Static limit eval function with derivatives using the Bezier
+    ///        form of the regular patches (see Far::BezierPatchTable).
+    ///
+    /// @param src                Input primvar pointer, holding the Bezier
+    ///                           points after the vertices of the patch
+    ///                           table. An offset of srcDesc will be applied
+    ///                           internally.
+    ///
+    /// @param srcDesc            vertex buffer descriptor for the input buffer
+    ///
+    /// @param dst                Output primvar pointer. An offset of dstDesc
+    ///                           will be applied internally.
+    ///
+    /// @param dstDesc            vertex buffer descriptor for the output buffer
+    ///
+    /// @param du                 Output U-derivatives pointer. An offset of
+    ///                           duDesc will be applied internally.
+    ///
+    /// @param duDesc             vertex buffer descriptor for the du buffer
+    ///
+    /// @param dv                 Output V-derivatives pointer. An offset of
+    ///                           dvDesc will be applied internally.
+    ///
+    /// @param dvDesc             vertex buffer descriptor for the dv buffer
+    ///
+    /// @param numPatchCoords     number of patchCoords.
+    ///
+    /// @param patchCoords        array of locations to be evaluated.
+    ///
+    /// @param patchArrays        an array of Osd::PatchArray struct
+    ///                           indexed by PatchCoord::arrayIndex
+    ///
+    /// @param patchIndexBuffer   an array of patch indices
+    ///                           indexed by PatchCoord::vertIndex
+    ///
+    /// @param patchParamBuffer   an array of Osd::PatchParam struct
+    ///                           indexed by PatchCoord::patchIndex
+    ///
+    /// @param bezierPointIndices the index of the first Bezier point of each
+    ///                           patch, or -1 (see
+    ///                           Far::BezierPatchTable::GetBezierPointIndexTable())
+    ///
+    /// @param queue              optional TbbEvalQueue : if not NULL, the
+    ///                           evaluation is spawned asynchronously
+    ///
+    static bool EvalPatchesBezier(
+        const float *src, BufferDescriptor const &srcDesc,
+        float *dst,       BufferDescriptor const &dstDesc,
+        float *du,        BufferDescriptor const &duDesc,
+        float *dv,        BufferDescriptor const &dvDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrays,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const int *bezierPointIndices,
+        TbbEvalQueue *queue = NULL);
 
     /// ----------------------------------------------------------------------
     ///
@@ -458,14 +1160,31 @@ public:
     /// ----------------------------------------------------------------------
 
     /// \brief synchronize all asynchronous computation invoked on this device.
+    ///
+    /// @param deviceContext  device context : waits for all the evaluations
+    ///                       of the queue if it is a TbbEvalQueue
+    ///
     static void Synchronize(void *deviceContext = NULL);
 
+    template <typename DEVICE_CONTEXT>
+    static void Synchronize(DEVICE_CONTEXT *deviceContext) {
+        if (TbbEvalQueue *queue = getEvalQueue(deviceContext)) {
+            queue->Finish();
+        }
+    }
+
     /// \brief initialize tbb task schedular
     ///        (optional: client may use tbb::task_scheduler_init)
     ///
     /// @param numThreads      how many threads
     ///
     static void SetNumThreads(int numThreads);
+
+private:
+    // Only device contexts of type TbbEvalQueue enable asynchronous
+    // evaluations : the device contexts of other backends are ignored.
+    static TbbEvalQueue *getEvalQueue(TbbEvalQueue *queue) { return queue; }
+    static TbbEvalQueue *getEvalQueue(void const *) { return NULL; }
 };
 
 
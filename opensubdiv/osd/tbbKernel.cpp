@@ -37,154 +37,164 @@ namespace OPENSUBDIV_VERSION {
 
 namespace Osd {
 
-#define grain_size  200
-
-template <class T> T *
-elementAtIndex(T * src, int index, BufferDescriptor const &desc) {
-
-    return src + index * desc.stride;
-}
-
-static inline void
-clear(float *dst, BufferDescriptor const &desc) {
-
-    assert(dst);
-    memset(dst, 0, desc.length*sizeof(float));
-}
-
-static inline void
-addWithWeight(float *dst, const float *src, int srcIndex, float weight,
-              BufferDescriptor const &desc) {
-
-    assert(src and dst);
-    src = elementAtIndex(src, srcIndex, desc);
-    for (int k = 0; k < desc.length; ++k) {
-        dst[k] += src[k] * weight;
-    }
-}
-
-static inline void
-copy(float *dst, int dstIndex, const float *src,
-     BufferDescriptor const &desc) {
-
-    assert(src and dst);
-
-    dst = elementAtIndex(dst, dstIndex, desc);
-    memcpy(dst, src, desc.length*sizeof(float));
-}
-
-
+// Minimum number of patch coords evaluated by a single task
+static int const PATCH_COORD_GRAIN_SIZE = 64;
+
+// Stencils are split in chunks with a similar number of weights (see
+// StencilPartition), each chunk being evaluated serially by a single task :
+// results are accumulated in stack buffers private to the task and written to
+// a contiguous range of the destination. OFFSET is the type of the stencil
+// offsets (32-bit, or 64-bit for tables of more than 2^31 weights).
+template <class OFFSET>
 class TBBStencilKernel {
 
     BufferDescriptor _srcDesc;
     BufferDescriptor _dstDesc;
+    BufferDescriptor _duDesc;
+    BufferDescriptor _dvDesc;
     float const * _vertexSrc;
     float * _vertexDst;
+    float * _vertexDu;
+    float * _vertexDv;
 
     int const * _sizes;
-    int const * _offsets,
-              * _indices;
+    OFFSET const * _offsets;
+    int const * _indices;
     float const * _weights;
+    float const * _duWeights;
+    float const * _dvWeights;
 
+    StencilPartition const * _partition;
+    int _start;
 
 public:
     TBBStencilKernel(float const *src, BufferDescriptor srcDesc,
                      float *dst,       BufferDescriptor dstDesc,
-                     int const * sizes, int const * offsets,
-                     int const * indices, float const * weights) :
+                     float *du,        BufferDescriptor duDesc,
+                     float *dv,        BufferDescriptor dvDesc,
+                     int const * sizes, OFFSET const * offsets,
+                     int const * indices, float const * weights,
+                     float const * duWeights, float const * dvWeights,
+                     StencilPartition const * partition, int start) :
          _srcDesc(srcDesc),
          _dstDesc(dstDesc),
+         _duDesc(duDesc),
+         _dvDesc(dvDesc),
          _vertexSrc(src),
          _vertexDst(dst),
+         _vertexDu(du),
+         _vertexDv(dv),
          _sizes(sizes),
          _offsets(offsets),
          _indices(indices),
-         _weights(weights) { }
-
-    TBBStencilKernel(TBBStencilKernel const & other) {
-        _srcDesc    = other._srcDesc;
-        _dstDesc    = other._dstDesc;
-        _sizes      = other._sizes;
-        _offsets    = other._offsets;
-        _indices    = other._indices;
-        _weights    = other._weights;
-        _vertexSrc  = other._vertexSrc;
-        _vertexDst  = other._vertexDst;
-    }
+         _weights(weights),
+         _duWeights(duWeights),
+         _dvWeights(dvWeights),
+         _partition(partition),
+         _start(start) { }
 
     void operator() (tbb::blocked_range<int> const &r) const {
-#define USE_SIMD
-#ifdef USE_SIMD
-        if (_srcDesc.length==4 and _srcDesc.stride==4 and _dstDesc.stride==4) {
 
-            // SIMD fast path for aligned primvar data (4 floats)
-            int offset = _offsets[r.begin()];
-            ComputeStencilKernel<4>(_vertexSrc, _vertexDst,
-                _sizes, _indices+offset, _weights+offset, r.begin(), r.end());
+        for (int chunk=r.begin(); chunk<r.end(); ++chunk) {
 
-        } else if (_srcDesc.length==8 and _srcDesc.stride==4 and _dstDesc.stride==4) {
+            int first = _partition->GetChunkBegin(chunk),
+                last = _partition->GetChunkBegin(chunk+1);
+            if (first == last) continue;
 
-            // SIMD fast path for aligned primvar data (8 floats)
-            int offset = _offsets[r.begin()];
-            ComputeStencilKernel<8>(_vertexSrc, _vertexDst,
-                _sizes, _indices+offset, _weights+offset, r.begin(), r.end());
+            ptrdiff_t dstIndex = first - _start;
 
-        } else {
-#else
-        {
-#endif
-            int const * sizes = _sizes;
-            int const * indices = _indices;
-            float const * weights = _weights;
-
-            if (r.begin()>0) {
-                sizes += r.begin();
-                indices += _offsets[r.begin()];
-                weights += _offsets[r.begin()];
+            if (_vertexDst and _vertexDu and _vertexDv) {
+                CpuEvalStencils(_vertexSrc, _srcDesc,
+                                _vertexDst + dstIndex*_dstDesc.stride, _dstDesc,
+                                _vertexDu + dstIndex*_duDesc.stride, _duDesc,
+                                _vertexDv + dstIndex*_dvDesc.stride, _dvDesc,
+                                _sizes, _offsets, _indices,
+                                _weights, _duWeights, _dvWeights, first, last);
+                continue;
             }
-
-            // Slow path for non-aligned data
-            float * result = (float*)alloca(_srcDesc.length * sizeof(float));
-
-            for (int i=r.begin(); i<r.end(); ++i, ++sizes) {
-
-                clear(result, _dstDesc);
-
-                for (int j=0; j<*sizes; ++j) {
-                    addWithWeight(result, _vertexSrc, *indices++, *weights++, _srcDesc);
-                }
-
-                copy(_vertexDst, i, result, _dstDesc);
+            if (_vertexDst) {
+                CpuEvalStencils(_vertexSrc, _srcDesc,
+                                _vertexDst + dstIndex*_dstDesc.stride, _dstDesc,
+                                _sizes, _offsets, _indices, _weights, first, last);
+            }
+            if (_vertexDu) {
+                CpuEvalStencils(_vertexSrc, _srcDesc,
+                                _vertexDu + dstIndex*_duDesc.stride, _duDesc,
+                                _sizes, _offsets, _indices, _duWeights, first, last);
+            }
+            if (_vertexDv) {
+                CpuEvalStencils(_vertexSrc, _srcDesc,
+                                _vertexDv + dstIndex*_dvDesc.stride, _dvDesc,
+                                _sizes, _offsets, _indices, _dvWeights, first, last);
             }
         }
     }
 };
 
-void
-TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+template <class OFFSET> static void
+tbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
+                float * du,        BufferDescriptor const &duDesc,
+                float * dv,        BufferDescriptor const &dvDesc,
                 int const * sizes,
-                int const * offsets,
+                OFFSET const * offsets,
                 int const * indices,
                 float const * weights,
-                int start, int end) {
-
-    if (start > 0) {
-        sizes += start;
-        indices += offsets[start];
-        weights += offsets[start];
-    }
-    src += srcDesc.offset;
-    dst += dstDesc.offset;
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end, int grainSize) {
 
-    TBBStencilKernel kernel(src, srcDesc, dst, dstDesc,
-                            sizes, offsets, indices, weights);
+    // The number of chunks is only bound by the grain size : the work-stealing
+    // scheduler balances them between threads.
+    StencilPartition partition(sizes, offsets, start, end, end-start,
+                               grainSize);
 
-    tbb::blocked_range<int> range(start, end, grain_size);
+    TBBStencilKernel<OFFSET> kernel(src, srcDesc, dst, dstDesc,
+                                    du, duDesc, dv, dvDesc,
+                                    sizes, offsets, indices,
+                                    weights, duWeights, dvWeights,
+                                    &partition, start);
 
+    tbb::blocked_range<int> range(0, partition.GetNumChunks(), 1);
     tbb::parallel_for(range, kernel);
 }
 
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                int const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize) {
+
+    tbbEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    0, BufferDescriptor(),
+                    0, BufferDescriptor(),
+                    sizes, offsets, indices,
+                    weights, 0, 0,
+                    start, end, grainSize);
+}
+
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize) {
+
+    tbbEvalStencils(src, srcDesc,
+                    dst, dstDesc,
+                    0, BufferDescriptor(),
+                    0, BufferDescriptor(),
+                    sizes, offsets, indices,
+                    weights, 0, 0,
+                    start, end, grainSize);
+}
+
 void
 TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
@@ -196,41 +206,33 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * weights,
                 float const * duWeights,
                 float const * dvWeights,
-                int start, int end) {
-    if (start > 0) {
-        sizes += start;
-        indices += offsets[start];
-        weights += offsets[start];
-        duWeights += offsets[start];
-        dvWeights += offsets[start];
-    }
+                int start, int end, int grainSize) {
 
-    if (src) src += srcDesc.offset;
-    if (dst) dst += dstDesc.offset;
-    if (du)  du  += duDesc.offset;
-    if (dv)  dv  += dvDesc.offset;
-
-    // PERFORMANCE: need to combine 3 launches together
-    if (dst) {
-        TBBStencilKernel kernel(src, srcDesc, dst, dstDesc,
-                                sizes, offsets, indices, weights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
-    }
+    tbbEvalStencils(src, srcDesc, dst, dstDesc,
+                    du, duDesc, dv, dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end, grainSize);
+}
 
-    if (du) {
-        TBBStencilKernel kernel(src, srcDesc, du, duDesc,
-                                sizes, offsets, indices, duWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
-    }
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * du,        BufferDescriptor const &duDesc,
+                float * dv,        BufferDescriptor const &dvDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end, int grainSize) {
 
-    if (dv) {
-        TBBStencilKernel kernel(src, srcDesc, dv, dvDesc,
-                                sizes, offsets, indices, dvWeights);
-        tbb::blocked_range<int> range(start, end, grain_size);
-        tbb::parallel_for(range, kernel);
-    }
+    tbbEvalStencils(src, srcDesc, dst, dstDesc,
+                    du, duDesc, dv, dvDesc,
+                    sizes, offsets, indices,
+                    weights, duWeights, dvWeights,
+                    start, end, grainSize);
 }
 
 // ---------------------------------------------------------------------------
@@ -250,7 +252,7 @@ struct BufferAdapter {
         }
     }
     const T *operator[] (int index) const {
-        return _p + _stride * index;
+        return _p + (ptrdiff_t)_stride * index;
     }
     BufferAdapter<T> & operator ++() {
         if (_p) {
@@ -332,6 +334,9 @@ public:
             Far::PatchParam const & param =
                 _patchParamBuffer[coord.handle.patchIndex];
 
+            const int *cvs =
+                _patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
             int numControlVertices = 0;
             if (patchType == Far::PatchDescriptor::REGULAR) {
                 Far::internal::GetBSplineWeights(param,
@@ -341,6 +346,11 @@ public:
                 Far::internal::GetGregoryWeights(param,
                                                  coord.s, coord.t, wP, wDs, wDt);
                 numControlVertices = 20;
+            } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+                Far::internal::GetExtraordinaryWeights(param,
+                    Far::internal::GetExtraordinaryValence(cvs),
+                    coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 20;
             } else if (patchType == Far::PatchDescriptor::QUADS) {
                 Far::internal::GetBilinearWeights(param,
                                                   coord.s, coord.t, wP, wDs, wDt);
@@ -349,9 +359,6 @@ public:
                 assert(0);
             }
 
-            const int *cvs =
-                &_patchIndexBuffer[array.indexBase + coord.handle.vertIndex];
-
             dstT.Clear();
             for (int j = 0; j < numControlVertices; ++j) {
                 dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
@@ -386,6 +393,9 @@ public:
             Far::PatchParam const & param =
                 _patchParamBuffer[coord.handle.patchIndex];
 
+            const int *cvs =
+                _patchIndexBuffer + array.indexBase + coord.handle.vertIndex;
+
             int numControlVertices = 0;
             if (patchType == Far::PatchDescriptor::REGULAR) {
                 Far::internal::GetBSplineWeights(param,
@@ -395,6 +405,11 @@ public:
                 Far::internal::GetGregoryWeights(param,
                                                  coord.s, coord.t, wP, wDs, wDt);
                 numControlVertices = 20;
+            } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+                Far::internal::GetExtraordinaryWeights(param,
+                    Far::internal::GetExtraordinaryValence(cvs),
+                    coord.s, coord.t, wP, wDs, wDt);
+                numControlVertices = 20;
             } else if (patchType == Far::PatchDescriptor::QUADS) {
                 Far::internal::GetBilinearWeights(param,
                                                   coord.s, coord.t, wP, wDs, wDt);
@@ -403,9 +418,6 @@ public:
                 assert(0);
             }
 
-            const int *cvs =
-                &_patchIndexBuffer[array.indexBase + coord.handle.vertIndex];
-
             dstT.Clear();
             dstDuT.Clear();
             dstDvT.Clear();
@@ -440,11 +452,296 @@ TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
                                 patchIndexBuffer,
                                 patchParamBuffer);
 
-    tbb::blocked_range<int> range(0, numPatchCoords, grain_size);
+    tbb::blocked_range<int> range(0, numPatchCoords, PATCH_COORD_GRAIN_SIZE);
     tbb::parallel_for(range, kernel);
 
 }
 
+// Varying evaluation : bilinear interpolation of the patch corners
+class TbbEvalPatchesVaryingKernel {
+    BufferDescriptor _srcDesc;
+    BufferDescriptor _dstDesc;
+    float const * _src;
+    float * _dst;
+    int _numPatchCoords;
+    const PatchCoord *_patchCoords;
+    const PatchArray *_patchArrayBuffer;
+    const int        *_patchIndexBuffer;
+    const PatchParam *_patchParamBuffer;
+
+public:
+    TbbEvalPatchesVaryingKernel(float const *src, BufferDescriptor srcDesc,
+                                float *dst,       BufferDescriptor dstDesc,
+                                int numPatchCoords,
+                                const PatchCoord *patchCoords,
+                                const PatchArray *patchArrayBuffer,
+                                const int *patchIndexBuffer,
+                                const PatchParam *patchParamBuffer) :
+        _srcDesc(srcDesc), _dstDesc(dstDesc),
+        _src(src), _dst(dst),
+        _numPatchCoords(numPatchCoords),
+        _patchCoords(patchCoords),
+        _patchArrayBuffer(patchArrayBuffer),
+        _patchIndexBuffer(patchIndexBuffer),
+        _patchParamBuffer(patchParamBuffer) {
+    }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        float wP[4];
+        int cvs[4];
+        BufferAdapter<const float> srcT(_src + _srcDesc.offset,
+                                        _srcDesc.length,
+                                        _srcDesc.stride);
+        BufferAdapter<float> dstT(_dst + _dstDesc.offset
+                                       + r.begin() * _dstDesc.stride,
+                                  _dstDesc.length,
+                                  _dstDesc.stride);
+
+        for (int i = r.begin(); i < r.end(); ++i) {
+            int numCorners = CpuGetVaryingPatchWeights(_patchCoords[i],
+                _patchArrayBuffer, _patchIndexBuffer, _patchParamBuffer,
+                wP, cvs);
+
+            dstT.Clear();
+            for (int j = 0; j < numCorners; ++j) {
+                dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
+            }
+            ++dstT;
+        }
+    }
+};
+
+void
+TbbEvalPatchesVarying(float const *src, BufferDescriptor const &srcDesc,
+                      float *dst,       BufferDescriptor const &dstDesc,
+                      int numPatchCoords,
+                      const PatchCoord *patchCoords,
+                      const PatchArray *patchArrayBuffer,
+                      const int *patchIndexBuffer,
+                      const PatchParam *patchParamBuffer) {
+
+    TbbEvalPatchesVaryingKernel kernel(src, srcDesc, dst, dstDesc,
+                                       numPatchCoords, patchCoords,
+                                       patchArrayBuffer,
+                                       patchIndexBuffer,
+                                       patchParamBuffer);
+
+    tbb::blocked_range<int> range(0, numPatchCoords, PATCH_COORD_GRAIN_SIZE);
+    tbb::parallel_for(range, kernel);
+}
+
+// Vertex and face-varying evaluation of the same patch coords
+class TbbEvalPatchesFaceVaryingKernel {
+    BufferDescriptor _srcDesc;
+    BufferDescriptor _dstDesc;
+    BufferDescriptor _fvarSrcDesc;
+    BufferDescriptor _fvarDstDesc;
+    float const * _src;
+    float * _dst;
+    float const * _fvarSrc;
+    float * _fvarDst;
+    int _numPatchCoords;
+    const PatchCoord *_patchCoords;
+    const PatchArray *_patchArrayBuffer;
+    const int        *_patchIndexBuffer;
+    const PatchParam *_patchParamBuffer;
+    const PatchArray *_fvarPatchArrayBuffer;
+    const int        *_fvarPatchIndexBuffer;
+
+public:
+    TbbEvalPatchesFaceVaryingKernel(
+        float const *src,     BufferDescriptor srcDesc,
+        float *dst,           BufferDescriptor dstDesc,
+        float const *fvarSrc, BufferDescriptor fvarSrcDesc,
+        float *fvarDst,       BufferDescriptor fvarDstDesc,
+        int numPatchCoords,
+        const PatchCoord *patchCoords,
+        const PatchArray *patchArrayBuffer,
+        const int *patchIndexBuffer,
+        const PatchParam *patchParamBuffer,
+        const PatchArray *fvarPatchArrayBuffer,
+        const int *fvarPatchIndexBuffer) :
+        _srcDesc(srcDesc), _dstDesc(dstDesc),
+        _fvarSrcDesc(fvarSrcDesc), _fvarDstDesc(fvarDstDesc),
+        _src(src), _dst(dst), _fvarSrc(fvarSrc), _fvarDst(fvarDst),
+        _numPatchCoords(numPatchCoords),
+        _patchCoords(patchCoords),
+        _patchArrayBuffer(patchArrayBuffer),
+        _patchIndexBuffer(patchIndexBuffer),
+        _patchParamBuffer(patchParamBuffer),
+        _fvarPatchArrayBuffer(fvarPatchArrayBuffer),
+        _fvarPatchIndexBuffer(fvarPatchIndexBuffer) {
+    }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        float wP[20], wDs[20], wDt[20];
+        BufferAdapter<const float> srcT(
+            _src ? _src + _srcDesc.offset : NULL,
+            _srcDesc.length, _srcDesc.stride);
+        BufferAdapter<float> dstT(
+            _src ? _dst + _dstDesc.offset + r.begin() * _dstDesc.stride : NULL,
+            _dstDesc.length, _dstDesc.stride);
+        BufferAdapter<const float> fvarSrcT(
+            _fvarSrc ? _fvarSrc + _fvarSrcDesc.offset : NULL,
+            _fvarSrcDesc.length, _fvarSrcDesc.stride);
+        BufferAdapter<float> fvarDstT(
+            _fvarSrc ? _fvarDst + _fvarDstDesc.offset
+                                + r.begin() * _fvarDstDesc.stride : NULL,
+            _fvarDstDesc.length, _fvarDstDesc.stride);
+
+        for (int i = r.begin(); i < r.end(); ++i) {
+            PatchCoord const &coord = _patchCoords[i];
+
+            if (_src) {
+                PatchArray const &array =
+                    _patchArrayBuffer[coord.handle.arrayIndex];
+
+                int patchType = array.GetPatchType();
+                Far::PatchParam const & param =
+                    _patchParamBuffer[coord.handle.patchIndex];
+
+                const int *cvs = _patchIndexBuffer + array.indexBase +
+                    coord.handle.vertIndex;
+
+                int numControlVertices = 0;
+                if (patchType == Far::PatchDescriptor::REGULAR) {
+                    Far::internal::GetBSplineWeights(param,
+                        coord.s, coord.t, wP, wDs, wDt);
+                    numControlVertices = 16;
+                } else if (patchType == Far::PatchDescriptor::GREGORY_BASIS) {
+                    Far::internal::GetGregoryWeights(param,
+                        coord.s, coord.t, wP, wDs, wDt);
+                    numControlVertices = 20;
+                } else if (patchType == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+                    Far::internal::GetExtraordinaryWeights(param,
+                        Far::internal::GetExtraordinaryValence(cvs),
+                        coord.s, coord.t, wP, wDs, wDt);
+                    numControlVertices = 20;
+                } else if (patchType == Far::PatchDescriptor::QUADS) {
+                    Far::internal::GetBilinearWeights(param,
+                        coord.s, coord.t, wP, wDs, wDt);
+                    numControlVertices = 4;
+                } else {
+                    assert(0);
+                }
+
+                dstT.Clear();
+                for (int j = 0; j < numControlVertices; ++j) {
+                    dstT.AddWithWeight(srcT[cvs[j]], wP[j]);
+                }
+                ++dstT;
+            }
+
+            if (_fvarSrc) {
+                const int *values = NULL;
+                int numValues = CpuGetFVarPatchWeights(coord,
+                    _fvarPatchArrayBuffer, _fvarPatchIndexBuffer,
+                    _patchParamBuffer, wP, &values);
+
+                fvarDstT.Clear();
+                for (int j = 0; j < numValues; ++j) {
+                    fvarDstT.AddWithWeight(fvarSrcT[values[j]], wP[j]);
+                }
+                ++fvarDstT;
+            }
+        }
+    }
+};
+
+void
+TbbEvalPatches(float const *src,     BufferDescriptor const &srcDesc,
+               float *dst,           BufferDescriptor const &dstDesc,
+               float const *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+               float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+               int numPatchCoords,
+               const PatchCoord *patchCoords,
+               const PatchArray *patchArrayBuffer,
+               const int *patchIndexBuffer,
+               const PatchParam *patchParamBuffer,
+               const PatchArray *fvarPatchArrayBuffer,
+               const int *fvarPatchIndexBuffer) {
+
+    TbbEvalPatchesFaceVaryingKernel kernel(src, srcDesc, dst, dstDesc,
+                                           fvarSrc, fvarSrcDesc,
+                                           fvarDst, fvarDstDesc,
+                                           numPatchCoords, patchCoords,
+                                           patchArrayBuffer,
+                                           patchIndexBuffer,
+                                           patchParamBuffer,
+                                           fvarPatchArrayBuffer,
+                                           fvarPatchIndexBuffer);
+
+    tbb::blocked_range<int> range(0, numPatchCoords, PATCH_COORD_GRAIN_SIZE);
+    tbb::parallel_for(range, kernel);
+}
+
+// Bezier evaluation : each range of patch coords is evaluated by the CPU kernel
+class TbbEvalPatchesBezierKernel {
+    BufferDescriptor _srcDesc;
+    BufferDescriptor _dstDesc;
+    BufferDescriptor _dstDuDesc;
+    BufferDescriptor _dstDvDesc;
+    float const * _src;
+    float * _dst;
+    float * _dstDu;
+    float * _dstDv;
+    const PatchCoord *_patchCoords;
+    const PatchArray *_patchArrayBuffer;
+    const int        *_patchIndexBuffer;
+    const PatchParam *_patchParamBuffer;
+    const int        *_bezierPointIndices;
+
+public:
+    TbbEvalPatchesBezierKernel(float const *src, BufferDescriptor srcDesc,
+                               float *dst,       BufferDescriptor dstDesc,
+                               float *dstDu,     BufferDescriptor dstDuDesc,
+                               float *dstDv,     BufferDescriptor dstDvDesc,
+                               const PatchCoord *patchCoords,
+                               const PatchArray *patchArrayBuffer,
+                               const int *patchIndexBuffer,
+                               const PatchParam *patchParamBuffer,
+                               const int *bezierPointIndices) :
+        _srcDesc(srcDesc), _dstDesc(dstDesc),
+        _dstDuDesc(dstDuDesc), _dstDvDesc(dstDvDesc),
+        _src(src), _dst(dst), _dstDu(dstDu), _dstDv(dstDv),
+        _patchCoords(patchCoords),
+        _patchArrayBuffer(patchArrayBuffer),
+        _patchIndexBuffer(patchIndexBuffer),
+        _patchParamBuffer(patchParamBuffer),
+        _bezierPointIndices(bezierPointIndices) {
+    }
+
+    void operator() (tbb::blocked_range<int> const &r) const {
+        CpuEvalPatchesBezier(_src, _srcDesc, _dst, _dstDesc,
+                             _dstDu, _dstDuDesc, _dstDv, _dstDvDesc,
+                             _patchCoords, _patchArrayBuffer,
+                             _patchIndexBuffer, _patchParamBuffer,
+                             _bezierPointIndices, r.begin(), r.end());
+    }
+};
+
+void
+TbbEvalPatchesBezier(float const *src, BufferDescriptor const &srcDesc,
+                     float *dst,       BufferDescriptor const &dstDesc,
+                     float *dstDu,     BufferDescriptor const &dstDuDesc,
+                     float *dstDv,     BufferDescriptor const &dstDvDesc,
+                     int numPatchCoords,
+                     const PatchCoord *patchCoords,
+                     const PatchArray *patchArrayBuffer,
+                     const int *patchIndexBuffer,
+                     const PatchParam *patchParamBuffer,
+                     const int *bezierPointIndices) {
+
+    TbbEvalPatchesBezierKernel kernel(src, srcDesc, dst, dstDesc,
+                                      dstDu, dstDuDesc, dstDv, dstDvDesc,
+                                      patchCoords, patchArrayBuffer,
+                                      patchIndexBuffer, patchParamBuffer,
+                                      bezierPointIndices);
+
+    tbb::blocked_range<int> range(0, numPatchCoords, PATCH_COORD_GRAIN_SIZE);
+    tbb::parallel_for(range, kernel);
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
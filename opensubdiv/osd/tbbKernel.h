@@ -27,6 +27,8 @@
 
 #include "../version.h"
 
+#include <cstddef>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -37,6 +39,8 @@ struct PatchCoord;
 struct PatchParam;
 struct BufferDescriptor;
 
+// The stencils [start, end) are split into chunks of at least 'grainSize'
+// weights (0 uses the default grain size, see StencilPartition)
 void
 TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float * dst,       BufferDescriptor const &dstDesc,
@@ -44,7 +48,7 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 int const * offsets,
                 int const * indices,
                 float const * weights,
-                int start, int end);
+                int start, int end, int grainSize = 0);
 
 void
 TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
@@ -57,7 +61,30 @@ TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
                 float const * weights,
                 float const * duWeights,
                 float const * dvWeights,
-                int start, int end);
+                int start, int end, int grainSize = 0);
+
+// 64-bit offsets (stencil tables of more than 2^31 weights)
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                int start, int end, int grainSize = 0);
+
+void
+TbbEvalStencils(float const * src, BufferDescriptor const &srcDesc,
+                float * dst,       BufferDescriptor const &dstDesc,
+                float * dstDu,     BufferDescriptor const &dstDuDesc,
+                float * dstDv,     BufferDescriptor const &dstDvDesc,
+                int const * sizes,
+                size_t const * offsets,
+                int const * indices,
+                float const * weights,
+                float const * duWeights,
+                float const * dvWeights,
+                int start, int end, int grainSize = 0);
 
 void
 TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
@@ -70,6 +97,45 @@ TbbEvalPatches(float const *src, BufferDescriptor const &srcDesc,
                const int *patchIndexBuffer,
                const PatchParam *patchParamBuffer);
 
+// Varying evaluation : bilinear interpolation of the patch corners
+void
+TbbEvalPatchesVarying(float const *src, BufferDescriptor const &srcDesc,
+                      float *dst,       BufferDescriptor const &dstDesc,
+                      int numPatchCoords,
+                      const PatchCoord *patchCoords,
+                      const PatchArray *patchArrayBuffer,
+                      const int *patchIndexBuffer,
+                      const PatchParam *patchParamBuffer);
+
+// Vertex and face-varying evaluation of the same patch coords (either is
+// skipped if its source is NULL)
+void
+TbbEvalPatches(float const *src,     BufferDescriptor const &srcDesc,
+               float *dst,           BufferDescriptor const &dstDesc,
+               float const *fvarSrc, BufferDescriptor const &fvarSrcDesc,
+               float *fvarDst,       BufferDescriptor const &fvarDstDesc,
+               int numPatchCoords,
+               const PatchCoord *patchCoords,
+               const PatchArray *patchArrayBuffer,
+               const int *patchIndexBuffer,
+               const PatchParam *patchParamBuffer,
+               const PatchArray *fvarPatchArrayBuffer,
+               const int *fvarPatchIndexBuffer);
+
+// Evaluation using the Bezier points of the patches that have them (see
+// Far::BezierPatchTable) -- derivatives are skipped if dstDu is NULL
+void
+TbbEvalPatchesBezier(float const *src, BufferDescriptor const &srcDesc,
+                     float *dst,       BufferDescriptor const &dstDesc,
+                     float *dstDu,     BufferDescriptor const &dstDuDesc,
+                     float *dstDv,     BufferDescriptor const &dstDvDesc,
+                     int numPatchCoords,
+                     const PatchCoord *patchCoords,
+                     const PatchArray *patchArrayBuffer,
+                     const int *patchIndexBuffer,
+                     const PatchParam *patchParamBuffer,
+                     const int *bezierPointIndices);
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
@@ -27,6 +27,7 @@
 
 #include "../version.h"
 #include "../far/patchTable.h"
+#include "../far/stencilTable.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -98,6 +99,30 @@ struct PatchParam : public Far::PatchParam {
 typedef std::vector<PatchArray> PatchArrayVector;
 typedef std::vector<PatchParam> PatchParamVector;
 
+/// \brief Returns the 64-bit offsets of a stencil table, or NULL if its
+///        stencils are located with the 32-bit offsets of GetOffsets()
+///
+/// Only Far stencil tables of more than 2^31 weights use 64-bit offsets
+/// (see Far::StencilTable::HasLargeOffsets) : the cpu evaluators select
+/// their 64-bit kernels with this function.
+///
+template <class STENCIL_TABLE>
+inline size_t const * GetLargeStencilOffsets(STENCIL_TABLE const *) {
+    return NULL;
+}
+
+inline size_t const *
+GetLargeStencilOffsets(Far::StencilTable const * stencilTable) {
+    return stencilTable->HasLargeOffsets() ?
+        &stencilTable->GetLargeOffsets()[0] : NULL;
+}
+
+inline size_t const *
+GetLargeStencilOffsets(Far::LimitStencilTable const * stencilTable) {
+    return stencilTable->HasLargeOffsets() ?
+        &stencilTable->GetLargeOffsets()[0] : NULL;
+}
+
 }  // end namespace Osd
 
 }  // end namespace OPENSUBDIV_VERSION
@@ -188,8 +188,20 @@ Scheme<SCHEME_CATMARK>::assignSmoothMaskForVertex(VERTEX const& vertex, MASK& ma
     mask.SetNumFaceWeights(valence);
     mask.SetFaceWeightsForFaceCenters(true);
 
-    Weight vWeight = (Weight)(valence - 2) / (Weight)valence;
-    Weight fWeight = 1.0f / (Weight)(valence * valence);
+    //  Smooth interior vertices of low valence are by far the most common, so their
+    //  weights -- (N-2)/N and 1/N^2 -- are tabulated rather than recomputed:
+    Weight vWeight;
+    Weight fWeight;
+    if ((valence >= 3) && (valence <= 6)) {
+        static double const vWeights[4] = { 1.0/3.0,  2.0/4.0,  3.0/5.0,  4.0/6.0 };
+        static double const fWeights[4] = { 1.0/9.0, 1.0/16.0, 1.0/25.0, 1.0/36.0 };
+
+        vWeight = (Weight) vWeights[valence - 3];
+        fWeight = (Weight) fWeights[valence - 3];
+    } else {
+        vWeight = (Weight)(valence - 2) / (Weight)valence;
+        fWeight = 1.0f / (Weight)(valence * valence);
+    }
     Weight eWeight = fWeight;
 
     mask.VertexWeight(0) = vWeight;
@@ -277,9 +289,23 @@ Scheme<SCHEME_CATMARK>::assignSmoothLimitMask(VERTEX const& vertex, MASK& posMas
         posMask.FaceWeight(2) = fWeight;
         posMask.FaceWeight(3) = fWeight;
     } else {
-        Weight fWeight = 1.0f / (Weight)(valence * (valence + 5.0f));
-        Weight eWeight = 4.0f * fWeight;
-        Weight vWeight = (Weight)(1.0f - valence * (eWeight + fWeight));
+        //  Weights are N/(N+5), 4/(N(N+5)) and 1/(N(N+5)) -- tabulated for the
+        //  common irregular valences:
+        Weight fWeight;
+        Weight eWeight;
+        Weight vWeight;
+        if ((valence == 3) || (valence == 5) || (valence == 6)) {
+            static double const vWeights[4] = { 3.0/8.0,  0.0, 5.0/10.0, 6.0/11.0 };
+            static double const fWeights[4] = { 1.0/24.0, 0.0, 1.0/50.0, 1.0/66.0 };
+
+            fWeight = (Weight) fWeights[valence - 3];
+            eWeight = 4.0f * fWeight;
+            vWeight = (Weight) vWeights[valence - 3];
+        } else {
+            fWeight = 1.0f / (Weight)(valence * (valence + 5.0f));
+            eWeight = 4.0f * fWeight;
+            vWeight = (Weight)(1.0f - valence * (eWeight + fWeight));
+        }
 
         posMask.VertexWeight(0) = vWeight;
         for (int i = 0; i < valence; ++i) {
@@ -477,6 +503,32 @@ Scheme<SCHEME_CATMARK>::assignSmoothLimitTangentMasks(VERTEX const& vertex,
         tan1Mask.FaceWeight(1) = -1.0f;
         tan1Mask.FaceWeight(2) = -1.0f;
         tan1Mask.FaceWeight(3) =  1.0f;
+    } else if ((valence == 3) || (valence == 5) || (valence == 6)) {
+        //  Precomputed weights for the common irregular valences, i.e. the results
+        //  of the general formulae below evaluated exactly:
+        static double const edgeWeights3[3] = { 4.0, -2.0, -2.0 };
+        static double const faceWeights3[3] = { 0.7807764064044151, -1.5615528128088303,
+                                                0.7807764064044151 };
+
+        static double const edgeWeights5[5] = { 4.0, 1.2360679774997898, -3.23606797749979,
+                                                -3.23606797749979, 1.2360679774997898 };
+        static double const faceWeights5[5] = { 1.09088984177143, -0.4166828415746915,
+                                                -1.348414000393477, -0.4166828415746915,
+                                                1.09088984177143 };
+
+        static double const edgeWeights6[6] = { 4.0, 2.0, -2.0, -4.0, -2.0, 2.0 };
+        static double const faceWeights6[6] = { 1.1374586088176875, 0.0, -1.1374586088176875,
+                                                -1.1374586088176875, 0.0, 1.1374586088176875 };
+
+        static double const * const edgeWeights[4] = { edgeWeights3, 0, edgeWeights5, edgeWeights6 };
+        static double const * const faceWeights[4] = { faceWeights3, 0, faceWeights5, faceWeights6 };
+
+        double const * eWeights = edgeWeights[valence - 3];
+        double const * fWeights = faceWeights[valence - 3];
+        for (int i = 0; i < valence; ++i) {
+            tan1Mask.EdgeWeight(i) = (Weight) eWeights[i];
+            tan1Mask.FaceWeight(i) = (Weight) fWeights[i];
+        }
     } else {
         double theta = 2.0f * M_PI / (double)valence;
 
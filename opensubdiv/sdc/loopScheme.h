@@ -191,11 +191,15 @@ Scheme<SCHEME_LOOP>::assignSmoothMaskForVertex(VERTEX const& vertex, MASK& mask)
     Weight eWeight = (Weight) 0.0625f;
     Weight vWeight = (Weight) 0.625f;
 
-    if (valence != 6) {
+    if ((valence >= 3) && (valence <= 5)) {
+        //  The common irregular valences are tabulated to avoid the cosf() below:
+        static double const vWeights[3] = { 0.4375, 0.515625,   0.5795339053710855 };
+        static double const eWeights[3] = { 0.1875, 0.12109375, 0.08409321892578289 };
+
+        eWeight = (Weight) eWeights[valence - 3];
+        vWeight = (Weight) vWeights[valence - 3];
+    } else if (valence != 6) {
         //  From HbrLoopSubdivision<T>::Subdivide(mesh, vertex):
-        //     - could use some lookup tables here for common irregular valence (5, 7, 8)
-        //       or all of these cosf() calls will be adding up...
-
         Weight invValence = 1.0f / (Weight) valence;
         Weight beta       = 0.25f * cosf((Weight)M_PI * 2.0f * invValence) + 0.375f;
 
@@ -293,13 +297,24 @@ Scheme<SCHEME_LOOP>::assignSmoothLimitMask(VERTEX const& vertex, MASK& posMask)
         posMask.EdgeWeight(5) = eWeight;
 
     } else {
-        Weight invValence = 1.0f / valence;
-
-        Weight beta = 0.25f * cosf((Weight)M_PI * 2.0f * invValence) + 0.375f;
-        beta = (0.625f - (beta * beta)) * invValence;;
-
-        Weight eWeight = 1.0f / (valence + 3.0f / (8.0f * beta));
-        Weight vWeight = (Weight)(1.0f - (eWeight * valence));
+        Weight eWeight;
+        Weight vWeight;
+        if ((valence >= 3) && (valence <= 5)) {
+            //  The common irregular valences are tabulated to avoid the cosf() below:
+            static double const vWeights[3] = { 0.4, 24.0/55.0, 0.47142172687440287 };
+            static double const eWeights[3] = { 0.2, 31.0/220.0, 0.10571565462511943 };
+
+            eWeight = (Weight) eWeights[valence - 3];
+            vWeight = (Weight) vWeights[valence - 3];
+        } else {
+            Weight invValence = 1.0f / valence;
+
+            Weight beta = 0.25f * cosf((Weight)M_PI * 2.0f * invValence) + 0.375f;
+            beta = (0.625f - (beta * beta)) * invValence;;
+
+            eWeight = 1.0f / (valence + 3.0f / (8.0f * beta));
+            vWeight = (Weight)(1.0f - (eWeight * valence));
+        }
 
         posMask.VertexWeight(0) = vWeight;
         for (int i = 0; i < valence; ++i) {
@@ -562,6 +577,28 @@ Scheme<SCHEME_LOOP>::assignSmoothLimitTangentMasks(VERTEX const& vertex,
         tan2Mask.EdgeWeight(3) =  0.0f;
         tan2Mask.EdgeWeight(4) = -Root3by2;
         tan2Mask.EdgeWeight(5) = -Root3by2;
+    } else if ((valence >= 3) && (valence <= 5)) {
+        //  Cosines and sines of the common irregular valences are tabulated:
+        static double const cos3[3] = { 1.0, -0.5, -0.5 };
+        static double const sin3[3] = { 0.0, 0.8660254037844386, -0.8660254037844386 };
+
+        static double const cos4[4] = { 1.0, 0.0, -1.0,  0.0 };
+        static double const sin4[4] = { 0.0, 1.0,  0.0, -1.0 };
+
+        static double const cos5[5] = { 1.0, 0.30901699437494745, -0.8090169943749475,
+                                        -0.8090169943749475, 0.30901699437494745 };
+        static double const sin5[5] = { 0.0, 0.9510565162951535, 0.5877852522924731,
+                                        -0.5877852522924731, -0.9510565162951535 };
+
+        static double const * const cosTable[3] = { cos3, cos4, cos5 };
+        static double const * const sinTable[3] = { sin3, sin4, sin5 };
+
+        double const * cosAlpha = cosTable[valence - 3];
+        double const * sinAlpha = sinTable[valence - 3];
+        for (int i = 0; i < valence; ++i) {
+            tan1Mask.EdgeWeight(i) = (Weight) cosAlpha[i];
+            tan2Mask.EdgeWeight(i) = (Weight) sinAlpha[i];
+        }
     } else {
         Weight alpha = (Weight) (2.0f * M_PI / valence);
         for (int i = 0; i < valence; ++i) {
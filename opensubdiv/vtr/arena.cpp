@@ -0,0 +1,120 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#include "../vtr/arena.h"
+
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr {
+namespace internal {
+
+Arena::Arena(size_t blockSize) :
+    _current(0),
+    _blocks(0),
+    _initialBlockSize(blockSize),
+    _blockSize(blockSize),
+    _memoryUsage(0) {
+}
+
+Arena::~Arena() {
+    clear();
+}
+
+Arena::Block *
+Arena::allocateBlock(size_t capacity) {
+
+    Block * block = static_cast<Block *>(::operator new(HEADER_SIZE + capacity));
+    block->next = _blocks;
+    block->capacity = capacity;
+    block->used = 0;
+
+    _blocks = block;
+    _memoryUsage += capacity;
+    return block;
+}
+
+void *
+Arena::allocate(size_t size) {
+
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    if (_current and (_current->used + size <= _current->capacity)) {
+        void * ptr = _current->data() + _current->used;
+        _current->used += size;
+        return ptr;
+    }
+
+    //  Requests larger than a block get a block of their own, leaving the current
+    //  block available for subsequent smaller requests:
+    if (size > _blockSize) {
+        Block * block = allocateBlock(size);
+        block->used = size;
+        if (_current) {
+            //  keep the current block at the head of the list
+            _blocks = block->next;
+            block->next = _current->next;
+            _current->next = block;
+        }
+        return block->data();
+    }
+
+    _current = allocateBlock(_blockSize);
+    _current->used = size;
+
+    _blockSize = (_blockSize < MAX_BLOCK_SIZE / 2) ? (_blockSize * 2) : MAX_BLOCK_SIZE;
+
+    return _current->data();
+}
+
+void
+Arena::deallocate(void * ptr, size_t size) {
+
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    //  Only the most recent allocation of the current block can be reclaimed:
+    if (_current and
+        (static_cast<char *>(ptr) + size == _current->data() + _current->used)) {
+        _current->used -= size;
+    }
+}
+
+void
+Arena::clear() {
+
+    while (_blocks) {
+        Block * next = _blocks->next;
+        ::operator delete(_blocks);
+        _blocks = next;
+    }
+    _current = 0;
+    _blockSize = _initialBlockSize;
+    _memoryUsage = 0;
+}
+
+} // end namespace internal
+} // end namespace Vtr
+
+} // end namespace OPENSUBDIV_VERSION
+} // end namespace OpenSubdiv
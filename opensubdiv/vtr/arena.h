@@ -0,0 +1,175 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+#ifndef OPENSUBDIV3_VTR_ARENA_H
+#define OPENSUBDIV3_VTR_ARENA_H
+
+#include "../version.h"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+namespace Vtr {
+namespace internal {
+
+//
+//  The Arena class is a simple monotonic allocator intended to hold the many
+//  vectors of topology and tags of the refined Levels and of the Refinements
+//  between them.  Their sizes are known as each level is refined, they are not
+//  modified once refinement is complete and they are all released together
+//  when the refiner is unrefined or destroyed.
+//
+//  Memory is requested in blocks of geometrically increasing size, so that a
+//  complete hierarchy of levels only requires a few large allocations instead
+//  of hundreds of them -- this reduces contention in the system allocator when
+//  many meshes are refined concurrently.  Deallocation only reclaims the most
+//  recent allocation (e.g. a vector trimmed to its final size after an estimate),
+//  everything else is released in bulk by clear().
+//
+//  An Arena is not thread-safe:  it is owned by a single TopologyRefiner.
+//
+class Arena {
+public:
+    Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~Arena();
+
+    void * allocate(size_t size);
+    void   deallocate(void * ptr, size_t size);
+
+    //  Releases all memory allocated from the arena:
+    void clear();
+
+    //  Total size of the blocks allocated from the system:
+    size_t getMemoryUsage() const { return _memoryUsage; }
+
+private:
+    //  Non-copyable:
+    Arena(Arena const &) { }
+    Arena & operator=(Arena const &) { return *this; }
+
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024,
+                        MAX_BLOCK_SIZE = 16 * 1024 * 1024,
+                        ALIGNMENT = 16;
+
+    struct Block {
+        Block * next;
+        size_t  capacity,
+                used;
+
+        char * data() { return reinterpret_cast<char *>(this) + HEADER_SIZE; }
+    };
+    static const size_t HEADER_SIZE = (sizeof(Block) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    Block * allocateBlock(size_t capacity);
+
+private:
+    Block * _current;
+    Block * _blocks;
+
+    size_t _initialBlockSize,
+           _blockSize,
+           _memoryUsage;
+};
+
+//
+//  STL allocator drawing from an Arena -- a default-constructed allocator (with no
+//  Arena) simply uses the global operator new/delete, so containers using it behave
+//  as with std::allocator unless an Arena is explicitly provided:
+//
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T              value_type;
+    typedef T *            pointer;
+    typedef T const *      const_pointer;
+    typedef T &            reference;
+    typedef T const &      const_reference;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+public:
+    ArenaAllocator(Arena * arena = 0) : _arena(arena) { }
+
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const & other) : _arena(other.getArena()) { }
+
+    Arena * getArena() const { return _arena; }
+
+    pointer       address(reference x) const       { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    pointer allocate(size_type n, void const * = 0) {
+        size_type size = n * sizeof(T);
+        return static_cast<pointer>(_arena ? _arena->allocate(size) : ::operator new(size));
+    }
+    void deallocate(pointer p, size_type n) {
+        if (_arena) {
+            _arena->deallocate(p, n * sizeof(T));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+    void construct(pointer p, const_reference value) { new (p) T(value); }
+    void destroy(pointer p) { p->~T(); }
+
+private:
+    Arena * _arena;
+};
+
+template <typename T, typename U>
+inline bool
+operator==(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b) {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+inline bool
+operator!=(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b) {
+    return a.getArena() != b.getArena();
+}
+
+//
+//  Vector type for members of Levels and Refinements allocated from an Arena:
+//
+template <typename T>
+struct ArenaVector {
+    typedef std::vector<T, ArenaAllocator<T> > type;
+};
+
+} // end namespace internal
+} // end namespace Vtr
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+} // end namespace OpenSubdiv
+
+#endif /* OPENSUBDIV3_VTR_ARENA_H */
@@ -433,6 +433,15 @@ FVarLevel::completeTopologyFromFaceValues(int regularBoundaryValence) {
             }
         }
 
+        //  Values of linear channels are all corners -- no inspection of the local
+        //  topology of the values is warranted:
+        //
+        if (_isLinear) {
+            ValueTagArray vValueTags = getVertexValueTags(vIndex);
+            std::fill(vValueTags.begin(), vValueTags.end(), valueTagMismatch);
+            continue;
+        }
+
         //  XXXX (barfowl) -- this pre-emptive sharpening of values will need to be
         //  revisited soon.  This intentionally avoids the overhead of identifying the
         //  local topology of the values along its boundaries -- necessary for smooth
@@ -91,6 +91,9 @@ FVarRefinement::applyRefinement() {
     populateChildValues();
     trimAndFinalizeChildValues();
 
+    //  Linear channels only tag values as matching or not (corners) : the crease
+    //  ends and semi-sharp values of smooth boundaries are not propagated
+    //
     propagateEdgeTags();
     propagateValueTags();
     if (_childFVar.hasSmoothBoundaries()) {
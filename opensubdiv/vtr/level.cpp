@@ -58,13 +58,32 @@ namespace internal {
 //
 //  Simple (for now) constructor and destructor:
 //
-Level::Level() :
+Level::Level(Arena * arena) :
     _faceCount(0),
     _edgeCount(0),
     _vertCount(0),
     _depth(0),
     _maxEdgeFaces(0),
-    _maxValence(0) {
+    _maxValence(0),
+    _faceVertCountsAndOffsets(arena),
+    _faceVertIndices(arena),
+    _faceEdgeIndices(arena),
+    _faceTags(arena),
+    _edgeVertIndices(arena),
+    _edgeFaceCountsAndOffsets(arena),
+    _edgeFaceIndices(arena),
+    _edgeFaceLocalIndices(arena),
+    _edgeSharpness(arena),
+    _edgeTags(arena),
+    _vertFaceCountsAndOffsets(arena),
+    _vertFaceIndices(arena),
+    _vertFaceLocalIndices(arena),
+    _vertEdgeCountsAndOffsets(arena),
+    _vertEdgeIndices(arena),
+    _vertEdgeLocalIndices(arena),
+    _vertSharpness(arena),
+    _vertTags(arena),
+    _arena(arena) {
 }
 
 Level::~Level() {
@@ -1346,11 +1365,12 @@ namespace {
     //  Once all incident members have been added, the main vector is compressed and may
     //  need to merge entries from the map in the process.
     //
+    typedef ArenaVector<Index>::type     LevelIndexVector;
     typedef std::map<Index, IndexVector> IrregIndexMap;
 
     class DynamicRelation {
     public:
-        DynamicRelation(IndexVector& countAndOffsets, IndexVector& indices, int membersPerComp);
+        DynamicRelation(LevelIndexVector& countAndOffsets, LevelIndexVector& indices, int membersPerComp);
         ~DynamicRelation() { }
 
     public:
@@ -1366,14 +1386,14 @@ namespace {
         int _compCount;
         int _memberCountPerComp;
 
-        IndexVector & _countsAndOffsets;
-        IndexVector & _regIndices;
+        LevelIndexVector & _countsAndOffsets;
+        LevelIndexVector & _regIndices;
 
         IrregIndexMap _irregIndices;
     };
 
     inline
-    DynamicRelation::DynamicRelation(IndexVector& countAndOffsets, IndexVector& indices, int membersPerComp) :
+    DynamicRelation::DynamicRelation(LevelIndexVector& countAndOffsets, LevelIndexVector& indices, int membersPerComp) :
             _compCount(0),
             _memberCountPerComp(membersPerComp),
             _countsAndOffsets(countAndOffsets),
@@ -1463,11 +1483,11 @@ namespace {
             cannotBeCompressedInPlace |= (memberCount > (_memberCountPerComp * _compCount));
 
             //  Copy members into the original or temporary vector accordingly:
-            IndexVector  tmpIndices;
+            LevelIndexVector  tmpIndices(_regIndices.get_allocator());
             if (cannotBeCompressedInPlace) {
                 tmpIndices.resize(memberCount);
             }
-            IndexVector& dstIndices = cannotBeCompressedInPlace ? tmpIndices : _regIndices;
+            LevelIndexVector& dstIndices = cannotBeCompressedInPlace ? tmpIndices : _regIndices;
 
             int memberMax = _memberCountPerComp;
             for (int i = 0; i < _compCount; ++i) {
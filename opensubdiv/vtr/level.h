@@ -30,6 +30,7 @@
 #include "../sdc/crease.h"
 #include "../sdc/options.h"
 #include "../vtr/types.h"
+#include "../vtr/arena.h"
 
 #include <algorithm>
 #include <vector>
@@ -150,9 +151,13 @@ public:
     ETag getFaceCompositeETag(ConstIndexArray & faceEdges) const;
 
 public:
-    Level();
+    //  Levels generated by refinement allocate their vectors from the Arena of
+    //  the refiner (if provided) -- see the notes on Arena:
+    Level(Arena * arena = 0);
     ~Level();
 
+    Arena * getArena() const { return _arena; }
+
     //  Simple accessors:
     int getDepth() const { return _depth; }
 
@@ -442,34 +447,36 @@ private:
     //
 
     //  Per-face:
-    std::vector<Index> _faceVertCountsAndOffsets;  // 2 per face, redundant after level 0
-    std::vector<Index> _faceVertIndices;           // 3 or 4 per face, variable at level 0
-    std::vector<Index> _faceEdgeIndices;           // matches face-vert indices
-    std::vector<FTag>  _faceTags;                  // 1 per face:  includes "hole" tag
+    ArenaVector<Index>::type _faceVertCountsAndOffsets;  // 2 per face, redundant after level 0
+    ArenaVector<Index>::type _faceVertIndices;           // 3 or 4 per face, variable at level 0
+    ArenaVector<Index>::type _faceEdgeIndices;           // matches face-vert indices
+    ArenaVector<FTag>::type  _faceTags;                  // 1 per face:  includes "hole" tag
 
     //  Per-edge:
-    std::vector<Index>      _edgeVertIndices;           // 2 per edge
-    std::vector<Index>      _edgeFaceCountsAndOffsets;  // 2 per edge
-    std::vector<Index>      _edgeFaceIndices;           // varies with faces per edge
-    std::vector<LocalIndex> _edgeFaceLocalIndices;      // varies with faces per edge
+    ArenaVector<Index>::type      _edgeVertIndices;           // 2 per edge
+    ArenaVector<Index>::type      _edgeFaceCountsAndOffsets;  // 2 per edge
+    ArenaVector<Index>::type      _edgeFaceIndices;           // varies with faces per edge
+    ArenaVector<LocalIndex>::type _edgeFaceLocalIndices;      // varies with faces per edge
 
-    std::vector<float>      _edgeSharpness;             // 1 per edge
-    std::vector<ETag>       _edgeTags;                  // 1 per edge:  manifold, boundary, etc.
+    ArenaVector<float>::type      _edgeSharpness;             // 1 per edge
+    ArenaVector<ETag>::type       _edgeTags;                  // 1 per edge:  manifold, boundary, etc.
 
     //  Per-vertex:
-    std::vector<Index>      _vertFaceCountsAndOffsets;  // 2 per vertex
-    std::vector<Index>      _vertFaceIndices;           // varies with valence
-    std::vector<LocalIndex> _vertFaceLocalIndices;      // varies with valence, 8-bit for now
+    ArenaVector<Index>::type      _vertFaceCountsAndOffsets;  // 2 per vertex
+    ArenaVector<Index>::type      _vertFaceIndices;           // varies with valence
+    ArenaVector<LocalIndex>::type _vertFaceLocalIndices;      // varies with valence, 8-bit for now
 
-    std::vector<Index>      _vertEdgeCountsAndOffsets;  // 2 per vertex
-    std::vector<Index>      _vertEdgeIndices;           // varies with valence
-    std::vector<LocalIndex> _vertEdgeLocalIndices;      // varies with valence, 8-bit for now
+    ArenaVector<Index>::type      _vertEdgeCountsAndOffsets;  // 2 per vertex
+    ArenaVector<Index>::type      _vertEdgeIndices;           // varies with valence
+    ArenaVector<LocalIndex>::type _vertEdgeLocalIndices;      // varies with valence, 8-bit for now
 
-    std::vector<float>      _vertSharpness;             // 1 per vertex
-    std::vector<VTag>       _vertTags;                  // 1 per vertex:  manifold, Sdc::Rule, etc.
+    ArenaVector<float>::type      _vertSharpness;             // 1 per vertex
+    ArenaVector<VTag>::type       _vertTags;                  // 1 per vertex:  manifold, Sdc::Rule, etc.
 
     //  Face-varying channels:
     std::vector<FVarLevel*> _fvarChannels;
+
+    Arena * _arena;
 };
 
 //
@@ -63,7 +63,23 @@ Refinement::Refinement(Level const & parent, Level & child, Sdc::Options const&
     _firstChildEdgeFromEdge(0),
     _firstChildVertFromFace(0),
     _firstChildVertFromEdge(0),
-    _firstChildVertFromVert(0) {
+    _firstChildVertFromVert(0),
+    //  all vectors are allocated from the Arena of the child level (if any):
+    _faceChildFaceIndices(child.getArena()),
+    _faceChildEdgeIndices(child.getArena()),
+    _faceChildVertIndex(child.getArena()),
+    _edgeChildEdgeIndices(child.getArena()),
+    _edgeChildVertIndex(child.getArena()),
+    _vertChildVertIndex(child.getArena()),
+    _childFaceParentIndex(child.getArena()),
+    _childEdgeParentIndex(child.getArena()),
+    _childVertexParentIndex(child.getArena()),
+    _childFaceTag(child.getArena()),
+    _childEdgeTag(child.getArena()),
+    _childVertexTag(child.getArena()),
+    _parentFaceTag(child.getArena()),
+    _parentEdgeTag(child.getArena()),
+    _parentVertexTag(child.getArena()) {
 
     assert((child.getDepth() == 0) && (child.getNumVertices() == 0));
     child._depth = 1 + parent.getDepth();
@@ -203,7 +219,7 @@ namespace {
     inline bool isSparseIndexMarked(Index index)   { return index != 0; }
 
     inline int
-    sequenceSparseIndexVector(IndexVector& indexVector, int baseValue = 0) {
+    sequenceSparseIndexVector(ArenaVector<Index>::type& indexVector, int baseValue = 0) {
         int validCount = 0;
         for (int i = 0; i < (int) indexVector.size(); ++i) {
             indexVector[i] = isSparseIndexMarked(indexVector[i])
@@ -213,7 +229,7 @@ namespace {
     }
 
     inline int
-    sequenceFullIndexVector(IndexVector& indexVector, int baseValue = 0) {
+    sequenceFullIndexVector(ArenaVector<Index>::type& indexVector, int baseValue = 0) {
         int indexCount = (int) indexVector.size();
         for (int i = 0; i < indexCount; ++i) {
             indexVector[i] = baseValue++;
@@ -374,32 +374,32 @@ protected:
     IndexArray _faceChildFaceCountsAndOffsets;
     IndexArray _faceChildEdgeCountsAndOffsets;
 
-    IndexVector _faceChildFaceIndices;  // *cannot* always use face-vert counts/offsets
-    IndexVector _faceChildEdgeIndices;  // can use face-vert counts/offsets
-    IndexVector _faceChildVertIndex;
+    ArenaVector<Index>::type _faceChildFaceIndices;  // *cannot* always use face-vert counts/offsets
+    ArenaVector<Index>::type _faceChildEdgeIndices;  // can use face-vert counts/offsets
+    ArenaVector<Index>::type _faceChildVertIndex;
 
-    IndexVector _edgeChildEdgeIndices;  // trivial/corresponding pair for each
-    IndexVector _edgeChildVertIndex;
+    ArenaVector<Index>::type _edgeChildEdgeIndices;  // trivial/corresponding pair for each
+    ArenaVector<Index>::type _edgeChildVertIndex;
 
-    IndexVector _vertChildVertIndex;
+    ArenaVector<Index>::type _vertChildVertIndex;
 
     //
     //  The child-to-parent mapping:
     //
-    IndexVector _childFaceParentIndex;
-    IndexVector _childEdgeParentIndex;
-    IndexVector _childVertexParentIndex;
+    ArenaVector<Index>::type _childFaceParentIndex;
+    ArenaVector<Index>::type _childEdgeParentIndex;
+    ArenaVector<Index>::type _childVertexParentIndex;
 
-    std::vector<ChildTag> _childFaceTag;
-    std::vector<ChildTag> _childEdgeTag;
-    std::vector<ChildTag> _childVertexTag;
+    ArenaVector<ChildTag>::type _childFaceTag;
+    ArenaVector<ChildTag>::type _childEdgeTag;
+    ArenaVector<ChildTag>::type _childVertexTag;
 
     //
     //  Tags for spase selection of components:
     //
-    std::vector<SparseTag> _parentFaceTag;
-    std::vector<SparseTag> _parentEdgeTag;
-    std::vector<SparseTag> _parentVertexTag;
+    ArenaVector<SparseTag>::type _parentFaceTag;
+    ArenaVector<SparseTag>::type _parentEdgeTag;
+    ArenaVector<SparseTag>::type _parentVertexTag;
 
     //
     //  Refinement data for face-varying channels present in the Levels being refined:
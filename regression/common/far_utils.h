@@ -27,6 +27,7 @@
 
 #include <far/topologyRefinerFactory.h>
 #include <far/primvarRefiner.h>
+#include <far/stencilTable.h>
 #include <far/types.h>
 
 #include <cstdio>
@@ -179,6 +180,19 @@ InterpolateFarVertexData(const char *shapeStr, Scheme scheme, int maxlevel,
 }
 
 
+//------------------------------------------------------------------------------
+// Stencil table of the given stencil sizes, without control indices nor
+// weights : locates stencils in tables too large to be allocated in the tests
+
+class SyntheticStencilTable : public OpenSubdiv::Far::StencilTable {
+public:
+    SyntheticStencilTable(int numControlVerts, std::vector<int> const & sizes) :
+        OpenSubdiv::Far::StencilTable(numControlVerts) {
+        _sizes = sizes;
+        generateOffsets();
+    }
+};
+
 //------------------------------------------------------------------------------
 
 namespace OpenSubdiv {
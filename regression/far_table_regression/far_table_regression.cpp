@@ -0,0 +1,1665 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include <far/bezierPatchTable.h>
+#include <far/clusterTable.h>
+#include <far/clusterTableFactory.h>
+#include <far/patchMap.h>
+#include <far/patchTableFactory.h>
+#include <far/ptexIndices.h>
+#include <far/stencilTableFactory.h>
+#include <far/uniformMeshExporter.h>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../regression/common/far_utils.h"
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <omp.h>
+#endif
+
+#include "../shapes/bilinear_cube.h"
+#include "../shapes/catmark_cube.h"
+#include "../shapes/catmark_cube_creases1.h"
+#include "../shapes/catmark_fan.h"
+#include "../shapes/catmark_fvar_bound0.h"
+#include "../shapes/catmark_hole_test1.h"
+#include "../shapes/catmark_lefthanded.h"
+#include "../shapes/catmark_pole8.h"
+#include "../shapes/catmark_single_crease.h"
+#include "../shapes/catmark_torus.h"
+#include "../shapes/loop_pole8.h"
+
+//
+// Regression testing of Far tables and factories against the reference paths
+// they are meant to reproduce (ex. incremental updates against tables created
+// from scratch)
+//
+// Notes:
+// - precision is held at 1e-6
+//
+#define PRECISION 1e-6
+
+using namespace OpenSubdiv;
+
+//------------------------------------------------------------------------------
+// Vertex class implementation
+struct Vertex {
+
+    Vertex() { }
+
+    Vertex(Vertex const & src) {
+        _pos[0]=src._pos[0]; _pos[1]=src._pos[1]; _pos[2]=src._pos[2];
+    }
+
+    void Clear(void * =0) { _pos[0]=_pos[1]=_pos[2]=0.0f; }
+
+    void AddWithWeight(Vertex const & src, float weight) {
+        _pos[0]+=weight*src._pos[0];
+        _pos[1]+=weight*src._pos[1];
+        _pos[2]+=weight*src._pos[2];
+    }
+
+    void SetPosition(float x, float y, float z) { _pos[0]=x; _pos[1]=y; _pos[2]=z; }
+
+    const float * GetPos() const { return _pos; }
+
+private:
+    float _pos[3];
+};
+
+typedef std::vector<Vertex> VertexBuffer;
+
+//------------------------------------------------------------------------------
+static Far::TopologyRefiner *
+createRefiner(std::string const & shapeStr, Scheme scheme, VertexBuffer & coarseVerts) {
+
+    typedef Far::TopologyRefinerFactory<Shape> RefinerFactory;
+
+    Shape * shape = Shape::parseObj(shapeStr.c_str(), scheme);
+
+    Far::TopologyRefiner * refiner = RefinerFactory::Create(*shape,
+        RefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+    assert(refiner);
+
+    coarseVerts.resize(shape->GetNumVertices());
+    for (int i=0; i<shape->GetNumVertices(); ++i) {
+        coarseVerts[i].SetPosition(shape->verts[i*3+0],
+                                   shape->verts[i*3+1],
+                                   shape->verts[i*3+2]);
+    }
+    delete shape;
+    return refiner;
+}
+
+//------------------------------------------------------------------------------
+// Computes the refined vertices and the local points of an adaptive table
+static void
+computeVertices(Far::TopologyRefiner const & refiner,
+    Far::PatchTable const & patchTable, VertexBuffer const & coarseVerts,
+    VertexBuffer & verts) {
+
+    Far::StencilTableFactory::Options options;
+    options.generateIntermediateLevels = true;
+    options.generateControlVerts = true;
+    options.generateOffsets = true;
+
+    Far::StencilTable const * stencils =
+        Far::StencilTableFactory::Create(refiner, options);
+
+    if (patchTable.GetLocalPointStencilTable()) {
+        Far::StencilTable const * appended =
+            Far::StencilTableFactory::AppendLocalPointStencilTable(refiner,
+                stencils, patchTable.GetLocalPointStencilTable());
+        delete stencils;
+        stencils = appended;
+    }
+
+    verts.resize(stencils->GetNumStencils());
+    stencils->UpdateValues(&coarseVerts[0], &verts[0]);
+    delete stencils;
+}
+
+//------------------------------------------------------------------------------
+// Evaluates the limit position of a ptex face
+static Far::PatchTable::PatchHandle const *
+evalLimit(Far::PatchTable const & patchTable, Far::PatchMap const & patchMap,
+    VertexBuffer const & verts, int face, float s, float t, Vertex & pos) {
+
+    pos.Clear();
+
+    Far::PatchTable::PatchHandle const * handle = patchMap.FindPatch(face, s, t);
+    if (handle) {
+        float wP[20], wDs[20], wDt[20];
+        patchTable.EvaluateBasis(*handle, s, t, wP, wDs, wDt);
+
+        Far::ConstIndexArray cvs = patchTable.GetPatchVertices(*handle);
+        for (int i=0; i<cvs.size(); ++i) {
+            pos.AddWithWeight(verts[cvs[i]], wP[i]);
+        }
+    }
+    return handle;
+}
+
+static float
+distance(Vertex const & a, Vertex const & b) {
+
+    float delta[3] = { a.GetPos()[0] - b.GetPos()[0],
+                       a.GetPos()[1] - b.GetPos()[1],
+                       a.GetPos()[2] - b.GetPos()[2] };
+    return sqrtf(delta[0]*delta[0] + delta[1]*delta[1] + delta[2]*delta[2]);
+}
+
+//------------------------------------------------------------------------------
+// Compares the limit surface, boundaries and transitions of two tables of the
+// same mesh over a grid of samples of each ptex face
+static int
+compareTables(int numPtexFaces,
+    Far::PatchTable const & tableA, VertexBuffer const & vertsA,
+    Far::PatchTable const & tableB, VertexBuffer const & vertsB) {
+
+    Far::PatchMap patchMapA(tableA),
+                  patchMapB(tableB);
+
+    int count = 0, numSamples = 8;
+    float maxDist = 0.0f;
+
+    for (int face=0; face<numPtexFaces; ++face) {
+        for (int i=0; i<=numSamples; ++i) {
+            for (int j=0; j<=numSamples; ++j) {
+
+                float s = (float)i/numSamples,
+                      t = (float)j/numSamples;
+
+                Vertex posA, posB;
+                Far::PatchTable::PatchHandle const
+                    * handleA = evalLimit(tableA, patchMapA, vertsA, face, s, t, posA),
+                    * handleB = evalLimit(tableB, patchMapB, vertsB, face, s, t, posB);
+
+                if ((handleA==0) != (handleB==0)) {
+                    ++count;
+                    continue;
+                }
+                if (handleA==0) {
+                    continue;
+                }
+
+                Far::PatchParam const & paramA = tableA.GetPatchParam(*handleA),
+                                      & paramB = tableB.GetPatchParam(*handleB);
+                if (paramA.GetBoundary() != paramB.GetBoundary() or
+                    paramA.GetTransition() != paramB.GetTransition() or
+                    paramA.GetDepth() != paramB.GetDepth()) {
+                    ++count;
+                }
+
+                float dist = distance(posA, posB);
+                maxDist = std::max(maxDist, dist);
+                if (dist > PRECISION) {
+                    ++count;
+                }
+            }
+        }
+    }
+
+    printf("  max distance : %.10f\n", maxDist);
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// PatchTableFactory::UpdateAdaptive : updating the table of a mesh after local
+// edits must match the table created from the edited mesh
+static int
+checkUpdateAdaptive(char const * name, std::string const & shapeStr,
+    std::string const & editedShapeStr, Far::Index const * faces, int numFaces,
+    bool useSingleCreasePatch, bool expectRejected=false) {
+
+    printf("- UpdateAdaptive %-20s ( single crease %d ): \n", name, useSingleCreasePatch);
+
+    int maxlevel = 3;
+
+    Far::PatchTableFactory::Options options(maxlevel);
+    options.useSingleCreasePatch = useSingleCreasePatch;
+    options.SetEndCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+    Far::TopologyRefiner::AdaptiveOptions adaptiveOptions(maxlevel);
+    adaptiveOptions.useSingleCreasePatch = useSingleCreasePatch;
+
+    VertexBuffer coarseVerts, editedCoarseVerts;
+
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, kCatmark, coarseVerts);
+    refiner->RefineAdaptive(adaptiveOptions);
+
+    Far::TopologyRefiner * editedRefiner =
+        createRefiner(editedShapeStr, kCatmark, editedCoarseVerts);
+    editedRefiner->RefineAdaptive(adaptiveOptions);
+
+    // table of the original mesh, updated after the edits
+    Far::PatchTable * updatedTable =
+        Far::PatchTableFactory::Create(*refiner, options);
+
+    VertexBuffer updatedVerts;
+    computeVertices(*refiner, *updatedTable, coarseVerts, updatedVerts);
+
+    int firstVertex = (int)updatedVerts.size();
+
+    Far::StencilTable const * updateStencils =
+        Far::PatchTableFactory::UpdateAdaptive(*editedRefiner,
+            Far::ConstIndexArray(faces, numFaces), firstVertex,
+            updatedTable, options);
+
+    int count = 0;
+    if (expectRejected or (not updateStencils)) {
+        count = (expectRejected == (updateStencils==0)) ? 0 : 1;
+    } else {
+        updatedVerts.resize(firstVertex + updateStencils->GetNumStencils());
+        updateStencils->UpdateValues(&editedCoarseVerts[0], &updatedVerts[firstVertex]);
+
+        // table created from the edited mesh
+        Far::PatchTable * table =
+            Far::PatchTableFactory::Create(*editedRefiner, options);
+
+        VertexBuffer verts;
+        computeVertices(*editedRefiner, *table, editedCoarseVerts, verts);
+
+        count = compareTables(Far::PtexIndices(*editedRefiner).GetNumFaces(),
+            *updatedTable, updatedVerts, *table, verts);
+
+        delete table;
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete updateStencils;
+    delete updatedTable;
+    delete editedRefiner;
+    delete refiner;
+    return count;
+}
+
+// UpdateAdaptive : applies a sequence of edits to the same table, each edit
+// modifying a single face of the previous mesh, and compares the table after
+// each update with a table created from the edited mesh
+static int
+checkSequentialUpdates(char const * name, std::string const * shapeStrs,
+    Far::Index const * faces, int numEdits, bool useSingleCreasePatch) {
+
+    printf("- UpdateAdaptive %-20s ( single crease %d, %d edits ): \n",
+        name, useSingleCreasePatch, numEdits);
+
+    int maxlevel = 3;
+
+    Far::PatchTableFactory::Options options(maxlevel);
+    options.useSingleCreasePatch = useSingleCreasePatch;
+    options.SetEndCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+    Far::TopologyRefiner::AdaptiveOptions adaptiveOptions(maxlevel);
+    adaptiveOptions.useSingleCreasePatch = useSingleCreasePatch;
+
+    VertexBuffer coarseVerts;
+
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStrs[0], kCatmark, coarseVerts);
+    refiner->RefineAdaptive(adaptiveOptions);
+
+    Far::PatchTable * updatedTable =
+        Far::PatchTableFactory::Create(*refiner, options);
+
+    VertexBuffer updatedVerts;
+    computeVertices(*refiner, *updatedTable, coarseVerts, updatedVerts);
+
+    delete refiner;
+
+    int count = 0;
+    for (int edit=1; edit<=numEdits and count==0; ++edit) {
+
+        VertexBuffer editedCoarseVerts;
+        Far::TopologyRefiner * editedRefiner =
+            createRefiner(shapeStrs[edit], kCatmark, editedCoarseVerts);
+        editedRefiner->RefineAdaptive(adaptiveOptions);
+
+        int firstVertex = (int)updatedVerts.size();
+
+        Far::StencilTable const * updateStencils =
+            Far::PatchTableFactory::UpdateAdaptive(*editedRefiner,
+                Far::ConstIndexArray(&faces[edit-1], 1), firstVertex,
+                updatedTable, options);
+
+        if (not updateStencils) {
+            printf("  edit %d rejected\n", edit);
+            count = 1;
+        } else {
+            updatedVerts.resize(firstVertex + updateStencils->GetNumStencils());
+            updateStencils->UpdateValues(&editedCoarseVerts[0],
+                &updatedVerts[firstVertex]);
+
+            Far::PatchTable * table =
+                Far::PatchTableFactory::Create(*editedRefiner, options);
+
+            VertexBuffer verts;
+            computeVertices(*editedRefiner, *table, editedCoarseVerts, verts);
+
+            count = compareTables(Far::PtexIndices(*editedRefiner).GetNumFaces(),
+                *updatedTable, updatedVerts, *table, verts);
+            if (updatedTable->GetNumPatchesTotal() != table->GetNumPatchesTotal()) {
+                printf("  edit %d : %d patches instead of %d\n", edit,
+                    updatedTable->GetNumPatchesTotal(), table->GetNumPatchesTotal());
+                ++count;
+            }
+            delete table;
+        }
+        delete updateStencils;
+        delete editedRefiner;
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete updatedTable;
+    return count;
+}
+
+static int
+checkUpdateAdaptive() {
+
+    int total = 0;
+
+    // creasing the edges of a face changes the isolation of its neighbors
+    // and the transitions of their own neighbors
+    std::string creasedTorus = catmark_torus + "t crease 2/1/0 4 5 10\n";
+
+    Far::Index face = 0;
+    for (int singleCrease=0; singleCrease<2; ++singleCrease) {
+        total += checkUpdateAdaptive("catmark_torus", catmark_torus,
+            creasedTorus, &face, 1, singleCrease!=0);
+    }
+
+    // creasing a second face, then uncreasing the first one, splices the
+    // patches into the arrays of the previous update (and shrinks them)
+    std::string shapes[4] = { catmark_torus, creasedTorus,
+        creasedTorus + "t crease 2/1/0 22 23 10\n",
+        catmark_torus + "t crease 2/1/0 22 23 10\n" };
+    Far::Index editedFaces[3] = { 0, 18, 0 };
+    for (int singleCrease=0; singleCrease<2; ++singleCrease) {
+        total += checkSequentialUpdates("catmark_torus", shapes, editedFaces, 3,
+            singleCrease!=0);
+    }
+
+    // splitting a quad into triangles shifts the ptex faces of the mesh and
+    // must be rejected
+    std::string splitTorus = catmark_torus;
+    std::string quad = "f 5/1/1 6/2/2 2/3/3 1/4/4\n";
+    splitTorus.replace(splitTorus.find(quad), quad.size(), "f 5/1/1 6/2/2 2/3/3\n");
+    splitTorus += "f 5/1/1 2/3/3 1/4/4\n";
+
+    Far::Index splitFaces[2] = { 0, 32 };
+    total += checkUpdateAdaptive("catmark_torus_split", catmark_torus,
+        splitTorus, splitFaces, 2, false, /*expectRejected*/true);
+
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// Returns a grid of n x n quads with sharp corners and creases, large enough
+// for the patches of its levels to be identified and gathered concurrently
+static std::string
+createCreasedGrid(int n) {
+
+    std::stringstream shape;
+    for (int y=0; y<=n; ++y) {
+        for (int x=0; x<=n; ++x) {
+            shape << "v " << x << " " << y << " 0\n";
+        }
+    }
+    for (int y=0; y<n; ++y) {
+        for (int x=0; x<n; ++x) {
+            int v = y*(n+1) + x + 1;
+            shape << "f " << v << " " << v+1 << " " << v+n+2 << " " << v+n+1 << "\n";
+        }
+    }
+    for (int y=3; y<n; y+=7) {
+        for (int x=3; x<n; x+=5) {
+            int v = y*(n+1) + x;
+            shape << "t corner 1/1/0 " << v << " 2.0\n";
+            shape << "t crease 2/1/0 " << v+n+1 << " " << v+n+2 << " 1.5\n";
+        }
+    }
+    return shape.str();
+}
+
+// Returns true if two tables have the same patches, in the same order
+static bool
+samePatches(Far::PatchTable const & a, Far::PatchTable const & b) {
+
+    if (a.GetNumPatchArrays() != b.GetNumPatchArrays() or
+        a.GetNumLocalPoints() != b.GetNumLocalPoints() or
+        a.GetSharpnessIndexTable().size() != b.GetSharpnessIndexTable().size()) {
+        return false;
+    }
+    bool hasSharpness = not a.GetSharpnessIndexTable().empty();
+    for (int array=0; array<a.GetNumPatchArrays(); ++array) {
+        if (not (a.GetPatchArrayDescriptor(array) == b.GetPatchArrayDescriptor(array)) or
+            a.GetNumPatches(array) != b.GetNumPatches(array)) {
+            return false;
+        }
+        Far::ConstIndexArray cvsA = a.GetPatchArrayVertices(array),
+                             cvsB = b.GetPatchArrayVertices(array);
+        if (memcmp(&cvsA[0], &cvsB[0], cvsA.size()*sizeof(Far::Index))) {
+            return false;
+        }
+        for (int patch=0; patch<a.GetNumPatches(array); ++patch) {
+            Far::PatchParam const & paramA = a.GetPatchParams(array)[patch],
+                                  & paramB = b.GetPatchParams(array)[patch];
+            if (memcmp(&paramA, &paramB, sizeof(Far::PatchParam)) or
+                (hasSharpness and
+                    a.GetSingleCreasePatchSharpnessValue(array, patch) !=
+                    b.GetSingleCreasePatchSharpnessValue(array, patch))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// PatchTableFactory : the patches identified and gathered concurrently for the
+// levels above the parallel threshold must be those of a serial build
+static int
+checkParallelPatches(int gridSize, bool useSingleCreasePatch) {
+
+    printf("- PatchTable parallel   grid %dx%d          ( single crease %d ): \n",
+        gridSize, gridSize, useSingleCreasePatch);
+
+    int maxlevel = 3;
+
+    VertexBuffer coarseVerts;
+    Far::TopologyRefiner * refiner =
+        createRefiner(createCreasedGrid(gridSize), kCatmark, coarseVerts);
+
+    Far::TopologyRefiner::AdaptiveOptions adaptiveOptions(maxlevel);
+    adaptiveOptions.useSingleCreasePatch = useSingleCreasePatch;
+    refiner->RefineAdaptive(adaptiveOptions);
+
+    Far::PatchTableFactory::Options options(maxlevel);
+    options.useSingleCreasePatch = useSingleCreasePatch;
+    options.SetEndCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    int numThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    Far::PatchTable const * serialTable =
+        Far::PatchTableFactory::Create(*refiner, options);
+#ifdef OPENSUBDIV_HAS_OPENMP
+    omp_set_num_threads(std::max(numThreads, 4));
+#endif
+    Far::PatchTable const * table =
+        Far::PatchTableFactory::Create(*refiner, options);
+#ifdef OPENSUBDIV_HAS_OPENMP
+    omp_set_num_threads(numThreads);
+#endif
+
+    int count = 0;
+    if (refiner->GetLevel(0).GetNumFaces() <= 1024) {
+        printf("  the grid is below the parallel threshold\n");
+        ++count;
+    }
+    if (not samePatches(*table, *serialTable)) {
+        printf("  patches differ from the serial build\n");
+        ++count;
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete table;
+    delete serialTable;
+    delete refiner;
+    return count;
+}
+
+static int
+checkParallelPatches() {
+
+    int total = 0;
+    for (int singleCrease=0; singleCrease<2; ++singleCrease) {
+        total += checkParallelPatches(40, singleCrease!=0);
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if two stencils have the same vertices and bitwise identical
+// weights
+static bool
+sameStencil(Far::Stencil const & a, Far::Stencil const & b) {
+
+    if (a.GetSize() != b.GetSize()) {
+        return false;
+    }
+    for (int i=0; i<a.GetSize(); ++i) {
+        if (a.GetVertexIndices()[i] != b.GetVertexIndices()[i] or
+            memcmp(&a.GetWeights()[i], &b.GetWeights()[i], sizeof(float))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes a cluster to a binary stream and reads it back
+static Far::ClusterTable *
+roundTrip(Far::ClusterTable const & cluster) {
+
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    if (not cluster.Write(stream)) {
+        return 0;
+    }
+    return Far::ClusterTable::Read(stream);
+}
+
+//------------------------------------------------------------------------------
+// ClusterTableFactory : the refined faces of each cluster (after a round-trip
+// through a stream) must be computed with the same stencils as the faces of
+// the uniformly refined mesh
+static int
+checkClusterTableUniform(char const * name, std::string const & shapeStr,
+    int maxClusterFaces) {
+
+    printf("- ClusterTable uniform  %-20s ( cluster size %d ): \n",
+        name, maxClusterFaces);
+
+    int level = 2;
+
+    VertexBuffer coarseVerts;
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, kCatmark, coarseVerts);
+    refiner->RefineUniform(Far::TopologyRefiner::UniformOptions(level));
+
+    Far::StencilTableFactory::Options stencilOptions;
+    stencilOptions.generateIntermediateLevels = false;
+    stencilOptions.generateOffsets = true;
+
+    Far::StencilTable const * stencils =
+        Far::StencilTableFactory::Create(*refiner, stencilOptions);
+
+    // refined faces of each base face, in the order of the last level
+    int numBaseFaces = refiner->GetLevel(0).GetNumFaces();
+    std::vector<std::vector<Far::Index> > refinedFaces(numBaseFaces);
+    for (int face=0; face<numBaseFaces; ++face) {
+        std::vector<Far::Index> parents(1, face), children;
+        for (int i=0; i<level; ++i) {
+            children.clear();
+            for (size_t j=0; j<parents.size(); ++j) {
+                Far::ConstIndexArray childFaces =
+                    refiner->GetLevel(i).GetFaceChildFaces(parents[j]);
+                children.insert(children.end(),
+                    childFaces.begin(), childFaces.end());
+            }
+            parents.swap(children);
+        }
+        refinedFaces[face] = parents;
+    }
+
+    std::vector<int> clusterOffsets;
+    std::vector<Far::Index> clusterFaces;
+    int numClusters = Far::ClusterTableFactory::PartitionFaces(*refiner,
+        maxClusterFaces, clusterOffsets, clusterFaces);
+
+    Far::TopologyLevel const & lastLevel = refiner->GetLevel(level);
+
+    int count = 0, numFaces = 0;
+    for (int i=0; i<numClusters; ++i) {
+
+        Far::ConstIndexArray faces(&clusterFaces[clusterOffsets[i]],
+            clusterOffsets[i+1]-clusterOffsets[i]);
+        if (faces.size() > maxClusterFaces) {
+            ++count;
+        }
+
+        Far::ClusterTable * created = Far::ClusterTableFactory::Create(
+            *refiner, faces, Far::ClusterTableFactory::Options(level));
+        Far::ClusterTable * cluster = roundTrip(*created);
+        delete created;
+
+        if (not cluster) {
+            ++count;
+            continue;
+        }
+
+        Far::StencilTable const * clusterStencils = cluster->GetStencilTable();
+        if (clusterStencils->GetNumStencils() != cluster->GetNumVertices()) {
+            ++count;
+        }
+
+        int refinedFace = 0;
+        for (int j=0; j<cluster->GetNumBaseFaces(); ++j) {
+            Far::Index face = cluster->GetBaseFaces()[j];
+            for (size_t k=0; k<refinedFaces[face].size(); ++k, ++refinedFace) {
+                Far::ConstIndexArray verts =
+                    lastLevel.GetFaceVertices(refinedFaces[face][k]),
+                                     clusterVerts =
+                    cluster->GetRefinedFaceVertices(refinedFace);
+                for (int v=0; v<verts.size(); ++v) {
+                    if (not sameStencil(stencils->GetStencil(verts[v]),
+                            clusterStencils->GetStencil(clusterVerts[v]))) {
+                        ++count;
+                    }
+                }
+            }
+        }
+        if (refinedFace != cluster->GetNumRefinedFaces()) {
+            ++count;
+        }
+        numFaces += cluster->GetNumBaseFaces();
+        delete cluster;
+    }
+
+    // every base face belongs to exactly one cluster
+    if (numFaces != numBaseFaces) {
+        ++count;
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete stencils;
+    delete refiner;
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// ClusterTableFactory : the limit surface of the patches of each cluster
+// (after a round-trip through a stream) must match the patches of the whole
+// adaptively refined mesh
+static int
+checkClusterTableAdaptive(char const * name, std::string const & shapeStr,
+    int maxClusterFaces) {
+
+    printf("- ClusterTable adaptive %-20s ( cluster size %d ): \n",
+        name, maxClusterFaces);
+
+    int maxlevel = 3;
+
+    Far::PatchTableFactory::Options options(maxlevel);
+    options.useSingleCreasePatch = true;
+    options.SetEndCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+    Far::TopologyRefiner::AdaptiveOptions adaptiveOptions(maxlevel);
+    adaptiveOptions.useSingleCreasePatch = true;
+
+    VertexBuffer coarseVerts;
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, kCatmark, coarseVerts);
+    refiner->RefineAdaptive(adaptiveOptions);
+
+    Far::PatchTable * table = Far::PatchTableFactory::Create(*refiner, options);
+
+    VertexBuffer verts;
+    computeVertices(*refiner, *table, coarseVerts, verts);
+
+    Far::PatchMap patchMap(*table);
+    Far::PtexIndices ptexIndices(*refiner);
+
+    std::vector<int> clusterOffsets;
+    std::vector<Far::Index> clusterFaces;
+    int numClusters = Far::ClusterTableFactory::PartitionFaces(*refiner,
+        maxClusterFaces, clusterOffsets, clusterFaces);
+
+    Far::ClusterTableFactory::Options clusterOptions(maxlevel);
+    clusterOptions.adaptive = true;
+    clusterOptions.generateVaryingStencils = true;
+    clusterOptions.patchOptions = options;
+
+    int count = 0, numPtexFaces = 0, numSamples = 8;
+    float maxDist = 0.0f;
+    for (int i=0; i<numClusters; ++i) {
+
+        Far::ConstIndexArray faces(&clusterFaces[clusterOffsets[i]],
+            clusterOffsets[i+1]-clusterOffsets[i]);
+
+        Far::ClusterTable * created = Far::ClusterTableFactory::Create(
+            *refiner, faces, clusterOptions, &ptexIndices);
+        Far::ClusterTable * cluster = roundTrip(*created);
+        delete created;
+
+        if (not cluster or not cluster->IsFeatureAdaptive() or
+            not cluster->GetVaryingStencilTable()) {
+            ++count;
+            delete cluster;
+            continue;
+        }
+
+        VertexBuffer clusterVerts(cluster->GetStencilTable()->GetNumStencils());
+        cluster->GetStencilTable()->UpdateValues(&coarseVerts[0],
+            clusterVerts.empty() ? 0 : &clusterVerts[0]);
+
+        Far::PatchTable const & clusterTable = *cluster->GetPatchTable();
+        Far::PatchMap clusterPatchMap(clusterTable);
+
+        for (int j=0; j<cluster->GetNumBaseFaces(); ++j) {
+            Far::Index face = cluster->GetBaseFaces()[j];
+            int numFaceVerts = refiner->GetLevel(0).GetFaceVertices(face).size(),
+                numFacePtexFaces = (numFaceVerts==4) ? 1 : numFaceVerts;
+
+            for (int k=0; k<numFacePtexFaces; ++k, ++numPtexFaces) {
+                int ptexFace = ptexIndices.GetFaceId(face) + k;
+                for (int si=0; si<=numSamples; ++si) {
+                    for (int ti=0; ti<=numSamples; ++ti) {
+                        float s = (float)si/numSamples,
+                              t = (float)ti/numSamples;
+
+                        Vertex pos, clusterPos;
+                        if (not evalLimit(*table, patchMap, verts,
+                                    ptexFace, s, t, pos) or
+                            not evalLimit(clusterTable, clusterPatchMap,
+                                    clusterVerts, ptexFace, s, t, clusterPos)) {
+                            ++count;
+                            continue;
+                        }
+
+                        float dist = distance(pos, clusterPos);
+                        maxDist = std::max(maxDist, dist);
+
+                        // the stencils of a cluster are factorized over a
+                        // region preserving the topology and ordering of the
+                        // mesh : the limit positions are bitwise identical
+                        float const * p = pos.GetPos(),
+                                    * q = clusterPos.GetPos();
+                        if (p[0]!=q[0] or p[1]!=q[1] or p[2]!=q[2]) {
+                            ++count;
+                        }
+                    }
+                }
+            }
+        }
+        delete cluster;
+    }
+
+    // every ptex face belongs to exactly one cluster
+    if (numPtexFaces != ptexIndices.GetNumFaces()) {
+        ++count;
+    }
+
+    printf("  max distance : %.10f\n", maxDist);
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete table;
+    delete refiner;
+    return count;
+}
+
+static int
+checkClusterTable() {
+
+    int total = 0;
+
+    int clusterSizes[3] = { 1, 3, 7 };
+    for (int i=0; i<3; ++i) {
+        total += checkClusterTableUniform("catmark_torus", catmark_torus, clusterSizes[i]);
+        total += checkClusterTableUniform("catmark_pole8", catmark_pole8, clusterSizes[i]);
+        total += checkClusterTableUniform("catmark_fan", catmark_fan, clusterSizes[i]);
+
+        total += checkClusterTableAdaptive("catmark_torus", catmark_torus, clusterSizes[i]);
+        total += checkClusterTableAdaptive("catmark_pole8", catmark_pole8, clusterSizes[i]);
+        total += checkClusterTableAdaptive("catmark_fan", catmark_fan, clusterSizes[i]);
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// BezierPatchTable : the Bezier form of the regular patches must match the
+// evaluation of the patches of the source table, and the other patches must
+// not be converted
+static int
+checkBezierPatchTable(char const * name, std::string const & shapeStr,
+    bool useSingleCreasePatch) {
+
+    printf("- BezierPatchTable %-20s ( single crease %d ): \n",
+        name, useSingleCreasePatch);
+
+    int maxlevel = 3;
+
+    Far::PatchTableFactory::Options options(maxlevel);
+    options.useSingleCreasePatch = useSingleCreasePatch;
+    options.SetEndCapType(Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+    Far::TopologyRefiner::AdaptiveOptions adaptiveOptions(maxlevel);
+    adaptiveOptions.useSingleCreasePatch = useSingleCreasePatch;
+
+    VertexBuffer coarseVerts;
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, kCatmark, coarseVerts);
+    refiner->RefineAdaptive(adaptiveOptions);
+
+    Far::PatchTable * table = Far::PatchTableFactory::Create(*refiner, options);
+
+    VertexBuffer verts;
+    computeVertices(*refiner, *table, coarseVerts, verts);
+
+    int firstBezierPoint = (int)verts.size();
+
+    Far::BezierPatchTable * bezierTable =
+        Far::BezierPatchTable::Create(*table, firstBezierPoint);
+
+    verts.resize(firstBezierPoint + bezierTable->GetNumBezierPoints());
+    bezierTable->ComputeBezierPointValues(&verts[0], &verts[firstBezierPoint]);
+
+    int count = 0;
+
+    // every regular patch, and only the regular patches, are converted
+    int numRegularPatches = 0;
+    for (int array=0, patch=0; array<table->GetNumPatchArrays(); ++array) {
+        bool isRegular = table->GetPatchArrayDescriptor(array).GetType() ==
+            Far::PatchDescriptor::REGULAR;
+        for (int i=0; i<table->GetNumPatches(array); ++i, ++patch) {
+            Far::PatchTable::PatchHandle handle;
+            handle.arrayIndex = array;
+            handle.patchIndex = patch;
+            if (isRegular != (bezierTable->GetBezierPoints(handle) !=
+                              Far::INDEX_INVALID)) {
+                ++count;
+            }
+        }
+        numRegularPatches += isRegular ? table->GetNumPatches(array) : 0;
+    }
+    if (numRegularPatches==0 or
+        bezierTable->GetNumPatches() != numRegularPatches) {
+        ++count;
+    }
+
+    Far::PatchMap patchMap(*table);
+
+    int numSamples = 8;
+    float maxDist = 0.0f, maxDerivDist = 0.0f;
+
+    int numPtexFaces = Far::PtexIndices(*refiner).GetNumFaces();
+    for (int face=0; face<numPtexFaces; ++face) {
+        for (int i=0; i<=numSamples; ++i) {
+            for (int j=0; j<=numSamples; ++j) {
+
+                float s = (float)i/numSamples,
+                      t = (float)j/numSamples;
+
+                Far::PatchTable::PatchHandle const * handle =
+                    patchMap.FindPatch(face, s, t);
+                if (handle==0) {
+                    continue;
+                }
+                Far::Index points = bezierTable->GetBezierPoints(*handle);
+                if (points==Far::INDEX_INVALID) {
+                    continue;
+                }
+
+                float wP[20], wDs[20], wDt[20];
+                Vertex pos, ds, dt;
+                pos.Clear(); ds.Clear(); dt.Clear();
+                table->EvaluateBasis(*handle, s, t, wP, wDs, wDt);
+                Far::ConstIndexArray cvs = table->GetPatchVertices(*handle);
+                for (int k=0; k<cvs.size(); ++k) {
+                    pos.AddWithWeight(verts[cvs[k]], wP[k]);
+                    ds.AddWithWeight(verts[cvs[k]], wDs[k]);
+                    dt.AddWithWeight(verts[cvs[k]], wDt[k]);
+                }
+
+                Vertex bezierPos, bezierDs, bezierDt;
+                bezierPos.Clear(); bezierDs.Clear(); bezierDt.Clear();
+                bezierTable->EvaluateBasis(*handle, s, t, wP, wDs, wDt);
+                for (int k=0; k<16; ++k) {
+                    bezierPos.AddWithWeight(verts[points+k], wP[k]);
+                    bezierDs.AddWithWeight(verts[points+k], wDs[k]);
+                    bezierDt.AddWithWeight(verts[points+k], wDt[k]);
+                }
+
+                float dist = distance(pos, bezierPos),
+                      derivDist = std::max(distance(ds, bezierDs),
+                                           distance(dt, bezierDt));
+                maxDist = std::max(maxDist, dist);
+                maxDerivDist = std::max(maxDerivDist, derivDist);
+                if (dist > PRECISION or derivDist > 1e-4) {
+                    ++count;
+                }
+            }
+        }
+    }
+
+    // the exported patches are the Bezier points, in order
+    int numElements = 3, stride = sizeof(Vertex)/sizeof(float);
+    std::vector<float> exported(16*numElements*bezierTable->GetNumPatches());
+    bezierTable->ExportBezierPatches(verts[0].GetPos(), numElements, stride,
+        exported.empty() ? 0 : &exported[0]);
+    for (int i=0; i<bezierTable->GetNumBezierPoints(); ++i) {
+        if (std::memcmp(&exported[i*numElements],
+                verts[firstBezierPoint+i].GetPos(),
+                numElements*sizeof(float)) != 0) {
+            ++count;
+            break;
+        }
+    }
+
+    printf("  max distance : %.10f, derivatives : %.10f\n",
+        maxDist, maxDerivDist);
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete bezierTable;
+    delete table;
+    delete refiner;
+    return count;
+}
+
+static int
+checkBezierPatchTable() {
+
+    int total = 0;
+
+    for (int singleCrease=0; singleCrease<2; ++singleCrease) {
+        total += checkBezierPatchTable("catmark_torus", catmark_torus,
+            singleCrease!=0);
+        total += checkBezierPatchTable("catmark_pole8", catmark_pole8,
+            singleCrease!=0);
+        total += checkBezierPatchTable("catmark_single_crease",
+            catmark_single_crease, singleCrease!=0);
+        total += checkBezierPatchTable("catmark_cube_creases1",
+            catmark_cube_creases1, singleCrease!=0);
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// Returns a shape with an interior extraordinary vertex of valence 6 : a fan
+// of 6 quads around the vertex, surrounded by a ring of quads
+static std::string
+createValence6Shape() {
+
+    std::ostringstream s;
+
+    // vertex 1 is the center, 2-13 and 14-25 the two rings
+    s << "v 0 0 0.5\n";
+    for (int ring = 1; ring <= 2; ++ring) {
+        for (int i = 0; i < 12; ++i) {
+            float a = 6.2831853f*(float)i/12.0f,
+                  r = (float)ring * ((i%2) ? 1.15f : 1.0f);
+            s << "v " << r*cosf(a) << " " << r*sinf(a) << " "
+              << 0.3f*sinf(3.0f*a)/(float)ring << "\n";
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        s << "f 1 " << 2+2*i << " " << 3+2*i << " " << 2+(2*i+2)%12 << "\n";
+    }
+    for (int i = 0; i < 12; ++i) {
+        s << "f " << 2+i << " " << 14+i << " " << 14+(i+1)%12 << " "
+          << 2+(i+1)%12 << "\n";
+    }
+    return s.str();
+}
+
+//------------------------------------------------------------------------------
+// ENDCAP_EXTRAORDINARY_BASIS : the exact end caps must match the limit surface
+// (approximated by a table isolated to a high level), and the faces that do
+// not qualify must fall back to the Gregory basis end caps
+static int
+checkEndCaps(char const * name, std::string const & shapeStr,
+    bool expectFallback) {
+
+    printf("- EndCaps %-20s : \n", name);
+
+    typedef Far::PatchTableFactory::Options Options;
+
+    int maxlevel = 2, refLevel = 10;
+
+    VertexBuffer coarseVerts;
+
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, kCatmark, coarseVerts);
+    refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(maxlevel));
+
+    Far::TopologyRefiner * refRefiner =
+        createRefiner(shapeStr, kCatmark, coarseVerts);
+    refRefiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(refLevel));
+
+    Options options(maxlevel), refOptions(refLevel);
+    options.SetEndCapType(Options::ENDCAP_EXTRAORDINARY_BASIS);
+    refOptions.SetEndCapType(Options::ENDCAP_GREGORY_BASIS);
+
+    Far::PatchTable * table = Far::PatchTableFactory::Create(*refiner, options);
+
+    options.SetEndCapType(Options::ENDCAP_GREGORY_BASIS);
+    Far::PatchTable * gregoryTable =
+        Far::PatchTableFactory::Create(*refiner, options);
+
+    Far::PatchTable * refTable =
+        Far::PatchTableFactory::Create(*refRefiner, refOptions);
+
+    VertexBuffer verts, gregoryVerts, refVerts;
+    computeVertices(*refiner, *table, coarseVerts, verts);
+    computeVertices(*refiner, *gregoryTable, coarseVerts, gregoryVerts);
+    computeVertices(*refRefiner, *refTable, coarseVerts, refVerts);
+
+    Far::PatchMap patchMap(*table),
+                  gregoryPatchMap(*gregoryTable),
+                  refPatchMap(*refTable);
+
+    // the approximation error of Gregory basis patches is of the order of
+    // 1e-3 of the size of the shapes, the exact patches of 1e-5
+    float size = 0.0f;
+    for (int i=0; i<(int)coarseVerts.size(); ++i) {
+        size = std::max(size, distance(coarseVerts[i], coarseVerts[0]));
+    }
+    float tolerance = 1e-4f * size;
+
+    int count = 0, numSamples = 8,
+        numExactSamples = 0, numFallbackSamples = 0;
+    float maxDist = 0.0f;
+
+    int numPtexFaces = Far::PtexIndices(*refiner).GetNumFaces();
+    for (int face=0; face<numPtexFaces; ++face) {
+        for (int i=0; i<=numSamples; ++i) {
+            for (int j=0; j<=numSamples; ++j) {
+
+                float s = (float)i/numSamples,
+                      t = (float)j/numSamples;
+
+                Vertex pos, gregoryPos, refPos;
+                Far::PatchTable::PatchHandle const
+                    * handle = evalLimit(*table, patchMap,
+                        verts, face, s, t, pos),
+                    * gregoryHandle = evalLimit(*gregoryTable,
+                        gregoryPatchMap, gregoryVerts, face, s, t, gregoryPos);
+                if ((handle==0) != (gregoryHandle==0)) {
+                    ++count;
+                    continue;
+                }
+                if (handle==0) {
+                    continue;
+                }
+
+                Far::PatchDescriptor::Type type = table->
+                    GetPatchArrayDescriptor(handle->arrayIndex).GetType();
+                if (type == Far::PatchDescriptor::EXTRAORDINARY_BASIS) {
+                    if (not evalLimit(*refTable, refPatchMap,
+                            refVerts, face, s, t, refPos)) {
+                        ++count;
+                        continue;
+                    }
+                    float dist = distance(pos, refPos);
+                    maxDist = std::max(maxDist, dist);
+                    if (dist > tolerance) {
+                        ++count;
+                    }
+                    ++numExactSamples;
+                } else {
+                    // fallback : same patch as the Gregory basis table
+                    if (type != gregoryTable->GetPatchArrayDescriptor(
+                            gregoryHandle->arrayIndex).GetType() or
+                        distance(pos, gregoryPos) > PRECISION) {
+                        ++count;
+                    }
+                    if (type == Far::PatchDescriptor::GREGORY_BASIS) {
+                        ++numFallbackSamples;
+                    }
+                }
+            }
+        }
+    }
+
+    if (numExactSamples==0 or expectFallback != (numFallbackSamples > 0)) {
+        ++count;
+    }
+
+    printf("  exact samples : %d, fallback samples : %d, "
+        "max distance : %.10f\n", numExactSamples, numFallbackSamples, maxDist);
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete refTable;
+    delete gregoryTable;
+    delete table;
+    delete refRefiner;
+    delete refiner;
+    return count;
+}
+
+static int
+checkEndCaps() {
+
+    int total = 0;
+
+    // exact end caps around valence 3, 5 and 6 vertices
+    total += checkEndCaps("catmark_cube", catmark_cube, false);
+    total += checkEndCaps("catmark_lefthanded", catmark_lefthanded, false);
+    total += checkEndCaps("valence6", createValence6Shape(), false);
+
+    // Gregory basis end caps around the valence 8 vertex
+    total += checkEndCaps("catmark_pole8", catmark_pole8, true);
+
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// Interpolates primvar data through all the levels of a uniform refinement
+// with the PrimvarRefiner, and returns the data of the last level
+enum InterpolationMode {
+    INTERPOLATE_VERTEX,
+    INTERPOLATE_VARYING,
+    INTERPOLATE_FACE_VARYING
+};
+
+static VertexBuffer
+interpolateLastLevel(Far::TopologyRefiner const & refiner,
+    InterpolationMode mode, VertexBuffer const & src) {
+
+    Far::PrimvarRefiner primvarRefiner(refiner);
+
+    VertexBuffer parent(src), child;
+    for (int level=1; level<=refiner.GetMaxLevel(); ++level) {
+        Far::TopologyLevel const & refLevel = refiner.GetLevel(level);
+        child.resize(mode==INTERPOLATE_FACE_VARYING ?
+            refLevel.GetNumFVarValues() : refLevel.GetNumVertices());
+        switch (mode) {
+            case INTERPOLATE_VERTEX:
+                primvarRefiner.Interpolate(level, parent, child);
+                break;
+            case INTERPOLATE_VARYING:
+                primvarRefiner.InterpolateVarying(level, parent, child);
+                break;
+            case INTERPOLATE_FACE_VARYING:
+                primvarRefiner.InterpolateFaceVarying(level, parent, child);
+                break;
+        }
+        parent.swap(child);
+    }
+    return parent;
+}
+
+static bool
+isEqual(VertexBuffer const & a, VertexBuffer const & b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i=0; i<(int)a.size(); ++i) {
+        if (distance(a[i], b[i]) != 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// UniformMeshExporter : the exported faces and primvar data must match the
+// last level of the refiner and the data interpolated by the PrimvarRefiner
+static int
+checkUniformMeshExporter(char const * name, std::string const & shapeStr,
+    Scheme scheme, int maxlevel, bool triangulateQuads) {
+
+    printf("- UniformMeshExporter %-20s ( level %d triangulate %d ): \n",
+        name, maxlevel, triangulateQuads);
+
+    VertexBuffer coarseVerts;
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, scheme, coarseVerts);
+    refiner->RefineUniform(Far::TopologyRefiner::UniformOptions(maxlevel));
+
+    Far::UniformMeshExporter::Options options;
+    options.triangulateQuads = triangulateQuads;
+    Far::UniformMeshExporter exporter(*refiner, options);
+
+    int count = 0;
+
+    // faces : the faces of the last level, without the holes, triangulated
+    // as {v0,v1,v2},{v3,v0,v2}
+    Far::TopologyLevel const & lastLevel = refiner->GetLevel(maxlevel);
+
+    bool hasFVar = refiner->GetNumFVarChannels() > 0 and
+        refiner->GetLevel(0).GetNumFVarValues() > 0;
+    bool triangulate = triangulateQuads and scheme != kLoop;
+
+    std::vector<Far::Index> faceVerts, faceFVarValues;
+    for (int face=0; face<lastLevel.GetNumFaces(); ++face) {
+        if (lastLevel.IsFaceHole(face)) {
+            continue;
+        }
+        Far::ConstIndexArray verts = lastLevel.GetFaceVertices(face);
+        Far::ConstIndexArray values = hasFVar ?
+            lastLevel.GetFaceFVarValues(face) : verts;
+        if (triangulate) {
+            int const tris[6] = { 0, 1, 2, 3, 0, 2 };
+            for (int i=0; i<6; ++i) {
+                faceVerts.push_back(verts[tris[i]]);
+                faceFVarValues.push_back(values[tris[i]]);
+            }
+        } else {
+            faceVerts.insert(faceVerts.end(), verts.begin(), verts.end());
+            faceFVarValues.insert(faceFVarValues.end(),
+                values.begin(), values.end());
+        }
+    }
+
+    int faceSize = triangulate ? 3 : (scheme == kLoop ? 3 : 4);
+    if (exporter.GetFaceSize() != faceSize or
+        exporter.GetNumFaceIndices() != (int)faceVerts.size() or
+        exporter.GetNumFaces() * faceSize != (int)faceVerts.size()) {
+        ++count;
+    } else {
+        std::vector<Far::Index> indices(faceVerts.size());
+        exporter.ExportFaceVertices(&indices[0]);
+        count += (indices != faceVerts);
+        if (hasFVar) {
+            exporter.ExportFaceFVarValues(&indices[0]);
+            count += (indices != faceFVarValues);
+        }
+    }
+
+    // primvar data : vertex and varying interpolation, repeated with the
+    // scratch buffer already allocated
+    VertexBuffer refVerts = interpolateLastLevel(*refiner,
+                                INTERPOLATE_VERTEX, coarseVerts),
+                 refVarying = interpolateLastLevel(*refiner,
+                                INTERPOLATE_VARYING, coarseVerts);
+
+    VertexBuffer verts(exporter.GetNumVertices());
+    exporter.Interpolate(coarseVerts, &verts[0]);
+    count += not isEqual(verts, refVerts);
+
+    size_t scratchMemoryUsage = exporter.GetScratchMemoryUsage();
+
+    exporter.InterpolateVarying(coarseVerts, &verts[0]);
+    count += not isEqual(verts, refVarying);
+
+    exporter.Interpolate(coarseVerts, &verts[0]);
+    count += not isEqual(verts, refVerts);
+
+    if (exporter.GetScratchMemoryUsage() != scratchMemoryUsage) {
+        ++count;
+    }
+
+    // face-varying data
+    if (hasFVar) {
+        VertexBuffer coarseValues(refiner->GetLevel(0).GetNumFVarValues());
+        for (int i=0; i<(int)coarseValues.size(); ++i) {
+            coarseValues[i].SetPosition(0.37f*i, sinf((float)i), 0.0f);
+        }
+        VertexBuffer refValues = interpolateLastLevel(*refiner,
+            INTERPOLATE_FACE_VARYING, coarseValues);
+
+        VertexBuffer values(exporter.GetNumFVarValues());
+        exporter.InterpolateFaceVarying(coarseValues, &values[0]);
+        count += not isEqual(values, refValues);
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete refiner;
+    return count;
+}
+
+static int
+checkUniformMeshExporter() {
+
+    int total = 0;
+
+    for (int level=1; level<=3; ++level) {
+        for (int triangulate=0; triangulate<2; ++triangulate) {
+            total += checkUniformMeshExporter("catmark_fvar_bound0",
+                catmark_fvar_bound0, kCatmark, level, triangulate!=0);
+            total += checkUniformMeshExporter("catmark_hole_test1",
+                catmark_hole_test1, kCatmark, level, triangulate!=0);
+            total += checkUniformMeshExporter("bilinear_cube",
+                bilinear_cube, kBilinear, level, triangulate!=0);
+            total += checkUniformMeshExporter("loop_pole8",
+                loop_pole8, kLoop, level, triangulate!=0);
+        }
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// Face ids span 31 bits : their high bits must round trip without altering
+// the other fields, and ids below 2^28 must encode as 28-bit ids
+static int
+checkPatchParamFaceIds() {
+
+    int count = 0;
+
+    printf("- PatchParam face ids\n");
+
+    Far::Index faceIds[] = { 0, 12345, (1<<28)-1, 1<<28, (1<<28)+12345,
+                             (1<<30)+(1<<29)+7, INT_MAX };
+
+    struct Fields {
+        short u, v;
+        unsigned short depth;
+        bool nonquad;
+        unsigned short boundary, transition;
+    } fields[] = { {    0,    0,  0, false, 0x0, 0x0 },
+                   { 1023, 1023, 14,  true, 0xf, 0xf },
+                   {  512,    1, 10, false, 0x5, 0xa },
+                   {    3,  700,  1,  true, 0xa, 0x5 } };
+
+    int numFaceIds = (int)(sizeof(faceIds)/sizeof(faceIds[0])),
+        numFields = (int)(sizeof(fields)/sizeof(fields[0]));
+
+    for (int i = 0; i < numFaceIds; ++i) {
+        for (int j = 0; j < numFields; ++j) {
+
+            Fields const & f = fields[j];
+
+            // the depth of the children of non-quad faces is offset by 1
+            unsigned short depth = f.nonquad ? f.depth+1 : f.depth;
+
+            Far::PatchParam param;
+            param.Set(faceIds[i], f.u, f.v, f.depth, f.nonquad,
+                f.boundary, f.transition);
+
+            if (param.GetFaceId() != faceIds[i] or
+                param.GetU() != f.u or param.GetV() != f.v or
+                param.GetDepth() != depth or
+                param.NonQuadRoot() != f.nonquad or
+                param.GetBoundary() != f.boundary or
+                param.GetTransition() != f.transition) {
+                printf("  face id %d (fields %d) : does not round trip\n",
+                    faceIds[i], j);
+                ++count;
+            }
+
+            bool isShortId = faceIds[i] < (1<<28);
+            if (isShortId and (param.field0 & 0xfffffff) !=
+                (unsigned int)faceIds[i]) {
+                printf("  face id %d (fields %d) : not encoded in 28 bits\n",
+                    faceIds[i], j);
+                ++count;
+            }
+            if (isShortId != (((param.field1 >> 5) & 0x7) == 0)) {
+                printf("  face id %d (fields %d) : high bits are %d\n",
+                    faceIds[i], j, (param.field1 >> 5) & 0x7);
+                ++count;
+            }
+        }
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Tables switch to 64-bit offsets when their weights overflow the range of
+// Index : checked on synthetic tables of stencil sizes only
+static int
+checkLargeStencilOffsets(char const * name, std::vector<int> const & sizes,
+    bool expectLargeOffsets) {
+
+    int count = 0;
+
+    SyntheticStencilTable table(1, sizes);
+
+    if (table.HasLargeOffsets() != expectLargeOffsets) {
+        printf("  %s : %s offsets\n", name,
+            table.HasLargeOffsets() ? "64-bit" : "32-bit");
+        return 1;
+    }
+
+    size_t numOffsets = expectLargeOffsets ?
+        table.GetLargeOffsets().size() : table.GetOffsets().size();
+    if (numOffsets != sizes.size() or
+        (expectLargeOffsets and not table.GetOffsets().empty()) or
+        (not expectLargeOffsets and not table.GetLargeOffsets().empty())) {
+        printf("  %s : invalid offsets tables\n", name);
+        return 1;
+    }
+
+    size_t offset = 0;
+    for (int i = 0; i < (int)sizes.size(); ++i) {
+        size_t stencilOffset = expectLargeOffsets ?
+            table.GetLargeOffsets()[i] : (size_t)table.GetOffsets()[i];
+        if (stencilOffset != offset) {
+            printf("  %s : stencil %d offset is %lu instead of %lu\n", name,
+                i, (unsigned long)stencilOffset, (unsigned long)offset);
+            ++count;
+        }
+        offset += sizes[i];
+    }
+    return count;
+}
+
+static int
+checkLargeStencilOffsets() {
+
+    int count = 0;
+
+    printf("- stencil table large offsets\n");
+
+    std::vector<int> sizes;
+
+    // INT_MAX weights fit 32-bit offsets
+    sizes.push_back(INT_MAX-2);
+    sizes.push_back(1);
+    sizes.push_back(1);
+    count += checkLargeStencilOffsets("INT_MAX weights", sizes, false);
+
+    // one more does not
+    sizes.push_back(1);
+    count += checkLargeStencilOffsets("INT_MAX+1 weights", sizes, true);
+
+    // offsets past 2^32
+    if (sizeof(size_t) > 4) {
+        sizes.assign(3, INT_MAX);
+        sizes.push_back(16);
+        count += checkLargeStencilOffsets("3*INT_MAX weights", sizes, true);
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// With linear interpolation of all the face-varying values, the face-varying
+// limit values of a quad are the bilinear interpolation of its corner values
+static int
+checkFVarLinearLimitStencils(bool adaptive) {
+
+    int count = 0;
+
+    printf("- face-varying linear limit stencils (%s)\n",
+        adaptive ? "adaptive" : "uniform");
+
+    typedef Far::TopologyRefinerFactory<Shape> RefinerFactory;
+
+    Shape * shape = Shape::parseObj(catmark_fvar_bound0.c_str(), kCatmark);
+
+    Sdc::Options sdcOptions = GetSdcOptions(*shape);
+    sdcOptions.SetFVarLinearInterpolation(Sdc::Options::FVAR_LINEAR_ALL);
+
+    Far::TopologyRefiner * refiner = RefinerFactory::Create(*shape,
+        RefinerFactory::Options(GetSdcType(*shape), sdcOptions));
+    assert(refiner and refiner->GetNumFVarChannels()==1);
+
+    int maxlevel = 2;
+    if (adaptive) {
+        refiner->RefineAdaptive(
+            Far::TopologyRefiner::AdaptiveOptions(maxlevel));
+    } else {
+        refiner->RefineUniform(
+            Far::TopologyRefiner::UniformOptions(maxlevel));
+    }
+
+    // the uvs of the shape are the values of the face-varying channel
+    VertexBuffer coarseValues(shape->uvs.size()/2);
+    for (int i=0; i<(int)coarseValues.size(); ++i) {
+        coarseValues[i].SetPosition(shape->uvs[i*2+0], shape->uvs[i*2+1], 0.0f);
+    }
+    delete shape;
+
+    // a grid of samples on each face (the coarse faces are quads : the ptex
+    // faces are the coarse faces)
+    Far::TopologyLevel const & coarseLevel = refiner->GetLevel(0);
+
+    int numSamples = 4, numFaces = coarseLevel.GetNumFaces();
+
+    std::vector<float> s, t;
+    for (int i=0; i<=numSamples; ++i) {
+        for (int j=0; j<=numSamples; ++j) {
+            s.push_back((float)i/numSamples);
+            t.push_back((float)j/numSamples);
+        }
+    }
+
+    Far::LimitStencilTableFactory::LocationArrayVec locations(numFaces);
+    for (int face=0; face<numFaces; ++face) {
+        locations[face].ptexIdx = face;
+        locations[face].numLocations = (int)s.size();
+        locations[face].s = &s[0];
+        locations[face].t = &t[0];
+    }
+
+    Far::LimitStencilTableFactory::Options options;
+    options.interpolationMode = Far::StencilTableFactory::INTERPOLATE_FACE_VARYING;
+
+    Far::LimitStencilTable const * stencils =
+        Far::LimitStencilTableFactory::Create(*refiner, locations, 0, 0, options);
+
+    if (not stencils or
+        stencils->GetNumStencils() != numFaces*(int)s.size()) {
+        printf("  missing face-varying limit stencils\n");
+        ++count;
+    } else {
+        VertexBuffer values(stencils->GetNumStencils());
+        stencils->UpdateValues(&coarseValues[0], &values[0]);
+
+        float maxDist = 0.0f;
+        for (int face=0, k=0; face<numFaces; ++face) {
+            Far::ConstIndexArray cvs = coarseLevel.GetFaceFVarValues(face);
+            assert(cvs.size()==4);
+
+            for (int i=0; i<(int)s.size(); ++i, ++k) {
+                float w[4] = { (1.0f-s[i])*(1.0f-t[i]), s[i]*(1.0f-t[i]),
+                               s[i]*t[i], (1.0f-s[i])*t[i] };
+
+                Vertex uv;
+                uv.Clear();
+                for (int j=0; j<4; ++j) {
+                    uv.AddWithWeight(coarseValues[cvs[j]], w[j]);
+                }
+                maxDist = std::max(maxDist, distance(uv, values[k]));
+            }
+        }
+        if (maxDist > PRECISION) {
+            printf("  limit uvs differ from the corner uvs : %g\n", maxDist);
+            ++count;
+        }
+    }
+    delete stencils;
+
+    // the triangles of a triangulated uniform table have no face-varying
+    // basis : the table is rejected
+    if (not adaptive) {
+        Far::PatchTableFactory::Options patchOptions(maxlevel);
+        patchOptions.generateFVarTables = true;
+        patchOptions.triangulateQuads = true;
+
+        Far::PatchTable const * patchTable =
+            Far::PatchTableFactory::Create(*refiner, patchOptions);
+
+        stencils = Far::LimitStencilTableFactory::Create(*refiner, locations,
+            0, patchTable, options);
+        if (stencils) {
+            printf("  triangulated face-varying patches were not rejected\n");
+            ++count;
+        }
+        delete stencils;
+        delete patchTable;
+    }
+
+    if (count==0) {
+        printf("  success !\n");
+    }
+
+    delete refiner;
+    return count;
+}
+
+//------------------------------------------------------------------------------
+static void
+silentErrorCallback(Far::ErrorType, const char *) { }
+
+//------------------------------------------------------------------------------
+int main(int /* argc */, char ** /* argv */) {
+
+    // some of the tests expect errors to be reported
+    Far::SetErrorCallback(silentErrorCallback);
+
+    int total = 0;
+
+    printf("precision : %f\n", PRECISION);
+
+    total += checkUpdateAdaptive();
+
+    total += checkParallelPatches();
+
+    total += checkClusterTable();
+
+    total += checkBezierPatchTable();
+
+    total += checkEndCaps();
+
+    total += checkUniformMeshExporter();
+
+    total += checkPatchParamFaceIds();
+
+    total += checkLargeStencilOffsets();
+
+    total += checkFVarLinearLimitStencils(false);
+
+    total += checkFVarLinearLimitStencils(true);
+
+    if (total==0) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Total failures : %d\n", total);
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
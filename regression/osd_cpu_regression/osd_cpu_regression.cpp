@@ -0,0 +1,2555 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+#include <far/bezierPatchTable.h>
+#include <far/patchMap.h>
+#include <far/patchTableFactory.h>
+#include <far/ptexIndices.h>
+#include <far/stencilTable.h>
+#include <far/stencilTableFactory.h>
+#include <osd/bufferDescriptor.h>
+#include <osd/cpuEvaluator.h>
+#include <osd/cpuPatchBVH.h>
+#include <osd/cpuPatchCuller.h>
+#include <osd/cpuPatchTable.h>
+#include <osd/cpuSharedTableStore.h>
+#include <osd/cpuTessellator.h>
+#include <osd/cpuVertexBuffer.h>
+#include <osd/mesh.h>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <osd/ompEvaluator.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_TBB
+    #include <osd/tbbEvaluator.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../regression/common/far_utils.h"
+
+#include "../shapes/catmark_cube.h"
+#include "../shapes/catmark_fvar_bound0.h"
+#include "../shapes/catmark_fvar_bound1.h"
+#include "../shapes/catmark_fvar_bound2.h"
+#include "../shapes/catmark_pole64.h"
+#include "../shapes/catmark_pyramid.h"
+#include "../shapes/catmark_torus.h"
+
+//
+// Regression testing of the CPU evaluators of Osd against the serial
+// reference paths (CpuEvaluator, Far tables)
+//
+// Notes:
+// - precision is held at 1e-6
+//
+#define PRECISION 1e-6
+
+using namespace OpenSubdiv;
+
+//------------------------------------------------------------------------------
+static Far::TopologyRefiner *
+createRefiner(std::string const & shapeStr, Scheme scheme,
+    std::vector<float> & coarsePositions) {
+
+    typedef Far::TopologyRefinerFactory<Shape> RefinerFactory;
+
+    Shape * shape = Shape::parseObj(shapeStr.c_str(), scheme);
+
+    Far::TopologyRefiner * refiner = RefinerFactory::Create(*shape,
+        RefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+    assert(refiner);
+
+    coarsePositions = shape->verts;
+    delete shape;
+    return refiner;
+}
+
+//------------------------------------------------------------------------------
+// Creates the stencils of the refined vertices of a uniform refinement
+static Far::StencilTable const *
+createStencilTable(std::string const & shapeStr, int level,
+    std::vector<float> & coarsePositions) {
+
+    Far::TopologyRefiner * refiner =
+        createRefiner(shapeStr, kCatmark, coarsePositions);
+
+    refiner->RefineUniform(Far::TopologyRefiner::UniformOptions(level));
+
+    Far::StencilTableFactory::Options options;
+    options.generateIntermediateLevels = true;
+    options.generateControlVerts = false;
+    options.generateOffsets = true;
+
+    Far::StencilTable const * stencils =
+        Far::StencilTableFactory::Create(*refiner, options);
+
+    delete refiner;
+    return stencils;
+}
+
+//------------------------------------------------------------------------------
+static float
+maxDifference(std::vector<float> const & a, std::vector<float> const & b) {
+
+    assert(a.size()==b.size());
+
+    float maxDiff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        maxDiff = std::max(maxDiff, fabsf(a[i] - b[i]));
+    }
+    return maxDiff;
+}
+
+//------------------------------------------------------------------------------
+// Checks the fused vertex + varying evaluation of the CpuEvaluator against
+// separate evaluations of the two tables, for a given layout of the vertex
+// and varying data (offsets of the primvars and strides of the rows)
+static int
+checkFusedStencils(char const * name, Far::StencilTable const & stencils,
+    std::vector<float> const & coarsePositions,
+    int vertexLength, int vertexStride, int varyingOffset, int varyingLength,
+    int varyingStride) {
+
+    int numCoarseVerts = (int)coarsePositions.size()/3,
+        numVerts = numCoarseVerts + stencils.GetNumStencils();
+
+    int bufferSize = std::max(numVerts*vertexStride,
+                              varyingOffset + numVerts*varyingStride);
+
+    // coarse data : positions, and varying values derived from them
+    std::vector<float> data(bufferSize, 0.0f);
+
+    Osd::BufferDescriptor srcDesc(0, vertexLength, vertexStride),
+        varyingSrcDesc(varyingOffset, varyingLength, varyingStride);
+
+    for (int i = 0; i < numCoarseVerts; ++i) {
+        for (int k = 0; k < vertexLength; ++k) {
+            data[i*vertexStride + k] = coarsePositions[i*3 + k%3] + k;
+        }
+        for (int k = 0; k < varyingLength; ++k) {
+            data[varyingOffset + i*varyingStride + k] =
+                coarsePositions[i*3 + k%3] * (float)(k+1);
+        }
+    }
+
+    std::vector<float> reference(bufferSize), result(bufferSize);
+
+    Osd::BufferDescriptor dstDesc(srcDesc), varyingDstDesc(varyingSrcDesc);
+    dstDesc.offset += numCoarseVerts*dstDesc.stride;
+    varyingDstDesc.offset += numCoarseVerts*varyingDstDesc.stride;
+
+    Osd::CpuVertexBuffer * refBuffer =
+        Osd::CpuVertexBuffer::Create(1, bufferSize);
+    Osd::CpuVertexBuffer * buffer =
+        Osd::CpuVertexBuffer::Create(1, bufferSize);
+    refBuffer->UpdateData(&data[0], 0, bufferSize);
+    buffer->UpdateData(&data[0], 0, bufferSize);
+
+    // reference : separate evaluations of the tables (the vertex and varying
+    // stencils of a uniform refinement match)
+    Osd::CpuEvaluator::EvalStencils(refBuffer, srcDesc, refBuffer, dstDesc,
+        &stencils);
+    Osd::CpuEvaluator::EvalStencils(refBuffer, varyingSrcDesc,
+        refBuffer, varyingDstDesc, &stencils);
+
+    Osd::CpuEvaluator::EvalStencils(buffer, srcDesc, buffer, dstDesc,
+        buffer, varyingSrcDesc, buffer, varyingDstDesc,
+        &stencils, &stencils);
+
+    std::copy(refBuffer->BindCpuBuffer(),
+        refBuffer->BindCpuBuffer() + bufferSize, reference.begin());
+    std::copy(buffer->BindCpuBuffer(),
+        buffer->BindCpuBuffer() + bufferSize, result.begin());
+
+    delete refBuffer;
+    delete buffer;
+
+    float diff = maxDifference(reference, result);
+    if (diff > PRECISION) {
+        printf("  %s (vertex %d/%d, varying %d/%d) : fused evaluation "
+            "differs by %f\n", name, vertexLength, vertexStride,
+            varyingLength, varyingStride, diff);
+        return 1;
+    }
+    return 0;
+}
+
+static int
+checkFusedStencils() {
+
+    int count = 0;
+
+    printf("Testing fused stencil evaluation\n");
+
+    std::vector<float> coarsePositions;
+    Far::StencilTable const * stencils =
+        createStencilTable(catmark_pole64, 2, coarsePositions);
+
+    // interleaved vertex and varying data
+    count += checkFusedStencils("interleaved", *stencils, coarsePositions,
+        3, 7, 3, 4, 7);
+
+    // separate rows of aligned data (SIMD fast paths) and unaligned data
+    int bufferOffset = 8*(int)(coarsePositions.size()/3 +
+                                stencils->GetNumStencils());
+    count += checkFusedStencils("aligned", *stencils, coarsePositions,
+        4, 4, bufferOffset, 8, 8);
+    count += checkFusedStencils("unaligned", *stencils, coarsePositions,
+        3, 3, bufferOffset, 5, 5);
+
+    delete stencils;
+
+    // empty tables are not evaluated
+    stencils = createStencilTable(catmark_cube, 0, coarsePositions);
+    assert(stencils->GetNumStencils() == 0);
+
+    Osd::CpuVertexBuffer * buffer = Osd::CpuVertexBuffer::Create(3, 8);
+    Osd::BufferDescriptor desc(0, 3, 3);
+    if (Osd::CpuEvaluator::EvalStencils(buffer, desc, buffer, desc,
+            buffer, desc, buffer, desc, stencils, stencils)) {
+        printf("  empty tables : fused evaluation succeeded\n");
+        ++count;
+    }
+    delete buffer;
+    delete stencils;
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Evaluates the refined positions of a stencil table (Far or shared)
+template <class STENCIL_TABLE>
+static std::vector<float>
+evalPositions(STENCIL_TABLE const * stencils,
+    std::vector<float> const & coarsePositions) {
+
+    int numCoarseVerts = (int)coarsePositions.size()/3,
+        numVerts = numCoarseVerts + stencils->GetNumStencils();
+
+    Osd::CpuVertexBuffer * buffer = Osd::CpuVertexBuffer::Create(3, numVerts);
+    buffer->UpdateData(&coarsePositions[0], 0, numCoarseVerts);
+
+    Osd::BufferDescriptor srcDesc(0, 3, 3),
+                          dstDesc(numCoarseVerts*3, 3, 3);
+    Osd::CpuEvaluator::EvalStencils(buffer, srcDesc, buffer, dstDesc,
+        stencils);
+
+    std::vector<float> result(buffer->BindCpuBuffer(),
+                              buffer->BindCpuBuffer() + numVerts*3);
+    delete buffer;
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Creates the patches of a shape : adaptive patches of different levels, with
+// transition edges and end caps, or uniform quads, and the stencils of the
+// refined vertices and local points they index
+static Far::PatchTable const *
+createPatchTable(Far::TopologyRefiner & refiner, bool uniform,
+    Far::StencilTable const ** stencils,
+    Far::PatchTableFactory::Options::EndCapType endCapType =
+        Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS) {
+
+    Far::PatchTableFactory::Options patchOptions(uniform ? 2 : 3);
+    patchOptions.SetEndCapType(endCapType);
+    if (uniform) {
+        refiner.RefineUniform(Far::TopologyRefiner::UniformOptions(2));
+        patchOptions.generateAllLevels = false;
+    } else {
+        refiner.RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(3));
+    }
+    Far::PatchTable const * patchTable =
+        Far::PatchTableFactory::Create(refiner, patchOptions);
+
+    Far::StencilTableFactory::Options stencilOptions;
+    stencilOptions.generateIntermediateLevels = not uniform;
+    stencilOptions.generateControlVerts = false;
+    stencilOptions.generateOffsets = true;
+    *stencils = Far::StencilTableFactory::Create(refiner, stencilOptions);
+    if (patchTable->GetLocalPointStencilTable()) {
+        Far::StencilTable const * combined =
+            Far::StencilTableFactory::AppendLocalPointStencilTable(
+                refiner, *stencils, patchTable->GetLocalPointStencilTable());
+        delete *stencils;
+        *stencils = combined;
+    }
+    return patchTable;
+}
+
+//------------------------------------------------------------------------------
+// Checks that the tessellation of a closed surface is watertight : every
+// edge of a triangle is shared with exactly one other triangle, traversed in
+// the opposite direction, and the triangles face the same way as the limit
+// surface
+static int
+checkTessellator(char const * name, Far::TopologyRefiner const & refiner,
+    Far::PatchTable const & patchTable, std::vector<float> const & positions,
+    Osd::CpuTessellator::EdgeMetric const & metric, char const * metricName) {
+
+    Osd::BufferDescriptor desc(0, 3, 3);
+
+    std::vector<Osd::PatchCoord> coords;
+    std::vector<int> triangles, offsets;
+    if (not Osd::CpuTessellator::Tessellate(refiner, patchTable,
+            &positions[0], desc, metric, 16, &coords, &triangles, &offsets)) {
+        printf("  %s (%s) : tessellation failed\n", name, metricName);
+        return 1;
+    }
+
+    int count = 0;
+
+    int numPatches = patchTable.GetNumPatchesTotal(),
+        numTriangles = (int)triangles.size()/3,
+        numVerts = (int)coords.size();
+    if ((int)offsets.size()!=numPatches+1 or offsets[0]!=0 or
+        offsets[numPatches]!=numTriangles) {
+        printf("  %s (%s) : triangle offsets mismatch\n", name, metricName);
+        ++count;
+    }
+
+    // limit positions and normals of the vertices
+    std::vector<float> P(3*numVerts), Du(3*numVerts), Dv(3*numVerts);
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(&patchTable);
+    Osd::CpuEvaluator::EvalPatches(&positions[0], desc, &P[0], desc,
+        &Du[0], desc, &Dv[0], desc, numVerts, &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer());
+    delete cpuPatchTable;
+
+    typedef std::map<std::pair<int, int>, int> EdgeMap;
+    EdgeMap edges;
+
+    std::vector<bool> used(numVerts, false);
+    int numFlipped = 0;
+    for (int i = 0; i < numTriangles; ++i) {
+        int const * tri = &triangles[3*i];
+
+        float const * p0 = &P[3*tri[0]],
+                    * p1 = &P[3*tri[1]],
+                    * p2 = &P[3*tri[2]];
+        float e1[3], e2[3];
+        for (int k = 0; k < 3; ++k) {
+            e1[k] = p1[k] - p0[k];
+            e2[k] = p2[k] - p0[k];
+        }
+        float n[3] = { e1[1]*e2[2] - e1[2]*e2[1],
+                       e1[2]*e2[0] - e1[0]*e2[2],
+                       e1[0]*e2[1] - e1[1]*e2[0] };
+
+        float dot = 0.0f;
+        for (int j = 0; j < 3; ++j) {
+            int v = tri[j];
+            float const * du = &Du[3*v], * dv = &Dv[3*v];
+            dot += n[0]*(du[1]*dv[2] - du[2]*dv[1]) +
+                   n[1]*(du[2]*dv[0] - du[0]*dv[2]) +
+                   n[2]*(du[0]*dv[1] - du[1]*dv[0]);
+
+            used[v] = true;
+            ++edges[std::make_pair(tri[j], tri[(j+1)%3])];
+        }
+        numFlipped += (dot < 0.0f);
+    }
+
+    int numOpen = 0, numNonManifold = 0;
+    for (EdgeMap::const_iterator it = edges.begin(); it != edges.end(); ++it) {
+        numNonManifold += (it->second > 1);
+        numOpen += (edges.find(std::make_pair(it->first.second,
+                                              it->first.first)) == edges.end());
+    }
+    int numUnused = (int)std::count(used.begin(), used.end(), false);
+
+    if (numOpen or numNonManifold or numFlipped or numUnused) {
+        printf("  %s (%s) : %d open edges, %d non-manifold edges, "
+            "%d flipped triangles, %d unused vertices\n", name, metricName,
+            numOpen, numNonManifold, numFlipped, numUnused);
+        ++count;
+    }
+    return count;
+}
+
+static int
+checkTessellator() {
+
+    int count = 0;
+
+    printf("Testing CpuTessellator\n");
+
+    struct TestShape {
+        char const * name;
+        std::string const * shapeStr;
+    } shapes[] = { { "catmark_cube", &catmark_cube },
+                   { "catmark_pyramid", &catmark_pyramid },
+                   { "catmark_torus", &catmark_torus } };
+
+    Osd::CpuTessellator::FixedRateMetric fixedRate(8);
+    Osd::CpuTessellator::CurvatureMetric curvature(0.002f);
+
+    for (int i = 0; i < (int)(sizeof(shapes)/sizeof(shapes[0])); ++i) {
+        for (int uniform = 0; uniform < 2; ++uniform) {
+
+            std::vector<float> coarsePositions;
+            Far::TopologyRefiner * refiner =
+                createRefiner(*shapes[i].shapeStr, kCatmark, coarsePositions);
+
+            Far::StencilTable const * stencils = 0;
+            Far::PatchTable const * patchTable =
+                createPatchTable(*refiner, uniform != 0, &stencils);
+
+            std::vector<float> positions =
+                evalPositions(stencils, coarsePositions);
+
+            std::string name = std::string(shapes[i].name) +
+                (uniform ? " uniform" : " adaptive");
+            count += checkTessellator(name.c_str(), *refiner, *patchTable,
+                positions, fixedRate, "fixed rate");
+            count += checkTessellator(name.c_str(), *refiner, *patchTable,
+                positions, curvature, "curvature");
+
+            delete stencils;
+            delete patchTable;
+            delete refiner;
+        }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Deterministic pseudo-random numbers in [0,1]
+static float
+nextRandom(unsigned int & seed) {
+    seed = seed * 1103515245u + 12345u;
+    return (float)((seed >> 8) & 0xffff) / 65535.0f;
+}
+
+// Evaluates the limit positions at locations of the patches
+static std::vector<float>
+evalLimitPositions(Far::PatchTable const & patchTable,
+    std::vector<float> const & positions,
+    std::vector<Osd::PatchCoord> const & coords) {
+
+    Osd::BufferDescriptor desc(0, 3, 3);
+    std::vector<float> limitPositions(3*coords.size());
+    if (coords.empty()) {
+        return limitPositions;
+    }
+
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(&patchTable);
+    Osd::CpuEvaluator::EvalPatches(&positions[0], desc, &limitPositions[0],
+        desc, (int)coords.size(), &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer());
+    delete cpuPatchTable;
+    return limitPositions;
+}
+
+// Limit positions of the vertices of a dense tessellation of the patches
+static std::vector<float>
+tessellateLimitSurface(Far::TopologyRefiner const & refiner,
+    Far::PatchTable const & patchTable, std::vector<float> const & positions,
+    int rate, std::vector<int> & triangles) {
+
+    std::vector<Osd::PatchCoord> coords;
+    Osd::CpuTessellator::FixedRateMetric fixedRate(rate);
+    Osd::CpuTessellator::Tessellate(refiner, patchTable, &positions[0],
+        Osd::BufferDescriptor(0, 3, 3), fixedRate, rate, &coords, &triangles);
+
+    return evalLimitPositions(patchTable, positions, coords);
+}
+
+// Limit positions at the locations of the hits of queries
+static std::vector<float>
+evalHits(Far::PatchTable const & patchTable,
+    std::vector<float> const & positions,
+    std::vector<Osd::CpuPatchBVH::Hit> const & hits) {
+
+    std::vector<Osd::PatchCoord> coords(hits.size());
+    for (size_t i = 0; i < hits.size(); ++i) {
+        coords[i] = hits[i].coord;
+    }
+    return evalLimitPositions(patchTable, positions, coords);
+}
+
+// Intersection of a ray with a triangle (Moller-Trumbore)
+static bool
+intersectTriangle(float const * origin, float const * direction,
+    float const * p0, float const * p1, float const * p2, float * t) {
+
+    float e1[3], e2[3], s[3];
+    for (int k = 0; k < 3; ++k) {
+        e1[k] = p1[k] - p0[k];
+        e2[k] = p2[k] - p0[k];
+        s[k] = origin[k] - p0[k];
+    }
+    float p[3] = { direction[1]*e2[2] - direction[2]*e2[1],
+                   direction[2]*e2[0] - direction[0]*e2[2],
+                   direction[0]*e2[1] - direction[1]*e2[0] };
+    float det = e1[0]*p[0] + e1[1]*p[1] + e1[2]*p[2];
+    if (fabsf(det) < 1e-12f) {
+        return false;
+    }
+    float u = (s[0]*p[0] + s[1]*p[1] + s[2]*p[2]) / det;
+    if (u < 0.0f or u > 1.0f) {
+        return false;
+    }
+    float q[3] = { s[1]*e1[2] - s[2]*e1[1],
+                   s[2]*e1[0] - s[0]*e1[2],
+                   s[0]*e1[1] - s[1]*e1[0] };
+    float v = (direction[0]*q[0] + direction[1]*q[1] + direction[2]*q[2]) / det;
+    if (v < 0.0f or u + v > 1.0f) {
+        return false;
+    }
+    *t = (e2[0]*q[0] + e2[1]*q[1] + e2[2]*q[2]) / det;
+    return *t > 0.0f;
+}
+
+// Checks the intersections of random rays against a dense tessellation of
+// the limit surface : the rays must hit the same surface at the same
+// distance (within the accuracy of the tessellation), and the hits must be
+// on the limit surface
+static int
+checkPatchBVHRays(char const * name, Far::TopologyRefiner const & refiner,
+    Far::PatchTable const & patchTable, std::vector<float> const & positions,
+    Osd::CpuPatchBVH const & bvh) {
+
+    int count = 0;
+
+    std::vector<int> triangles;
+    std::vector<float> limitPositions = tessellateLimitSurface(refiner,
+        patchTable, positions, refiner.IsUniform() ? 16 : 64, triangles);
+
+    float bmin[3], bmax[3], size = 0.0f;
+    bvh.GetBounds(bmin, bmax);
+    for (int k = 0; k < 3; ++k) {
+        size = std::max(size, bmax[k] - bmin[k]);
+    }
+
+    // rays through random points of the bounds, starting outside of them
+    int const numRays = 100;
+    std::vector<float> origins(3*numRays), directions(3*numRays);
+    unsigned int seed = 7;
+    for (int i = 0; i < numRays; ++i) {
+        float center[3], direction[3], length = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            center[k] = bmin[k] + nextRandom(seed) * (bmax[k] - bmin[k]);
+            direction[k] = nextRandom(seed) - 0.5f;
+            length += direction[k] * direction[k];
+        }
+        length = sqrtf(length);
+        for (int k = 0; k < 3; ++k) {
+            direction[k] /= length;
+            origins[3*i + k] = center[k] - 2.0f * size * direction[k];
+            directions[3*i + k] = direction[k];
+        }
+    }
+
+    std::vector<Osd::CpuPatchBVH::Hit> hits(numRays);
+    bvh.IntersectRays(numRays, &origins[0], &directions[0], 0.0f, 1e30f,
+        &hits[0]);
+
+    std::vector<float> hitPositions = evalHits(patchTable, positions, hits);
+
+    int numMismatches = 0, numMisplaced = 0;
+    for (int i = 0; i < numRays; ++i) {
+
+        float const * origin = &origins[3*i],
+                    * direction = &directions[3*i];
+
+        float tMin = 1e30f;
+        for (size_t j = 0; j < triangles.size(); j += 3) {
+            float t;
+            if (intersectTriangle(origin, direction,
+                    &limitPositions[3*triangles[j]],
+                    &limitPositions[3*triangles[j+1]],
+                    &limitPositions[3*triangles[j+2]], &t)) {
+                tMin = std::min(tMin, t);
+            }
+        }
+
+        Osd::CpuPatchBVH::Hit const & hit = hits[i];
+
+        // rays grazing the silhouette may hit only one of the surfaces
+        bool hitTessellation = (tMin < 1e30f),
+             hitSurface = (hit.distance >= 0.0f);
+        if (hitTessellation != hitSurface or
+            (hitSurface and fabsf(hit.distance - tMin) > 2e-3f * size)) {
+            ++numMismatches;
+        }
+        if (not hitSurface) {
+            continue;
+        }
+
+        float error = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            error = std::max(error, fabsf(hitPositions[3*i + k] -
+                (origin[k] + hit.distance * direction[k])));
+        }
+        Far::PatchParam param = patchTable.GetPatchParam(hit.coord.handle);
+        if (error > 1e-4f * size or hit.ptexFace != param.GetFaceId()) {
+            ++numMisplaced;
+        }
+    }
+
+    if (numMismatches > numRays/100 or numMisplaced) {
+        printf("  %s : %d rays differ from the tessellation, %d hits are "
+            "not on the surface\n", name, numMismatches, numMisplaced);
+        ++count;
+    }
+    return count;
+}
+
+// Checks the closest points of random points against the vertices of a
+// dense tessellation of the limit surface : the closest points must not be
+// further than the closest vertex, must be on the limit surface at the
+// distance found, and are not found beyond the search distance
+static int
+checkPatchBVHClosestPoints(char const * name,
+    Far::TopologyRefiner const & refiner, Far::PatchTable const & patchTable,
+    std::vector<float> const & positions, Osd::CpuPatchBVH const & bvh) {
+
+    int count = 0;
+
+    std::vector<int> triangles;
+    std::vector<float> limitPositions = tessellateLimitSurface(refiner,
+        patchTable, positions, refiner.IsUniform() ? 16 : 64, triangles);
+
+    float bmin[3], bmax[3], size = 0.0f;
+    bvh.GetBounds(bmin, bmax);
+    for (int k = 0; k < 3; ++k) {
+        size = std::max(size, bmax[k] - bmin[k]);
+    }
+
+    // random points in bounds enlarged by half their size
+    int const numPoints = 50;
+    std::vector<float> points(3*numPoints);
+    unsigned int seed = 11;
+    for (int i = 0; i < 3*numPoints; ++i) {
+        int k = i%3;
+        float center = 0.5f * (bmin[k] + bmax[k]),
+              extent = 0.75f * (bmax[k] - bmin[k]);
+        points[i] = center + extent * (2.0f * nextRandom(seed) - 1.0f);
+    }
+
+    std::vector<Osd::CpuPatchBVH::Hit> hits(numPoints);
+    int numFound = bvh.FindClosestPoints(numPoints, &points[0], 1e30f,
+        &hits[0]);
+
+    std::vector<float> hitPositions = evalHits(patchTable, positions, hits);
+
+    int numFurther = 0, numMisplaced = 0, numOutside = 0;
+    for (int i = 0; i < numPoints; ++i) {
+
+        float const * point = &points[3*i];
+
+        float minDistance = 1e30f;
+        for (size_t j = 0; j < limitPositions.size(); j += 3) {
+            float d = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                float e = limitPositions[j+k] - point[k];
+                d += e * e;
+            }
+            minDistance = std::min(minDistance, d);
+        }
+        minDistance = sqrtf(minDistance);
+
+        Osd::CpuPatchBVH::Hit const & hit = hits[i];
+        if (hit.distance < 0.0f or hit.distance > minDistance + 1e-5f*size) {
+            ++numFurther;
+            continue;
+        }
+
+        float d = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            float e = hitPositions[3*i + k] - point[k];
+            d += e * e;
+        }
+        Far::PatchParam param = patchTable.GetPatchParam(hit.coord.handle);
+        if (fabsf(sqrtf(d) - hit.distance) > 1e-4f * size or
+            hit.ptexFace != param.GetFaceId()) {
+            ++numMisplaced;
+        }
+
+        // nothing is found closer than the closest point
+        Osd::CpuPatchBVH::Hit nearHit;
+        if (bvh.FindClosestPoint(point, 0.9f * hit.distance, &nearHit) or
+            nearHit.distance >= 0.0f) {
+            ++numOutside;
+        }
+    }
+
+    if (numFound != numPoints or numFurther or numMisplaced or numOutside) {
+        printf("  %s : %d/%d points found, %d further than the "
+            "tessellation, %d not on the surface, %d found beyond the "
+            "search distance\n", name, numFound, numPoints, numFurther,
+            numMisplaced, numOutside);
+        ++count;
+    }
+    return count;
+}
+
+static int
+checkPatchBVH() {
+
+    int count = 0;
+
+    printf("Testing CpuPatchBVH\n");
+
+    struct TestShape {
+        char const * name;
+        std::string const * shapeStr;
+        bool uniform;
+    } shapes[] = { { "catmark_cube", &catmark_cube, false },
+                   { "catmark_pyramid", &catmark_pyramid, false },
+                   { "catmark_torus", &catmark_torus, true } };
+
+    for (int i = 0; i < (int)(sizeof(shapes)/sizeof(shapes[0])); ++i) {
+
+        std::vector<float> coarsePositions;
+        Far::TopologyRefiner * refiner =
+            createRefiner(*shapes[i].shapeStr, kCatmark, coarsePositions);
+
+        Far::StencilTable const * stencils = 0;
+        Far::PatchTable const * patchTable =
+            createPatchTable(*refiner, shapes[i].uniform, &stencils);
+
+        std::vector<float> positions =
+            evalPositions(stencils, coarsePositions);
+
+        Osd::BufferDescriptor desc(0, 3, 3);
+        Osd::CpuPatchBVH * bvh =
+            Osd::CpuPatchBVH::Create(*patchTable, &positions[0], desc);
+        if (not bvh) {
+            printf("  %s : creation failed\n", shapes[i].name);
+            ++count;
+        } else {
+            count += checkPatchBVHRays(shapes[i].name, *refiner,
+                *patchTable, positions, *bvh);
+            count += checkPatchBVHClosestPoints(shapes[i].name, *refiner,
+                *patchTable, positions, *bvh);
+
+            // deform the surface and refit the hierarchy
+            for (size_t j = 0; j < coarsePositions.size(); j += 3) {
+                float x = coarsePositions[j];
+                coarsePositions[j] = 1.3f * x + 0.2f;
+                coarsePositions[j+1] += 0.3f * sinf(3.0f * x);
+                coarsePositions[j+2] *= 0.8f;
+            }
+            positions = evalPositions(stencils, coarsePositions);
+            bvh->Refit(&positions[0], desc);
+
+            std::string name = std::string(shapes[i].name) + " (refit)";
+            count += checkPatchBVHRays(name.c_str(), *refiner,
+                *patchTable, positions, *bvh);
+            count += checkPatchBVHClosestPoints(name.c_str(), *refiner,
+                *patchTable, positions, *bvh);
+        }
+
+        delete bvh;
+        delete stencils;
+        delete patchTable;
+        delete refiner;
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+static bool
+samePatchCoord(Osd::PatchCoord const & a, Osd::PatchCoord const & b) {
+    return a.handle.patchIndex == b.handle.patchIndex and
+           a.s == b.s and a.t == b.t;
+}
+
+// Column-major camera matrices
+static void
+lookAt(float const eye[3], float const target[3], float modelView[16]) {
+
+    float f[3], up[3] = { 0.0f, 1.0f, 0.0f }, side[3], u[3];
+    for (int k = 0; k < 3; ++k) {
+        f[k] = target[k] - eye[k];
+    }
+    float length = sqrtf(f[0]*f[0] + f[1]*f[1] + f[2]*f[2]);
+    for (int k = 0; k < 3; ++k) {
+        f[k] /= length;
+    }
+    if (fabsf(f[1]) > 0.9f) {
+        up[0] = 1.0f;
+        up[1] = 0.0f;
+    }
+    side[0] = f[1]*up[2] - f[2]*up[1];
+    side[1] = f[2]*up[0] - f[0]*up[2];
+    side[2] = f[0]*up[1] - f[1]*up[0];
+    length = sqrtf(side[0]*side[0] + side[1]*side[1] + side[2]*side[2]);
+    for (int k = 0; k < 3; ++k) {
+        side[k] /= length;
+    }
+    u[0] = side[1]*f[2] - side[2]*f[1];
+    u[1] = side[2]*f[0] - side[0]*f[2];
+    u[2] = side[0]*f[1] - side[1]*f[0];
+
+    for (int k = 0; k < 3; ++k) {
+        modelView[4*k + 0] = side[k];
+        modelView[4*k + 1] = u[k];
+        modelView[4*k + 2] = -f[k];
+        modelView[4*k + 3] = 0.0f;
+    }
+    modelView[12] = -(side[0]*eye[0] + side[1]*eye[1] + side[2]*eye[2]);
+    modelView[13] = -(u[0]*eye[0] + u[1]*eye[1] + u[2]*eye[2]);
+    modelView[14] = f[0]*eye[0] + f[1]*eye[1] + f[2]*eye[2];
+    modelView[15] = 1.0f;
+}
+
+static void
+perspective(float fovy, float zNear, float zFar, float projection[16]) {
+
+    std::fill(projection, projection + 16, 0.0f);
+    float f = 1.0f / tanf(0.5f * fovy);
+    projection[0] = f;
+    projection[5] = f;
+    projection[10] = (zFar + zNear) / (zNear - zFar);
+    projection[11] = -1.0f;
+    projection[14] = 2.0f * zFar * zNear / (zNear - zFar);
+}
+
+static void
+orthographic(float height, float zNear, float zFar, float projection[16]) {
+
+    std::fill(projection, projection + 16, 0.0f);
+    projection[0] = 1.0f / height;
+    projection[5] = 1.0f / height;
+    projection[10] = -2.0f / (zFar - zNear);
+    projection[14] = -(zFar + zNear) / (zFar - zNear);
+    projection[15] = 1.0f;
+}
+
+// Checks that the patch culler is conservative : the samples of a dense
+// tessellation are within the bounds and normal cones of their patches,
+// and the samples in the view frustum of random cameras (and facing them,
+// when culling back faces) are on patches found visible
+static int
+checkPatchCuller(char const * name, Far::TopologyRefiner const & refiner,
+    Far::PatchTable const & patchTable, std::vector<float> const & positions,
+    Osd::CpuPatchCuller & culler) {
+
+    int count = 0;
+
+    Osd::BufferDescriptor desc(0, 3, 3);
+
+    std::vector<Osd::PatchCoord> coords;
+    std::vector<int> triangles;
+    Osd::CpuTessellator::FixedRateMetric fixedRate(16);
+    Osd::CpuTessellator::Tessellate(refiner, patchTable, &positions[0], desc,
+        fixedRate, 16, &coords, &triangles);
+
+    int numSamples = (int)coords.size();
+    std::vector<float> P(3*numSamples), Du(3*numSamples), Dv(3*numSamples);
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(&patchTable);
+    Osd::CpuEvaluator::EvalPatches(&positions[0], desc, &P[0], desc,
+        &Du[0], desc, &Dv[0], desc, numSamples, &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer());
+    delete cpuPatchTable;
+
+    float bmin[3] = { 1e30f, 1e30f, 1e30f },
+          bmax[3] = { -1e30f, -1e30f, -1e30f }, size = 0.0f;
+    std::vector<float> N(3*numSamples);
+    for (int i = 0; i < numSamples; ++i) {
+        float const * du = &Du[3*i], * dv = &Dv[3*i];
+        float * n = &N[3*i];
+        n[0] = du[1]*dv[2] - du[2]*dv[1];
+        n[1] = du[2]*dv[0] - du[0]*dv[2];
+        n[2] = du[0]*dv[1] - du[1]*dv[0];
+        float length = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        for (int k = 0; k < 3; ++k) {
+            n[k] = (length > 0.0f) ? n[k] / length : 0.0f;
+            bmin[k] = std::min(bmin[k], P[3*i + k]);
+            bmax[k] = std::max(bmax[k], P[3*i + k]);
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        size = std::max(size, bmax[k] - bmin[k]);
+    }
+
+    // bounds and normal cones of the patches
+    int numOutside = 0;
+    for (int i = 0; i < numSamples; ++i) {
+        int patch = coords[i].handle.patchIndex;
+        float const * bounds = culler.GetPatchBounds(patch),
+                    * cone = culler.GetPatchNormalCone(patch),
+                    * p = &P[3*i],
+                    * n = &N[3*i];
+        bool outside = false;
+        for (int k = 0; k < 3; ++k) {
+            outside |= (p[k] < bounds[k] - 1e-5f*size or
+                        p[k] > bounds[3+k] + 1e-5f*size);
+        }
+        float cosAngle = n[0]*cone[0] + n[1]*cone[1] + n[2]*cone[2];
+        // cones wider than pi/2 do not bound the normals
+        if (cone[3] < 1.5707963f and (n[0] or n[1] or n[2]) and
+            acosf(std::min(1.0f, cosAngle)) > cone[3] + 1e-4f) {
+            outside = true;
+        }
+        numOutside += outside;
+    }
+
+    // cameras around the surface, inside and outside of its bounds
+    float center[3];
+    for (int k = 0; k < 3; ++k) {
+        center[k] = 0.5f * (bmin[k] + bmax[k]);
+    }
+
+    int const numViews = 16;
+    int numMissed = 0, numCulled = 0;
+    unsigned int seed = 5;
+    for (int view = 0; view < numViews; ++view) {
+
+        float dir[3], length = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            dir[k] = 2.0f * nextRandom(seed) - 1.0f;
+            length += dir[k] * dir[k];
+        }
+        length = sqrtf(length);
+
+        float distance = size * ((view < numViews/2) ?
+            (0.3f + 1.5f * nextRandom(seed)) : 2.0f);
+        float eye[3], target[3];
+        for (int k = 0; k < 3; ++k) {
+            eye[k] = center[k] + dir[k] / length * distance;
+            target[k] = center[k] +
+                0.3f * size * (2.0f * nextRandom(seed) - 1.0f);
+        }
+
+        float modelView[16], projection[16];
+        lookAt(eye, target, modelView);
+        bool isOrthographic = (view%4 == 3);
+        if (isOrthographic) {
+            orthographic(0.4f * size, 0.01f * size, 10.0f * size, projection);
+        } else {
+            perspective(0.3f + 0.8f * nextRandom(seed), 0.01f * size,
+                10.0f * size, projection);
+        }
+
+        // clip space transform
+        float m[16];
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                m[4*c + r] = 0.0f;
+                for (int k = 0; k < 4; ++k) {
+                    m[4*c + r] += projection[4*k + r] * modelView[4*c + k];
+                }
+            }
+        }
+
+        for (int cullBackfaces = 0; cullBackfaces < 2; ++cullBackfaces) {
+
+            std::vector<Far::PatchTable::PatchHandle> visiblePatches;
+            int numVisible = culler.Cull(modelView, projection,
+                cullBackfaces != 0, &visiblePatches);
+            if (numVisible != (int)visiblePatches.size()) {
+                ++numMissed;
+            }
+            numCulled += culler.GetNumPatches() - numVisible;
+
+            std::vector<Osd::PatchCoord> expectedCoords;
+            for (int i = 0; i < numSamples; ++i) {
+                if (culler.IsPatchVisible(coords[i].handle.patchIndex)) {
+                    expectedCoords.push_back(coords[i]);
+                }
+
+                float const * p = &P[3*i], * n = &N[3*i];
+                float x[4];
+                for (int r = 0; r < 4; ++r) {
+                    x[r] = m[r]*p[0] + m[4+r]*p[1] + m[8+r]*p[2] + m[12+r];
+                }
+                if (fabsf(x[0]) > x[3] or fabsf(x[1]) > x[3] or
+                    fabsf(x[2]) > x[3]) {
+                    continue;
+                }
+                if (cullBackfaces) {
+                    float v[3];
+                    for (int k = 0; k < 3; ++k) {
+                        v[k] = isOrthographic ?
+                            (target[k] - eye[k]) : (p[k] - eye[k]);
+                    }
+                    if (v[0]*n[0] + v[1]*n[1] + v[2]*n[2] >= 0.0f) {
+                        continue;
+                    }
+                }
+                if (not culler.IsPatchVisible(coords[i].handle.patchIndex)) {
+                    ++numMissed;
+                }
+            }
+
+            std::vector<Osd::PatchCoord> visibleCoords;
+            int numVisibleCoords = culler.CullPatchCoords(numSamples,
+                &coords[0], &visibleCoords);
+            if (numVisibleCoords != (int)expectedCoords.size() or
+                visibleCoords.size() != expectedCoords.size() or
+                not std::equal(expectedCoords.begin(), expectedCoords.end(),
+                    visibleCoords.begin(), samePatchCoord)) {
+                ++numMissed;
+            }
+        }
+    }
+
+    if (numOutside or numMissed or numCulled == 0) {
+        printf("  %s : %d samples outside of the bounds of their patch, "
+            "%d visible samples culled, %d patches culled\n", name,
+            numOutside, numMissed, numCulled);
+        ++count;
+    }
+    return count;
+}
+
+static int
+checkPatchCuller() {
+
+    int count = 0;
+
+    printf("Testing CpuPatchCuller\n");
+
+    struct TestShape {
+        char const * name;
+        std::string const * shapeStr;
+        bool uniform;
+    } shapes[] = { { "catmark_cube", &catmark_cube, false },
+                   { "catmark_pyramid", &catmark_pyramid, false },
+                   { "catmark_torus", &catmark_torus, true } };
+
+    for (int i = 0; i < (int)(sizeof(shapes)/sizeof(shapes[0])); ++i) {
+
+        std::vector<float> coarsePositions;
+        Far::TopologyRefiner * refiner =
+            createRefiner(*shapes[i].shapeStr, kCatmark, coarsePositions);
+
+        Far::StencilTable const * stencils = 0;
+        Far::PatchTable const * patchTable =
+            createPatchTable(*refiner, shapes[i].uniform, &stencils);
+
+        std::vector<float> positions =
+            evalPositions(stencils, coarsePositions);
+
+        Osd::BufferDescriptor desc(0, 3, 3);
+        Osd::CpuPatchCuller * culler =
+            Osd::CpuPatchCuller::Create(*patchTable, &positions[0], desc);
+        if (not culler) {
+            printf("  %s : creation failed\n", shapes[i].name);
+            ++count;
+        } else {
+            count += checkPatchCuller(shapes[i].name, *refiner,
+                *patchTable, positions, *culler);
+
+            // deform the surface and update a range of the vertices : the
+            // bounds must match the bounds of a new culler
+            for (size_t j = 0; j < coarsePositions.size(); j += 3) {
+                float x = coarsePositions[j];
+                coarsePositions[j] = 1.3f * x + 0.2f;
+                coarsePositions[j+1] += 0.3f * sinf(3.0f * x);
+            }
+            std::vector<float> deformed =
+                evalPositions(stencils, coarsePositions);
+
+            int numVerts = (int)positions.size()/3,
+                start = numVerts/3,
+                end = 2*numVerts/3;
+            std::copy(deformed.begin() + 3*start, deformed.begin() + 3*end,
+                positions.begin() + 3*start);
+            culler->UpdateVertices(&positions[0], desc, start, end);
+
+            Osd::CpuPatchCuller * reference =
+                Osd::CpuPatchCuller::Create(*patchTable, &positions[0], desc);
+            int numDifferent = 0;
+            for (int patch = 0; patch < culler->GetNumPatches(); ++patch) {
+                numDifferent +=
+                    (not std::equal(culler->GetPatchBounds(patch),
+                        culler->GetPatchBounds(patch) + 6,
+                        reference->GetPatchBounds(patch))) or
+                    (not std::equal(culler->GetPatchNormalCone(patch),
+                        culler->GetPatchNormalCone(patch) + 4,
+                        reference->GetPatchNormalCone(patch)));
+            }
+            if (numDifferent) {
+                printf("  %s : %d patches differ after UpdateVertices()\n",
+                    shapes[i].name, numDifferent);
+                ++count;
+            }
+            delete reference;
+        }
+
+        delete culler;
+        delete stencils;
+        delete patchTable;
+        delete refiner;
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Checks the evaluation of the Bezier form of the regular patches against the
+// evaluation of the control vertices of the patch table
+static int
+checkEvalPatchesBezier(char const * name, Far::TopologyRefiner & refiner,
+    std::vector<float> const & coarsePositions) {
+
+    int count = 0;
+
+    Far::StencilTable const * stencils = 0;
+    Far::PatchTable const * patchTable =
+        createPatchTable(refiner, false, &stencils);
+
+    std::vector<float> positions = evalPositions(stencils, coarsePositions);
+
+    // the Bezier points follow the vertices of the patch table
+    Far::BezierPatchTable * bezierTable = Far::BezierPatchTable::Create(
+        *patchTable, (int)positions.size()/3);
+    if (bezierTable->GetNumPatches() == 0) {
+        printf("  %s : no Bezier patches\n", name);
+        ++count;
+    } else {
+        positions = evalPositions(
+            bezierTable->GetBezierPointStencilTable(), positions);
+    }
+
+    // random locations on every patch
+    std::vector<Osd::PatchCoord> coords;
+    unsigned int seed = 1;
+    for (int array=0, patch=0; array<patchTable->GetNumPatchArrays(); ++array) {
+        int ncvs = patchTable->GetPatchArrayDescriptor(array).
+            GetNumControlVertices();
+        for (int i=0; i<patchTable->GetNumPatches(array); ++i, ++patch) {
+            Far::PatchTable::PatchHandle handle;
+            handle.arrayIndex = array;
+            handle.patchIndex = patch;
+            handle.vertIndex = i * ncvs;
+
+            Far::PatchParam param = patchTable->GetPatchParam(handle);
+            float fraction = param.GetParamFraction();
+            for (int j=0; j<4; ++j) {
+                float s = (param.GetU() + nextRandom(seed)) * fraction,
+                      t = (param.GetV() + nextRandom(seed)) * fraction;
+                coords.push_back(Osd::PatchCoord(handle, s, t));
+            }
+        }
+    }
+
+    int numCoords = (int)coords.size();
+    std::vector<float> P(3*numCoords), Du(3*numCoords), Dv(3*numCoords),
+        bezierP(3*numCoords), bezierDu(3*numCoords), bezierDv(3*numCoords);
+
+    Osd::BufferDescriptor desc(0, 3, 3);
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(patchTable);
+    Osd::CpuEvaluator::EvalPatches(&positions[0], desc, &P[0], desc,
+        &Du[0], desc, &Dv[0], desc, numCoords, &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer());
+
+    int const * bezierPointIndices =
+        &bezierTable->GetBezierPointIndexTable()[0];
+
+    Osd::CpuEvaluator::EvalPatchesBezier(&positions[0], desc,
+        &bezierP[0], desc, &bezierDu[0], desc, &bezierDv[0], desc,
+        numCoords, &coords[0], cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer(), bezierPointIndices);
+
+    float diff = maxDifference(P, bezierP),
+          derivDiff = std::max(maxDifference(Du, bezierDu),
+                               maxDifference(Dv, bezierDv));
+    if (diff > 1e-5 or derivDiff > 1e-3) {
+        printf("  %s : max difference %g, derivatives %g\n",
+            name, diff, derivDiff);
+        ++count;
+    }
+
+    // position only evaluation
+    std::vector<float> bezierPosOnly(3*numCoords);
+    Osd::CpuEvaluator::EvalPatchesBezier(&positions[0], desc,
+        &bezierPosOnly[0], desc, numCoords, &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer(), bezierPointIndices);
+    if (bezierPosOnly != bezierP) {
+        printf("  %s : position only evaluation mismatch\n", name);
+        ++count;
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    // the OpenMP evaluator must match the serial one exactly
+    std::vector<float> ompP(3*numCoords), ompDu(3*numCoords),
+        ompDv(3*numCoords);
+    Osd::OmpEvaluator::EvalPatchesBezier(&positions[0], desc,
+        &ompP[0], desc, &ompDu[0], desc, &ompDv[0], desc,
+        numCoords, &coords[0], cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer(), bezierPointIndices);
+    if (ompP != bezierP or ompDu != bezierDu or ompDv != bezierDv) {
+        printf("  %s : OmpEvaluator mismatch\n", name);
+        ++count;
+    }
+#endif
+
+    delete cpuPatchTable;
+    delete bezierTable;
+    delete stencils;
+    delete patchTable;
+    return count;
+}
+
+static int
+checkEvalPatchesBezier() {
+
+    int count = 0;
+
+    printf("Testing EvalPatchesBezier\n");
+
+    struct TestShape {
+        char const * name;
+        std::string const * shapeStr;
+    } shapes[] = { { "catmark_cube", &catmark_cube },
+                   { "catmark_pyramid", &catmark_pyramid },
+                   { "catmark_torus", &catmark_torus } };
+
+    for (int i = 0; i < (int)(sizeof(shapes)/sizeof(shapes[0])); ++i) {
+
+        std::vector<float> coarsePositions;
+        Far::TopologyRefiner * refiner =
+            createRefiner(*shapes[i].shapeStr, kCatmark, coarsePositions);
+
+        count += checkEvalPatchesBezier(shapes[i].name, *refiner,
+            coarsePositions);
+
+        delete refiner;
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Creates a refiner and the face-varying values of the refined levels of a
+// shape (see InterpolateFVarData)
+static Far::TopologyRefiner *
+createFVarRefiner(std::string const & shapeStr, int level, bool adaptive,
+    std::vector<float> & fvarValues) {
+
+    typedef Far::TopologyRefinerFactory<Shape> RefinerFactory;
+
+    Shape * shape = Shape::parseObj(shapeStr.c_str(), kCatmark);
+
+    Far::TopologyRefiner * refiner = RefinerFactory::Create(*shape,
+        RefinerFactory::Options(GetSdcType(*shape), GetSdcOptions(*shape)));
+    assert(refiner);
+
+    if (adaptive) {
+        refiner->RefineAdaptive(
+            Far::TopologyRefiner::AdaptiveOptions(level));
+    } else {
+        refiner->RefineUniform(Far::TopologyRefiner::UniformOptions(level));
+    }
+
+    InterpolateFVarData(*refiner, *shape, fvarValues);
+
+    delete shape;
+    return refiner;
+}
+
+// Checks the face-varying evaluation of the CPU evaluators against the
+// face-varying basis of the Far patch table
+static int
+checkEvalPatchesFaceVarying(char const * name, std::string const & shapeStr) {
+
+    int count = 0;
+
+    int const level = 3;
+
+    std::vector<float> fvarValues;
+    Far::TopologyRefiner * refiner =
+        createFVarRefiner(shapeStr, level, true, fvarValues);
+
+    Far::PatchTableFactory::Options options(level);
+    options.generateFVarTables = true;
+    options.SetEndCapType(
+        Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+    Far::PatchTable const * patchTable =
+        Far::PatchTableFactory::Create(*refiner, options);
+
+    // reference : Far::PatchTable::EvaluateBasisFaceVarying
+    Far::PatchMap patchMap(*patchTable);
+    std::vector<Osd::PatchCoord> coords;
+    std::vector<float> reference;
+    unsigned int seed = 1;
+    int numPtexFaces = Far::PtexIndices(*refiner).GetNumFaces();
+    for (int face = 0; face < numPtexFaces; ++face) {
+        for (int i = 0; i < 16; ++i) {
+            float s = nextRandom(seed), t = nextRandom(seed);
+            Far::PatchTable::PatchHandle const * handle =
+                patchMap.FindPatch(face, s, t);
+            assert(handle);
+            coords.push_back(Osd::PatchCoord(*handle, s, t));
+
+            float wP[20], wDs[20], wDt[20];
+            patchTable->EvaluateBasisFaceVarying(*handle, s, t,
+                wP, wDs, wDt);
+
+            Far::ConstIndexArray values =
+                patchTable->GetPatchFVarValues(*handle);
+            float uv[2] = { 0.0f, 0.0f };
+            for (int j = 0; j < values.size(); ++j) {
+                uv[0] += wP[j] * fvarValues[values[j]*2];
+                uv[1] += wP[j] * fvarValues[values[j]*2+1];
+            }
+            reference.push_back(uv[0]);
+            reference.push_back(uv[1]);
+        }
+    }
+
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(patchTable);
+
+    int numCoords = (int)coords.size();
+    Osd::BufferDescriptor desc(0, 2, 2);
+
+    // the evaluators sum the same weights in the same order
+    std::vector<float> result(2*numCoords, -1.0f);
+    if (not Osd::CpuEvaluator::EvalPatchesFaceVarying(&fvarValues[0], desc,
+            &result[0], desc, numCoords, &coords[0],
+            cpuPatchTable->GetFVarPatchArrayBuffer(),
+            cpuPatchTable->GetFVarPatchIndexBuffer(),
+            cpuPatchTable->GetPatchParamBuffer()) or result != reference) {
+        printf("  %s : CpuEvaluator face-varying values differ by %f\n",
+            name, maxDifference(result, reference));
+        ++count;
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    std::fill(result.begin(), result.end(), -1.0f);
+    if (not Osd::OmpEvaluator::EvalPatchesFaceVarying(&fvarValues[0], desc,
+            &result[0], desc, numCoords, &coords[0],
+            cpuPatchTable->GetFVarPatchArrayBuffer(),
+            cpuPatchTable->GetFVarPatchIndexBuffer(),
+            cpuPatchTable->GetPatchParamBuffer()) or result != reference) {
+        printf("  %s : OmpEvaluator face-varying values differ by %f\n",
+            name, maxDifference(result, reference));
+        ++count;
+    }
+#endif
+
+    delete cpuPatchTable;
+    delete patchTable;
+    delete refiner;
+    return count;
+}
+
+static int
+checkEvalPatchesFaceVarying() {
+
+    int count = 0;
+
+    printf("Testing face-varying EvalPatches\n");
+
+    count += checkEvalPatchesFaceVarying("catmark_fvar_bound0",
+        catmark_fvar_bound0);
+    count += checkEvalPatchesFaceVarying("catmark_fvar_bound1",
+        catmark_fvar_bound1);
+    count += checkEvalPatchesFaceVarying("catmark_fvar_bound2",
+        catmark_fvar_bound2);
+
+    // the triangle patches of uniform triangulated tables are rejected
+    std::vector<float> fvarValues;
+    Far::TopologyRefiner * refiner =
+        createFVarRefiner(catmark_fvar_bound0, 1, false, fvarValues);
+
+    Far::PatchTableFactory::Options options(1);
+    options.generateFVarTables = true;
+    options.triangulateQuads = true;
+
+    Far::PatchTable const * patchTable =
+        Far::PatchTableFactory::Create(*refiner, options);
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(patchTable);
+
+    Osd::PatchCoord coord;
+    coord.s = coord.t = 0.5f;
+    float result[2];
+    Osd::BufferDescriptor desc(0, 2, 2);
+
+    if (cpuPatchTable->GetNumFVarChannels() != 1 or
+        cpuPatchTable->GetFVarPatchArrayBuffer() or
+        cpuPatchTable->GetFVarPatchIndexBuffer() or
+        Osd::CpuEvaluator::EvalPatchesFaceVarying(&fvarValues[0], desc,
+            result, desc, 1, &coord,
+            cpuPatchTable->GetFVarPatchArrayBuffer(),
+            cpuPatchTable->GetFVarPatchIndexBuffer(),
+            cpuPatchTable->GetPatchParamBuffer())) {
+        printf("  triangulated face-varying patches were not rejected\n");
+        ++count;
+    }
+
+    delete cpuPatchTable;
+    delete patchTable;
+    delete refiner;
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Varying primvars interpolate bilinearly at every level of refinement : on
+// the quads of catmark_cube, the varying limit values of the patches must be
+// the bilinear interpolation of the varying values of the coarse corners
+static int
+checkEvalPatchesVarying(char const * name, bool uniform,
+    Far::PatchTableFactory::Options::EndCapType endCapType) {
+
+    int count = 0;
+
+    std::vector<float> coarseValues;
+    Far::TopologyRefiner * refiner =
+        createRefiner(catmark_cube, kCatmark, coarseValues);
+
+    Far::StencilTable const * stencils = 0;
+    Far::PatchTable const * patchTable =
+        createPatchTable(*refiner, uniform, &stencils, endCapType);
+    delete stencils;
+
+    Far::StencilTableFactory::Options stencilOptions;
+    stencilOptions.interpolationMode =
+        Far::StencilTableFactory::INTERPOLATE_VARYING;
+    stencilOptions.generateIntermediateLevels = not uniform;
+    stencilOptions.generateControlVerts = false;
+    stencilOptions.generateOffsets = true;
+    stencils = Far::StencilTableFactory::Create(*refiner, stencilOptions);
+    if (patchTable->GetLocalPointVaryingStencilTable()) {
+        Far::StencilTable const * combined =
+            Far::StencilTableFactory::AppendLocalPointStencilTable(*refiner,
+                stencils, patchTable->GetLocalPointVaryingStencilTable());
+        delete stencils;
+        stencils = combined;
+    }
+    std::vector<float> values = evalPositions(stencils, coarseValues);
+
+    // random locations on every face, and the bilinear interpolation of its
+    // corners (the faces are quads : the ptex faces are the coarse faces)
+    Far::TopologyLevel const & coarseLevel = refiner->GetLevel(0);
+    Far::PatchMap patchMap(*patchTable);
+    std::vector<Osd::PatchCoord> coords;
+    std::vector<float> reference;
+    std::map<Far::PatchDescriptor::Type, int> numCoordsPerType;
+    unsigned int seed = 1;
+    for (int face = 0; face < coarseLevel.GetNumFaces(); ++face) {
+        Far::ConstIndexArray verts = coarseLevel.GetFaceVertices(face);
+        assert(verts.size()==4);
+
+        for (int i = 0; i < 32; ++i) {
+            float s = nextRandom(seed), t = nextRandom(seed);
+            Far::PatchTable::PatchHandle const * handle =
+                patchMap.FindPatch(face, s, t);
+            assert(handle);
+            coords.push_back(Osd::PatchCoord(*handle, s, t));
+            ++numCoordsPerType[patchTable->GetPatchArrayDescriptor(
+                handle->arrayIndex).GetType()];
+
+            float w[4] = { (1.0f-s)*(1.0f-t), s*(1.0f-t), s*t, (1.0f-s)*t };
+            for (int k = 0; k < 3; ++k) {
+                float value = 0.0f;
+                for (int j = 0; j < 4; ++j) {
+                    value += w[j] * coarseValues[verts[j]*3+k];
+                }
+                reference.push_back(value);
+            }
+        }
+    }
+
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(patchTable);
+
+    int numCoords = (int)coords.size();
+    Osd::BufferDescriptor desc(0, 3, 3);
+
+    bool legacyGregory =
+        numCoordsPerType.count(Far::PatchDescriptor::GREGORY) or
+        numCoordsPerType.count(Far::PatchDescriptor::GREGORY_BOUNDARY);
+
+    std::vector<float> result(3*numCoords, -1.0f);
+    bool evaluated = Osd::CpuEvaluator::EvalPatchesVarying(&values[0], desc,
+        &result[0], desc, numCoords, &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer());
+
+    if (legacyGregory) {
+        // the legacy Gregory patches have no varying corners
+        if (evaluated) {
+            printf("  %s : legacy Gregory patches were not rejected\n", name);
+            ++count;
+        }
+    } else {
+        float diff = maxDifference(result, reference);
+        if (not evaluated or diff > PRECISION) {
+            printf("  %s : CpuEvaluator varying values differ by %g\n",
+                name, diff);
+            ++count;
+        }
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    // the OpenMP evaluator must match the serial one exactly
+    std::vector<float> ompResult(3*numCoords, -1.0f);
+    if (Osd::OmpEvaluator::EvalPatchesVarying(&values[0], desc,
+            &ompResult[0], desc, numCoords, &coords[0],
+            cpuPatchTable->GetPatchArrayBuffer(),
+            cpuPatchTable->GetPatchIndexBuffer(),
+            cpuPatchTable->GetPatchParamBuffer()) != evaluated or
+        (evaluated and ompResult != result)) {
+        printf("  %s : OmpEvaluator mismatch\n", name);
+        ++count;
+    }
+#endif
+
+    delete cpuPatchTable;
+    delete stencils;
+    delete patchTable;
+    delete refiner;
+    return count;
+}
+
+static int
+checkEvalPatchesVarying() {
+
+    typedef Far::PatchTableFactory::Options Options;
+
+    int count = 0;
+
+    printf("Testing varying EvalPatches\n");
+
+    // regular and Gregory basis patches
+    count += checkEvalPatchesVarying("adaptive", false,
+        Options::ENDCAP_GREGORY_BASIS);
+    // quads
+    count += checkEvalPatchesVarying("uniform", true,
+        Options::ENDCAP_GREGORY_BASIS);
+    // legacy Gregory patches
+    count += checkEvalPatchesVarying("legacy Gregory", false,
+        Options::ENDCAP_LEGACY_GREGORY);
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// ENDCAP_EXTRAORDINARY_BASIS : the CPU evaluators must match the evaluation of
+// the Far table, and the consumers that cannot evaluate the exact end caps
+// must reject the table
+static int
+checkExtraordinaryEndCaps() {
+
+    int count = 0;
+
+    printf("Testing extraordinary basis end caps\n");
+
+    std::vector<float> coarsePositions;
+    Far::TopologyRefiner * refiner =
+        createRefiner(catmark_cube, kCatmark, coarsePositions);
+
+    Far::StencilTable const * stencils = 0;
+    Far::PatchTable const * patchTable = createPatchTable(*refiner, false,
+        &stencils, Far::PatchTableFactory::Options::ENDCAP_EXTRAORDINARY_BASIS);
+
+    std::vector<float> positions = evalPositions(stencils, coarsePositions);
+
+    // reference : Far::PatchTable::EvaluateBasis
+    Far::PatchMap patchMap(*patchTable);
+    std::vector<Osd::PatchCoord> coords;
+    std::vector<float> refPositions;
+    unsigned int seed = 1;
+    int numExact = 0, numPtexFaces = Far::PtexIndices(*refiner).GetNumFaces();
+    for (int face = 0; face < numPtexFaces; ++face) {
+        for (int i = 0; i < 32; ++i) {
+            float s = nextRandom(seed), t = nextRandom(seed);
+            Far::PatchTable::PatchHandle const * handle =
+                patchMap.FindPatch(face, s, t);
+            assert(handle);
+            coords.push_back(Osd::PatchCoord(*handle, s, t));
+
+            numExact += patchTable->GetPatchArrayDescriptor(
+                handle->arrayIndex).GetType() ==
+                    Far::PatchDescriptor::EXTRAORDINARY_BASIS;
+
+            float wP[20], wDs[20], wDt[20], pos[3] = { 0.0f, 0.0f, 0.0f };
+            patchTable->EvaluateBasis(*handle, s, t, wP, wDs, wDt);
+            Far::ConstIndexArray cvs = patchTable->GetPatchVertices(*handle);
+            for (int j = 0; j < cvs.size(); ++j) {
+                for (int k = 0; k < 3; ++k) {
+                    pos[k] += wP[j] * positions[3*cvs[j] + k];
+                }
+            }
+            refPositions.insert(refPositions.end(), pos, pos + 3);
+        }
+    }
+    if (numExact == 0) {
+        printf("  no extraordinary basis patches\n");
+        ++count;
+    }
+
+    float diff = maxDifference(
+        evalLimitPositions(*patchTable, positions, coords), refPositions);
+    if (diff > PRECISION) {
+        printf("  CpuEvaluator : max difference %g\n", diff);
+        ++count;
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    Osd::BufferDescriptor desc(0, 3, 3);
+    std::vector<float> ompPositions(refPositions.size());
+    Osd::CpuPatchTable * cpuPatchTable =
+        Osd::CpuPatchTable::Create(patchTable);
+    Osd::OmpEvaluator::EvalPatches(&positions[0], desc, &ompPositions[0],
+        desc, (int)coords.size(), &coords[0],
+        cpuPatchTable->GetPatchArrayBuffer(),
+        cpuPatchTable->GetPatchIndexBuffer(),
+        cpuPatchTable->GetPatchParamBuffer());
+    delete cpuPatchTable;
+
+    diff = maxDifference(ompPositions, refPositions);
+    if (diff > PRECISION) {
+        printf("  OmpEvaluator : max difference %g\n", diff);
+        ++count;
+    }
+#endif
+
+    Osd::BufferDescriptor vertexDesc(0, 3, 3);
+    Osd::CpuPatchBVH * bvh = Osd::CpuPatchBVH::Create(*patchTable,
+        &positions[0], vertexDesc);
+    if (bvh) {
+        printf("  CpuPatchBVH : table not rejected\n");
+        ++count;
+        delete bvh;
+    }
+    Osd::CpuPatchCuller * culler = Osd::CpuPatchCuller::Create(*patchTable,
+        &positions[0], vertexDesc);
+    if (culler) {
+        printf("  CpuPatchCuller : table not rejected\n");
+        ++count;
+        delete culler;
+    }
+    std::vector<int> triangles;
+    Osd::CpuTessellator::FixedRateMetric fixedRate(4);
+    if (Osd::CpuTessellator::Tessellate(*refiner, *patchTable,
+            &positions[0], vertexDesc, fixedRate, 4, &coords, &triangles)) {
+        printf("  CpuTessellator : table not rejected\n");
+        ++count;
+    }
+
+    delete stencils;
+    delete patchTable;
+    delete refiner;
+    return count;
+}
+
+#ifndef _WIN32
+// Publishes a copy of the bytes of a segment (optionally truncated, with its
+// recorded size patched accordingly) under a new name. An int of the copy
+// can be overwritten at byte 'patchOffset' (no patch if 0).
+static bool
+publishCopy(char const * srcName, char const * dstName, size_t size,
+    size_t patchOffset = 0, int patchValue = 0) {
+
+    int fd = shm_open(srcName, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    fstat(fd, &st);
+    std::vector<char> bytes((size_t)st.st_size);
+    ssize_t numRead = pread(fd, &bytes[0], bytes.size(), 0);
+    close(fd);
+    if (numRead != (ssize_t)bytes.size() or size > bytes.size()) {
+        return false;
+    }
+
+    // the segment size follows the magic, version and pointer size
+    memcpy(&bytes[16], &size, sizeof(size));
+
+    if (patchOffset) {
+        if (patchOffset + sizeof(int) > size) return false;
+        memcpy(&bytes[patchOffset], &patchValue, sizeof(int));
+    }
+
+    fd = shm_open(dstName, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    bool written = pwrite(fd, &bytes[0], size, 0) == (ssize_t)size;
+    close(fd);
+    return written;
+}
+
+// Reads the offset of an array from the header of a segment
+static size_t
+readArrayOffset(char const * name, size_t fieldOffset) {
+
+    size_t offset = 0;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return 0;
+    if (pread(fd, &offset, sizeof(offset), (off_t)fieldOffset) !=
+        (ssize_t)sizeof(offset)) {
+        offset = 0;
+    }
+    close(fd);
+    return offset;
+}
+
+//------------------------------------------------------------------------------
+// Checks that tables published in a shared memory segment evaluate as the Far
+// tables once attached, and that invalid segments are rejected
+static int
+checkSharedTableStore() {
+
+    int count = 0;
+
+    printf("Testing shared table store\n");
+
+    std::vector<float> coarsePositions;
+    Far::StencilTable const * stencils =
+        createStencilTable(catmark_pole64, 2, coarsePositions);
+
+    char name[64], copyName[64];
+    snprintf(name, sizeof(name), "/osd_cpu_regression.%d", (int)getpid());
+    snprintf(copyName, sizeof(copyName), "/osd_cpu_regression.%d.copy",
+        (int)getpid());
+    Osd::CpuSharedTableStore::Unlink(name);
+    Osd::CpuSharedTableStore::Unlink(copyName);
+
+    Osd::CpuSharedTableStore * published =
+        Osd::CpuSharedTableStore::Publish(name, stencils, stencils, NULL);
+    if (not published) {
+        printf("  could not publish %s (skipped)\n", name);
+        delete stencils;
+        return count;
+    }
+
+    // publishing over an existing segment fails
+    Osd::CpuSharedTableStore * duplicate =
+        Osd::CpuSharedTableStore::Publish(name, stencils, NULL, NULL);
+    if (duplicate) {
+        printf("  published over an existing segment\n");
+        delete duplicate;
+        ++count;
+    }
+
+    Osd::CpuSharedTableStore * attached =
+        Osd::CpuSharedTableStore::Attach(name);
+    if (not attached) {
+        printf("  could not attach %s\n", name);
+        ++count;
+    } else {
+        Osd::CpuSharedStencilTable const * shared =
+            attached->GetVertexStencilTable();
+        if (not shared or not attached->GetVaryingStencilTable() or
+            attached->GetPatchTable() or
+            shared->GetNumStencils() != stencils->GetNumStencils() or
+            shared->GetNumControlVertices() !=
+                stencils->GetNumControlVertices() or
+            shared->HasLargeOffsets()) {
+            printf("  attached tables do not match the published tables\n");
+            ++count;
+        } else {
+            float diff = maxDifference(
+                evalPositions(stencils, coarsePositions),
+                evalPositions(shared, coarsePositions));
+            if (diff > PRECISION) {
+                printf("  attached stencils evaluation differs by %f\n",
+                    diff);
+                ++count;
+            }
+        }
+
+        // copies of the segment truncated before the end of its arrays are
+        // rejected, whole copies are accepted
+        size_t size = attached->GetSize();
+        size_t truncatedSizes[] = { size - 4, size/2, 128 };
+        for (int i = 0; i < 3; ++i) {
+            if (not publishCopy(name, copyName, truncatedSizes[i])) {
+                printf("  could not copy %s\n", name);
+                ++count;
+                continue;
+            }
+            Osd::CpuSharedTableStore * truncated =
+                Osd::CpuSharedTableStore::Attach(copyName);
+            if (truncated) {
+                printf("  attached a segment truncated to %d bytes\n",
+                    (int)truncatedSizes[i]);
+                delete truncated;
+                ++count;
+            }
+            Osd::CpuSharedTableStore::Unlink(copyName);
+        }
+
+        if (publishCopy(name, copyName, size)) {
+            Osd::CpuSharedTableStore * copy =
+                Osd::CpuSharedTableStore::Attach(copyName);
+            if (not copy) {
+                printf("  could not attach a copy of the segment\n");
+                ++count;
+            }
+            delete copy;
+            Osd::CpuSharedTableStore::Unlink(copyName);
+        }
+
+        // copies with a corrupted header or vertex stencils are rejected :
+        // the vertex stencil section follows the segment size, and locates
+        // its offsets and indices at bytes 56 and 64 of the header
+        size_t offsets = readArrayOffset(name, 56),
+               indices = readArrayOffset(name, 64);
+        int numControlVertices = stencils->GetNumControlVertices(),
+            numWeights = (int)stencils->GetControlIndices().size();
+
+        struct Corruption {
+            char const * name;
+            size_t offset;
+            int value;
+        } corruptions[] = {
+            { "unpublished", 8, 0 },
+            { "non contiguous offsets", offsets + sizeof(int),
+                stencils->GetOffsets()[1] + 1 },
+            { "out of range index", indices, numControlVertices },
+            { "negative index", indices + (numWeights-1)*sizeof(int), -1 } };
+
+        for (int i = 0; i < 4; ++i) {
+            if (not offsets or not indices or
+                not publishCopy(name, copyName, size,
+                    corruptions[i].offset, corruptions[i].value)) {
+                printf("  could not copy %s\n", name);
+                ++count;
+                continue;
+            }
+            Osd::CpuSharedTableStore * corrupted =
+                Osd::CpuSharedTableStore::Attach(copyName);
+            if (corrupted) {
+                printf("  attached a segment with %s\n",
+                    corruptions[i].name);
+                delete corrupted;
+                ++count;
+            }
+            Osd::CpuSharedTableStore::Unlink(copyName);
+        }
+        delete attached;
+    }
+
+    delete published;
+    Osd::CpuSharedTableStore::Unlink(name);
+
+    // unlinked segments can no longer be attached
+    attached = Osd::CpuSharedTableStore::Attach(name);
+    if (attached) {
+        printf("  attached an unlinked segment\n");
+        delete attached;
+        ++count;
+    }
+
+    delete stencils;
+    return count;
+}
+#endif
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+//------------------------------------------------------------------------------
+// Cost of the stencils in [first, last) balanced by the partitions : their
+// number of weights, plus 2 per stencil (clearing and copying the result)
+static int
+getCost(Far::StencilTable const & stencils, int first, int last) {
+
+    if (first == last) return 0;
+    return stencils.GetOffsets()[last-1] + stencils.GetSizes()[last-1] -
+        stencils.GetOffsets()[first] + 2*(last - first);
+}
+
+//------------------------------------------------------------------------------
+// Checks the partitions of an OmpStencilTable for a simulated NUMA topology
+// and its evaluation against the CpuEvaluator
+static int
+checkOmpStencilTable(char const * name, Far::StencilTable const & stencils,
+    std::vector<float> const & coarsePositions, int numNodes,
+    int numThreadsPerNode) {
+
+    int count = 0;
+
+    Osd::OmpNumaTopology topology(numNodes, numThreadsPerNode);
+    Osd::OmpStencilTable table(&stencils, topology);
+
+    int numStencils = stencils.GetNumStencils(),
+        numPartitions = table.GetNumPartitions();
+
+    if (numPartitions != topology.GetNumThreads()) {
+        printf("  %s (%d nodes x %d threads) : %d partitions\n",
+            name, numNodes, numThreadsPerNode, numPartitions);
+        return 1;
+    }
+
+    if (table.GetPartitionBegin(0) != 0 or
+        table.GetPartitionBegin(numPartitions) != numStencils) {
+        printf("  %s (%d nodes x %d threads) : partitions do not cover "
+            "the stencils\n", name, numNodes, numThreadsPerNode);
+        ++count;
+    }
+
+    // ranges are split in at most one chunk per stencil, and the cost of a
+    // single stencil bounds the imbalance of a chunk
+    int maxCost = 0;
+    for (int i = 0; i < numStencils; ++i) {
+        maxCost = std::max(maxCost, getCost(stencils, i, i+1) + 1);
+    }
+    int totalCost = getCost(stencils, 0, numStencils);
+
+    for (int node = 0; node < numNodes; ++node) {
+
+        int nodeBegin = table.GetNodeBegin(node),
+            nodeEnd = table.GetNodeBegin(node+1);
+
+        if (nodeBegin != table.GetPartitionBegin(node*numThreadsPerNode)) {
+            printf("  %s (%d nodes x %d threads) : node %d begins at %d\n",
+                name, numNodes, numThreadsPerNode, node, nodeBegin);
+            ++count;
+        }
+
+        int nodeCost = getCost(stencils, nodeBegin, nodeEnd);
+        int maxNodeCost = totalCost/std::min(numNodes, numStencils) + maxCost;
+        if (nodeCost > maxNodeCost) {
+            printf("  %s (%d nodes x %d threads) : node %d costs %d out "
+                "of %d\n", name, numNodes, numThreadsPerNode, node,
+                nodeCost, totalCost);
+            ++count;
+        }
+
+        // the ranges of the threads of a node stay within the node range
+        for (int i = 0; i < numThreadsPerNode; ++i) {
+
+            int partition = node*numThreadsPerNode + i,
+                first = table.GetPartitionBegin(partition),
+                last = table.GetPartitionBegin(partition+1);
+
+            if (table.GetPartitionNode(partition) != node or
+                first < nodeBegin or last > nodeEnd or first > last) {
+                printf("  %s (%d nodes x %d threads) : partition %d "
+                    "[%d, %d) is outside of node %d [%d, %d)\n", name,
+                    numNodes, numThreadsPerNode, partition, first, last,
+                    node, nodeBegin, nodeEnd);
+                ++count;
+                continue;
+            }
+
+            int numChunks = std::min(numThreadsPerNode, nodeEnd-nodeBegin),
+                cost = getCost(stencils, first, last);
+            if (cost > nodeCost/std::max(numChunks, 1) + maxCost) {
+                printf("  %s (%d nodes x %d threads) : partition %d costs %d "
+                    "out of %d\n", name, numNodes, numThreadsPerNode,
+                    partition, cost, nodeCost);
+                ++count;
+            }
+        }
+    }
+
+    // evaluation, with and without first-touch of the destination
+    Osd::BufferDescriptor desc(0, 3, 3);
+
+    std::vector<float> reference(numStencils*3),
+                       result(numStencils*3);
+
+    Osd::CpuEvaluator::EvalStencils(&coarsePositions[0], desc,
+        &reference[0], desc,
+        &stencils.GetSizes()[0], &stencils.GetOffsets()[0],
+        &stencils.GetControlIndices()[0], &stencils.GetWeights()[0],
+        0, numStencils);
+
+    for (int firstTouch = 0; firstTouch < 2; ++firstTouch) {
+
+        std::fill(result.begin(), result.end(), -1.0f);
+        if (firstTouch) {
+            Osd::OmpEvaluator::FirstTouch(&result[0], desc, &table);
+        }
+        Osd::OmpEvaluator::EvalStencils(&coarsePositions[0], desc,
+            &result[0], desc, &table);
+
+        float diff = maxDifference(reference, result);
+        if (diff > PRECISION) {
+            printf("  %s (%d nodes x %d threads) : evaluation differs "
+                "by %f\n", name, numNodes, numThreadsPerNode, diff);
+            ++count;
+        }
+    }
+    return count;
+}
+
+static int
+checkOmpStencilTable() {
+
+    int count = 0;
+
+    printf("Testing OmpStencilTable\n");
+
+    static int const topologies[][2] = {
+        { 1, 1 }, { 1, 4 }, { 2, 2 }, { 4, 1 }, { 3, 3 }, { 8, 8 } };
+    static int const numTopologies = sizeof(topologies)/sizeof(topologies[0]);
+
+    struct TestShape {
+        char const * name;
+        std::string const * shapeStr;
+        int level;
+    } shapes[] = { { "catmark_cube", &catmark_cube, 1 },
+                   { "catmark_pole64", &catmark_pole64, 3 } };
+
+    for (int i = 0; i < (int)(sizeof(shapes)/sizeof(shapes[0])); ++i) {
+
+        std::vector<float> coarsePositions;
+        Far::StencilTable const * stencils = createStencilTable(
+            *shapes[i].shapeStr, shapes[i].level, coarsePositions);
+
+        for (int j = 0; j < numTopologies; ++j) {
+            count += checkOmpStencilTable(shapes[i].name, *stencils,
+                coarsePositions, topologies[j][0], topologies[j][1]);
+        }
+        delete stencils;
+    }
+
+    // tables with large offsets are rejected (a synthetic table only locates
+    // its stencils : none of them can be evaluated)
+    std::vector<int> sizes(2, INT_MAX/2 + 1);
+    SyntheticStencilTable largeStencils(8, sizes);
+
+    Osd::OmpStencilTable * rejected =
+        Osd::OmpStencilTable::Create(&largeStencils);
+    if (rejected) {
+        printf("  created a table with large offsets\n");
+        delete rejected;
+        ++count;
+    }
+
+    Osd::OmpStencilTable emptyTable(&largeStencils, Osd::OmpNumaTopology(2, 2));
+    if (emptyTable.GetNumStencils() != 0 or emptyTable.GetOffsetsBuffer()) {
+        printf("  constructed a table with large offsets\n");
+        ++count;
+    } else {
+        std::vector<float> const src(8*3, 1.0f);
+        std::vector<float> dst(8*3, -1.0f);
+        Osd::BufferDescriptor desc(0, 3, 3);
+        Osd::OmpEvaluator::EvalStencils(&src[0], desc, &dst[0], desc,
+            &emptyTable);
+        if (dst != std::vector<float>(8*3, -1.0f)) {
+            printf("  evaluated a table with large offsets\n");
+            ++count;
+        }
+    }
+    return count;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Osd::Mesh binds its buffers as VBOs : CPU stand-ins for the GL buffer and
+// patch table types
+class TestVertexBuffer : public Osd::CpuVertexBuffer {
+public:
+    static TestVertexBuffer * Create(int numElements, int numVertices,
+        void * /*deviceContext*/ = NULL) {
+        return new TestVertexBuffer(numElements, numVertices);
+    }
+    float * BindVBO(void * /*deviceContext*/ = NULL) {
+        return BindCpuBuffer();
+    }
+private:
+    TestVertexBuffer(int numElements, int numVertices) :
+        Osd::CpuVertexBuffer(numElements, numVertices) { }
+};
+
+class TestPatchTable : public Osd::CpuPatchTable {
+public:
+    typedef float * VertexBufferBinding;
+
+    static TestPatchTable * Create(Far::PatchTable const * patchTable,
+        void * /*deviceContext*/ = NULL) {
+        return new TestPatchTable(patchTable);
+    }
+private:
+    explicit TestPatchTable(Far::PatchTable const * patchTable) :
+        Osd::CpuPatchTable(patchTable) { }
+};
+
+#ifdef OPENSUBDIV_HAS_TBB
+//------------------------------------------------------------------------------
+// Queues the two evaluations of a batch : the first one is overwritten by the
+// second one if they run in submission order
+static void
+queueBatch(Osd::TbbEvalQueue & queue, Far::StencilTable const & stencils,
+    float const * first, float const * second, float * dst) {
+
+    Osd::BufferDescriptor desc(0, 3, 3);
+
+    float const * sources[2] = { first, second };
+    for (int i = 0; i < 2; ++i) {
+        Osd::TbbEvaluator::EvalStencils(sources[i], desc, dst, desc,
+            &stencils.GetSizes()[0], &stencils.GetOffsets()[0],
+            &stencils.GetControlIndices()[0], &stencils.GetWeights()[0],
+            0, stencils.GetNumStencils(), &queue);
+    }
+}
+
+//------------------------------------------------------------------------------
+// TbbEvalQueue : the evaluations of a batch run in submission order and are
+// complete once the batch is waited for (Submit() waiting for the batch that
+// reuses its slot), and an Osd::Mesh using the queue as its device context
+// matches the CPU evaluation after Synchronize()
+static int
+checkTbbEvalQueue() {
+
+    int count = 0;
+
+    printf("Testing TbbEvalQueue\n");
+
+    std::vector<float> coarsePositions;
+    Far::StencilTable const * stencils =
+        createStencilTable(catmark_pole64, 3, coarsePositions);
+
+    int numStencils = stencils->GetNumStencils();
+
+    Osd::BufferDescriptor desc(0, 3, 3);
+
+    // each batch evaluates its own (scaled) positions
+    int numFences = 3,
+        numBatches = 3*numFences + 1;
+
+    std::vector< std::vector<float> > sources(numBatches),
+        references(numBatches),
+        results(numBatches, std::vector<float>(numStencils*3, -1.0f));
+
+    for (int batch = 0; batch < numBatches; ++batch) {
+        sources[batch] = coarsePositions;
+        for (size_t i = 0; i < sources[batch].size(); ++i) {
+            sources[batch][i] *= (float)(batch + 1);
+        }
+        references[batch].resize(numStencils*3);
+        Osd::CpuEvaluator::EvalStencils(&sources[batch][0], desc,
+            &references[batch][0], desc,
+            &stencils->GetSizes()[0], &stencils->GetOffsets()[0],
+            &stencils->GetControlIndices()[0], &stencils->GetWeights()[0],
+            0, numStencils);
+    }
+
+    Osd::TbbEvalQueue queue(numFences);
+
+    std::vector<int> fences(numBatches);
+    for (int batch = 0; batch < numBatches; ++batch) {
+
+        queueBatch(queue, *stencils, &sources[(batch+1)%numBatches][0],
+            &sources[batch][0], &results[batch][0]);
+
+        fences[batch] = queue.Submit();
+        if (fences[batch] != batch) {
+            printf("  batch %d : fence %d\n", batch, fences[batch]);
+            ++count;
+        }
+
+        // the batch of the slot reused by the next one is complete
+        int completed = batch + 1 - numFences;
+        if (completed >= 0) {
+            float diff = maxDifference(references[completed],
+                results[completed]);
+            if (diff > PRECISION) {
+                printf("  batch %d differs by %f after Submit()\n",
+                    completed, diff);
+                ++count;
+            }
+        }
+    }
+
+    // waiting for a fence completes the batches submitted before it
+    queue.Wait(fences[numBatches-1]);
+    for (int batch = 0; batch < numBatches; ++batch) {
+        float diff = maxDifference(references[batch], results[batch]);
+        if (diff > PRECISION) {
+            printf("  batch %d differs by %f after Wait()\n", batch, diff);
+            ++count;
+        }
+    }
+
+    // an open batch is drained by Finish()
+    std::fill(results[0].begin(), results[0].end(), -1.0f);
+    queueBatch(queue, *stencils, &sources[1][0], &sources[0][0],
+        &results[0][0]);
+    queue.Finish();
+    if (maxDifference(references[0], results[0]) > PRECISION) {
+        printf("  open batch not drained by Finish()\n");
+        ++count;
+    }
+    delete stencils;
+
+    // Osd::Mesh : Refine() is queued, Synchronize() waits for it
+    typedef Osd::Mesh<TestVertexBuffer, Far::StencilTable,
+        Osd::TbbEvaluator, TestPatchTable, Osd::TbbEvalQueue> TbbMesh;
+    typedef Osd::Mesh<TestVertexBuffer, Far::StencilTable,
+        Osd::CpuEvaluator, TestPatchTable> CpuMesh;
+
+    Osd::MeshBitset bits;
+    bits.set(Osd::MeshAdaptive, true);
+    bits.set(Osd::MeshEndCapGregoryBasis, true);
+
+    std::vector<float> torusPositions;
+    TbbMesh tbbMesh(createRefiner(catmark_torus, kCatmark, torusPositions),
+        3, 0, 2, bits, NULL, &queue);
+    CpuMesh cpuMesh(createRefiner(catmark_torus, kCatmark, torusPositions),
+        3, 0, 2, bits);
+
+    int numCoarseVerts = (int)torusPositions.size()/3;
+    for (int frame = 0; frame < 2*numFences; ++frame) {
+
+        for (size_t i = 0; i < torusPositions.size(); ++i) {
+            torusPositions[i] *= 1.5f;
+        }
+
+        tbbMesh.UpdateVertexBuffer(&torusPositions[0], 0, numCoarseVerts);
+        tbbMesh.Refine();
+        tbbMesh.Synchronize();
+
+        cpuMesh.UpdateVertexBuffer(&torusPositions[0], 0, numCoarseVerts);
+        cpuMesh.Refine();
+
+        int numVerts = cpuMesh.GetNumVertices();
+        float const * tbbVerts = tbbMesh.GetVertexBuffer()->BindCpuBuffer(),
+                    * cpuVerts = cpuMesh.GetVertexBuffer()->BindCpuBuffer();
+
+        std::vector<float> a(tbbVerts, tbbVerts + numVerts*3),
+                           b(cpuVerts, cpuVerts + numVerts*3);
+        if (tbbMesh.GetNumVertices() != numVerts or
+            maxDifference(a, b) > PRECISION) {
+            printf("  frame %d : queued Mesh differs from the CPU Mesh\n",
+                frame);
+            ++count;
+        }
+    }
+    return count;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Refines the control points stored at the front of a CpuVertexBuffer in place
+static void
+refineInPlace(Osd::CpuVertexBuffer * buffer,
+    Far::StencilTable const & stencils, int numCoarseVerts) {
+
+    buffer->UpdateData(buffer->BindCpuBuffer(), 0, numCoarseVerts);
+
+    Osd::CpuEvaluator::EvalStencils(
+        buffer, Osd::BufferDescriptor(0, 3, 3),
+        buffer, Osd::BufferDescriptor(numCoarseVerts*3, 3, 3), &stencils);
+}
+
+// Checks CpuVertexBuffers wrapping client memory : the memory is refined in
+// place, can be rebound and is not released with the buffer. The client
+// storage starts past the front of its allocation, so releasing it with the
+// buffer would abort the test.
+static int
+checkAdoptedBuffers() {
+
+    int count = 0;
+
+    printf("Testing adopted vertex buffers\n");
+
+    std::vector<float> coarsePositions;
+    Far::StencilTable const * stencils =
+        createStencilTable(catmark_cube, 3, coarsePositions);
+
+    int numCoarseVerts = (int)coarsePositions.size()/3,
+        numVerts = numCoarseVerts + stencils->GetNumStencils(),
+        numFloats = numVerts*3;
+
+    // reference : refinement of a buffer owning its storage
+    Osd::CpuVertexBuffer * owned = Osd::CpuVertexBuffer::Create(3, numVerts);
+    owned->UpdateData(&coarsePositions[0], 0, numCoarseVerts);
+    refineInPlace(owned, *stencils, numCoarseVerts);
+    std::vector<float> reference(owned->BindCpuBuffer(),
+        owned->BindCpuBuffer() + numFloats);
+
+    if (Osd::CpuVertexBuffer::Create(NULL, 3, numVerts)) {
+        printf("  Create : NULL memory was wrapped\n");
+        ++count;
+    }
+
+    // client memory guarded by a sentinel on each side
+    float const sentinel = -123.0f;
+    std::vector<float> memory0(numFloats+2, sentinel),
+                       memory1(numFloats+2, sentinel);
+    float * storage0 = &memory0[1],
+          * storage1 = &memory1[1];
+
+    std::copy(coarsePositions.begin(), coarsePositions.end(), storage0);
+    std::copy(coarsePositions.begin(), coarsePositions.end(), storage1);
+
+    Osd::CpuVertexBuffer * adopted =
+        Osd::CpuVertexBuffer::Create(storage0, 3, numVerts);
+    if (adopted == NULL or adopted->BindCpuBuffer() != storage0 or
+        adopted->GetNumElements() != 3 or
+        adopted->GetNumVertices() != numVerts) {
+        printf("  Create : client memory is not wrapped\n");
+        delete adopted;
+        delete owned;
+        delete stencils;
+        return count + 1;
+    }
+
+    // UpdateData from the buffer memory itself is a no-op
+    adopted->UpdateData(storage0, 0, numCoarseVerts);
+    if (not std::equal(coarsePositions.begin(), coarsePositions.end(),
+        storage0)) {
+        printf("  UpdateData : in place control points were modified\n");
+        ++count;
+    }
+
+    refineInPlace(adopted, *stencils, numCoarseVerts);
+    if (not std::equal(reference.begin(), reference.end(), storage0)) {
+        printf("  adopted buffer : refinement in place differs\n");
+        ++count;
+    }
+
+    // rebinding : the next "frame" is refined in its own memory, the previous
+    // one is left untouched
+    storage0[0] = sentinel;
+    adopted->SetCpuBuffer(storage1);
+    refineInPlace(adopted, *stencils, numCoarseVerts);
+    if (adopted->BindCpuBuffer() != storage1 or
+        not std::equal(reference.begin(), reference.end(), storage1)) {
+        printf("  SetCpuBuffer : rebound buffer refinement differs\n");
+        ++count;
+    }
+    if (storage0[0] != sentinel or
+        not std::equal(reference.begin()+1, reference.end(), storage0+1)) {
+        printf("  SetCpuBuffer : previous memory was modified\n");
+        ++count;
+    }
+
+    // rebinding a buffer owning its storage releases that storage only
+    owned->SetCpuBuffer(storage0);
+    if (owned->BindCpuBuffer() != storage0) {
+        printf("  SetCpuBuffer : owned buffer was not rebound\n");
+        ++count;
+    }
+
+    delete adopted;
+    delete owned;
+
+    // the client memory outlives the buffers, untouched
+    if (memory0.front() != sentinel or memory0.back() != sentinel or
+        memory1.front() != sentinel or memory1.back() != sentinel or
+        not std::equal(reference.begin(), reference.end(), storage1)) {
+        printf("  client memory was modified by the buffer destruction\n");
+        ++count;
+    }
+
+    delete stencils;
+    return count;
+}
+
+//------------------------------------------------------------------------------
+typedef Osd::Mesh<TestVertexBuffer, Far::StencilTable,
+    Osd::CpuEvaluator, TestPatchTable> SharedTableMesh;
+
+// Refines the control points scaled by 'scale' : the results are scaled
+// exactly by powers of 2
+static bool
+refineMatches(SharedTableMesh & mesh,
+    std::vector<float> const & coarsePositions,
+    std::vector<float> const & reference, float scale) {
+
+    std::vector<float> positions(coarsePositions);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i] *= scale;
+    }
+    mesh.UpdateVertexBuffer(&positions[0], 0, (int)positions.size()/3);
+    mesh.Refine();
+
+    float const * result = mesh.GetVertexBuffer()->BindCpuBuffer();
+    for (size_t i = 0; i < reference.size(); ++i) {
+        if (result[i] != reference[i]*scale) return false;
+    }
+    return true;
+}
+
+// Checks meshes sharing the tables of a source mesh : the tables must stay
+// valid whichever mesh is deleted first, including meshes created and
+// deleted concurrently
+static int
+checkSharedMeshTables() {
+
+    int count = 0;
+
+    printf("Testing meshes sharing tables\n");
+
+    Osd::MeshBitset bits;
+    bits.set(Osd::MeshAdaptive, true);
+    bits.set(Osd::MeshEndCapGregoryBasis, true);
+
+    int const level = 2;
+
+    std::vector<float> coarsePositions;
+
+    // reference evaluation of a mesh owning its tables
+    SharedTableMesh * source = new SharedTableMesh(
+        createRefiner(catmark_torus, kCatmark, coarsePositions),
+        3, 0, level, bits);
+
+    source->UpdateVertexBuffer(&coarsePositions[0], 0,
+        (int)coarsePositions.size()/3);
+    source->Refine();
+
+    float const * sourceData = source->GetVertexBuffer()->BindCpuBuffer();
+    std::vector<float> reference(sourceData,
+        sourceData + source->GetNumVertices()*3);
+
+    // instances outliving their source
+    SharedTableMesh * instance0 = new SharedTableMesh(*source, 3, 0);
+    SharedTableMesh * instance1 = new SharedTableMesh(*source, 3, 0);
+    delete source;
+
+    if (not refineMatches(*instance0, coarsePositions, reference, 2.0f) or
+        not refineMatches(*instance1, coarsePositions, reference, 4.0f)) {
+        printf("  instances differ after deleting the source\n");
+        ++count;
+    }
+    delete instance0;
+
+    if (not refineMatches(*instance1, coarsePositions, reference, 0.5f)) {
+        printf("  instance differs after deleting a sibling\n");
+        ++count;
+    }
+
+    // source outliving its instances
+    source = new SharedTableMesh(*instance1, 3, 0);
+    delete instance1;
+
+    instance0 = new SharedTableMesh(*source, 3, 0);
+    delete instance0;
+
+    if (not refineMatches(*source, coarsePositions, reference, 1.0f)) {
+        printf("  source differs after deleting its instances\n");
+        ++count;
+    }
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    // instances created, evaluated and deleted concurrently
+    int const numInstances = 64;
+    std::vector<SharedTableMesh *> instances(numInstances);
+
+    #pragma omp parallel for
+    for (int i = 0; i < numInstances; ++i) {
+        instances[i] = new SharedTableMesh(*source, 3, 0);
+    }
+    delete source;
+
+    int numMismatches = 0;
+    #pragma omp parallel for reduction(+:numMismatches)
+    for (int i = 0; i < numInstances; ++i) {
+        if (not refineMatches(*instances[i], coarsePositions, reference,
+            (float)(1 << (i%8)))) {
+            ++numMismatches;
+        }
+        delete instances[i];
+    }
+    if (numMismatches) {
+        printf("  %d concurrent instances differ\n", numMismatches);
+        ++count;
+    }
+#else
+    delete source;
+#endif
+    return count;
+}
+
+//------------------------------------------------------------------------------
+static void
+silentErrorCallback(Far::ErrorType, const char *) { }
+
+//------------------------------------------------------------------------------
+int main(int /* argc */, char ** /* argv */) {
+
+    // some of the tests expect errors to be reported
+    Far::SetErrorCallback(silentErrorCallback);
+
+    int total = 0;
+
+    printf("precision : %f\n", PRECISION);
+
+    total += checkFusedStencils();
+
+    total += checkTessellator();
+
+    total += checkPatchBVH();
+
+    total += checkPatchCuller();
+
+    total += checkExtraordinaryEndCaps();
+
+    total += checkEvalPatchesBezier();
+
+    total += checkEvalPatchesFaceVarying();
+
+    total += checkEvalPatchesVarying();
+
+    total += checkAdoptedBuffers();
+
+    total += checkSharedMeshTables();
+
+#ifndef _WIN32
+    total += checkSharedTableStore();
+#endif
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    total += checkOmpStencilTable();
+#endif
+
+#ifdef OPENSUBDIV_HAS_TBB
+    total += checkTbbEvalQueue();
+#endif
+
+    if (total==0) {
+        printf("All tests passed.\n");
+    } else {
+        printf("Total failures : %d\n", total);
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------
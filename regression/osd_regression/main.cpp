@@ -45,10 +45,18 @@ GLFWwindow* g_window=0;
 
 #include <stdio.h>
 #include <cassert>
+#include <climits>
+#include <cstring>
 
 #include <osd/cpuEvaluator.h>
 #include <osd/cpuVertexBuffer.h>
 #include <osd/cpuGLVertexBuffer.h>
+#ifdef OPENSUBDIV_HAS_GLSL_TRANSFORM_FEEDBACK
+    #include <osd/glXFBEvaluator.h>
+#endif
+#ifdef OPENSUBDIV_HAS_GLSL_COMPUTE
+    #include <osd/glComputeEvaluator.h>
+#endif
 #include <far/stencilTableFactory.h>
 
 #include "../common/cmp_utils.h"
@@ -74,12 +82,14 @@ using namespace OpenSubdiv;
 enum BackendType {
     kBackendCPU   = 0, // raw CPU
     kBackendCPUGL = 1, // CPU with GL-backed buffer
+    kBackendCPUGLAdopted = 2, // CPU with GL-backed buffer wrapping client memory
     kBackendCount
 };
 
 static const char* g_BackendNames[kBackendCount] = {
     "CPU",
     "CPUGL",
+    "CPUGL_ADOPTED",
 };
 
 static int g_Backend = -1;
@@ -322,6 +332,90 @@ checkMeshCPUGL(FarTopologyRefiner *refiner,
     return result;
 }
 
+//------------------------------------------------------------------------------
+// The buffer wraps client memory : the control points are written in place,
+// the memory is rebound to a second frame and must outlive the buffer. The
+// client storage starts past the front of its allocation, so releasing it
+// with the buffer would abort the test.
+static int
+checkMeshCPUGLAdopted(FarTopologyRefiner *refiner,
+                      const std::vector<xyzVV>& coarseverts,
+                      xyzmesh * refmesh) {
+
+    Far::StencilTable const *vertexStencils;
+    Far::StencilTable const *varyingStencils;
+    buildStencilTable(*refiner, &vertexStencils, &varyingStencils);
+
+    int numCoarseVerts = (int)coarseverts.size(),
+        numVerts = refiner->GetNumVerticesTotal(),
+        numFloats = numVerts * 3;
+
+    float const sentinel = -123.0f;
+    std::vector<float> memory0(numFloats+2, sentinel),
+                       memory1(numFloats+2, sentinel);
+    float * storage0 = &memory0[1],
+          * storage1 = &memory1[1];
+
+    for (int i=0; i<numCoarseVerts; ++i) {
+        memcpy(storage0 + i*3, coarseverts[i].GetPos(), 3*sizeof(float));
+    }
+    memcpy(storage1, storage0, numCoarseVerts*3*sizeof(float));
+
+    Osd::CpuGLVertexBuffer *vb =
+        Osd::CpuGLVertexBuffer::Create(storage0, 3, numVerts);
+
+    int result = 0;
+
+    // frame 0 : control points written in place, UpdateData is a no-op
+    vb->UpdateData(storage0, 0, numCoarseVerts);
+    if (vb->BindCpuBuffer() != storage0) {
+        printf("// adopted buffer does not wrap the client memory\n");
+        ++result;
+    }
+
+    Osd::CpuEvaluator::EvalStencils(
+        vb, Osd::BufferDescriptor(0, 3, 3),
+        vb, Osd::BufferDescriptor(numCoarseVerts*3, 3, 3),
+        vertexStencils);
+
+    result += checkVertexBuffer(*refiner, refmesh, storage0, 3);
+
+    // frame 1 : rebound memory, the VBO must be refreshed from it
+    vb->BindVBO();
+    vb->SetCpuBuffer(storage1);
+
+    Osd::CpuEvaluator::EvalStencils(
+        vb, Osd::BufferDescriptor(0, 3, 3),
+        vb, Osd::BufferDescriptor(numCoarseVerts*3, 3, 3),
+        vertexStencils);
+
+    result += checkVertexBuffer(*refiner, refmesh, storage1, 3);
+
+    std::vector<float> vboData(numFloats);
+    glBindBuffer(GL_ARRAY_BUFFER, vb->BindVBO());
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, numFloats*sizeof(float),
+        &vboData[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (memcmp(&vboData[0], storage1, numFloats*sizeof(float))) {
+        printf("// VBO was not updated from the rebound memory\n");
+        ++result;
+    }
+
+    delete vertexStencils;
+    delete varyingStencils;
+    delete vb;
+
+    // the client memory outlives the buffer
+    if (memory0.front() != sentinel or memory0.back() != sentinel or
+        memory1.front() != sentinel or memory1.back() != sentinel or
+        memcmp(storage0, storage1, numFloats*sizeof(float))) {
+        printf("// client memory was modified by the buffer destruction\n");
+        ++result;
+    }
+
+    return result;
+}
+
 //------------------------------------------------------------------------------
 static int 
 checkMesh( char const * msg, std::string const & shape, int levels, Scheme scheme, int backend ) {
@@ -346,6 +440,9 @@ checkMesh( char const * msg, std::string const & shape, int levels, Scheme schem
         case kBackendCPUGL: 
             result = checkMeshCPUGL(refiner, farVertexData, refmesh); 
             break;
+        case kBackendCPUGLAdopted:
+            result = checkMeshCPUGLAdopted(refiner, farVertexData, refmesh);
+            break;
     }
 
     delete refmesh;
@@ -564,6 +661,41 @@ int checkBackend(int backend, int levels) {
     return total;
 }
 
+//------------------------------------------------------------------------------
+// The GL stencil tables only support 32-bit offsets : tables with large
+// offsets must be rejected (a synthetic table only locates its stencils)
+static int
+checkLargeStencilTables() {
+
+    printf("*** checking large stencil tables\n");
+
+    int count = 0;
+
+    std::vector<int> sizes(2, INT_MAX/2 + 1);
+    SyntheticStencilTable largeStencils(8, sizes);
+
+#ifdef OPENSUBDIV_HAS_GLSL_TRANSFORM_FEEDBACK
+    if (Osd::GLStencilTableTBO * table =
+        Osd::GLStencilTableTBO::Create(&largeStencils)) {
+        printf("// GLStencilTableTBO created with large offsets\n");
+        delete table;
+        ++count;
+    }
+#endif
+#ifdef OPENSUBDIV_HAS_GLSL_COMPUTE
+    if (Osd::GLStencilTableSSBO * table =
+        Osd::GLStencilTableSSBO::Create(&largeStencils)) {
+        printf("// GLStencilTableSSBO created with large offsets\n");
+        delete table;
+        ++count;
+    }
+#endif
+
+    if (count==0)
+        printf("  success !\n");
+    return count;
+}
+
 //------------------------------------------------------------------------------
 static void
 usage(char ** argv) {
@@ -666,6 +798,8 @@ main(int argc, char ** argv) {
         total += checkBackend (g_Backend, levels);
     }
 
+    total += checkLargeStencilTables();
+
     glfwTerminate();
 
     if (total==0)
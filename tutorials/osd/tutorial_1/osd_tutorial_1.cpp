@@ -0,0 +1,308 @@
+//
+//   Copyright 2015 Pixar
+//
+//   Licensed under the Apache License, Version 2.0 (the "Apache License")
+//   with the following modification; you may not use this file except in
+//   compliance with the Apache License and the following modification to it:
+//   Section 6. Trademarks. is deleted and replaced with:
+//
+//   6. Trademarks. This License does not grant permission to use the trade
+//      names, trademarks, service marks, or product names of the Licensor
+//      and its affiliates, except as required to comply with Section 4(c) of
+//      the License and to reproduce the content of the NOTICE file.
+//
+//   You may obtain a copy of the Apache License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the Apache License with the above modification is
+//   distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+//   KIND, either express or implied. See the Apache License for the specific
+//   language governing permissions and limitations under the Apache License.
+//
+
+
+
+//------------------------------------------------------------------------------
+// Tutorial description:
+//
+// This tutorial intersects rays with the limit surface of an animated mesh
+// using Osd::CpuPatchBVH, and reports the time spent updating the vertices
+// with EvalStencils(), refitting the hierarchy and tracing the rays, for each
+// frame.
+//
+// Usage : osd_tutorial_1 [resolution] [frames]
+//
+
+#if defined(_WIN32)
+    #include <windows.h>
+#endif
+
+#include <opensubdiv/far/topologyDescriptor.h>
+#include <opensubdiv/far/stencilTableFactory.h>
+#include <opensubdiv/far/patchTableFactory.h>
+#include <opensubdiv/osd/cpuEvaluator.h>
+#include <opensubdiv/osd/cpuPatchBVH.h>
+#include <opensubdiv/osd/cpuVertexBuffer.h>
+
+#include <examples/common/stopwatch.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace OpenSubdiv;
+
+//------------------------------------------------------------------------------
+// Torus geometry : 'g_ringSegments' rings of 'g_tubeSegments' quads, with a
+// few triangles whose extraordinary vertices generate Gregory end-cap patches
+
+static int const g_ringSegments = 48,
+                 g_tubeSegments = 16;
+
+static float const g_ringRadius = 1.0f,
+                   g_tubeRadius = 0.35f;
+
+static void createTorus(std::vector<float> & positions,
+    std::vector<int> & vertsPerFace, std::vector<int> & vertIndices);
+
+static void animateTorus(std::vector<float> const & positions, float time,
+    float * animated);
+
+static Far::TopologyRefiner * createTopologyRefiner(
+    std::vector<int> const & vertsPerFace,
+    std::vector<int> const & vertIndices, int maxlevel);
+
+//------------------------------------------------------------------------------
+int main(int argc, char ** argv) {
+
+    int resolution = argc > 1 ? atoi(argv[1]) : 512,
+        nframes = argc > 2 ? atoi(argv[2]) : 10,
+        maxlevel = 3;
+
+    std::vector<float> positions;
+    std::vector<int> vertsPerFace, vertIndices;
+    createTorus(positions, vertsPerFace, vertIndices);
+
+    int nCoarseVerts = (int)positions.size() / 3;
+
+    //
+    // Setup phase
+    //
+    Far::StencilTable const * stencilTable = NULL;
+    Far::PatchTable const * patchTable = NULL;
+    {
+        Far::TopologyRefiner * refiner =
+            createTopologyRefiner(vertsPerFace, vertIndices, maxlevel);
+
+        // Stencils for the refined vertices of all the levels, which are
+        // indexed by the patches
+        Far::StencilTableFactory::Options options;
+        options.generateOffsets = true;
+        options.generateIntermediateLevels = true;
+
+        stencilTable = Far::StencilTableFactory::Create(*refiner, options);
+
+        Far::PatchTableFactory::Options patchOptions(maxlevel);
+        patchOptions.SetEndCapType(
+            Far::PatchTableFactory::Options::ENDCAP_GREGORY_BASIS);
+
+        patchTable = Far::PatchTableFactory::Create(*refiner, patchOptions);
+
+        // Append the stencils of the local points of the end-caps
+        if (Far::StencilTable const * localPointStencilTable =
+            patchTable->GetLocalPointStencilTable()) {
+            Far::StencilTable const * table =
+                Far::StencilTableFactory::AppendLocalPointStencilTable(
+                    *refiner, stencilTable, localPointStencilTable);
+            delete stencilTable;
+            stencilTable = table;
+        }
+
+        delete refiner;
+    }
+
+    int nRefinedVerts = stencilTable->GetNumStencils();
+
+    Osd::CpuVertexBuffer * vbuffer =
+        Osd::CpuVertexBuffer::Create(3, nCoarseVerts + nRefinedVerts);
+
+    Osd::BufferDescriptor srcDesc(0, 3, 3),
+                          dstDesc(nCoarseVerts*3, 3, 3);
+
+    // Primary rays of a pinhole camera looking at the torus
+    int nrays = resolution * resolution;
+
+    std::vector<float> origins(3*nrays), directions(3*nrays);
+    {
+        float const eye[3] = { 0.0f, -3.0f, 2.0f },
+                    fov = 0.6f;
+
+        for (int y=0; y<resolution; ++y) {
+            for (int x=0; x<resolution; ++x) {
+                float * o = &origins[3*(y*resolution + x)],
+                      * d = &directions[3*(y*resolution + x)];
+
+                float u = fov * ((x + 0.5f) / resolution * 2.0f - 1.0f),
+                      v = fov * ((y + 0.5f) / resolution * 2.0f - 1.0f);
+
+                // camera looking at the origin down the (0, 3, -2) axis
+                o[0] = eye[0]; o[1] = eye[1]; o[2] = eye[2];
+                d[0] = u;
+                d[1] = 0.832f + 0.555f * v;
+                d[2] = -0.555f + 0.832f * v;
+            }
+        }
+    }
+    std::vector<Osd::CpuPatchBVH::Hit> hits(nrays);
+
+    std::vector<float> animated(positions.size());
+
+    Osd::CpuPatchBVH * bvh = NULL;
+
+    //
+    // Execution phase (every frame)
+    //
+    printf("%d patches, %d rays per frame\n",
+        patchTable->GetNumPatchesTotal(), nrays);
+
+    Stopwatch s;
+    for (int frame=0; frame<nframes; ++frame) {
+
+        animateTorus(positions, 0.1f * frame, &animated[0]);
+        vbuffer->UpdateData(&animated[0], 0, nCoarseVerts);
+
+        s.Start();
+        Osd::CpuEvaluator::EvalStencils(vbuffer, srcDesc,
+                                        vbuffer, dstDesc,
+                                        stencilTable);
+        s.Stop();
+        double evalTime = s.GetElapsed();
+
+        // Build the hierarchy on the first frame, refit it afterwards
+        float const * vertexData = vbuffer->BindCpuBuffer();
+
+        s.Start();
+        if (not bvh) {
+            bvh = Osd::CpuPatchBVH::Create(*patchTable, vertexData, srcDesc);
+        } else {
+            bvh->Refit(vertexData, srcDesc);
+        }
+        s.Stop();
+        double bvhTime = s.GetElapsed();
+
+        if (not bvh) {
+            printf("Error : unsupported patches\n");
+            break;
+        }
+
+        s.Start();
+        int nhits = bvh->IntersectRays(nrays, &origins[0], &directions[0],
+            0.0f, 1e30f, &hits[0]);
+        s.Stop();
+        double traceTime = s.GetElapsed();
+
+        printf("frame %2d : eval %7.3f ms, %s %7.3f ms, "
+            "trace %8.3f ms (%5.2f Mrays/s, %d hits)\n",
+            frame, evalTime*1000.0, frame ? "refit" : "build", bvhTime*1000.0,
+            traceTime*1000.0, nrays / traceTime * 1e-6, nhits);
+    }
+
+    delete bvh;
+    delete vbuffer;
+    delete stencilTable;
+    delete patchTable;
+}
+
+//------------------------------------------------------------------------------
+static void
+createTorus(std::vector<float> & positions,
+    std::vector<int> & vertsPerFace, std::vector<int> & vertIndices) {
+
+    float const pi = 3.14159265f;
+
+    for (int i=0; i<g_ringSegments; ++i) {
+        float ringAngle = 2.0f * pi * i / g_ringSegments;
+        for (int j=0; j<g_tubeSegments; ++j) {
+            float tubeAngle = 2.0f * pi * j / g_tubeSegments,
+                  radius = g_ringRadius + g_tubeRadius * cosf(tubeAngle);
+            positions.push_back(radius * cosf(ringAngle));
+            positions.push_back(radius * sinf(ringAngle));
+            positions.push_back(g_tubeRadius * sinf(tubeAngle));
+        }
+    }
+
+    for (int i=0; i<g_ringSegments; ++i) {
+        int i1 = (i+1) % g_ringSegments;
+        for (int j=0; j<g_tubeSegments; ++j) {
+            int j1 = (j+1) % g_tubeSegments;
+
+            // split every 8th quad of the first tube ring into 2 triangles
+            // to add a few extraordinary vertices
+            if (i==0 and (j%8)==0) {
+                vertsPerFace.push_back(3);
+                vertIndices.push_back(i *g_tubeSegments + j);
+                vertIndices.push_back(i1*g_tubeSegments + j);
+                vertIndices.push_back(i1*g_tubeSegments + j1);
+                vertsPerFace.push_back(3);
+                vertIndices.push_back(i *g_tubeSegments + j);
+                vertIndices.push_back(i1*g_tubeSegments + j1);
+                vertIndices.push_back(i *g_tubeSegments + j1);
+            } else {
+                vertsPerFace.push_back(4);
+                vertIndices.push_back(i *g_tubeSegments + j);
+                vertIndices.push_back(i1*g_tubeSegments + j);
+                vertIndices.push_back(i1*g_tubeSegments + j1);
+                vertIndices.push_back(i *g_tubeSegments + j1);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static void
+animateTorus(std::vector<float> const & positions, float time,
+    float * animated) {
+
+    // ripples traveling along the ring
+    for (int i=0; i<(int)positions.size()/3; ++i) {
+        float const * p = &positions[3*i];
+        float angle = atan2f(p[1], p[0]),
+              scale = 1.0f + 0.1f * sinf(6.0f * angle + time);
+        animated[3*i+0] = p[0];
+        animated[3*i+1] = p[1];
+        animated[3*i+2] = p[2] * scale;
+    }
+}
+
+//------------------------------------------------------------------------------
+static Far::TopologyRefiner *
+createTopologyRefiner(std::vector<int> const & vertsPerFace,
+    std::vector<int> const & vertIndices, int maxlevel) {
+
+    typedef Far::TopologyDescriptor Descriptor;
+
+    Sdc::SchemeType type = OpenSubdiv::Sdc::SCHEME_CATMARK;
+
+    Sdc::Options options;
+    options.SetVtxBoundaryInterpolation(Sdc::Options::VTX_BOUNDARY_EDGE_ONLY);
+
+    Descriptor desc;
+    desc.numVertices = g_ringSegments * g_tubeSegments;
+    desc.numFaces = (int)vertsPerFace.size();
+    desc.numVertsPerFace = &vertsPerFace[0];
+    desc.vertIndicesPerFace = &vertIndices[0];
+
+    Far::TopologyRefiner * refiner =
+        Far::TopologyRefinerFactory<Descriptor>::Create(desc,
+            Far::TopologyRefinerFactory<Descriptor>::Options(type, options));
+
+    // Adaptively refine the topology around the extraordinary features
+    refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(maxlevel));
+
+    return refiner;
+}
+
+//------------------------------------------------------------------------------